@@ -0,0 +1,104 @@
+#ifndef _X3D_BENCH_H_
+#define _X3D_BENCH_H_
+
+#include "internal/Trace.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace Bench {
+
+/**
+ * One timed run of a benchmark body. The body does its setup, calls
+ * resume() and then loops #iterations times; the clock stops when the
+ * body returns. Work done before resume() or between pause() and
+ * resume() is not counted.
+ */
+class Run {
+public:
+
+    /// number of times the body should do its work
+    size_t iterations;
+
+    /// items processed per iteration (events, nodes, values) for throughput
+    double items;
+
+    Run(size_t iterations) :
+        iterations(iterations), items(1), elapsed(0), begin(0), running(false) {}
+
+    /// start (or restart) the clock
+    void resume() {
+        if (!running) {
+            running = true;
+            begin = X3D::Trace::clock();
+        }
+    }
+
+    /// stop the clock, e.g. to rebuild state between iterations
+    void pause() {
+        if (running) {
+            elapsed += X3D::Trace::clock() - begin;
+            running = false;
+        }
+    }
+
+    /// @returns nanoseconds counted so far
+    uint64_t nanoseconds() const { return elapsed; }
+
+private:
+    uint64_t elapsed, begin;
+    bool running;
+};
+
+/// benchmark body
+typedef void (*Function)(Run& run);
+
+/// a registered benchmark
+struct Case {
+    string group;
+    string name;
+    Function function;
+
+    string fullName() const { return group + "." + name; }
+};
+
+/// @returns all registered benchmarks, in registration order
+inline vector<Case>& cases() {
+    static vector<Case> all;
+    return all;
+}
+
+/// Registers a benchmark at static initialization; see BENCH().
+struct Register {
+    Register(const char* group, const char* name, Function function) {
+        Case c;
+        c.group = group;
+        c.name = name;
+        c.function = function;
+        cases().push_back(c);
+    }
+};
+
+}
+
+/**
+ * Define a benchmark, in the style of gtest's TEST():
+ *
+ *   BENCH(Group, Name) {
+ *       // setup
+ *       run.resume();
+ *       for (size_t i = 0; i < run.iterations; i++)
+ *           ...
+ *   }
+ */
+#define BENCH(group, name) \
+    static void bench_##group##_##name(Bench::Run& run); \
+    static Bench::Register register_##group##_##name( \
+        #group, #name, bench_##group##_##name); \
+    static void bench_##group##_##name(Bench::Run& run)
+
+#endif // #ifndef _X3D_BENCH_H_
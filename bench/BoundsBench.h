@@ -0,0 +1,59 @@
+#include "Grouping/Group.h"
+
+using X3D::Grouping::Group;
+
+/// build Transforms of 1,000 bounded Transforms each, on a grid 100
+/// apart, ten to a side; @returns the outer Transforms
+static vector<Transform*> boundedScene(int count=100) {
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    vector<Transform*> groups;
+    for (int i = 0; i < count; i++) {
+        Transform* group = browser()->createNode<Transform>("Transform");
+        group->translation(SFVec3f((float) (i % 10) * 100,
+            (float) (i / 10 % 10) * 100, (float) (i / 100) * 100));
+        group->realize();
+        root->children().add(group);
+        groups.push_back(group);
+        for (int j = 0; j < 1000; j++) {
+            Transform* node = browser()->createNode<Transform>("Transform");
+            unsigned int h = (unsigned int) (i * 1000 + j) * 2654435761u;
+            node->translation(SFVec3f(
+                (float) (h % 97), (float) (h / 97 % 89), (float) (h / 8633 % 83)));
+            node->bboxSize(SFVec3f(1, 1, 1));
+            node->realize();
+            group->children().add(node);
+        }
+    }
+    browser()->bounds.update();
+    return groups;
+}
+
+/// rebuild the tree over 100,000 objects
+static void rebuildBounds(Bench::Run& run, size_t threshold) {
+    boundedScene();
+    browser()->bounds.setParallel(threshold);
+    run.items = 100000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        browser()->transforms.invalidateStructure();
+        browser()->bounds.update();
+    }
+    run.pause();
+    browser()->bounds.setParallel(16384);
+}
+
+BENCH(Bounds, Rebuild100k) { rebuildBounds(run, 100000); }
+BENCH(Bounds, RebuildParallel100k) { rebuildBounds(run, 16384); }
+
+/// move one of 100 groups of 1,000 objects, and refit
+BENCH(Bounds, Refit100k) {
+    vector<Transform*> groups = boundedScene();
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        groups[i % 100]->invalidate();
+        browser()->bounds.update();
+    }
+}
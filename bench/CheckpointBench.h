@@ -0,0 +1,25 @@
+#include "internal/Checkpoint.h"
+#include "internal/SceneGenerator.h"
+
+#include <cstdio>
+
+/// step a generated scene, taking a checkpoint every frame; compare Simulate1k
+BENCH(Checkpoint, Simulate1k) {
+    string path = generate(1000);
+    World* world = World::read(browser(), path.c_str());
+    remove(path.c_str());
+    browser()->wake(0);
+    browser()->simulate();
+    Checkpoint* checkpoint = browser()->checkpoint();
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 1; i <= run.iterations; i++) {
+        browser()->wake(i * 0.01);
+        browser()->simulate();
+        delete checkpoint;
+        checkpoint = browser()->checkpoint();
+    }
+    run.pause();
+    delete checkpoint;
+    delete world;
+}
@@ -0,0 +1,56 @@
+#include "Core/MetadataSet.h"
+#include "Core/MetadataFloat.h"
+#include "Time/TimeSensor.h"
+
+using X3D::Core::MetadataSet;
+using X3D::Core::MetadataFloat;
+using X3D::Time::TimeSensor;
+
+/// a two-level metadata tree with 111 nodes
+static MetadataSet* metadataTree() {
+    MetadataSet* root = browser()->createNode<MetadataSet>("MetadataSet");
+    for (int i = 0; i < 10; i++) {
+        MetadataSet* set = browser()->createNode<MetadataSet>("MetadataSet");
+        for (int j = 0; j < 10; j++) {
+            MetadataFloat* leaf = browser()->createNode<MetadataFloat>("MetadataFloat");
+            for (int k = 0; k < 16; k++)
+                leaf->value().add(k * 0.5f);
+            set->value().add(leaf);
+        }
+        root->value().add(set);
+    }
+    return root;
+}
+
+/// clones accumulate in the browser, so start over every so often
+static const size_t clonesPerScene = 100;
+
+BENCH(Clone, Deep111Nodes) {
+    Node* root = metadataTree();
+    run.items = 111;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        if (i % clonesPerScene == clonesPerScene - 1) {
+            run.pause();
+            browser()->reset();
+            root = metadataTree();
+            run.resume();
+        }
+        map<Node*,Node*> mapping;
+        root->clone(&mapping);
+    }
+}
+
+BENCH(Clone, ShallowTimeSensor) {
+    Node* node = browser()->createNode<TimeSensor>("TimeSensor");
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        if (i % clonesPerScene == clonesPerScene - 1) {
+            run.pause();
+            browser()->reset();
+            node = browser()->createNode<TimeSensor>("TimeSensor");
+            run.resume();
+        }
+        node->clone(NULL, true);
+    }
+}
@@ -0,0 +1,8 @@
+#include "internal/DeltaStream.h"
+
+/// step a generated scene while writing its deltas; compare Simulate1k
+BENCH(Delta, Simulate1k) {
+    browser()->deltas.open("/dev/null");
+    simulateGenerated(run, 1000);
+    browser()->deltas.close();
+}
@@ -0,0 +1,8 @@
+#include "internal/EventLog.h"
+
+/// step a generated scene while logging its events; compare Simulate1k
+BENCH(EventLog, Record1k) {
+    browser()->recorder.open("/dev/null");
+    simulateGenerated(run, 1000);
+    browser()->recorder.close();
+}
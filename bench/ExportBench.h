@@ -0,0 +1,26 @@
+#include "internal/SharedExport.h"
+
+#include <unistd.h>
+
+/// export 100 interpolator outputs, all changing every frame
+BENCH(Export, Changed100) {
+    vector<ScalarInterpolator*> nodes;
+    SharedExport out;
+    char name[32];
+    for (int i = 0; i < 100; i++) {
+        nodes.push_back(identity());
+        sprintf(name, "value%d", i);
+        out.add(&nodes.back()->value_changed, name);
+    }
+    sprintf(name, "/x3d-bench-%d", (int) getpid());
+    out.open(name);
+    run.items = 100;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        for (size_t j = 0; j < nodes.size(); j++)
+            nodes[j]->set_fraction(((i + j) % 100) * 0.01f);
+        browser()->wake(i * 0.01);
+        browser()->simulate();
+    }
+    out.close();
+}
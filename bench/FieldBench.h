@@ -0,0 +1,87 @@
+#include <sstream>
+
+using std::istringstream;
+using std::ostringstream;
+
+/// parse the same text into a new field repeatedly (MF parsing appends)
+template <class F>
+static void parseLoop(Bench::Run& run, const string& text) {
+    istringstream is(text);
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        F field;
+        is.clear();
+        is.seekg(0);
+        if (!field.parse(is))
+            throw X3DError("benchmark input did not parse: " + text.substr(0, 40));
+    }
+}
+
+/// print a field repeatedly
+static void printLoop(Bench::Run& run, const X3DField& field) {
+    ostringstream os;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        os.str("");
+        field.print(os);
+    }
+}
+
+/// text of n whitespace-separated floats
+static string floatText(int n, int perValue=1) {
+    ostringstream os;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < perValue; j++)
+            os << (i * 0.25f + j) << " ";
+        if (perValue > 1)
+            os << ", ";
+    }
+    return os.str();
+}
+
+BENCH(Field, ParseSFVec3f) {
+    parseLoop<SFVec3f>(run, "1.5 -2.25 3e2");
+}
+
+BENCH(Field, PrintSFVec3f) {
+    SFVec3f field(1.5f, -2.25f, 300.0f);
+    printLoop(run, field);
+}
+
+BENCH(Field, ParseSFRotation) {
+    parseLoop<SFRotation>(run, "0 1 0 1.5707963");
+}
+
+BENCH(Field, ParseMFFloat10000) {
+    run.items = 10000;
+    parseLoop<MFFloatArray>(run, floatText(10000));
+}
+
+BENCH(Field, PrintMFFloat10000) {
+    MFFloatArray field;
+    for (int i = 0; i < 10000; i++)
+        field.add(i * 0.25f);
+    run.items = 10000;
+    printLoop(run, field);
+}
+
+BENCH(Field, ParseMFVec3f1000) {
+    run.items = 1000;
+    parseLoop<MFVec3fArray>(run, floatText(1000, 3));
+}
+
+BENCH(Field, PrintMFVec3f1000) {
+    MFVec3fArray field;
+    for (int i = 0; i < 1000; i++)
+        field.add(SFVec3f(i, i / 2, -i));
+    run.items = 1000;
+    printLoop(run, field);
+}
+
+BENCH(Field, ParseMFString100) {
+    ostringstream os;
+    for (int i = 0; i < 100; i++)
+        os << "\"string number " << i << "\" ";
+    run.items = 100;
+    parseLoop<MFStringArray>(run, os.str());
+}
@@ -0,0 +1,57 @@
+#include "internal/SceneGenerator.h"
+
+#include <cstdio>
+
+/// write a default-shaped generated scene of about n nodes
+static string generate(size_t nodes) {
+    static const char* filename = "generated.x3d";
+    SceneGenerator gen;
+    gen.scaleTo(nodes);
+    gen.write(filename);
+    return filename;
+}
+
+/// load a generated scene once per iteration
+static void readGenerated(Bench::Run& run, size_t nodes) {
+    string path = generate(nodes);
+    run.items = nodes;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        delete World::read(browser(), path.c_str());
+        browser()->reset();
+    }
+    run.pause();
+    remove(path.c_str());
+}
+
+/**
+ * Step a generated scene one frame per iteration; its sensors loop. The
+ * first frame, which initializes every root and sensor, isn't timed.
+ * In demand-driven mode, the sink interpolators at the end of each chain
+ * and the coordinate interpolators aren't observed, so they don't run.
+ */
+static void simulateGenerated(Bench::Run& run, size_t nodes, bool demand=false) {
+    browser()->setDemandDriven(demand);
+    string path = generate(nodes);
+    World* world = World::read(browser(), path.c_str());
+    remove(path.c_str());
+    browser()->wake(0);
+    browser()->simulate();
+    run.items = nodes;
+    run.resume();
+    for (size_t i = 1; i <= run.iterations; i++) {
+        browser()->wake(i * 0.01);
+        browser()->simulate();
+    }
+    run.pause();
+    delete world;
+    browser()->setDemandDriven(false);
+}
+
+BENCH(Generated, Read1k) { readGenerated(run, 1000); }
+BENCH(Generated, Read10k) { readGenerated(run, 10000); }
+BENCH(Generated, Read100k) { readGenerated(run, 100000); }
+BENCH(Generated, Simulate1k) { simulateGenerated(run, 1000); }
+BENCH(Generated, Simulate10k) { simulateGenerated(run, 10000); }
+BENCH(Generated, Simulate100k) { simulateGenerated(run, 100000); }
+BENCH(Generated, Simulate10kDemand) { simulateGenerated(run, 10000, true); }
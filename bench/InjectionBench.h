@@ -0,0 +1,14 @@
+/// queue values for 100 fields, ten each, and drain them in one step
+BENCH(Injection, Coalesce1000) {
+    vector<ScalarInterpolator*> nodes;
+    for (int i = 0; i < 100; i++)
+        nodes.push_back(identity());
+    InjectionQueue& queue = browser()->injections;
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        for (int j = 0; j < 1000; j++)
+            queue.inject(&nodes[j % 100]->set_fraction, SFFloat((j % 10) * 0.1f));
+        browser()->simulate();
+    }
+}
@@ -0,0 +1,52 @@
+#include "Interpolation/PositionInterpolator.h"
+#include "Interpolation/CoordinateInterpolator.h"
+
+using X3D::Interpolation::X3DInterpolatorNode;
+using X3D::Interpolation::PositionInterpolator;
+using X3D::Interpolation::CoordinateInterpolator;
+
+/// fill the key field with n evenly spaced keys on [0,1]
+static void evenKeys(X3DInterpolatorNode* node, int n) {
+    for (int i = 0; i < n; i++)
+        node->key().array().push_back(i / (float) (n - 1));
+}
+
+/// drive an interpolator with a sweep of fractions
+static void sweep(Bench::Run& run, X3DInterpolatorNode* node) {
+    node->realize();
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        // step by a prime so successive fractions land in different keys
+        node->set_fraction((i * 37 % 1000) * 0.001f);
+        browser()->route();
+        browser()->endRoute();
+    }
+}
+
+BENCH(Interpolation, Scalar64Keys) {
+    ScalarInterpolator* node =
+        browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+    evenKeys(node, 64);
+    for (int i = 0; i < 64; i++)
+        node->keyValue().array().push_back(i * i);
+    sweep(run, node);
+}
+
+BENCH(Interpolation, Position64Keys) {
+    PositionInterpolator* node =
+        browser()->createNode<PositionInterpolator>("PositionInterpolator");
+    evenKeys(node, 64);
+    for (int i = 0; i < 64; i++)
+        node->keyValue().array().push_back(SFVec3f(i, i * 2, i * 3));
+    sweep(run, node);
+}
+
+BENCH(Interpolation, Coordinate16Keys1000Points) {
+    CoordinateInterpolator* node =
+        browser()->createNode<CoordinateInterpolator>("CoordinateInterpolator");
+    evenKeys(node, 16);
+    for (int i = 0; i < 16 * 1000; i++)
+        node->keyValue().array().push_back(SFVec3f(i, -i, i / 2));
+    run.items = 1000;
+    sweep(run, node);
+}
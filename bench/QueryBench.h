@@ -0,0 +1,83 @@
+#include "internal/SpatialQuery.h"
+
+/// @returns a point spread over the first so many groups of boundedScene()
+static SFVec3f queryPoint(unsigned int i, int groups) {
+    unsigned int h = (i + 1) * 2654435761u;
+    float side = groups >= 10 ? 1000.0f : 100.0f * groups;
+    float x = (float) (h % 1000) / 1000 * side;
+    float y = (float) (h / 1000 % 1000) / 1000 * (groups > 10 ? 1000 : 100);
+    float z = (float) (h / 1000000 % 1000) / 1000 * 100 * ((groups + 99) / 100);
+    return SFVec3f(x, y, z);
+}
+
+/// cast batches of 10,000 rays along x through a scene of groups * 1,000
+static void castRays(Bench::Run& run, int groups) {
+    boundedScene(groups);
+    vector<Ray> rays;
+    for (unsigned int i = 0; i < 10000; i++) {
+        SFVec3f p = queryPoint(i, groups);
+        rays.push_back(Ray(SFVec3f(-10.0f, p.y, p.z), SFVec3f(1.0f, 0.01f, 0.0f)));
+    }
+    vector<RayHit> hits;
+    run.items = 10000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        browser()->raycast(rays, hits);
+}
+
+/// find the objects in batches of 10,000 boxes of side 10
+static void overlapBoxes(Bench::Run& run, int groups) {
+    boundedScene(groups);
+    vector<BoundingBox> boxes;
+    for (unsigned int i = 0; i < 10000; i++) {
+        SFVec3f p = queryPoint(i, groups);
+        boxes.push_back(BoundingBox(p, p + SFVec3f(10, 10, 10)));
+    }
+    QueryResults results;
+    run.items = 10000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        browser()->overlap(boxes, results);
+}
+
+/// find the 8 nearest objects to each of a batch of 10,000 points
+static void findNearest(Bench::Run& run, int groups) {
+    boundedScene(groups);
+    vector<SFVec3f> points;
+    for (unsigned int i = 0; i < 10000; i++)
+        points.push_back(queryPoint(i, groups));
+    QueryResults results;
+    run.items = 10000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        browser()->nearest(points, 8, results);
+}
+
+/// cull a scene against a batch of 64 frusta, each seeing about 1%
+static void cullFrusta(Bench::Run& run, int groups) {
+    boundedScene(groups);
+    vector<Frustum> frusta;
+    for (unsigned int i = 0; i < 64; i++) {
+        // orthographic view of a 100-unit cube
+        SFVec3f p = queryPoint(i, groups);
+        float m[16] = {
+            0.02f, 0, 0, -0.02f * p.x - 1,
+            0, 0.02f, 0, -0.02f * p.y - 1,
+            0, 0, 0.02f, -0.02f * p.z - 1,
+            0, 0, 0, 1
+        };
+        frusta.push_back(Frustum::fromMatrix(m));
+    }
+    QueryResults results;
+    run.items = 64;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        browser()->overlap(frusta, results);
+}
+
+BENCH(Query, Raycast100k) { castRays(run, 100); }
+BENCH(Query, Overlap100k) { overlapBoxes(run, 100); }
+BENCH(Query, Nearest100k) { findNearest(run, 100); }
+BENCH(Query, Frustum100k) { cullFrusta(run, 100); }
+BENCH(Query, Raycast1M) { castRays(run, 1000); }
+BENCH(Query, Nearest1M) { findNearest(run, 1000); }
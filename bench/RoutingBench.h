@@ -0,0 +1,66 @@
+#include "Interpolation/ScalarInterpolator.h"
+
+using X3D::Interpolation::ScalarInterpolator;
+
+/// create a realized identity interpolator: fraction in, same value out
+static ScalarInterpolator* identity() {
+    ScalarInterpolator* node =
+        browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+    node->key().array().push_back(0);
+    node->key().array().push_back(1);
+    node->keyValue().array().push_back(0);
+    node->keyValue().array().push_back(1);
+    node->realize();
+    return node;
+}
+
+/// send one event into the source and run the cascade
+static void pulse(ScalarInterpolator* source, size_t i) {
+    source->set_fraction((i % 100) * 0.01f);
+    browser()->wake(i * 0.01);
+    browser()->simulate();
+}
+
+/// one output routed to many inputs
+BENCH(Routing, FanOut1000) {
+    ScalarInterpolator* source = identity();
+    for (int i = 0; i < 1000; i++)
+        browser()->createRoute(source, "value_changed", identity(), "set_fraction");
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        pulse(source, i);
+}
+
+/// many outputs routed to one input
+BENCH(Routing, FanIn1000) {
+    vector<ScalarInterpolator*> sources;
+    ScalarInterpolator* sink = identity();
+    for (int i = 0; i < 1000; i++) {
+        sources.push_back(identity());
+        browser()->createRoute(sources.back(), "value_changed", sink, "set_fraction");
+    }
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        for (size_t j = 0; j < sources.size(); j++)
+            sources[j]->set_fraction(((i + j) % 100) * 0.01f);
+        browser()->wake(i * 0.01);
+        browser()->simulate();
+    }
+}
+
+/// a linear chain of routes, one hop per node
+BENCH(Routing, Chain1000) {
+    ScalarInterpolator* source = identity();
+    ScalarInterpolator* last = source;
+    for (int i = 0; i < 1000; i++) {
+        ScalarInterpolator* next = identity();
+        browser()->createRoute(last, "value_changed", next, "set_fraction");
+        last = next;
+    }
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++)
+        pulse(source, i);
+}
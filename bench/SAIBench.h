@@ -0,0 +1,81 @@
+#include "internal/SAIServer.h"
+#include "internal/SAIClient.h"
+#include "internal/Atomic.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/// a client thread driving a bench's server
+struct SAIBenchClient {
+    string path;
+    size_t fields;
+    size_t iterations;
+    bool roundTrip;
+    int ready;
+    int done;
+};
+
+/// look up fields, then send batches of sets or wait for each change
+static void* driveServer(void* arg) {
+    SAIBenchClient* bench = (SAIBenchClient*) arg;
+    SAIClient client;
+    client.connect(bench->path);
+    vector<uint32_t> inputs;
+    char name[32];
+    for (size_t i = 0; i < bench->fields; i++) {
+        sprintf(name, "N%lu", (unsigned long) i);
+        uint32_t node = client.getNode(name);
+        inputs.push_back(client.getField(node, "set_fraction").handle);
+        if (bench->roundTrip)
+            client.subscribe(client.getField(node, "value_changed").handle);
+    }
+    X3D::atomicStore(&bench->ready, 1);
+    for (size_t i = 0; i < bench->iterations; i++) {
+        if (bench->roundTrip) {
+            client.set(inputs[0], SFFloat((i % 2) * 0.5f));
+            client.receive();
+        } else {
+            for (int j = 0; j < 1000; j++)
+                client.set(inputs[j % inputs.size()], SFFloat((j % 10) * 0.1f));
+            client.sync();
+        }
+    }
+    client.close();
+    X3D::atomicStore(&bench->done, 1);
+    return NULL;
+}
+
+/// serve a client thread, timing it once it has looked up its fields
+static void serveBenchClient(Bench::Run& run, size_t fields, bool roundTrip) {
+    char path[64], name[32];
+    sprintf(path, "/tmp/x3d-bench-%d.sock", (int) getpid());
+    for (size_t i = 0; i < fields; i++) {
+        sprintf(name, "N%lu", (unsigned long) i);
+        browser()->getScope()->define(name, identity());
+    }
+    SAIServer server;
+    server.listen(path);
+    SAIBenchClient bench = { path, fields, run.iterations, roundTrip, 0, 0 };
+    pthread_t id;
+    pthread_create(&id, NULL, driveServer, &bench);
+    while (!X3D::atomicLoad(&bench.ready))
+        server.poll(1);
+    run.resume();
+    while (!X3D::atomicLoad(&bench.done))
+        server.poll(1);
+    run.pause();
+    pthread_join(id, NULL);
+    server.close();
+}
+
+/// a client streams 1000 sets to 100 fields, then waits for their cascade
+BENCH(SAI, Set1000) {
+    run.items = 1000;
+    serveBenchClient(run, 100, false);
+}
+
+/// a client sets a field and waits to be told of the change it causes
+BENCH(SAI, RoundTrip) {
+    run.items = 1;
+    serveBenchClient(run, 1, true);
+}
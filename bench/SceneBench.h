@@ -0,0 +1,56 @@
+#ifndef TOP_SRCDIR
+#define TOP_SRCDIR ".."
+#endif
+
+/// @returns path of a file relative to the top of the source tree
+static string dataPath(const char* name) {
+    return string(TOP_SRCDIR) + "/" + name;
+}
+
+/**
+ * Load a scene and step it through its active period at 100 frames per
+ * second. Time can't be rewound, so the scene is reloaded (untimed) for
+ * every iteration.
+ */
+static void simulateScene(Bench::Run& run, const char* name, double seconds) {
+    string path = dataPath(name);
+    int frames = (int) (seconds * 100);
+    run.items = frames;
+    for (size_t i = 0; i < run.iterations; i++) {
+        World* world = World::read(browser(), path.c_str());
+        run.resume();
+        for (int frame = 0; frame <= frames; frame++) {
+            browser()->wake(frame * 0.01);
+            browser()->simulate();
+        }
+        run.pause();
+        delete world;
+        browser()->reset();
+    }
+}
+
+/// load and discard a scene once per iteration
+static void readScene(Bench::Run& run, const char* name) {
+    string path = dataPath(name);
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        delete World::read(browser(), path.c_str());
+        browser()->reset();
+    }
+}
+
+BENCH(Scene, SimulateTimeSensor) {
+    simulateScene(run, "test/data/TimeSensor.xml", 6);
+}
+
+BENCH(Scene, SimulateInterpolate) {
+    simulateScene(run, "test/data/Interpolate.xml", 2);
+}
+
+BENCH(Scene, ReadInterpolate) {
+    readScene(run, "test/data/Interpolate.xml");
+}
+
+BENCH(Scene, ReadVenus) {
+    readScene(run, "data/venus.x3d");
+}
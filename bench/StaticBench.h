@@ -0,0 +1,64 @@
+#include "Grouping/StaticGroup.h"
+
+using X3D::Grouping::StaticGroup;
+
+/// build a StaticGroup of 1,000 bounded Transforms, used by 100 Transforms
+/// on a grid 100 apart; @returns the Transforms using it
+static vector<Transform*> instancedScene(bool compile) {
+    StaticGroup* model = browser()->createNode<StaticGroup>("StaticGroup");
+    model->realize();
+    for (int j = 0; j < 1000; j++) {
+        Transform* node = browser()->createNode<Transform>("Transform");
+        unsigned int h = (unsigned int) j * 2654435761u;
+        node->translation(SFVec3f(
+            (float) (h % 97), (float) (h / 97 % 89), (float) (h / 8633 % 83)));
+        node->bboxSize(SFVec3f(1, 1, 1));
+        node->realize();
+        model->children().add(node);
+    }
+    if (compile)
+        model->compile();
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    vector<Transform*> uses;
+    for (int i = 0; i < 100; i++) {
+        Transform* use = browser()->createNode<Transform>("Transform");
+        use->translation(SFVec3f((float) (i % 10) * 100,
+            (float) (i / 10) * 100, 0.0f));
+        use->realize();
+        use->children().add(model);
+        root->children().add(use);
+        uses.push_back(use);
+    }
+    browser()->bounds.update();
+    return uses;
+}
+
+/// rebuild the transforms and bounds of 100 uses of 1,000 nodes
+static void rebuildInstances(Bench::Run& run, bool compile) {
+    instancedScene(compile);
+    run.items = 100000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        browser()->transforms.invalidateStructure();
+        browser()->bounds.update();
+    }
+}
+
+/// move every use of 1,000 nodes, and refit
+static void moveInstances(Bench::Run& run, bool compile) {
+    vector<Transform*> uses = instancedScene(compile);
+    run.items = 100000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        for (size_t j = 0; j < uses.size(); j++)
+            uses[j]->invalidate();
+        browser()->bounds.update();
+    }
+}
+
+BENCH(Static, Rebuild100k) { rebuildInstances(run, true); }
+BENCH(Static, RebuildDynamic100k) { rebuildInstances(run, false); }
+BENCH(Static, Move100k) { moveInstances(run, true); }
+BENCH(Static, MoveDynamic100k) { moveInstances(run, false); }
@@ -0,0 +1,28 @@
+/// counts the changes it is sent
+class CountingObserver : public FieldObserver {
+public:
+    size_t count;
+    CountingObserver() : count(0) {}
+    void changed(const vector<Change>& changes) { count += changes.size(); }
+};
+
+/// one observer on each of 1000 interpolators, of which some change
+static void observe(Bench::Run& run, size_t changing) {
+    vector<ScalarInterpolator*> nodes;
+    vector<CountingObserver> observers(1000);
+    for (int i = 0; i < 1000; i++) {
+        nodes.push_back(identity());
+        nodes.back()->value_changed.subscribe(&observers[i]);
+    }
+    run.items = changing;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        for (size_t j = 0; j < changing; j++)
+            nodes[(i * changing + j) % 1000]->set_fraction(((i + j) % 100) * 0.01f);
+        browser()->wake(i * 0.01);
+        browser()->simulate();
+    }
+}
+
+BENCH(Subscription, Sparse10of1000) { observe(run, 10); }
+BENCH(Subscription, Dense1000) { observe(run, 1000); }
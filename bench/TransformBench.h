@@ -0,0 +1,62 @@
+#include "Grouping/Transform.h"
+
+using X3D::Grouping::Transform;
+
+/// build a tree of Transforms, four children per node, to the given depth;
+/// @returns the nodes in the order created, root first
+static vector<Transform*> transformTree(int depth) {
+    vector<Transform*> nodes;
+    nodes.push_back(browser()->createNode<Transform>("Transform"));
+    nodes.back()->realize();
+    browser()->addRoot(nodes.back());
+    size_t level = 0, end = 1;
+    for (int d = 1; d < depth; d++) {
+        for (; level < end; level++) {
+            for (int i = 0; i < 4; i++) {
+                Transform* node = browser()->createNode<Transform>("Transform");
+                node->translation().x = (float) i;
+                node->realize();
+                nodes[level]->children().add(node);
+                nodes.push_back(node);
+            }
+        }
+        end = nodes.size();
+    }
+    browser()->transforms.update();
+    return nodes;
+}
+
+/// recompute every world matrix of a 5,461-node tree
+BENCH(Transform, UpdateAll5k) {
+    vector<Transform*> nodes = transformTree(7);
+    run.items = (double) nodes.size();
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        nodes[0]->invalidate();
+        browser()->transforms.update();
+    }
+}
+
+/// recompute the world matrices of one leaf in a 5,461-node tree
+BENCH(Transform, UpdateLeaf5k) {
+    vector<Transform*> nodes = transformTree(7);
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        nodes[nodes.size() - 1 - i % 1024]->invalidate();
+        browser()->transforms.update();
+    }
+}
+
+/// query the world matrix of every node in a 5,461-node tree
+BENCH(Transform, Query5k) {
+    vector<Transform*> nodes = transformTree(7);
+    run.items = (double) nodes.size();
+    run.resume();
+    float sum = 0;
+    for (size_t i = 0; i < run.iterations; i++)
+        for (size_t j = 0; j < nodes.size(); j++)
+            sum += nodes[j]->getWorldMatrix().array()[3];
+    run.pause();
+    if (sum < 0)
+        printf("%f\n", sum);
+}
@@ -0,0 +1,31 @@
+#include "Grouping/Transform.h"
+
+using X3D::Grouping::Transform;
+
+/// move 100 transforms ten times each through SAIField::set()
+static void moveTransforms(Bench::Run& run, bool batched) {
+    vector<Transform*> nodes;
+    for (int i = 0; i < 100; i++) {
+        nodes.push_back(browser()->createNode<Transform>("Transform"));
+        nodes.back()->realize();
+    }
+    run.items = 1000;
+    run.resume();
+    for (size_t i = 0; i < run.iterations; i++) {
+        if (batched)
+            browser()->beginUpdate();
+        for (int j = 0; j < 1000; j++) {
+            float x = (float) (i + j);
+            nodes[j % 100]->translation.set(SFVec3f(x, 0.0f, 0.0f));
+        }
+        if (batched) {
+            browser()->endUpdate();
+        } else {
+            browser()->route();
+            browser()->endRoute();
+        }
+    }
+}
+
+BENCH(Update, Direct1000) { moveTransforms(run, false); }
+BENCH(Update, Batched1000) { moveTransforms(run, true); }
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Performance benchmarks.
+ *
+ * usage: run_bench [-l] [-f filter] [-t seconds] [-r repeats] [-j file]
+ *
+ *   -l  list benchmark names and exit
+ *   -f  only run benchmarks whose name contains the filter
+ *   -t  minimum timed duration of each repeat (default 0.2)
+ *   -r  number of timed repeats; the median is reported (default 5)
+ *   -j  also write results as JSON to the file ("-" for stdout only)
+ *
+ * Compare JSON output against a stored baseline with bin/bench-compare.
+ */
+
+#include "internal/Browser.h"
+#include "internal/World.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ofstream;
+using std::ostream;
+
+#include <libxml/parser.h>
+
+using namespace X3D;
+
+Browser* browser() {
+	return Browser::getSingleton();
+}
+
+#include "Bench.h"
+
+// here's the list of benchmarks
+#include "RoutingBench.h"
+#include "InterpolationBench.h"
+#include "FieldBench.h"
+#include "CloneBench.h"
+#include "SceneBench.h"
+#include "GeneratedBench.h"
+#include "InjectionBench.h"
+#include "UpdateBench.h"
+#include "SubscriptionBench.h"
+#include "ExportBench.h"
+#include "SAIBench.h"
+#include "DeltaBench.h"
+#include "CheckpointBench.h"
+#include "EventLogBench.h"
+#include "TransformBench.h"
+#include "BoundsBench.h"
+#include "QueryBench.h"
+#include "StaticBench.h"
+
+/// outcome of one benchmark
+struct Result {
+    string name;
+    string error;
+    size_t iterations;
+    double nsPerOp;
+    double minNsPerOp;
+    double itemsPerSecond;
+};
+
+/// run the body once with n iterations, leaving the browser empty
+static Bench::Run runOnce(const Bench::Case& c, size_t n) {
+    Bench::Run run(n);
+    try {
+        c.function(run);
+    } catch (...) {
+        browser()->reset();
+        throw;
+    }
+    run.pause();
+    browser()->reset();
+    return run;
+}
+
+static Result measure(const Bench::Case& c, double minSeconds, int repeats) {
+    Result result;
+    result.name = c.fullName();
+    result.iterations = 0;
+    result.nsPerOp = result.minNsPerOp = result.itemsPerSecond = 0;
+    try {
+        // grow the iteration count until one run takes long enough
+        uint64_t target = (uint64_t) (minSeconds * 1e9);
+        size_t n = 1;
+        Bench::Run run = runOnce(c, n);
+        while (run.nanoseconds() < target) {
+            double scale = run.nanoseconds() ?
+                1.2 * target / run.nanoseconds() : 100;
+            n = (size_t) (n * std::min(100.0, std::max(2.0, scale)));
+            run = runOnce(c, n);
+        }
+        vector<double> perOp;
+        double items = run.items;
+        for (int i = 0; i < repeats; i++) {
+            run = runOnce(c, n);
+            perOp.push_back((double) run.nanoseconds() / n);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        result.iterations = n;
+        result.nsPerOp = perOp[perOp.size() / 2];
+        result.minNsPerOp = perOp[0];
+        result.itemsPerSecond = items * 1e9 / result.nsPerOp;
+    } catch (X3DError& e) {
+        result.error = e.what();
+    } catch (std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+static void printResult(const Result& r) {
+    char buf[160];
+    if (!r.error.empty()) {
+        sprintf(buf, "%-40s  error: ", r.name.c_str());
+        cout << buf << r.error << endl;
+        return;
+    }
+    sprintf(buf, "%-40s %12.1f ns/op %12.1f ns min %14.0f items/s %10lu iters",
+        r.name.c_str(), r.nsPerOp, r.minNsPerOp, r.itemsPerSecond,
+        (unsigned long) r.iterations);
+    cout << buf << endl;
+}
+
+static string jsonString(const string& s) {
+    string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (c == '\n')
+            out += "\\n";
+        else
+            out += c;
+    }
+    return out + "\"";
+}
+
+static void writeJson(ostream& os, const vector<Result>& results) {
+    char buf[160];
+#ifdef __OPTIMIZE__
+    const char* optimized = "true";
+#else
+    const char* optimized = "false";
+#endif
+    os << "{" << endl
+       << "  \"version\": 1," << endl
+       << "  \"optimized\": " << optimized << "," << endl
+       << "  \"results\": [" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << "    {\"name\": " << jsonString(r.name);
+        if (!r.error.empty()) {
+            os << ", \"error\": " << jsonString(r.error);
+        } else {
+            sprintf(buf, ", \"iterations\": %lu, \"ns_per_op\": %.2f, "
+                         "\"min_ns_per_op\": %.2f, \"items_per_second\": %.1f",
+                (unsigned long) r.iterations, r.nsPerOp, r.minNsPerOp,
+                r.itemsPerSecond);
+            os << buf;
+        }
+        os << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    os << "  ]" << endl << "}" << endl;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = "";
+    const char* json = NULL;
+    double seconds = 0.2;
+    int repeats = 5;
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "-l"))
+            list = true;
+        else if (!strcmp(argv[i], "-f") && more)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "-t") && more)
+            seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && more)
+            repeats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-j") && more)
+            json = argv[++i];
+        else {
+            cerr << "usage: " << argv[0]
+                 << " [-l] [-f filter] [-t seconds] [-r repeats] [-j file]" << endl;
+            return 2;
+        }
+    }
+    if (repeats < 1)
+        repeats = 1;
+
+    LIBXML_TEST_VERSION
+    Browser browser;
+    bool toStdout = json != NULL && !strcmp(json, "-");
+    vector<Result> results;
+    vector<Bench::Case>& cases = Bench::cases();
+    for (size_t i = 0; i < cases.size(); i++) {
+        if (cases[i].fullName().find(filter) == string::npos)
+            continue;
+        if (list) {
+            cout << cases[i].fullName() << endl;
+            continue;
+        }
+        results.push_back(measure(cases[i], seconds, repeats));
+        if (!toStdout)
+            printResult(results.back());
+    }
+
+    if (toStdout) {
+        writeJson(cout, results);
+    } else if (json != NULL) {
+        ofstream out(json);
+        if (!out) {
+            cerr << argv[0] << ": can't write " << json << endl;
+            return 1;
+        }
+        writeJson(out, results);
+    }
+    xmlCleanupParser();
+    return 0;
+}
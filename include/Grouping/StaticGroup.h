@@ -22,14 +22,53 @@
 
 #include "Grouping/X3DBoundedObject.h"
 #include "Core/X3DChildNode.h"
+#include "internal/CompiledGroup.h"
+
+using X3D::Core::X3DChildNode;
 
 namespace X3D {
 namespace Grouping {
 
+/**
+ * Group whose contents don't change once loaded. After compile(), which
+ * Browser::compileStaticGroups() calls when a world is read, the nodes
+ * below are frozen and flattened into a CompiledGroup, shared by every
+ * use of the group; the browser then treats the group as a single
+ * object with the bounds of its contents.
+ *
+ * \see ISO-IEC-19775-1.2 Part 1, 10.4.3 "StaticGroup"
+ */
 class StaticGroup : public X3DChildNode, public X3DBoundedObject {
 public:
     DefaultInOutField<StaticGroup, MFNodeSet<X3DChildNode> > children;
+
+    /// Constructor.
+    StaticGroup() : compiled(NULL) {}
+
+    /// Destructor.
+    ~StaticGroup();
+
     void setup() {}
+
+    /**
+     * Freeze and flatten the group's contents. A group with routes into
+     * or out of its contents is left as it is. Unless bounds were given,
+     * those of the contents become the group's.
+     *
+     * @returns whether the group is now compiled
+     */
+    bool compile();
+
+    /// @returns whether the group has been compiled
+    bool isCompiled() const { return compiled != NULL; }
+
+    /// @returns flattened contents, or NULL if not compiled
+    const CompiledGroup* getCompiled() const { return compiled; }
+
+private:
+
+    /// flattened contents
+    CompiledGroup* compiled;
 };
 
 }}
@@ -17,16 +17,77 @@
  * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef _X3D_TRANSFORM_H_
+#define _X3D_TRANSFORM_H_
+
+#include "Grouping/X3DGroupingNode.h"
+#include "internal/SFMatrix.h"
+#include "internal/SFRotation.h"
+
 namespace X3D {
 namespace Grouping {
 
+/**
+ * Grouping node which places its children in the coordinate system
+ * given by its fields, relative to its parent's. The node caches its
+ * local matrix, and the browser's TransformHierarchy caches the world
+ * matrix of each Transform in the scene; both are marked stale when a
+ * field changes through the usual channels. A field set silently, as by
+ * a checkpoint or a DeltaReader, needs a call to invalidate().
+ *
+ * Matrices take column vectors, $ p' = M p $, so the local matrix is
+ * $ T \cdot C \cdot R \cdot SR \cdot S \cdot SR^{-1} \cdot C^{-1} $.
+ *
+ * \see ISO-IEC-19775-1.2 Part 1, 10.4.4 "Transform"
+ */
 class Transform : public X3DGroupingNode {
 public:
-    DefaultInOutField<Transform, SFVec3f> center;
-    DefaultInOutField<Transform, SFRotation> rotation;
-    DefaultInOutField<Transform, SFVec3f> scale;
-    DefaultInOutField<Transform, SFRotation> scaleOrientation;
-    DefaultInOutField<Transform, SFVec3f> translation;
+
+    /// field which marks the matrices stale when it changes
+    template <class T> class MatrixField : public InOutField<Transform, T> {
+        void action() {
+            this->node()->invalidate();
+        }
+    };
+
+    MatrixField<SFVec3f> center;
+    MatrixField<SFRotation> rotation;
+    MatrixField<SFVec3f> scale;
+    MatrixField<SFRotation> scaleOrientation;
+    MatrixField<SFVec3f> translation;
+
+    /// Constructor.
+    Transform() : matrixDirty(true) {}
+
+    void setup() {
+        scale.value = SFVec3f(1, 1, 1);
+    }
+
+    /// @returns local matrix, composed from the fields when they changed
+    const SFMatrix4f& getMatrix();
+
+    /**
+     * Get the matrix from this node's coordinates to the world's, as
+     * cached by Browser::transforms. If the node is used more than
+     * once, the first instance is given.
+     *
+     * @returns world matrix
+     * @throws X3DError if the node isn't in the scene graph
+     */
+    SFMatrix4f getWorldMatrix();
+
+    /// Mark the local and world matrices stale.
+    void invalidate();
+
+private:
+
+    /// cached local matrix
+    SFMatrix4f matrix;
+
+    /// whether #matrix needs composing
+    bool matrixDirty;
 };
 
 }}
+
+#endif // #ifndef _X3D_TRANSFORM_H_
@@ -21,17 +21,44 @@
 #define _X3D_X3DBOUNDEDOBJECT_H_
 
 #include "Core/X3DNode.h"
+#include "internal/BoundingBox.h"
 #include "internal/InitField.h"
 #include "internal/SFVec.h"
 
 namespace X3D {
 namespace Grouping {
 
+/**
+ * Node with bounds. A bboxSize of (-1, -1, -1) means the bounds are
+ * unknown, in which case the browser computes them from the children.
+ *
+ * \see ISO-IEC-19775-1.2 Part 1, 10.3.1 "X3DBoundedObject"
+ */
 class X3DBoundedObject : virtual public Core::X3DNode {
 public:
     InitField<X3DBoundedObject, SFVec3f> bboxCenter;
     InitField<X3DBoundedObject, SFVec3f> bboxSize;
     void setup();
+
+    /// @returns whether the bounds were given, rather than left unknown
+    bool hasBBox() {
+        const SFVec3f& size = bboxSize.value;
+        return size.x >= 0 && size.y >= 0 && size.z >= 0;
+    }
+
+    /// @returns given bounds, in the node's own coordinates
+    BoundingBox getBBox() {
+        return BoundingBox::fromCenter(bboxCenter.value, bboxSize.value);
+    }
+
+    /**
+     * Get the bounds of the node in world coordinates, as kept by
+     * Browser::bounds: those given, or else those of its descendants.
+     *
+     * @returns world bounds, empty if none below the node are known
+     * @throws X3DError if the node isn't in the scene graph
+     */
+    BoundingBox getBounds();
 };
 
 }}
@@ -45,7 +45,11 @@ public:
         }
     } removeChildren;
 
-    DefaultInOutField<X3DGroupingNode, MFNodeSet<X3DChildNode> > children;
+    /// children; changing them marks the transform hierarchy stale
+    class Children :
+        public InOutField<X3DGroupingNode, MFNodeSet<X3DChildNode> > {
+        void action();
+    } children;
 
     void setup();
 
@@ -32,6 +32,7 @@ public:
     void setup() {}
 protected:
     bool outputIsDirty();
+    bool outputIsObserved();
     void setFraction(float fraction, int index);
 };
 
@@ -13,6 +13,7 @@ public:
     void setup() {}
 protected:
     bool outputIsDirty();
+    bool outputIsObserved();
     virtual void setFraction(float fraction, int index);
 };
 
@@ -48,10 +48,17 @@ public:
 
     void setFraction(float fraction);
 
+    /// Save the last fraction and key index.
+    void saveState(Encoder& out) const;
+
+    /// Restore the last fraction and key index.
+    void restoreState(Decoder& in);
+
 protected:
 
     virtual void setFraction(float fraction, int index) { throw X3DError("ABSTRACT"); }
     virtual bool outputIsDirty() { throw X3DError("ABSTRACT"); }
+    virtual bool outputIsObserved() { throw X3DError("ABSTRACT"); }
     virtual int findKeyIndex(float fraction);
 
 };
@@ -31,7 +31,6 @@ private:
 
     X3DField* expected;
     X3DField* actual;
-    list<Route*> routes;
     double time;
 
 public:
@@ -51,9 +50,6 @@ public:
     const string& getName() const;
     bool isDirty() const;
     void clearDirty();
-    void addIncomingRoute(Route* route);
-    void removeIncomingRoute(Route* route);
-    const list<Route*>& getIncomingRoutes() const;
     bool test(string* reason);
     void predict();
 
@@ -76,6 +76,12 @@ public:
     /// We actually have a field for this now.
     bool getIsActive() const;
 
+    /// Save the cycle clock and next scheduled time.
+    void saveState(Encoder& out) const;
+
+    /// Restore the cycle clock and next scheduled time.
+    void restoreState(Decoder& in);
+
 private:
 
     /// elapsed (not counting pause) since cycle event
@@ -90,6 +96,23 @@ private:
     /// network sort of four elements
     void sortEvents(double* times, int* indexes);
 
+    /**
+     * Send a continuous output event. In demand-driven mode, an output
+     * nothing observes just gets its new value, without an event.
+     *
+     * @param field output field
+     * @param value new value
+     */
+    template <class F, class T> void emit(F& field, T value) {
+        if (demands(field))
+            field.send(value);
+        else
+            field.value = value;
+    }
+
+    /// @returns whether the browser wants events from the field
+    bool demands(const SAIField& field);
+
     /// no copy constructor
     TimeSensor(const TimeSensor& node) { throw X3DError("COPY CONSTRUCTOR"); }
 };
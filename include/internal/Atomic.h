@@ -0,0 +1,69 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_ATOMIC_H_
+#define _X3D_ATOMIC_H_
+
+/*
+ * Sequentially consistent atomic operations on plain variables, for the
+ * few structures shared with threads other than the simulation thread.
+ * These wrap the compiler's atomic builtins, which ThreadSanitizer
+ * understands.
+ */
+
+namespace X3D {
+
+/// @returns value at p
+template <class T> inline T atomicLoad(const T* p) {
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+/// Store a value at p.
+template <class T> inline void atomicStore(T* p, T value) {
+    __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+/// Store a value at p. @returns previous value
+template <class T> inline T atomicExchange(T* p, T value) {
+    return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+/// Add to the value at p. @returns new value
+template <class T> inline T atomicAdd(T* p, T n) {
+    return __atomic_add_fetch(p, n, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Store a value at p if p holds the expected value.
+ *
+ * @returns whether the value was stored
+ */
+template <class T> inline bool atomicCompareExchange(T* p, T expected, T value) {
+    return __atomic_compare_exchange_n(p, &expected, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/// Keep memory accesses from moving across this point.
+inline void atomicFence() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+}
+
+#endif // #ifndef _X3D_ATOMIC_H_
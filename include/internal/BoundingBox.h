@@ -0,0 +1,144 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_BOUNDINGBOX_H_
+#define _X3D_BOUNDINGBOX_H_
+
+#include "internal/SFVec.h"
+#include <cmath>
+#include <float.h>
+
+namespace X3D {
+
+/**
+ * Axis-aligned box, as used for scene bounds. A box whose minimum
+ * exceeds its maximum is empty; the default box is empty.
+ */
+class BoundingBox {
+public:
+
+    /// minimum corner
+    SFVec3f min;
+
+    /// maximum corner
+    SFVec3f max;
+
+    /// Constructor; the box is empty.
+    BoundingBox() : min(FLT_MAX, FLT_MAX, FLT_MAX),
+                    max(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+
+    /**
+     * Constructor.
+     *
+     * @param min minimum corner
+     * @param max maximum corner
+     */
+    BoundingBox(const SFVec3f& min, const SFVec3f& max) : min(min), max(max) {}
+
+    /**
+     * Make a box from a center and size, as given by X3DBoundedObject.
+     *
+     * @param center center of box
+     * @param size extent along each axis
+     * @returns box
+     */
+    static BoundingBox fromCenter(const SFVec3f& center, const SFVec3f& size) {
+        SFVec3f half(size.x / 2, size.y / 2, size.z / 2);
+        return BoundingBox(center - half, center + half);
+    }
+
+    /// @returns whether the box contains no points
+    bool empty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    /// @returns center of box
+    SFVec3f center() const {
+        return SFVec3f((min.x + max.x) / 2, (min.y + max.y) / 2,
+                       (min.z + max.z) / 2);
+    }
+
+    /// @returns extent along each axis
+    SFVec3f size() const { return max - min; }
+
+    /**
+     * Grow the box to contain another.
+     *
+     * @param box box to contain
+     */
+    void extend(const BoundingBox& box) {
+        if (box.min.x < min.x) min.x = box.min.x;
+        if (box.min.y < min.y) min.y = box.min.y;
+        if (box.min.z < min.z) min.z = box.min.z;
+        if (box.max.x > max.x) max.x = box.max.x;
+        if (box.max.y > max.y) max.y = box.max.y;
+        if (box.max.z > max.z) max.z = box.max.z;
+    }
+
+    /**
+     * Grow the box to contain a point.
+     *
+     * @param p point to contain
+     */
+    void extend(const SFVec3f& p) {
+        extend(BoundingBox(p, p));
+    }
+
+    /// @returns whether the boxes share any point
+    bool overlaps(const BoundingBox& box) const {
+        return min.x <= box.max.x && box.min.x <= max.x
+            && min.y <= box.max.y && box.min.y <= max.y
+            && min.z <= box.max.z && box.min.z <= max.z;
+    }
+
+    /// @returns whether the point is inside the box or on its surface
+    bool contains(const SFVec3f& p) const {
+        return min.x <= p.x && p.x <= max.x
+            && min.y <= p.y && p.y <= max.y
+            && min.z <= p.z && p.z <= max.z;
+    }
+
+    /**
+     * Get the box containing this one after a transformation, which is
+     * as tight as an axis-aligned box can be for an affine matrix.
+     *
+     * @param m 16 row-major floats, for column vectors
+     * @returns transformed box, or an empty box if this one is
+     */
+    BoundingBox transform(const float* m) const {
+        if (empty())
+            return *this;
+        SFVec3f c = center();
+        SFVec3f e(
+            (max.x - min.x) / 2, (max.y - min.y) / 2, (max.z - min.z) / 2);
+        float nc[3], ne[3];
+        for (int i = 0; i < 3; i++) {
+            const float* r = m + 4 * i;
+            nc[i] = r[0] * c.x + r[1] * c.y + r[2] * c.z + r[3];
+            ne[i] = std::fabs(r[0]) * e.x + std::fabs(r[1]) * e.y
+                  + std::fabs(r[2]) * e.z;
+        }
+        return BoundingBox(
+            SFVec3f(nc[0] - ne[0], nc[1] - ne[1], nc[2] - ne[2]),
+            SFVec3f(nc[0] + ne[0], nc[1] + ne[1], nc[2] + ne[2]));
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_BOUNDINGBOX_H_
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_BOUNDINGVOLUMEHIERARCHY_H_
+#define _X3D_BOUNDINGVOLUMEHIERARCHY_H_
+
+#include "internal/BoundingBox.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class Node;
+class TransformHierarchy;
+
+/**
+ * Bounding-volume hierarchy over the scene graph, kept by the browser as
+ * Browser::bounds. Its objects are the instances of X3DBoundedObject
+ * nodes whose bounds were given; each has a world box, being its given
+ * box under its world matrix from Browser::transforms. Nodes whose
+ * bounds are unknown get those of the objects below them.
+ *
+ * The tree is binary, split at the median along the longest axis of the
+ * objects' centers, and laid out depth-first in one array, so the first
+ * child of a volume follows it. Objects are stored in tree order, so
+ * each leaf holds a contiguous run of at most four.
+ *
+ * Like the transforms, the tree is brought up to date when queried.
+ * When only world matrices have changed, the tree is refit: the objects
+ * whose matrices changed get new world boxes, and only the volumes above
+ * them are recomputed. When the structure of the graph changes, the tree
+ * is rebuilt, building subtrees on their own threads once a scene has
+ * more objects than the parallel threshold.
+ */
+class BoundingVolumeHierarchy {
+public:
+
+    /// node of the tree
+    struct Volume {
+        /// box containing the objects below
+        BoundingBox box;
+
+        /// first object of a leaf, or second child of a branch
+        uint32_t first;
+
+        /// number of objects of a leaf, or 0 for a branch
+        uint32_t count;
+    };
+
+    /// instance of a node with given bounds
+    struct Object {
+        /// node, an X3DBoundedObject
+        Node* node;
+
+        /// index of instance in Browser::transforms
+        uint32_t instance;
+
+        /// given bounds, in the node's own coordinates
+        BoundingBox local;
+    };
+
+    /// most objects in a leaf
+    static const uint32_t LEAF_SIZE = 4;
+
+private:
+
+    /// volumes in depth-first order; the root comes first
+    vector<Volume> volumes;
+
+    /// objects in tree order
+    vector<Object> objects;
+
+    /// world box of each object, in tree order
+    vector<BoundingBox> boxes;
+
+    /// tree position of each object, in instance order
+    vector<uint32_t> byInstance;
+
+    /// which volumes the current refit changed
+    vector<uint8_t> changed;
+
+    /// version of the transforms the tree was built from
+    uint32_t version;
+
+    /// last pass of the transforms the tree was fit to
+    uint32_t seen;
+
+    /// object boxes recomputed by the last update
+    size_t refitted;
+
+    /// number of rebuilds
+    size_t builds;
+
+    /// number of objects above which rebuilds use threads
+    size_t threshold;
+
+    /// most threads a rebuild uses
+    unsigned int threads;
+
+    /// Disallow copy constructor
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy& bvh) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the tree is built on the first query.
+    BoundingVolumeHierarchy();
+
+    /**
+     * Bring the tree up to date with the transforms, refitting it or
+     * rebuilding it. Queries do this themselves.
+     *
+     * @returns number of object boxes recomputed
+     */
+    size_t update();
+
+    /**
+     * Get the world bounds of a node: its given bounds if it is an
+     * X3DBoundedObject which has them, or else the union of those of
+     * the objects below it. If the node is used more than once, the
+     * first instance is given.
+     *
+     * @param node node in the scene graph
+     * @returns world box, empty if no bounds are known
+     * @throws X3DError if the node isn't below the browser's roots
+     */
+    BoundingBox getBounds(Node* node);
+
+    /// @returns world box of the whole scene, empty if none is known
+    BoundingBox getSceneBounds();
+
+    /// Forget the scene, as when the browser is reset.
+    void clear();
+
+    /// @returns volumes in depth-first order, as of the last update
+    const vector<Volume>& getVolumes() const { return volumes; }
+
+    /// @returns objects in tree order, as of the last update
+    const vector<Object>& getObjects() const { return objects; }
+
+    /// @returns world box of each object, in tree order
+    const vector<BoundingBox>& getBoxes() const { return boxes; }
+
+    /// @returns number of objects, as of the last update
+    size_t size() const { return objects.size(); }
+
+    /// @returns number of object boxes recomputed by the last update
+    size_t refittedCount() const { return refitted; }
+
+    /// @returns number of times the tree was rebuilt
+    size_t buildCount() const { return builds; }
+
+    /**
+     * Set how large a scene must be for rebuilds to use threads.
+     *
+     * @param objects number of objects above which rebuilds use threads
+     * @param threads most threads to use, or 0 for one per processor
+     */
+    void setParallel(size_t objects, unsigned int threads=0);
+
+    /// @returns number of objects above which rebuilds use threads
+    size_t getParallelThreshold() const { return threshold; }
+
+    /// @returns most threads a rebuild uses, which queries also use
+    unsigned int getThreads() const { return threads; }
+
+private:
+
+    /// per-rebuild state, shared by the threads
+    struct Build;
+
+    /// subtree built on its own thread
+    struct Task;
+
+    /// Collect the objects below the roots and build the tree.
+    void rebuild(TransformHierarchy& transforms);
+
+    /// Recompute the boxes of objects whose matrices changed.
+    void refit(TransformHierarchy& transforms);
+
+    /**
+     * Build the subtree of one volume.
+     *
+     * @param build rebuild state
+     * @param volume index of volume
+     * @param begin first object, in build order
+     * @param end object after the last
+     * @param depth depth of volume
+     */
+    static void build(Build& build, uint32_t volume,
+                      uint32_t begin, uint32_t end, unsigned int depth);
+
+    /// thread body building one subtree
+    static void* buildThread(void* arg);
+
+    /// @returns number of volumes in a subtree of so many objects
+    static uint32_t volumeCount(uint32_t objects);
+};
+
+}
+
+#endif // #ifndef _X3D_BOUNDINGVOLUMEHIERARCHY_H_
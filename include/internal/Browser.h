@@ -22,9 +22,25 @@
 
 #include "Core/X3DSensorNode.h"
 #include "Time/X3DTimeDependentNode.h"
+#include "internal/BoundingVolumeHierarchy.h"
 #include "internal/Profile.h"
+#include "internal/RouteTable.h"
+#include "internal/RouteGraph.h"
+#include "internal/Checkpoint.h"
+#include "internal/DeltaStream.h"
+#include "internal/EventLog.h"
 #include "internal/Event.h"
+#include "internal/InjectionQueue.h"
+#include "internal/FramePipeline.h"
+#include "internal/MemoryReport.h"
 #include "internal/NodeDef.h"
+#include "internal/Scope.h"
+#include "internal/Snapshot.h"
+#include "internal/SpatialQuery.h"
+#include "internal/Subscriptions.h"
+#include "internal/Trace.h"
+#include "internal/TransformHierarchy.h"
+#include "internal/UpdateBuffer.h"
 #include "internal/builtin.h"
 #include <list>
 #include <queue>
@@ -51,6 +67,11 @@ class Plugin;
  * party plugins.
  */
 class Browser {
+
+    // allow event log to record and restore the clock
+    friend class EventRecorder;
+    friend class EventReplayer;
+
 private:
 
 	/// all nodes managed by the browser
@@ -74,11 +95,14 @@ private:
     /// fields which need to be routed
     vector<SAIField*> dirtyFields;
 
-    /// nodes which should be cleared
-    vector<SAIField*> firedFields;
+    /// nodes with dirty output fields, to be cleared when the cascade ends
+    vector<Node*> dirtyNodes;
 
-    /// named nodes
-    map<string, Node*> defs;
+    /// global naming scope
+    Scope defs;
+
+    /// stack of entered naming scopes; the last is current
+    vector<Scope*> scopes;
 
     /// registered plugins
     list<Plugin*> plugins;
@@ -95,6 +119,28 @@ private:
     /// whether simulation has started
     bool started;
 
+    /// number of cascades completed
+    unsigned int cascade;
+
+    /// whether unobserved outputs are skipped; see setDemandDriven()
+    bool demandDriven;
+
+    /// whether routes are delayed to the next frame; see setPipelined()
+    bool pipelined;
+
+    /// values committed at the last frame boundary, in pipelined mode
+    FramePipeline pipeline;
+
+    /// number of beginUpdate() calls not yet ended
+    unsigned int updateDepth;
+
+    /// values of the last checkpoint taken or restored, for the next
+    /// checkpoint to share
+    Checkpoint checkpointBase;
+
+    /// replayer of an event log, if one is open
+    EventReplayer* replayer;
+
 public:
 
 	/// profile supported by the browser
@@ -137,6 +183,100 @@ public:
      */
     void addNode(Node* node);
 
+    /// route event trace; disabled until enabled
+    Trace trace;
+
+    /// cascade profiler; disabled until enabled
+    Profiler profiler;
+
+    /// route lists of all routed fields
+    RouteTable routeTable;
+
+    /// analysis of the routes between nodes; see analyzeRoutes()
+    RouteGraph routeGraph;
+
+    /// snapshots of captured fields for other threads, published at
+    /// the end of each cascade
+    SnapshotStore snapshots;
+
+    /// events sent from other threads, drained at the start of each
+    /// simulate() step
+    InjectionQueue injections;
+
+    /// writes buffered between beginUpdate() and endUpdate()
+    UpdateBuffer updates;
+
+    /// observers of output fields, called at the end of each cascade
+    Subscriptions subscriptions;
+
+    /// stream of the fields fired in each cascade, for mirrors; closed
+    /// until opened
+    DeltaStream deltas;
+
+    /// log of the events sent into the scene, for replaying the run;
+    /// closed until opened
+    EventRecorder recorder;
+
+    /// world matrices of the scene's Transforms, updated when queried
+    TransformHierarchy transforms;
+
+    /// bounds of the scene, over #transforms, updated when queried
+    BoundingVolumeHierarchy bounds;
+
+    /**
+     * Save the contents of the event trace, along with the names of
+     * all routes in the scene, for decoding with x3dtrace.
+     *
+     * @param filename path of trace file
+     */
+    void saveTrace(const string& filename);
+
+    /**
+     * Count the memory used by all managed nodes, their fields and
+     * the routes between them.
+     *
+     * @returns memory report
+     */
+    MemoryReport memoryReport();
+
+    /**
+     * Analyze the routes between all managed nodes, finding route cycles,
+     * ranking nodes in topological order and, if #routeGraph has pruning
+     * on, deactivating nodes whose events nothing can see. This is done
+     * after a world is read; routes created later update the analysis
+     * where they can, and make it stale where they can't. A stale
+     * analysis is run again at the start of the next cascade, or by
+     * getRouteGraph().
+     *
+     * @returns route graph analysis
+     */
+    const RouteGraph& analyzeRoutes();
+
+    /**
+     * Get the route graph analysis, running it again first if it is
+     * stale. A graph which has never been analyzed is left alone.
+     *
+     * @returns route graph analysis
+     */
+    const RouteGraph& getRouteGraph();
+
+    /**
+     * Compile every StaticGroup not yet compiled, freezing its contents;
+     * see StaticGroup::compile(). This is done after a world is read.
+     *
+     * @returns number of groups compiled
+     */
+    size_t compileStaticGroups();
+
+    /// @returns all managed nodes, in the order they were created
+    const list<Node*>& getNodes() const { return nodes; }
+
+    /// @returns root nodes of the scene graph, in the order added
+    const list<Node*>& getRoots() const { return roots; }
+
+    /// @returns id of the current cascade
+    unsigned int getCascade() const { return cascade; }
+
     /**
      * Gets the current simulation tick time.
      *
@@ -269,6 +409,30 @@ public:
      */
     Node* getNode(const string& name);
 
+    /**
+     * Make the given scope current, so that DEF names are defined in
+     * and looked up from it until it is left again.
+     *
+     * @param scope naming scope to enter
+     */
+    void enterScope(Scope* scope);
+
+    /**
+     * Leave the given scope. Scopes entered after it stay entered, so
+     * worlds may be freed in any order. Leaving a scope which is not
+     * entered does nothing.
+     *
+     * @param scope naming scope to leave
+     * @throws X3DError if the scope is the global one
+     */
+    void leaveScope(Scope* scope);
+
+    /// @returns current naming scope
+    Scope* getScope() { return scopes.back(); }
+
+    /// @returns global naming scope
+    Scope* getGlobalScope() { return &defs; }
+
     /**
      * Look up a node by its name, returning NULL if it isn't found.
      * Return a type-specific version of the node, and throw an error
@@ -281,7 +445,7 @@ public:
         Node* found = getNode(name);
         if (found == NULL)
             return NULL;
-        N* node = dynamic_cast<N*>(found);
+        N* node = nodeCast<N>(found);
         if (node == NULL)
             throw X3DError("node type mismatch");
         return node;
@@ -296,7 +460,7 @@ public:
         list<Node*>::iterator it;
         for (it = roots.begin(); it != roots.end(); it++) {
             Node* node = *it;
-            N* test = dynamic_cast<N*>(node);
+            N* test = nodeCast<N>(node);
             if (test != NULL)
                 return test;
         }
@@ -372,6 +536,51 @@ public:
     Route* createRoute(const string& fromNode, const string& fromField,
                        const string& toNode, const string& toField);
 
+    /**
+     * Start buffering writes made with SAIField::set() to input fields,
+     * as in the SAI. Until the matching endUpdate(), each field keeps
+     * only the last value written to it. Updates nest; only the
+     * outermost endUpdate() sends the values.
+     */
+    void beginUpdate();
+
+    /**
+     * End an update. At the outermost one, send the buffered values to
+     * their fields, in the order the fields were first written, and
+     * route them all in a single cascade.
+     *
+     * @throws X3DError if no update was begun
+     */
+    void endUpdate();
+
+    /// @returns whether writes are being buffered
+    bool isUpdating() const { return updateDepth > 0; }
+
+    /**
+     * Capture the mutable state of the scene, to return to later with
+     * restore(): field values, state nodes keep outside their fields,
+     * such as a TimeSensor's cycle clock, the event queue and the
+     * simulation time. Values which haven't changed since the last
+     * checkpoint are shared with it, so this is cheap enough to do
+     * every frame. The structure of the scene, meaning which nodes
+     * exist, node fields and routes, isn't captured.
+     *
+     * @returns new checkpoint, which the caller must delete
+     * @throws X3DError during a cascade or update, or in pipelined mode
+     */
+    Checkpoint* checkpoint();
+
+    /**
+     * Return the scene to a checkpoint. Values are set silently, so
+     * nothing is routed and observers aren't told. Nodes created since
+     * the checkpoint keep their state.
+     *
+     * @param checkpoint checkpoint taken from this scene
+     * @throws X3DError during a cascade or update, in pipelined mode,
+     *         or if the scene has been reset since the checkpoint
+     */
+    void restore(const Checkpoint& checkpoint);
+
     /**
      * Add a dirty field to the list of
      * fields to route from.
@@ -380,6 +589,145 @@ public:
      */
     void addDirtyField(SAIField* field);
 
+    /**
+     * Switch demand-driven evaluation on or off; it is off by default.
+     * In demand-driven mode, output events which nothing observes are
+     * not sent. Interpolators whose output has no routes and isn't
+     * watched don't run at all, and time sensors store such outputs
+     * without sending them. An interpolator skipped this way catches up
+     * on its next input after its output becomes observed. With pruning
+     * on in #routeGraph, routes which lead only to dead nodes don't count
+     * as observers.
+     *
+     * @param on whether to skip unobserved outputs
+     */
+    void setDemandDriven(bool on) { demandDriven = on; }
+
+    /// @returns whether demand-driven evaluation is on
+    bool isDemandDriven() const { return demandDriven; }
+
+    /**
+     * Check whether anything needs the events of an output field.
+     *
+     * @param field output field
+     * @returns false if in demand-driven mode and field is unobserved
+     */
+    bool demands(const SAIField& field) const {
+        return !demandDriven || field.isObserved();
+    }
+
+    /**
+     * Switch pipelined frames on or off; they are off by default. In
+     * pipelined mode a frame doesn't route its own events. Instead, the
+     * values of the fields which changed are committed at the end of the
+     * frame, and routes send the committed values at the start of the
+     * next. Each route then adds a frame of latency, but the stages of a
+     * frame no longer wait on each other: sensors and routes both write
+     * the fields' current values and only read committed ones, and
+     * readers outside the simulation see the values of the last frame
+     * boundary throughout the frame. Values committed before pipelining
+     * is switched off are still sent in the next frame.
+     *
+     * @param on whether to pipeline frames
+     */
+    void setPipelined(bool on) { pipelined = on; }
+
+    /// @returns whether frames are pipelined
+    bool isPipelined() const { return pipelined; }
+
+    /// @returns values committed in pipelined mode
+    const FramePipeline& getPipeline() const { return pipeline; }
+
+    /**
+     * Watch an output field from outside the scene graph, as an SAI
+     * client would. A watched field counts as observed in demand-driven
+     * mode, like a routed one. Watches don't nest; one unwatch() undoes
+     * any number of watch() calls.
+     *
+     * @param field field to watch
+     */
+    void watch(SAIField* field);
+
+    /// @param field field to stop watching
+    void unwatch(SAIField* field);
+
+    /**
+     * Subscribe an observer to an output field. At the end of each
+     * cascade which changed any of its fields, after routing and before
+     * dirty fields are cleared, the observer is called once with all of
+     * them and their values. A subscribed field counts as observed, as
+     * a watched one does.
+     *
+     * @param field output field
+     * @param observer observer to call when it changes
+     * @throws X3DError if the field isn't output-capable
+     */
+    void subscribe(SAIField* field, FieldObserver* observer);
+
+    /**
+     * Unsubscribe an observer from an output field. Has no effect if it
+     * wasn't subscribed.
+     *
+     * @param field output field
+     * @param observer subscribed observer
+     */
+    void unsubscribe(SAIField* field, FieldObserver* observer);
+
+    /**
+     * Add a node to the list of nodes whose dirty fields are cleared
+     * at the end of the cascade. Called by Node::setDirty() when the
+     * node gets its first dirty field.
+     *
+     * @param node node with dirty fields
+     */
+    void addDirtyNode(Node* node);
+
+    /**
+     * Find the nearest node each ray hits, by the world bounds of the
+     * objects in #bounds. Large batches run on as many threads as
+     * #bounds uses to build.
+     *
+     * @param rays rays to cast
+     * @param hits set to the nearest hit of each ray
+     */
+    void raycast(const vector<Ray>& rays, vector<RayHit>& hits);
+
+    /**
+     * Find the nearest node a ray hits.
+     *
+     * @param ray ray to cast
+     * @returns nearest hit, whose node is NULL if there is none
+     */
+    RayHit raycast(const Ray& ray);
+
+    /**
+     * Find the nodes whose bounds overlap each box.
+     *
+     * @param boxes world boxes to search
+     * @param results set to the nodes found for each box
+     */
+    void overlap(const vector<BoundingBox>& boxes, QueryResults& results);
+
+    /**
+     * Find the nodes whose bounds may be inside each frustum, as for
+     * view culling.
+     *
+     * @param frusta frusta to search
+     * @param results set to the nodes found for each frustum
+     */
+    void overlap(const vector<Frustum>& frusta, QueryResults& results);
+
+    /**
+     * Find the k nodes whose bounds are nearest each point, nearest
+     * first, with their distances.
+     *
+     * @param points points to search from
+     * @param k most nodes to find for each point
+     * @param results set to the nodes found for each point
+     */
+    void nearest(const vector<SFVec3f>& points, size_t k,
+                 QueryResults& results);
+
 private:
 
     /**
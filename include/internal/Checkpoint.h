@@ -0,0 +1,157 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_CHECKPOINT_H_
+#define _X3D_CHECKPOINT_H_
+
+#include "internal/Encoder.h"
+#include "internal/Event.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <list>
+#include <queue>
+#include <vector>
+
+using std::list;
+using std::priority_queue;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+class SAIField;
+class X3DField;
+
+/**
+ * The mutable state of a scene at the end of a cascade, taken by
+ * Browser::checkpoint() and put back by Browser::restore(): the values
+ * of all fields which hold one, the state nodes keep outside their
+ * fields (see Node::saveState()), the event queue and the simulation
+ * clock. Node fields are left out; like routes, they are the structure
+ * of the scene rather than its state.
+ *
+ * Values are shared between checkpoints. Each checkpoint compares the
+ * live values with those of the last checkpoint taken or restored, and
+ * only copies the ones which differ, so a checkpoint of a scene where
+ * little changed each frame costs a pass of comparisons and a little
+ * memory, even when it holds large MF or image values. Values left
+ * behind by deleted checkpoints are reused rather than reallocated. Field values
+ * are plain containers which nodes write in place, so there is no
+ * write to intercept for a true copy-on-write.
+ */
+class Checkpoint {
+
+    friend class Browser;
+
+private:
+
+    /// a field value, shared by the checkpoints it didn't change between
+    struct Value {
+        X3DField* value;
+        unsigned int refs;
+    };
+
+    /// number of the browser's nodes covered
+    size_t nodeCount;
+
+    /// fields holding values other than nodes, in node order
+    vector<SAIField*> fields;
+
+    /// value of each field
+    vector<Value*> values;
+
+    /// values copied, rather than shared, when the checkpoint was taken
+    size_t copies;
+
+    /// state saved by each covered node, in node order
+    ByteBuffer states;
+
+    /// scheduled sensor events
+    priority_queue<Event> events;
+
+    /// sensors not yet initialized
+    vector<Core::X3DSensorNode*> newSensors;
+
+    /// simulation time
+    double time;
+
+    /// next time to wake up
+    double wakeupTime;
+
+    /// whether the simulation had started
+    bool started;
+
+    /// id of the next cascade
+    unsigned int cascade;
+
+    /// Constructor; the checkpoint starts empty.
+    Checkpoint() : nodeCount(0), copies(0), time(0), wakeupTime(0),
+                   started(false), cascade(0) {}
+
+    /// Disallow copy constructor
+    Checkpoint(const Checkpoint& checkpoint) {
+        throw X3DError("illegal copy");
+    }
+
+    /**
+     * Capture the values of the fields of the given nodes, sharing those
+     * which are unchanged since another checkpoint. Changed values which
+     * no other checkpoint holds are taken from the base and overwritten,
+     * so the base must be replaced afterwards.
+     *
+     * @param nodes all managed nodes
+     * @param base checkpoint whose values to share, covering a prefix
+     *             of the same nodes
+     */
+    void capture(const list<Node*>& nodes, Checkpoint& base);
+
+    /**
+     * Make this checkpoint share another's field values, forgetting its
+     * own. Only the fields and values are shared.
+     *
+     * @param other checkpoint to share
+     */
+    void share(const Checkpoint& other);
+
+    /// Set the captured values on fields which no longer hold them.
+    void restoreValues() const;
+
+    /// Release the values, leaving the checkpoint empty.
+    void clear();
+
+public:
+
+    /// Destructor; releases the values.
+    ~Checkpoint();
+
+    /// @returns id of the cascade the checkpoint resumes at
+    unsigned int getCascade() const { return cascade; }
+
+    /// @returns simulation time of the checkpoint
+    double getTime() const { return time; }
+
+    /// @returns number of field values held
+    size_t fieldCount() const { return fields.size(); }
+
+    /// @returns number of values copied rather than shared
+    size_t copiedCount() const { return copies; }
+};
+
+}
+
+#endif // #ifndef _X3D_CHECKPOINT_H_
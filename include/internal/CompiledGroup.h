@@ -0,0 +1,128 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_COMPILEDGROUP_H_
+#define _X3D_COMPILEDGROUP_H_
+
+#include "internal/BoundingBox.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class Node;
+
+/**
+ * Frozen contents of a StaticGroup, as made by StaticGroup::compile().
+ * The graph below the group is flattened in depth-first order into
+ * contiguous arrays: each node, the end of its subtree, and its matrix
+ * into the group's coordinates, with the Transforms on the way already
+ * multiplied in. The given bounds of the nodes below are kept the same
+ * way, in the group's coordinates.
+ *
+ * Every field of the nodes below is marked SAIField::FROZEN, so none of
+ * them can be written or routed, and nothing here ever goes stale. The
+ * browser's TransformHierarchy stops at a compiled group, so however
+ * many times the group is used, its contents cost one copy of these
+ * arrays and nothing per frame.
+ */
+class CompiledGroup {
+public:
+
+    /**
+     * Flatten and freeze the nodes below a group.
+     *
+     * @param group group whose children to compile
+     */
+    explicit CompiledGroup(Node* group);
+
+    /**
+     * Check whether any node below a group has a field with routes,
+     * which would keep it from being compiled.
+     *
+     * @param group group to check
+     * @returns whether a route leads into or out of the group's contents
+     */
+    static bool isRouted(Node* group);
+
+    /// @returns number of nodes below the group, counting each use
+    size_t size() const { return nodes.size(); }
+
+    /// @returns node at a position, in depth-first order
+    Node* getNode(size_t i) const { return nodes[i]; }
+
+    /// @returns position after the last node below the one at i
+    uint32_t getEnd(size_t i) const { return ends[i]; }
+
+    /// @returns row-major matrix from the coordinates of the node at i
+    ///          (inside it, for a Transform) to the group's
+    const float* getMatrix(size_t i) const { return &matrices[16 * i]; }
+
+    /**
+     * Find the first use of a node below the group.
+     *
+     * @param node node to find
+     * @returns position of node, or size() if it isn't below the group
+     */
+    size_t indexOf(Node* node) const;
+
+    /// @returns number of nodes below the group with given bounds
+    size_t boxCount() const { return boxes.size(); }
+
+    /// @returns position of the jth node with given bounds
+    uint32_t getBoxed(size_t j) const { return boxed[j]; }
+
+    /// @returns given bounds of the jth such node, in the group's coordinates
+    const BoundingBox& getBox(size_t j) const { return boxes[j]; }
+
+    /// @returns bounds of everything below the group, empty if none are given
+    const BoundingBox& getBounds() const { return bounds; }
+
+    /// @returns bytes held by the arrays
+    size_t getBytes() const;
+
+private:
+
+    /// nodes in depth-first order
+    vector<Node*> nodes;
+
+    /// position after each node's subtree
+    vector<uint32_t> ends;
+
+    /// 16 floats per node
+    vector<float> matrices;
+
+    /// positions of the nodes with given bounds
+    vector<uint32_t> boxed;
+
+    /// their bounds, in the group's coordinates
+    vector<BoundingBox> boxes;
+
+    /// union of #boxes
+    BoundingBox bounds;
+
+    /// Mark every field of a node frozen.
+    static void freeze(Node* node);
+};
+
+}
+
+#endif // #ifndef _X3D_COMPILEDGROUP_H_
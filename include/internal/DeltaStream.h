@@ -0,0 +1,287 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_DELTASTREAM_H_
+#define _X3D_DELTASTREAM_H_
+
+#include "internal/Encoder.h"
+#include "internal/NodeIds.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+class SAIField;
+class X3DField;
+
+/**
+ * Stream of the output fields fired in each cascade, for mirroring a
+ * simulation into another process, such as a viewer, much more cheaply
+ * than sending snapshots. When open, Browser::endRoute() records one
+ * delta per cascade; a DeltaReader replays them into the mirror's
+ * browser, which must hold the same scene, built the same way.
+ *
+ * The stream starts with a magic word and version. Each delta is a
+ * 32-bit length, then the cascade, time and number of fields, then
+ * for each field its node id, its output index, an encoding, the size
+ * of its value in the packed form of X3DField::encode(), and the
+ * encoded bytes. Node ids number the browser's nodes in the order they
+ * were created, which is the same in both processes.
+ *
+ * A value is either written in full (#FULL) or, for MF fields whose
+ * encoded size hasn't changed since they were last written, as the
+ * XOR of the new and previous bytes (#XOR), which leaves zeros
+ * wherever elements are unchanged. The XOR is written as alternating
+ * counts of zero and literal bytes, with the literals after each
+ * count, and is only used when that is shorter.
+ */
+class DeltaStream {
+public:
+
+    /// "X3DD", first word of the stream
+    static const uint32_t MAGIC = 0x44443358;
+
+    /// version of the format
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /// value encodings
+    typedef enum {
+        FULL = 0,
+        XOR
+    } Encoding;
+
+private:
+
+    /// file descriptor written to, or -1
+    int fd;
+
+    /// whether the descriptor was opened here, and is closed here
+    bool owned;
+
+    /// ids of nodes written
+    NodeIds ids;
+
+    /// last encoding written for each MF field
+    map<SAIField*, vector<char> > previous;
+
+    /// the last delta, including its length
+    ByteBuffer delta;
+
+    /// encoding of the value being written
+    ByteBuffer value;
+
+    /// deltas written
+    size_t deltas;
+
+    /// bytes written, including the stream header
+    size_t bytes;
+
+    /// Disallow copy constructor
+    DeltaStream(const DeltaStream& stream) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the stream starts closed.
+    DeltaStream() : fd(-1), owned(false), deltas(0), bytes(0) {}
+
+    /// Destructor; closes the stream.
+    ~DeltaStream();
+
+    /**
+     * Start writing deltas to a file, replacing it.
+     *
+     * @param filename path of file
+     * @throws X3DError if the file can't be created
+     */
+    void open(const string& filename);
+
+    /**
+     * Start writing deltas to an open file descriptor, such as a
+     * connected socket. The descriptor is not closed by close().
+     *
+     * @param fd descriptor to write to
+     */
+    void attach(int fd);
+
+    /// Stop writing deltas, and forget what was written.
+    void close();
+
+    /// @returns whether deltas are being written
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * Write the delta of a cascade, with the dirty output fields of the
+     * given nodes. Called by Browser::endRoute().
+     *
+     * @param cascade id of the cascade which just ended
+     * @param time simulation time
+     * @param nodes nodes with dirty outputs
+     * @throws X3DError if the delta can't be written
+     */
+    void record(unsigned int cascade, double time, const vector<Node*>& nodes);
+
+    /// @returns the last delta written, including its length word
+    const vector<char>& lastDelta() const { return delta.bytes; }
+
+    /// @returns number of deltas written
+    size_t deltaCount() const { return deltas; }
+
+    /// @returns number of bytes written
+    size_t byteCount() const { return bytes; }
+
+private:
+
+    /**
+     * Write the value of a field into #delta.
+     *
+     * @param field fired field
+     */
+    void write(SAIField* field);
+
+    /**
+     * Write bytes to the descriptor.
+     *
+     * @param data bytes to write
+     * @param size number of bytes
+     */
+    void send(const char* data, size_t size);
+};
+
+/**
+ * Replays a DeltaStream into the scene of this process's browser. Each
+ * value is set silently on its field, without routing, since the stream
+ * already holds every field the cascade fired.
+ */
+class DeltaReader {
+private:
+
+    /// file descriptor read from, or -1
+    int fd;
+
+    /// whether the descriptor was opened here, and is closed here
+    bool owned;
+
+    /// nodes by id
+    NodeIds ids;
+
+    /// last encoding of each field, by node id and output index
+    map<uint64_t, vector<char> > previous;
+
+    /// decoded value of each field type
+    map<int, X3DField*> values;
+
+    /// body of the delta being read
+    vector<char> delta;
+
+    /// cascade of the last delta
+    unsigned int cascade;
+
+    /// time of the last delta
+    double time;
+
+    /// deltas applied
+    size_t deltas;
+
+    /// Disallow copy constructor
+    DeltaReader(const DeltaReader& reader) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the reader starts closed.
+    DeltaReader() : fd(-1), owned(false), cascade(0), time(0), deltas(0) {}
+
+    /// Destructor; closes the reader.
+    ~DeltaReader();
+
+    /**
+     * Start reading deltas from a file.
+     *
+     * @param filename path of file
+     * @throws X3DError if the file can't be read or isn't a delta stream
+     */
+    void open(const string& filename);
+
+    /**
+     * Start reading deltas from an open file descriptor. The descriptor
+     * is not closed by close().
+     *
+     * @param fd descriptor to read from
+     * @throws X3DError if the stream doesn't start with the stream header
+     */
+    void attach(int fd);
+
+    /// Stop reading, and forget the previous values.
+    void close();
+
+    /// @returns whether deltas are being read
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * Read the next delta, blocking until it arrives, and apply it.
+     *
+     * @returns whether a delta was applied; false at the end of the stream
+     * @throws X3DError if the delta is malformed
+     */
+    bool next();
+
+    /**
+     * Apply one delta, as written by DeltaStream.
+     *
+     * @param data delta, not including its length word
+     * @param size bytes in the delta
+     * @throws X3DError if the delta is malformed or names unknown fields
+     */
+    void apply(const char* data, size_t size);
+
+    /// @returns cascade of the last delta applied
+    unsigned int getCascade() const { return cascade; }
+
+    /// @returns simulation time of the last delta applied
+    double getTime() const { return time; }
+
+    /// @returns number of deltas applied
+    size_t deltaCount() const { return deltas; }
+
+private:
+
+    /**
+     * Read bytes from the descriptor.
+     *
+     * @param data buffer to fill
+     * @param size bytes to read
+     * @returns whether all were read; false if the stream ended first
+     */
+    bool receive(char* data, size_t size);
+};
+
+}
+
+#endif // #ifndef _X3D_DELTASTREAM_H_
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_ENCODER_H_
+#define _X3D_ENCODER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+/**
+ * Sink for the packed binary form of field values. Values write
+ * themselves into an encoder with X3DField::encode(); subclasses decide
+ * what to do with the bytes (hash them, buffer them, etc.).
+ */
+class Encoder {
+public:
+
+    /// Virtual destructor.
+    virtual ~Encoder() {}
+
+    /**
+     * Accept a run of raw bytes.
+     *
+     * @param data pointer to bytes
+     * @param size number of bytes
+     */
+    virtual void write(const void* data, size_t size) = 0;
+
+    /**
+     * Write a plain value in native byte order.
+     *
+     * @param x value to write
+     */
+    template <typename T> void put(T x) {
+        write(&x, sizeof(T));
+    }
+
+    /**
+     * Write a length-prefixed string.
+     *
+     * @param s string to write
+     */
+    void putString(const string& s) {
+        put<unsigned int>(s.size());
+        write(s.data(), s.size());
+    }
+};
+
+/**
+ * Source of values in packed binary form, the reverse of Encoder.
+ * Values read themselves from a decoder with X3DField::decode(). A read
+ * past the end of the data fails and reads nothing.
+ */
+class Decoder {
+private:
+
+    /// next byte to read
+    const char* next;
+
+    /// end of the data
+    const char* end;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param data pointer to bytes
+     * @param size number of bytes
+     */
+    Decoder(const void* data, size_t size) :
+        next((const char*) data), end((const char*) data + size) {}
+
+    /**
+     * Read a run of raw bytes.
+     *
+     * @param data pointer to bytes to fill
+     * @param size number of bytes
+     * @returns false if there aren't enough bytes left
+     */
+    bool read(void* data, size_t size) {
+        if (remaining() < size)
+            return false;
+        memcpy(data, next, size);
+        next += size;
+        return true;
+    }
+
+    /**
+     * Read a plain value in native byte order.
+     *
+     * @param x value to fill
+     * @returns false if there aren't enough bytes left
+     */
+    template <typename T> bool get(T& x) {
+        return read(&x, sizeof(T));
+    }
+
+    /**
+     * Read a length-prefixed string.
+     *
+     * @param s string to fill
+     * @returns false if there aren't enough bytes left
+     */
+    bool getString(string& s) {
+        unsigned int size;
+        const char* start = next;
+        if (!get(size))
+            return false;
+        if (remaining() < size) {
+            next = start;
+            return false;
+        }
+        s.assign(next, size);
+        next += size;
+        return true;
+    }
+
+    /// @returns number of bytes left to read
+    size_t remaining() const { return end - next; }
+};
+
+/**
+ * Encoder which reduces everything written to it to a 32-bit FNV-1a hash.
+ * Used to identify values cheaply, e.g. in event traces.
+ */
+class Digest : public Encoder {
+public:
+
+    /// current hash value
+    unsigned int value;
+
+    /// Constructor.
+    Digest() : value(2166136261u) {}
+
+    void write(const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*) data;
+        for (size_t i = 0; i < size; i++) {
+            value ^= p[i];
+            value *= 16777619u;
+        }
+    }
+};
+
+/**
+ * Encoder which appends everything written to it to a byte vector, to
+ * be copied elsewhere. Clear #bytes to reuse it.
+ */
+class ByteBuffer : public Encoder {
+public:
+
+    /// bytes written so far
+    vector<char> bytes;
+
+    void write(const void* data, size_t size) {
+        const char* p = (const char*) data;
+        bytes.insert(bytes.end(), p, p + size);
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_ENCODER_H_
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_EVENTLOG_H_
+#define _X3D_EVENTLOG_H_
+
+#include "internal/Encoder.h"
+#include "internal/NodeIds.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::ostream;
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+class SAIField;
+class X3DField;
+
+/**
+ * Log of the events sent into a scene from outside, for replaying a
+ * run exactly, as when comparing the performance of two builds. When
+ * open, the browser records the wakeups asked for with Browser::wake(),
+ * each simulate() step with the values drained from the injection
+ * queue, and the values sent by each update, including those written
+ * by field observers. After each cascade it records a digest of the
+ * output fields the cascade fired, so the replay can be checked.
+ *
+ * Open the log right after the scene is read, before it is simulated;
+ * the clock is recorded then, and an EventReplayer starts the replaying
+ * browser from it. Values written straight to fields outside an
+ * update, followed by Browser::route(), aren't recorded.
+ *
+ * The log starts with a magic word, the version, and the cascade,
+ * simulation time and started flag of the browser. Each record is a
+ * code and its arguments: #WAKE and a time; #SIMULATE or #UPDATE and
+ * the number of values sent, then for each its node id, field name,
+ * field type and the value in the packed form of X3DField::encode();
+ * or #CASCADE and the cascade, time and digest.
+ */
+class EventRecorder {
+public:
+
+    /// "X3DE", first word of the log
+    static const uint32_t MAGIC = 0x45443358;
+
+    /// version of the format
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /// record codes
+    typedef enum {
+        WAKE = 1,
+        SIMULATE,
+        UPDATE,
+        CASCADE
+    } Code;
+
+private:
+
+    /// file written to, or NULL
+    FILE* file;
+
+    /// name of the file, for errors
+    string filename;
+
+    /// ids of nodes sent to and fired
+    NodeIds ids;
+
+    /// values sent since the last simulate() or update()
+    ByteBuffer sent;
+
+    /// number of values in #sent
+    uint32_t sentCount;
+
+    /// record being written
+    ByteBuffer record;
+
+    /// cascades recorded
+    size_t cascades;
+
+    /// Disallow copy constructor
+    EventRecorder(const EventRecorder& recorder) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the log starts closed.
+    EventRecorder() : file(NULL), sentCount(0), cascades(0) {}
+
+    /// Destructor; closes the log.
+    ~EventRecorder();
+
+    /**
+     * Start recording to a file, replacing it.
+     *
+     * @param filename path of file
+     * @throws X3DError if the file can't be created
+     */
+    void open(const string& filename);
+
+    /// Stop recording, and flush the log.
+    void close();
+
+    /// @returns whether events are being recorded
+    bool isOpen() const { return file != NULL; }
+
+    /// @returns number of cascades recorded
+    size_t cascadeCount() const { return cascades; }
+
+    /**
+     * Record a wakeup. Called by Browser::wake().
+     *
+     * @param time time to wake up
+     */
+    void wake(double time);
+
+    /**
+     * Note a value sent to a field, to be recorded with the next step
+     * or update. Called as the injection queue drains and as an update
+     * is applied.
+     *
+     * @param field field sent to
+     * @param value value sent
+     */
+    void send(SAIField* field, const X3DField& value);
+
+    /// Record a simulate() step, with the values drained for it.
+    /// Called by Browser::simulate().
+    void simulate() { write(SIMULATE); }
+
+    /// Record an update, with the values it sent. Called by
+    /// Browser::endUpdate().
+    void update() { write(UPDATE); }
+
+    /**
+     * Record the digest of a cascade. Called by Browser::endRoute().
+     *
+     * @param cascade id of the cascade which just ended
+     * @param time simulation time
+     * @param nodes nodes with dirty outputs
+     */
+    void cascade(unsigned int cascade, double time, const vector<Node*>& nodes);
+
+    /**
+     * Compute the digest of the output fields fired in a cascade: for
+     * each node with dirty outputs, its id and the index and value of
+     * each dirty output.
+     *
+     * @param ids ids of the nodes
+     * @param nodes nodes with dirty outputs
+     * @returns digest
+     */
+    static uint32_t digest(NodeIds& ids, const vector<Node*>& nodes);
+
+private:
+
+    /**
+     * Write a record of the values sent, and forget them.
+     *
+     * @param code #SIMULATE or #UPDATE
+     */
+    void write(Code code);
+
+    /**
+     * Write #record to the file.
+     *
+     * @throws X3DError if it can't be written
+     */
+    void flush();
+};
+
+/**
+ * Replays an EventRecorder log into this process's browser, which must
+ * hold the same scene, read the same way, and not have simulated it yet.
+ * Each step and update is repeated the way it was recorded, so nodes
+ * run exactly as they did. The digest of each cascade is checked
+ * against the log, and each cascade is timed from the start of the step
+ * or update, or the end of the cascade before it.
+ *
+ * Field observers are called as usual; their writes are in the log
+ * already, so the replaying browser shouldn't have any which write.
+ */
+class EventReplayer {
+public:
+
+    /// one replayed cascade
+    struct Cascade {
+        /// cascade id
+        unsigned int cascade;
+
+        /// simulation time
+        double time;
+
+        /// wall-clock nanoseconds spent
+        uint64_t nanoseconds;
+
+        /// digest of the fired outputs
+        uint32_t digest;
+
+        /// whether the log holds the same cascade, time and digest
+        bool matched;
+    };
+
+private:
+
+    /// contents of the log
+    vector<char> log;
+
+    /// position in #log
+    Decoder in;
+
+    /// ids of nodes sent to and fired
+    NodeIds ids;
+
+    /// decoded value of each field type
+    map<int, X3DField*> values;
+
+    /// cascades replayed
+    vector<Cascade> cascades;
+
+    /// number of cascades checked against the log
+    size_t checked;
+
+    /// cascades which didn't match the log
+    size_t mismatches;
+
+    /// clock at the start of the current step or the last cascade
+    uint64_t mark;
+
+    /// Disallow copy constructor
+    EventReplayer(const EventReplayer& replayer) : in(NULL, 0) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the replayer starts closed.
+    EventReplayer() : in(NULL, 0), checked(0), mismatches(0), mark(0) {}
+
+    /// Destructor; closes the replayer.
+    ~EventReplayer();
+
+    /**
+     * Read a log, and set the browser's clock to where it was when
+     * recording started.
+     *
+     * @param filename path of log
+     * @throws X3DError if the file can't be read or isn't a log, or
+     *      another replayer is open
+     */
+    void open(const string& filename);
+
+    /// Stop replaying; the cascades replayed are kept.
+    void close();
+
+    /// @returns whether a log is being replayed
+    bool isOpen() const { return !log.empty(); }
+
+    /**
+     * Replay the next record of the log.
+     *
+     * @returns whether there was one; false at the end of the log
+     * @throws X3DError if the record is malformed or names unknown
+     *      fields
+     */
+    bool next();
+
+    /**
+     * Replay the rest of the log, and close it.
+     *
+     * @returns whether every cascade matched the log
+     */
+    bool run();
+
+    /**
+     * Check the digest of a replayed cascade and time it. Called by
+     * Browser::endRoute().
+     *
+     * @param cascade id of the cascade which just ended
+     * @param time simulation time
+     * @param nodes nodes with dirty outputs
+     */
+    void cascade(unsigned int cascade, double time, const vector<Node*>& nodes);
+
+    /// @returns cascades replayed
+    const vector<Cascade>& getCascades() const { return cascades; }
+
+    /// @returns number of cascades, replayed or logged, which didn't match
+    size_t mismatchCount() const { return mismatches; }
+
+    /**
+     * Print one line per cascade replayed, and the total and slowest
+     * times.
+     *
+     * @param os stream to print to
+     * @param each whether to print the line for each cascade
+     */
+    void print(ostream& os, bool each=true) const;
+
+private:
+
+    /**
+     * Read values sent and send them to their fields, either by
+     * injecting them or, if updating, by writing them.
+     *
+     * @param updating whether an update has been begun
+     */
+    void send(bool updating);
+
+    /// Check the next replayed cascade against a logged one.
+    void check();
+};
+
+}
+
+#endif // #ifndef _X3D_EVENTLOG_H_
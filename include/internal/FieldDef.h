@@ -26,6 +26,8 @@
 namespace X3D {
 
 class NodeDef;
+template <class N> N* nodeCast(Node* node);
+template <class N> const N* nodeCast(const Node* node);
 
 /**
  * Field definition structure. Defines the name, type, and access permissions
@@ -46,6 +48,12 @@ public:
     /// Access type (init-only, input-only, output-only, or input-output)
 	const SAIField::Access access;
 
+    /// bytes taken up by the field object within its node
+    const size_t size;
+
+    /// bytes of that taken by the field's value, or 0 if it has none
+    const size_t valueSize;
+
     /**
      * Constructor.
      * 
@@ -53,16 +61,22 @@ public:
      * @param name field name
      * @param type field datatype
      * @param access field access level
+     * @param size size of field object
+     * @param valueSize size of field value within the field object
      */
 	FieldDef(
 		NodeDef* nodeDef,
 		const string& name,
 		X3DField::Type type,
-		SAIField::Access access) :
+		SAIField::Access access,
+		size_t size,
+		size_t valueSize) :
 		nodeDef(nodeDef),
 		name(name),
 		type(type),
-		access(access) {}
+		access(access),
+		size(size),
+		valueSize(valueSize) {}
 	
     /**
      * Pretty-printing method.
@@ -128,6 +142,8 @@ public:
      * @param name field name
      * @param type field datatype
      * @param access field access level
+     * @param size size of field object
+     * @param valueSize size of field value within the field object
      * @param field node member pointer
      */
 	FieldDefImpl(
@@ -135,8 +151,10 @@ public:
 		const string& name,
 		X3DField::Type type,
 		SAIField::Access access,
+		size_t size,
+		size_t valueSize,
 		SAIField N::*field) :
-		FieldDef(nodeDef, name, type, access),
+		FieldDef(nodeDef, name, type, access, size, valueSize),
 		field(field) {}
 
     /**
@@ -160,7 +178,7 @@ public:
     virtual SAIField* getField(Node* node) {
         if (node == NULL)
             throw X3DError("called getField() on null node");
-        N* ptr = dynamic_cast<N*>(node);
+        N* ptr = nodeCast<N>(node);
         if (ptr == NULL) {
             std::ostringstream os;
             os << "called getField() on node of wrong type;"
@@ -181,7 +199,7 @@ public:
      * @returns pointer to field object instance
      */
     virtual const SAIField* getField(const Node* node) {
-        const N* ptr = dynamic_cast<const N*>(node);
+        const N* ptr = nodeCast<N>(node);
         if (ptr == NULL)
             throw X3DError("called getField() on node of wrong type");
         return &(ptr->*field);
@@ -42,7 +42,8 @@ public:
     /// Iteration mode lets you filter based on four criteria:
     /// - INPUT: input-capable fields (INPUT_ONLY, INPUT_OUTPUT)
     /// - OUTPUT: output-capable fields (OUTPUT_ONLY, INPUT_OUTPUT)
-    /// - DIRTY: all output capable fields which are marked dirty
+    /// - DIRTY: all output capable fields which are marked dirty; this
+    ///   reads the node's dirty mask rather than asking every field
     /// - CAN_INIT: all initializable fields (INIT_ONLY, INPUT_OUTPUT)
     /// - ALL: all input or output-capable fields
     typedef enum {
@@ -88,9 +89,18 @@ private:
     /// The node definition hierarchy iterator
     list<NodeDef*>::iterator chain_it;
 
+    /// In DIRTY mode, index of the current field in NodeDef::outputs
+    size_t output;
+
     /// Chomp until the next filtered field is found
     void findNext();
 
+    /// Skip to the next dirty output field, starting at #output
+    void findDirty();
+
+    /// @returns the definition of the current field
+    FieldDef* currentDef() const;
+
     /// Return true if the current field def passes the filter
     bool filter();
 };
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_FRAMEPIPELINE_H_
+#define _X3D_FRAMEPIPELINE_H_
+
+#include "internal/X3DField.h"
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+using std::map;
+using std::vector;
+
+namespace X3D {
+
+class SAIField;
+
+/**
+ * Second buffer of output values for pipelined frames; see
+ * Browser::setPipelined(). At the end of each frame, the values of the
+ * fields which changed in it and which have routes, are watched or are
+ * subscribed to are copied into their committed buffers. During the
+ * next frame, routes send the committed values, while sensors and
+ * routed-to nodes write the fields' own values, which are committed at
+ * the end of that frame.
+ *
+ * Committed buffers are allocated the first time a field is committed
+ * and reused after that, so a steady scene commits without allocating.
+ */
+class FramePipeline {
+private:
+
+    /// committed value of each field committed so far
+    map<SAIField*, X3DField*> buffers;
+
+    /// field and committed value
+    typedef std::pair<SAIField*, X3DField*> Commit;
+
+    /// fields committed at the last frame boundary, in the order they
+    /// changed
+    vector<Commit> committed;
+
+    /// number of frames committed
+    size_t frame;
+
+    /// Disallow copy constructor
+    FramePipeline(const FramePipeline& pipeline) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    FramePipeline() : frame(0) {}
+
+    /// Destructor; frees the committed buffers.
+    ~FramePipeline();
+
+    /**
+     * Commit the values of changed fields at the end of a frame. Fields
+     * with no outgoing routes which aren't watched or subscribed to are
+     * skipped.
+     *
+     * @param fields fields which changed during the frame
+     */
+    void commit(const vector<SAIField*>& fields);
+
+    /**
+     * Send the values committed at the last frame boundary along the
+     * routes of their fields, once. The receiving fields change in the
+     * current frame.
+     */
+    void deliver();
+
+    /**
+     * Forget a field which is being freed, with its committed value.
+     * Called by ~SAIField().
+     *
+     * @param field field being freed
+     */
+    void release(SAIField* field);
+
+    /// @returns whether there are committed values to deliver
+    bool isPending() const { return !committed.empty(); }
+
+    /// @returns number of frames committed
+    size_t getFrame() const { return frame; }
+
+    /**
+     * Get the value a field had at the last frame boundary at which it
+     * was committed.
+     *
+     * @param field field to look up
+     * @returns committed value, or NULL if the field was never committed
+     */
+    const X3DField* getCommitted(SAIField* field) const;
+
+    /// Forget all committed values, as when the scene is reset.
+    void clear();
+};
+
+}
+
+#endif // #ifndef _X3D_FRAMEPIPELINE_H_
@@ -21,6 +21,7 @@
 #define _X3D_INFIELD_H_
 
 #include "internal/SAIField.h"
+#include "internal/UpdateBuffer.h"
 
 namespace X3D {
 
@@ -44,10 +45,6 @@ private:
     typedef typename TT::REF_TYPE T;
     typedef typename TT::CONST_TYPE CT;
 
-protected:
-
-    list<Route*> incomingRoutes;
-
 public:
 
     /// Empty constructor.
@@ -91,9 +88,16 @@ public:
      * the value is of the wrong type or if the node is not in
      * state REALIZED.
      * 
+     * Between Browser::beginUpdate() and Browser::endUpdate(), the
+     * value is buffered instead.
+     *
      * @param value generic event value
      */
     INLINE void set(const X3DField& value) {
+        if (SAIField::buffering != NULL) {
+            SAIField::buffering->add<TT>(this, value);
+            return;
+        }
         (*this)(TT::unwrap(value));
     }
 
@@ -127,6 +131,9 @@ public:
     INLINE void operator()(CT value) {
         if (!node()->realized())
             throw X3DError("can't write to input field until node is realized", node());
+        if (this->flags & SAIField::FROZEN)
+            throw X3DError("field is frozen in a compiled StaticGroup", node());
+        ProfilerScope scope(node());
         action(value);
     }
 
@@ -150,19 +157,6 @@ public:
      */
     virtual void clearDirty() {}
 
-    void addIncomingRoute(Route* route) {
-        incomingRoutes.push_back(route);
-    }
-
-    void removeIncomingRoute(Route* route) {
-        incomingRoutes.remove(route);
-    }
-
-    const list<Route*>& getIncomingRoutes() const {
-        return incomingRoutes;
-    }
-
-
 private:
 
     // no copy constructor
@@ -21,6 +21,7 @@
 #define _X3D_INOUTFIELD_H_
 
 #include "internal/SAIField.h"
+#include "internal/UpdateBuffer.h"
 
 namespace X3D {
 
@@ -55,22 +56,13 @@ private:
     typedef typename TT::REF_TYPE T;
     typedef typename TT::CONST_TYPE CT;
 
-    /// whether field value has been modified since last event cascade
-    bool dirty;
-
-protected:
-
-    list<Route*> incomingRoutes;
-
-    list<Route*> outgoingRoutes;
-
 public:
 
     /// generic wrapper value of this field
     TT value;
 
     /// Default constructor; #value will have its default value.
-    InOutField() : dirty(false) {}
+    InOutField() {}
 
     /**
      * Returns a pointer to the node which owns this field.
@@ -116,9 +108,16 @@ public:
      * node is realized and #filter returns true, mark the field as dirty
      * and schedule for routing.
      * 
+     * Between Browser::beginUpdate() and Browser::endUpdate(), the
+     * value is buffered instead.
+     *
      * @param value generic field value to set
      */
     INLINE void set(const X3DField& value) {
+        if (SAIField::buffering != NULL) {
+            SAIField::buffering->add<TT>(this, value);
+            return;
+        }
         static TT x;
         try {
             (*this)(x.unwrap(value));
@@ -170,9 +169,11 @@ public:
             this->value = value;
             this->value.realize();
         } else {
+            if (this->flags & SAIField::FROZEN)
+                throw X3DError("field is frozen in a compiled StaticGroup", node());
             if (!filter(value))
                 return;
-            if (dirty) {
+            if (node()->isDirty(this->index)) {
                 throw EventLoopError(this);
             }
             this->value = value;
@@ -192,7 +193,9 @@ public:
     void send(CT value) {
         if (!node()->realized())
             throw X3DError("can't send output until realized");
-        if (dirty)
+        if (this->flags & SAIField::FROZEN)
+            throw X3DError("field is frozen in a compiled StaticGroup", node());
+        if (node()->isDirty(this->index))
             throw X3DError(
                 string("already wrote to this field: ") +
                     this->SAIField::getName());
@@ -206,11 +209,15 @@ public:
      * @param value whether field is changed
      */
     void changed(bool value=true) {
-        if (value && !dirty) {
+        if (value && !node()->isDirty(this->index)) {
             node()->queue(this);
+            ProfilerScope scope(node());
             action();
         }
-        dirty = value;
+        if (value)
+            node()->setDirty(this->index);
+        else
+            node()->clearDirty(this->index);
     }
 
     /**
@@ -221,20 +228,20 @@ public:
      * @param value native event value
      * @returns whether value has changed
      */
-    virtual bool filter(CT value) { return !(dirty || (this->value() == value)); }
+    virtual bool filter(CT value) { return !(node()->isDirty(this->index) || (this->value() == value)); }
 
     /**
      * Return whether field has been marked dirty since last event cascade.
      * 
      * @returns whether field is dirty
      */
-    bool isDirty() const { return dirty; }
+    bool isDirty() const { return node()->isDirty(this->index); }
 
     /**
      * Clear the dirty value.
      */
     virtual void clearDirty() {
-        dirty = false;
+        node()->clearDirty(this->index);
     }
 
     /**
@@ -242,30 +249,6 @@ public:
      */
     virtual void action() = 0;
 
-    void addIncomingRoute(Route* route) {
-        incomingRoutes.push_back(route);
-    }
-
-    void removeIncomingRoute(Route* route) {
-        incomingRoutes.remove(route);
-    }
-
-    const list<Route*>& getIncomingRoutes() const {
-        return incomingRoutes;
-    }
-
-    void addOutgoingRoute(Route* route) {
-        outgoingRoutes.push_back(route);
-    }
-
-    void removeOutgoingRoute(Route* route) {
-        outgoingRoutes.remove(route);
-    }
-
-    const list<Route*>& getOutgoingRoutes() const {
-        return outgoingRoutes;
-    }
-
 private:
 
     // no copy constructor
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_INJECTIONQUEUE_H_
+#define _X3D_INJECTIONQUEUE_H_
+
+#include "internal/SAIField.h"
+#include "internal/Atomic.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace X3D {
+
+class EventRecorder;
+
+/**
+ * Lock-free queue of events sent to input fields from other threads,
+ * such as input devices or the network. Any number of threads may
+ * inject(); the simulation thread drains the queue at the start of each
+ * frame, in Browser::simulate(). Of several values injected into one
+ * field before a drain, only the last is sent, and fields are sent to
+ * in the order they were first injected into.
+ *
+ * This is Vyukov's multi-producer single-consumer queue: a producer
+ * swaps its entry in as the head and then links the previous head to
+ * it, and the consumer follows the links from the tail. An entry whose
+ * producer is between those two steps ends the drain early and is
+ * picked up by the next one.
+ */
+class InjectionQueue {
+public:
+
+    /// counters of a queue, kept by the simulation thread
+    struct Stats {
+        /// values sent to fields
+        uint64_t applied;
+
+        /// values replaced by later values for the same field
+        uint64_t coalesced;
+
+        /// most entries taken by one drain
+        size_t maxDepth;
+
+        /// total and longest nanoseconds from inject() to drain()
+        uint64_t totalLatency, maxLatency;
+
+        Stats() : applied(0), coalesced(0), maxDepth(0),
+                  totalLatency(0), maxLatency(0) {}
+
+        /// @returns mean nanoseconds from inject() to drain()
+        double meanLatency() const {
+            uint64_t count = applied + coalesced;
+            return count == 0 ? 0 : (double) totalLatency / count;
+        }
+    };
+
+private:
+
+    /// one injected value
+    struct Entry {
+        Entry* next;
+        SAIField* field;
+        X3DField* value;
+        uint64_t time;
+    };
+
+    /// most recently injected entry; producers swap this
+    Entry* head;
+
+    /// oldest entry not yet drained; only the consumer touches this
+    Entry* tail;
+
+    /// placeholder keeping the queue non-empty
+    Entry stub;
+
+    /// injected entries not yet drained
+    size_t depth;
+
+    /// counters
+    Stats stats;
+
+    /// Disallow copy constructor
+    InjectionQueue(const InjectionQueue& queue) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    InjectionQueue();
+
+    /// Destructor; frees undrained entries without sending them.
+    ~InjectionQueue();
+
+    /**
+     * Queue a value for an input field. Safe on any thread.
+     *
+     * @param field field to send value to
+     * @param value value to send
+     * @throws X3DError if the field doesn't take input of that type
+     */
+    template <class T> void inject(SAIField* field, const T& value) {
+        check(field, value);
+        Entry* entry = new Entry();
+        entry->field = field;
+        entry->value = new T(value);
+        entry->time = now();
+        atomicAdd(&depth, (size_t) 1);
+        push(entry);
+    }
+
+    /**
+     * Queue a value of any type for an input field, as when replaying
+     * events. Safe on any thread.
+     *
+     * @param field field to send value to
+     * @param value value to send
+     * @throws X3DError if the field doesn't take input of that type
+     */
+    void inject(SAIField* field, const X3DField& value);
+
+    /**
+     * Send the queued values to their fields, which are then routed by
+     * the cascade. Called on the simulation thread.
+     *
+     * @param recorder event log to note the values sent in, if any
+     * @returns number of fields sent to
+     */
+    size_t drain(EventRecorder* recorder=NULL);
+
+    /// @returns number of entries injected and not yet drained
+    size_t getDepth() const { return atomicLoad(&depth); }
+
+    /// @returns counters
+    const Stats& getStats() const { return stats; }
+
+    /// Free undrained entries without sending them, as when the scene
+    /// is reset, and zero the counters. No thread may be injecting.
+    void clear();
+
+private:
+
+    /**
+     * Make sure a field can take a value.
+     *
+     * @throws X3DError if it can't
+     */
+    static void check(SAIField* field, const X3DField& value);
+
+    /// @returns monotonic clock time, in nanoseconds
+    static uint64_t now();
+
+    /// Link an entry in as the head.
+    void push(Entry* entry);
+
+    /// @returns oldest linked entry, or NULL if there is none
+    Entry* pop();
+};
+
+}
+
+#endif // #ifndef _X3D_INJECTIONQUEUE_H_
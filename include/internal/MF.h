@@ -135,6 +135,27 @@ public:
     virtual void print(ostream& os) const = 0;
     virtual bool empty() const = 0;
     virtual int size() const = 0;
+    // packed binary form: count, then each element
+    void encode(Encoder& out) const {
+        out.put<unsigned int>(size());
+        const_iterator it;
+        for (it = begin(); it != end(); it++)
+            S(*it).encode(out);
+    }
+    bool decode(Decoder& in) {
+        unsigned int count;
+        // every element takes at least a byte
+        if (!in.get(count) || count > in.remaining())
+            return false;
+        std::vector<S> elements(count);
+        for (size_t i = 0; i < count; i++)
+            if (!elements[i].decode(in))
+                return false;
+        clear();
+        for (size_t i = 0; i < count; i++)
+            add(elements[i]());
+        return true;
+    }
     // constructor
     MF() {}
     // iterators
@@ -150,7 +171,16 @@ public:
     INLINE MF<S>& operator()() { return *this; }
     INLINE const MF<S>& operator()() const { return *this; }
     MF<S>& operator()(const X3DField& value) {
-        throw X3DError("direct list assignment not supported");
+        if (value.getType() != getType())
+            throw X3DError(
+                string("base type mismatch; expected ") + getTypeName() +
+                ", but was " + value.getTypeName());
+        const MF<S>* mf = dynamic_cast<const MF<S>*>(&value);
+        if (mf == NULL)
+            throw X3DError("list type mismatch");
+        if (mf != this)
+            *this = *mf;
+        return *this;
     }
     const MF<S>& operator=(const MF<S>& mf) {
         clear();
@@ -235,7 +265,7 @@ public:
     typedef const MFNode<N>& CONST_TYPE;
     typedef MF<SFNode<N> > parent;
     void addNode(Node* node) {
-        N* n = dynamic_cast<N*>(node);
+        N* n = nodeCast<N>(node);
         if (n == NULL)
             throw X3DError("node type mismatch");
         this->add(n); // XXX problem spot...
@@ -327,6 +357,12 @@ public:
     virtual void clear() { elements.clear(); }
     virtual bool empty() const { return elements.empty(); }
     virtual int size() const { return elements.size(); }
+    size_t heapBytes() const {
+        size_t bytes = elements.size() * (sizeof(T) + 2 * sizeof(void*));
+        for (CONST_ITER it = elements.begin(); it != elements.end(); it++)
+            bytes += valueHeapBytes(*it);
+        return bytes;
+    }
     INLINE bool operator==(const MFList<S>& mf) const {
         return elements == mf.elements;
     }
@@ -386,6 +422,12 @@ public:
     virtual void clear() { elements.clear(); }
     virtual bool empty() const { return elements.empty(); }
     virtual int size() const { return elements.size(); }
+    size_t heapBytes() const {
+        size_t bytes = elements.capacity() * sizeof(T);
+        for (CONST_ITER it = elements.begin(); it != elements.end(); it++)
+            bytes += valueHeapBytes(*it);
+        return bytes;
+    }
     INLINE bool operator==(const MFArray<S>& mf) const {
         return elements == mf.elements;
     }
@@ -451,6 +493,7 @@ public:
     virtual void clear() { elements.clear(); }
     virtual bool empty() const { return elements.empty(); }
     virtual int size() const { return elements.size(); }
+    size_t heapBytes() const { return elements.size() * 3 * sizeof(void*); }
     INLINE bool operator==(const MFNodeList<N>& mf) const {
         return elements == mf.elements;
     }
@@ -519,6 +562,7 @@ public:
     virtual void clear() { elements.clear(); }
     virtual bool empty() const { return elements.empty(); }
     virtual int size() const { return elements.size(); }
+    size_t heapBytes() const { return elements.size() * 5 * sizeof(void*); }
     INLINE bool operator==(const MFNodeSet<N>& mf) const {
         return elements == mf.elements;
     }
@@ -586,6 +630,7 @@ public:
     virtual void clear() { elements.clear(); }
     virtual bool empty() const { return elements.empty(); }
     virtual int size() const { return elements.size(); }
+    size_t heapBytes() const { return elements.capacity() * sizeof(N*); }
     INLINE bool operator==(const MFNodeArray<N>& mf) const {
         return elements == mf.elements;
     }
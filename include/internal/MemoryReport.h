@@ -0,0 +1,121 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_MEMORYREPORT_H_
+#define _X3D_MEMORYREPORT_H_
+
+#include <stddef.h>
+#include <string>
+#include <map>
+#include <ostream>
+
+using std::string;
+using std::map;
+using std::ostream;
+
+namespace X3D {
+
+class Node;
+
+/**
+ * Accounting of the memory used by a set of nodes, their fields and the
+ * routes between them, as gathered by Browser::memoryReport().
+ *
+ * Node bytes are the size of each node's class, which includes its
+ * fields; field bytes are the part of that taken up by field objects,
+ * and value bytes the part of that which holds field values. Anything
+ * else in a field object (node and definition pointers, the flags word)
+ * is overhead. Heap bytes are what values own outside the node, such as
+ * MF elements and image pixels.
+ *
+ * Route lists are kept in the browser's route table rather than in the
+ * fields, and are counted separately.
+ *
+ * Container overhead is estimated from the standard node layouts, and
+ * nodes made by a factory are counted at the size of their definition's
+ * class, so the totals are close but not exact.
+ */
+class MemoryReport {
+public:
+
+    /// memory taken by one kind of thing
+    struct Entry {
+        /// number of instances
+        size_t count;
+
+        /// bytes taken by the instances themselves
+        size_t bytes;
+
+        /// of #bytes, those taken by field values
+        size_t valueBytes;
+
+        /// heap bytes owned by the instances
+        size_t heapBytes;
+
+        Entry() : count(0), bytes(0), valueBytes(0), heapBytes(0) {}
+
+        /// @returns own and heap bytes
+        size_t total() const { return bytes + heapBytes; }
+    };
+
+    /// entries by node type name; heap bytes are those of the node's fields
+    map<string, Entry> nodeTypes;
+
+    /// entries by field type name (SFFloat, MFNode, ...)
+    map<string, Entry> fieldTypes;
+
+    /// route objects
+    Entry routes;
+
+    /// route lists of routed fields; count and bytes are those of the
+    /// browser's route table, heap bytes the list entries
+    Entry routeLists;
+
+    /**
+     * Add a node, its fields and its outgoing routes to the report.
+     *
+     * @param node node to count
+     */
+    void add(Node* node);
+
+    /// @returns number of nodes counted
+    size_t nodeCount() const;
+
+    /// @returns total bytes of nodes, routes and everything they own
+    size_t totalBytes() const;
+
+    /**
+     * Print a table of the totals, node types and field types.
+     *
+     * @param os stream to print to
+     * @param n number of node types to print, largest first
+     */
+    void print(ostream& os, size_t n=20) const;
+
+    /**
+     * Write the report as JSON.
+     *
+     * @param os stream to write to
+     */
+    void writeJson(ostream& os) const;
+};
+
+}
+
+#endif // #ifndef _X3D_MEMORYREPORT_H_
@@ -25,6 +25,7 @@
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <map>
+#include <stdint.h>
 
 using std::string;
 
@@ -33,6 +34,19 @@ namespace X3D {
 // forward declarations
 class NodeDef;
 class Browser;
+class Encoder;
+class Decoder;
+template <class N> class NodeDefImpl;
+
+/**
+ * Per-class tag, used to identify a node class by address without
+ * requiring RTTI.
+ */
+template <class N> struct NodeType {
+    static const char tag;
+};
+
+template <class N> const char NodeType<N>::tag = 0;
 
 /**
  * Base class for all abstract and concrete node types.
@@ -41,6 +55,7 @@ class Browser;
  */
 class Node {
 friend class NodeDef;
+template <class N> friend class NodeDefImpl;
 public:
     /// Node lifcycle stage definitions
 	typedef enum {
@@ -56,16 +71,29 @@ public:
     /// Current stage of node lifecycle
 	Stage stage;
 
+    /// most output fields a node may have, one per bit of the dirty mask
+    static const unsigned int MAX_OUTPUTS = 64;
+
 private:
 
     string name;
 
+    /// whether node is exactly of its definition's class (not a subclass
+    /// made by a factory), so the definition's subobject offsets apply
+    bool exact;
+
+    /// output fields written during this cascade, by bit of field index
+    uint64_t dirty;
+
+    /// Add the node to the browser's list of dirty nodes.
+    void markDirty();
+
     /// Disallow copy constructor
 	Node(const Node& node) { throw X3DError("illegal copy"); }
 
 public:
     /// Empty constructor. Nodes start in stage SETUP.
-	Node() : stage(SETUP), definition(NULL) {}
+	Node() : stage(SETUP), definition(NULL), exact(false), dirty(0) {}
 
     /// Virtual deconstructor.
 	virtual ~Node();
@@ -194,6 +222,44 @@ public:
      */
     void queue(SAIField* field);
 
+    /// @returns whether any output field was written during this cascade
+    bool isDirty() const { return dirty != 0; }
+
+    /**
+     * Check whether an output field was written during this cascade.
+     *
+     * @param index output index of the field (SAIField::index)
+     * @returns whether field is dirty
+     */
+    bool isDirty(unsigned int index) const {
+        return (dirty >> index) & 1;
+    }
+
+    /**
+     * Mark an output field as written. The first field marked in a
+     * cascade puts the node on the browser's dirty node list, which
+     * the browser clears when the cascade ends.
+     *
+     * @param index output index of the field (SAIField::index)
+     */
+    void setDirty(unsigned int index) {
+        if (dirty == 0)
+            markDirty();
+        dirty |= (uint64_t) 1 << index;
+    }
+
+    /**
+     * Clear the dirty mark of an output field.
+     *
+     * @param index output index of the field (SAIField::index)
+     */
+    void clearDirty(unsigned int index) {
+        dirty &= ~((uint64_t) 1 << index);
+    }
+
+    /// Clear the dirty marks of all output fields.
+    void clearDirty() { dirty = 0; }
+
     /// @returns the default containerField for this node
     virtual const string& defaultContainerField();
 
@@ -206,8 +272,65 @@ public:
      * @returns whether special parsing was performed
      */
     virtual bool parseSpecial(xmlNode* xml, const string& filename);
+
+    /**
+     * Save whatever state the node keeps outside its fields, for
+     * Browser::checkpoint(). Nodes with such state override this and
+     * restoreState(); the default saves nothing.
+     *
+     * @param out encoder to write to
+     */
+    virtual void saveState(Encoder& out) const {}
+
+    /**
+     * Restore state saved by saveState(), for Browser::restore().
+     *
+     * @param in decoder to read from
+     */
+    virtual void restoreState(Decoder& in) {}
+
+    /**
+     * Find the subobject of this node with the given class tag, using
+     * the offsets precomputed by the node definition.
+     *
+     * @param tag address of NodeType<N>::tag for the wanted class
+     * @returns subobject pointer, or NULL if unknown
+     */
+    void* getSubobject(const void* tag) const;
 };
 
+/**
+ * Convert a node pointer to a pointer of the given node class. Nodes whose
+ * class matches their definition use the definition's precomputed offsets;
+ * anything else falls back to a dynamic cast.
+ *
+ * @param node node to convert
+ * @returns converted pointer, or NULL if node is NULL or of another class
+ */
+template <class N> N* nodeCast(Node* node) {
+    if (node == NULL)
+        return NULL;
+    void* sub = node->getSubobject(&NodeType<N>::tag);
+    if (sub != NULL)
+        return static_cast<N*>(sub);
+    return dynamic_cast<N*>(node);
+}
+
+/**
+ * Convert a const node pointer to a pointer of the given node class.
+ *
+ * @param node node to convert
+ * @returns converted pointer, or NULL if node is NULL or of another class
+ */
+template <class N> const N* nodeCast(const Node* node) {
+    if (node == NULL)
+        return NULL;
+    void* sub = node->getSubobject(&NodeType<N>::tag);
+    if (sub != NULL)
+        return static_cast<const N*>(sub);
+    return dynamic_cast<const N*>(node);
+}
+
 }
 
 #endif // #ifndef _X3D_NODE_H_
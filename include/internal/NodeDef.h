@@ -25,6 +25,7 @@
 #include <map>
 #include <list>
 #include <vector>
+#include <cstddef>
 
 using std::map;
 using std::list;
@@ -49,6 +50,15 @@ class NodeDef {
     friend class Prototype;
 
 public:
+    /// capability bits, set for definitions of those kinds of node
+    typedef enum {
+        SENSOR = 0x1,
+        TIME_DEPENDENT = 0x2,
+        BINDABLE = 0x4,
+        GROUPING = 0x8,
+        INTERPOLATOR = 0x10
+    } Capability;
+
     /// map of field basename to field definition
 	map<string, FieldDef*> fields;
 
@@ -64,10 +74,26 @@ public:
     /// chain from root ancestor to self
     list<NodeDef*> chain;
 
+    /// output-capable fields of the whole chain, in chain order; the
+    /// position of a field here is its bit in a node's dirty mask
+    vector<FieldDef*> outputs;
+
 private:
     /// list of node parents
 	vector<NodeDef*> parents;
 
+    /// offset of a chain member's class within this definition's class
+    struct Offset {
+        const void* tag;
+        ptrdiff_t offset;
+    };
+
+    /// subobject offsets, from self back to root ancestor
+    vector<Offset> offsets;
+
+    /// capability bits
+    unsigned int capabilities;
+
 protected:
     bool finished;
 
@@ -89,7 +115,8 @@ public:
      * @param abstract whether node definition is abstarct
      */
 	NodeDef(Component* component, const string& name, bool abstract) :
-		component(component), name(name), abstract(abstract), finished(false) {}
+        capabilities(0), finished(false),
+		component(component), name(name), abstract(abstract) {}
 
     /// Virtual destructor.
 	virtual ~NodeDef();
@@ -102,6 +129,9 @@ public:
      * @returns field object pointer
      */
     virtual SAIField* getField(const string& name, Node* node) = 0;
+
+    /// @returns size of this definition's class
+    virtual size_t getSize() const = 0;
     
     /**
      * Add a node defintiion as a parent of this one. The parent node
@@ -114,9 +144,37 @@ public:
     /**
      * This should be called after all inheritance and field declaration
      * has been completed. Any further precomputation should be done.
+     * This computes the capability bits, the offsets of each
+     * ancestor's subobject within nodes of this definition, and the
+     * list of output fields.
+     *
+     * @throws X3DError if there are more than Node::MAX_OUTPUTS outputs
      */
     void finish();
 
+    /**
+     * Check whether nodes of this definition have the given capability.
+     *
+     * @param cap capability to check
+     * @returns whether capability bit is set
+     */
+    bool is(Capability cap) const { return (capabilities & cap) != 0; }
+
+    /**
+     * Find the subobject of a node of exactly this definition's class
+     * which has the given class tag.
+     *
+     * @param node node of this definition
+     * @param tag address of NodeType<N>::tag for the wanted class
+     * @returns subobject pointer, or NULL if class is not in the chain
+     */
+    void* getSubobject(const Node* node, const void* tag) const {
+        for (size_t i = 0; i < offsets.size(); i++)
+            if (offsets[i].tag == tag)
+                return (char*) node + offsets[i].offset;
+        return NULL;
+    }
+
     /** @returns the name of the node type */
     const string& getName();
 
@@ -163,6 +221,13 @@ protected:
      */
     void manage(Node* node);
 
+    /**
+     * Give each output field of a new node its index in #outputs.
+     *
+     * @param node node to set up
+     */
+    void indexOutputs(Node* node);
+
     /**
      * Create a new prototype definition which is based on this
      * node definition as its interface.
@@ -177,9 +242,25 @@ protected:
      * @returns new node instance
      */
     template <class N> N* create() {
-        return dynamic_cast<N*>(create());
+        return nodeCast<N>(create());
     }
 
+    /// @returns address of NodeType<N>::tag for this definition's class
+    virtual const void* getTag() const = 0;
+
+    /// @returns a static instance of this definition's class
+    virtual Node* getProbe() = 0;
+
+    /**
+     * Find the offset of this definition's class within the given node,
+     * by a dynamic cast. Only used when finishing a definition.
+     *
+     * @param node node to look in
+     * @param offset set to offset of subobject from node
+     * @returns whether node is of this definition's class
+     */
+    virtual bool findOffset(Node* node, ptrdiff_t& offset) = 0;
+
     /** 
      * Add a field definition to this node. Field can be of any
      * access type.
@@ -245,12 +326,15 @@ public:
         N* node;
         if (!factories.empty())
             node = factories.front()->create();
-        else
+        else {
             node = new N();
+            node->exact = true;
+        }
         node->definition = this;
         list<NodeDef*>::reverse_iterator it;
         for (it = chain.rbegin(); it != chain.rend(); it++)
             (*it)->setup(node);
+        indexOutputs(node);
         manage(node);
         // XXX: possibly memory leak if setup methods fail
         return node;
@@ -310,7 +394,7 @@ protected:
      * @param node node to set up
      */
     void setup(Node* node) {
-        N* ptr = dynamic_cast<N*>(node);
+        N* ptr = nodeCast<N>(node);
         if (ptr == NULL)
             throw X3DError("setup() called on node of wrong type");
         initFields(ptr);
@@ -329,6 +413,37 @@ protected:
             (static_cast<FieldDefImpl<N>*>(*it))->init(node);
     }
 
+    const void* getTag() const {
+        return &NodeType<N>::tag;
+    }
+
+    Node* getProbe() {
+        return &probe();
+    }
+
+    size_t getSize() const {
+        return sizeof(N);
+    }
+
+    bool findOffset(Node* node, ptrdiff_t& offset) {
+        N* ptr = dynamic_cast<N*>(node);
+        if (ptr == NULL)
+            return false;
+        offset = (char*) ptr - (char*) node;
+        return true;
+    }
+
+    /**
+     * Static instance of the node type, used to read field types
+     * and class layout. It is never set up or managed.
+     *
+     * @returns probe instance
+     */
+    static N& probe() {
+        static N node;
+        return node;
+    }
+
 public:
 
     /**
@@ -341,14 +456,14 @@ public:
      * @param ptr node class pointer to field declaration
      * @returns new field definition
      */
-    // TODO: create a chunk of junk memory to point to via templatized node
-    // pointer, so that static read-only lookups don't segfault
 	template <typename T> FieldDef* createField(const string& name, T N::*ptr) {
-        static N node;
+        N& node = probe();
         X3DField::Type type = (node.*ptr).getType();
         SAIField::Access access = (node.*ptr).getAccess();
         SAIField N::*field = (SAIField N::*) ptr;
-		FieldDef* def = new FieldDefImpl<N>(this, name, type, access, field);
+        size_t valueSize = access == SAIField::INPUT_ONLY ? 0 : sizeof(typename T::VALUE_TYPE);
+		FieldDef* def = new FieldDefImpl<N>(
+            this, name, type, access, sizeof(T), valueSize, field);
 		addField(def);
 		return def;
 	}
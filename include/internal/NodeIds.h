@@ -0,0 +1,105 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_NODEIDS_H_
+#define _X3D_NODEIDS_H_
+
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class Node;
+
+/**
+ * Numbers the browser's nodes in the order they were created, for
+ * streams which name nodes to another process, or to a later run. A
+ * scene read the same way gets the same numbers. Nodes are only ever
+ * added to the end of the browser's list, so numbers stay put as the
+ * scene grows; both directions are looked up lazily, renumbering when
+ * a node is missing.
+ */
+class NodeIds {
+private:
+
+    /// id of a node, in the table of node ids
+    struct Entry {
+        /// node, or NULL for an empty table entry
+        Node* node;
+
+        /// id, or ~0 if not yet numbered
+        uint32_t id;
+
+        Entry() : node(NULL), id(~0u) {}
+    };
+
+    /// ids of nodes seen, in an open-addressed table whose size is a
+    /// power of two; a std::map lookup per fired node cost more than
+    /// the rest of recording a delta
+    vector<Entry> ids;
+
+    /// number of nodes in #ids
+    size_t count;
+
+    /// nodes by id
+    vector<Node*> nodes;
+
+public:
+
+    /// Constructor; no node is numbered yet.
+    NodeIds() : count(0) {}
+
+    /**
+     * Look up the id of a node.
+     *
+     * @param node managed node
+     * @returns node id
+     * @throws X3DError if the browser doesn't manage the node
+     */
+    uint32_t id(Node* node);
+
+    /**
+     * Look up the node with an id.
+     *
+     * @param id node id
+     * @returns managed node
+     * @throws X3DError if there is no such node
+     */
+    Node* node(uint32_t id);
+
+    /// Forget all ids, as when the scene is reset.
+    void clear();
+
+private:
+
+    /**
+     * Find a node's entry in #ids, adding it if it isn't there.
+     *
+     * @param node node to find
+     * @returns table entry
+     */
+    Entry& find(Node* node);
+};
+
+}
+
+#endif // #ifndef _X3D_NODEIDS_H_
@@ -54,20 +54,13 @@ private:
     typedef typename TT::REF_TYPE T;
     typedef typename TT::CONST_TYPE CT;
 
-    /// whether field has been modified
-    bool dirty;
-
-protected:
-
-    list<Route*> outgoingRoutes;
-
 public:
 
     /// Stored value of the field; last thing sent in output event.
     TT value;
 
     /// Empty constructor.
-    OutField() : dirty(false) {}
+    OutField() {}
 
     /**
      * Get a reference to the node which owns this field.
@@ -166,7 +159,9 @@ public:
     INLINE void send(CT value) {
         if (!node()->realized())
             throw X3DError("can't route event until realized", node());
-        if (dirty)
+        if (this->flags & SAIField::FROZEN)
+            throw X3DError("field is frozen in a compiled StaticGroup", node());
+        if (node()->isDirty(this->index))
             throw X3DError(
                 string("already wrote to this field: ") +
                     this->SAIField::getName(), node());
@@ -181,21 +176,25 @@ public:
      * @param value whether field is changed
      */
     void changed(bool value=true) {
-        if (value && !dirty) {
+        if (value && !node()->isDirty(this->index)) {
             node()->queue(this);
+            ProfilerScope scope(node());
             action();
         }
-        dirty = value;
+        if (value)
+            node()->setDirty(this->index);
+        else
+            node()->clearDirty(this->index);
     }
 
     /// @returns whether field has been marked dirty
-    bool isDirty() const { return dirty; }
+    bool isDirty() const { return node()->isDirty(this->index); }
 
     /**
      * Clear the dirty value.
      */
     virtual void clearDirty() {
-        dirty = false;
+        node()->clearDirty(this->index);
     }
 
     /**
@@ -206,18 +205,6 @@ public:
      */
     virtual void action() = 0;
 
-    void addOutgoingRoute(Route* route) {
-        outgoingRoutes.push_back(route);
-    }
-
-    void removeOutgoingRoute(Route* route) {
-        outgoingRoutes.remove(route);
-    }
-
-    const list<Route*>& getOutgoingRoutes() const {
-        return outgoingRoutes;
-    }
-
 private:
 
     // no copy constructor
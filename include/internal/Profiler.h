@@ -0,0 +1,245 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_PROFILER_H_
+#define _X3D_PROFILER_H_
+
+#include "internal/errors.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ostream;
+
+namespace X3D {
+
+class Node;
+class Route;
+
+/**
+ * Cascade profiler. When enabled, the browser's routing loop, route
+ * activations, sensor evaluations and field actions are timed, and call
+ * counts plus inclusive and exclusive time are accumulated per node type,
+ * per DEF-named node, and per route. Results can be written as a flat
+ * report of the top entries, or as Chrome trace-event JSON.
+ *
+ * Instrumented code goes through ProfilerScope, which only tests the
+ * static #active pointer while profiling is off.
+ */
+class Profiler {
+public:
+
+    /// kind of thing being timed
+    typedef enum {
+        CASCADE,
+        ROUTE,
+        NODE_TYPE,
+        NODE
+    } Category;
+
+    /// accumulated timing of one thing
+    struct Stat {
+        /// display name
+        string name;
+
+        /// kind of thing timed
+        Category category;
+
+        /// number of times entered
+        uint64_t count;
+
+        /// total time inside, in ticks
+        uint64_t inclusive;
+
+        /// total time inside but not in nested timed things, in ticks
+        uint64_t exclusive;
+
+        Stat() : category(CASCADE), count(0), inclusive(0), exclusive(0) {}
+    };
+
+    /// profiler currently recording, or NULL
+    static Profiler* active;
+
+private:
+
+    /// one entered scope
+    struct Frame {
+        Stat* stat;
+        Stat* extra;
+        uint64_t start;
+        uint64_t child;
+    };
+
+    /// one completed scope, for trace export
+    struct Span {
+        Stat* stat;
+        uint64_t start;
+        uint64_t duration;
+        uint32_t depth;
+    };
+
+    /// stats keyed by route, node definition or node
+    map<const void*, Stat> stats;
+
+    /// stats for nodes and routes which no longer exist
+    vector<Stat> retired;
+
+    /// stat for the browser's routing loop
+    Stat cascadeStat;
+
+    /// currently entered scopes
+    vector<Frame> frames;
+
+    /// completed scopes, in order of completion
+    vector<Span> spans;
+
+    /// spans not kept because #maxSpans was reached
+    uint64_t droppedSpans;
+
+    /// tick count and clock time when profiling was enabled
+    uint64_t baseTicks, baseClock;
+
+    /// Disallow copy constructor
+    Profiler(const Profiler& p) { throw X3DError("illegal copy"); }
+
+public:
+
+    /// largest number of spans kept for trace export
+    size_t maxSpans;
+
+    /// Constructor. Profiling starts disabled.
+    Profiler();
+
+    /// Destructor.
+    ~Profiler();
+
+    /// Start recording; this becomes the active profiler.
+    void enable();
+
+    /// Stop recording. Results are kept until clear().
+    void disable();
+
+    /// @returns whether this profiler is recording
+    bool isEnabled() const { return active == this; }
+
+    /// Discard all results.
+    void clear();
+
+    /**
+     * Stop keying results by the current nodes and routes, which are
+     * about to be deleted. Their results are kept under their names,
+     * but spans recorded so far are dropped.
+     */
+    void retireScene();
+
+    /// Begin timing one pass of the routing loop.
+    void enterCascade();
+
+    /**
+     * Begin timing a route activation.
+     *
+     * @param route route being activated
+     */
+    void enterRoute(const Route* route);
+
+    /**
+     * Begin timing work done by a node (a field action or sensor
+     * evaluation).
+     *
+     * @param node node doing the work
+     */
+    void enterNode(Node* node);
+
+    /// Finish timing the innermost scope.
+    void leave();
+
+    /**
+     * Collect all results, converted to nanoseconds and sorted by
+     * decreasing exclusive time.
+     *
+     * @param results vector to fill
+     */
+    void getResults(vector<Stat>& results) const;
+
+    /**
+     * Print the entries with the most exclusive time.
+     *
+     * @param os stream to print to
+     * @param n number of entries to print
+     */
+    void report(ostream& os, size_t n=20) const;
+
+    /**
+     * Write the recorded spans as Chrome trace-event JSON.
+     *
+     * @param os stream to write to
+     */
+    void writeChromeTrace(ostream& os) const;
+
+private:
+
+    /// push a frame for the given stats
+    void enter(Stat* stat, Stat* extra);
+
+    /// @returns nanoseconds per tick
+    double tickScale() const;
+};
+
+/**
+ * Times the enclosing block if a profiler is active. The constructor and
+ * destructor are a pointer test when profiling is off.
+ */
+class ProfilerScope {
+private:
+    Profiler* profiler;
+
+public:
+
+    /// Time one pass of the routing loop.
+    ProfilerScope() : profiler(Profiler::active) {
+        if (profiler != NULL)
+            profiler->enterCascade();
+    }
+
+    /// Time a route activation.
+    ProfilerScope(const Route* route) : profiler(Profiler::active) {
+        if (profiler != NULL)
+            profiler->enterRoute(route);
+    }
+
+    /// Time work done by a node.
+    ProfilerScope(Node* node) : profiler(Profiler::active) {
+        if (profiler != NULL)
+            profiler->enterNode(node);
+    }
+
+    ~ProfilerScope() {
+        if (profiler != NULL)
+            profiler->leave();
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_PROFILER_H_
@@ -21,6 +21,7 @@
 #define _X3D_PROTOINST_H_
 
 #include "Core/X3DPrototypeInstance.h"
+#include "internal/Scope.h"
 
 #include <map>
 #include <string>
@@ -38,7 +39,7 @@ class Route;
 class ProtoInst : virtual public Core::X3DPrototypeInstance {
 protected:
 
-    map<string, Node*> defs;
+    Scope defs;
     vector<Node*> nodes;
     vector<Route*> routes;
 
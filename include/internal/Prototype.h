@@ -24,6 +24,7 @@
 #include "internal/ProtoField.h"
 #include "internal/ProtoInst.h"
 #include "internal/Connect.h"
+#include "internal/Scope.h"
 
 #include <list>
 #include <vector>
@@ -46,7 +47,7 @@ protected:
 
     vector<Node*> nodes;
     list<Route*> routes;
-    map<string, Node*> defs;
+    Scope defs;
     map<string, ProtoField*> fields;
     map<string, ProtoField*> in_fields;
     map<string, ProtoField*> out_fields;
@@ -100,7 +101,7 @@ public:
     ~PrototypeImpl() { delete root; }
 
     virtual void setRootNode(Node* node) {
-        N* n = dynamic_cast<N*>(node);
+        N* n = nodeCast<N>(node);
         if (n == NULL)
             throw X3DError("wrong root node for prototype", node);
         root = n;
@@ -25,7 +25,15 @@
 namespace X3D {
 
 class Route {
+private:
+
+    /// id to give the next route created
+    static unsigned int nextId;
+
 public:
+    /// unique id of route, used to identify it in event traces
+    const unsigned int id;
+
     /// field which is source of event
     SAIField* const fromField;
 
@@ -34,7 +42,7 @@ public:
 
     /// Basic constructor.
     Route(SAIField* from, SAIField* to) :
-            fromField(from), toField(to) {
+            id(nextId++), fromField(from), toField(to) {
         if (from == NULL)
             throw X3DError("source field is null");
         if (to == NULL)
@@ -52,6 +60,7 @@ public:
      */
     Route(Node* from_node, const string& from_field,
           Node* to_node, const string& to_field) :
+            id(nextId++),
             fromField(from_node->getField(from_field)),
             toField(to_node->getField(to_field)) {
         checkTypes();
@@ -63,6 +72,15 @@ public:
      */
     void activate() const;
 
+    /**
+     * Send a value to the #toField, whether or not it is the current
+     * value of the #fromField. Pipelined frames send committed values
+     * this way.
+     *
+     * @param value value to send
+     */
+    void deliver(const X3DField& value) const;
+
     /**
      * Remove this route from the scene by de-listing it, but don't free its
      * memory. After calling this method, the route is dangling (not part of
@@ -75,13 +93,18 @@ public:
      */
     void insert();
 
+    /**
+     * Describe the route in the form "[Type] name.field -> name.field [Type]",
+     * for use in logs and traces.
+     *
+     * @returns route description
+     */
+    string describe() const;
+
 private:
 
     /// Make sure from and to field types are the same
     void checkTypes();
-
-    /// Log a route firing event with the given value
-    void logEvent(const X3DField& value) const;
 };
 
 }
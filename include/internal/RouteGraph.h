@@ -0,0 +1,217 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_ROUTEGRAPH_H_
+#define _X3D_ROUTEGRAPH_H_
+
+#include <stddef.h>
+#include <list>
+#include <map>
+#include <vector>
+#include <ostream>
+
+using std::list;
+using std::map;
+using std::vector;
+using std::ostream;
+
+namespace X3D {
+
+class Node;
+class Route;
+
+/**
+ * Static analysis of the graph of routes between nodes, run by
+ * Browser::analyzeRoutes() after a world is read. Each node with a route
+ * is a vertex; each route is an edge from the node sending the event to
+ * the one receiving it.
+ *
+ * The analysis finds the strongly connected components of the graph.
+ * Those with more than one node, or with a node routed to itself, are
+ * route cycles; X3D allows them, but they are only broken at run time
+ * by the rule that a field sends one event per cascade. The components
+ * are also ranked in topological order, so that a node's rank is below
+ * the ranks of all nodes it sends events to, unless they share a cycle.
+ *
+ * Finally, a node is live if anything outside the route graph can see
+ * its events: it has a watched or subscribed output, or it is not an
+ * interpolator, sensor or time-dependent node (so its inputs have other
+ * effects), or it routes to a live node. With pruning on, the outputs of the other,
+ * dead nodes are marked unobserved, so in demand-driven mode whole
+ * chains of interpolators stop running when nothing at their end is
+ * watched. See Browser::setDemandDriven().
+ *
+ * Routes created after the analysis update it incrementally: a route
+ * into a live node revives its source and whatever leads to it, and a
+ * route which agrees with the current ranks leaves them valid. Any
+ * other change makes the analysis stale, and the browser runs it again
+ * before the next cascade routes or the graph is next read through
+ * Browser::getRouteGraph().
+ */
+class RouteGraph {
+public:
+
+    /// rank of nodes which aren't in the graph
+    static const size_t NONE = (size_t) -1;
+
+private:
+
+    /// vertex numbers of nodes
+    map<Node*, size_t> index;
+
+    /// nodes by vertex number
+    vector<Node*> vertices;
+
+    /// rank of each vertex
+    vector<size_t> ranks;
+
+    /// liveness of each vertex
+    vector<bool> live;
+
+    /// nodes in topological order
+    vector<Node*> order;
+
+    /// nodes of each route cycle
+    vector< vector<Node*> > cycles;
+
+    /// number of routes seen by the last analysis
+    size_t edgeCount;
+
+    /// number of dead vertices
+    size_t deadCount;
+
+    /// whether dead nodes' outputs are marked unobserved
+    bool pruning;
+
+    /// whether the graph has been analyzed
+    bool analyzed;
+
+    /// whether routes have changed in ways not reflected in the analysis
+    bool stale;
+
+public:
+
+    /// Constructor; the graph starts out empty and unanalyzed.
+    RouteGraph() : edgeCount(0), deadCount(0), pruning(false),
+                   analyzed(false), stale(false) {}
+
+    /**
+     * Analyze the routes between the given nodes, replacing any previous
+     * analysis.
+     *
+     * @param nodes all nodes which may have routes
+     */
+    void analyze(const list<Node*>& nodes);
+
+    /**
+     * Turn pruning of dead nodes on or off; it is off by default. This
+     * takes effect at the next analysis.
+     *
+     * @param on whether to mark outputs of dead nodes unobserved
+     */
+    void setPruning(bool on) { pruning = on; }
+
+    /// @returns whether pruning is on
+    bool isPruning() const { return pruning; }
+
+    /**
+     * Update the analysis for a route which has just been inserted.
+     *
+     * @param route new route
+     */
+    void addRoute(const Route* route);
+
+    /**
+     * Update the analysis for a route which has just been removed.
+     * Nodes stay live, so this only makes the ranks and cycles stale.
+     *
+     * @param route removed route
+     */
+    void removeRoute(const Route* route);
+
+    /**
+     * Make a node live, along with every dead node routed to it, and
+     * mark their outputs observed again.
+     *
+     * @param node node which something can now see
+     */
+    void revive(Node* node);
+
+    /// @returns whether the graph has been analyzed and is not stale
+    bool isCurrent() const { return analyzed && !stale; }
+
+    /// @returns whether the graph has been analyzed but is now stale
+    bool isStale() const { return analyzed && stale; }
+
+    /**
+     * Get the rank of a node in the topological order of the graph.
+     * Nodes in the same cycle have the same rank.
+     *
+     * @param node node to rank
+     * @returns rank, or #NONE if the node has no routes
+     */
+    size_t rank(Node* node) const;
+
+    /**
+     * Check whether a node is live. Nodes outside the graph are.
+     *
+     * @param node node to check
+     * @returns whether the node is live
+     */
+    bool isLive(Node* node) const;
+
+    /// @returns routed nodes in topological order
+    const vector<Node*>& getOrder() const { return order; }
+
+    /// @returns nodes of each route cycle
+    const vector< vector<Node*> >& getCycles() const { return cycles; }
+
+    /// @returns number of routed nodes
+    size_t nodeCount() const { return vertices.size(); }
+
+    /// @returns number of routes in the last analysis
+    size_t routeCount() const { return edgeCount; }
+
+    /// @returns number of dead nodes
+    size_t deadNodeCount() const { return deadCount; }
+
+    /**
+     * Print a summary of the analysis, and the nodes of each cycle.
+     *
+     * @param os stream to print to
+     */
+    void print(ostream& os) const;
+
+    /// Forget the analysis, as when the scene is reset.
+    void clear();
+
+private:
+
+    /**
+     * Mark the outputs of a node pruned or not.
+     *
+     * @param node node whose outputs to mark
+     * @param pruned whether to mark them pruned
+     */
+    static void markOutputs(Node* node, bool pruned);
+};
+
+}
+
+#endif // #ifndef _X3D_ROUTEGRAPH_H_
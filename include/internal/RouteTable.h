@@ -0,0 +1,113 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_ROUTETABLE_H_
+#define _X3D_ROUTETABLE_H_
+
+#include "internal/errors.h"
+#include <stddef.h>
+#include <list>
+#include <vector>
+
+using std::list;
+using std::vector;
+
+namespace X3D {
+
+class Route;
+
+/**
+ * Route connectivity of all routed fields, owned by the browser. Most
+ * fields never get a route, so rather than every field carrying its own
+ * route lists, the lists of routed fields are kept here and the fields
+ * only carry flag bits saying whether they have any, plus the number of
+ * their slot in this table.
+ *
+ * Slot numbers start at one, so zero can mean "no slot". Freed slots
+ * are reused. The lists of each slot are allocated separately, so
+ * references to them stay valid while the table grows.
+ */
+class RouteTable {
+public:
+
+    /// routes into and out of one field
+    struct Links {
+        list<Route*> incoming;
+        list<Route*> outgoing;
+    };
+
+private:
+
+    /// lists by slot number less one; NULL for free slots
+    vector<Links*> slots;
+
+    /// free slot numbers
+    vector<unsigned int> freeSlots;
+
+    /// Disallow copy constructor
+    RouteTable(const RouteTable& table) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// empty route list, for fields without routes
+    static const list<Route*> none;
+
+    /// Constructor.
+    RouteTable() {}
+
+    /// Destructor; frees the lists, but not the routes in them.
+    ~RouteTable();
+
+    /**
+     * Allocate empty lists.
+     *
+     * @returns slot number of new lists
+     */
+    unsigned int add();
+
+    /**
+     * Get the lists in a slot.
+     *
+     * @param slot slot number, as returned by add()
+     * @returns lists in slot
+     */
+    Links& operator[](unsigned int slot) const { return *slots[slot - 1]; }
+
+    /**
+     * Free the lists in a slot, so that the slot may be reused.
+     *
+     * @param slot slot number, as returned by add()
+     */
+    void remove(unsigned int slot);
+
+    /// @returns number of slots in use
+    size_t size() const { return slots.size() - freeSlots.size(); }
+
+    /// @returns bytes taken by the table and lists, not counting list entries
+    size_t bytes() const;
+
+    /// Free all lists.
+    void clear();
+};
+
+}
+
+#endif // #ifndef _X3D_ROUTETABLE_H_
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SAICLIENT_H_
+#define _X3D_SAICLIENT_H_
+
+#include "internal/SAIProtocol.h"
+#include "internal/X3DField.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+/**
+ * Blocking client of SAIServer, for other processes and for tests. It
+ * doesn't need a browser; values are plain X3DField objects.
+ *
+ * SETs are only queued, so many can go out in one write; flush() sends
+ * them, and every other request flushes first. Requests wait for their
+ * reply, taking in any NOTIFY which arrives before it. The latest value
+ * of each subscribed field is kept, and can be read with value().
+ */
+class SAIClient {
+public:
+
+    /// a field handle, with what the server said about the field
+    struct Field {
+        uint32_t handle;
+        X3DField::Type type;
+        uint8_t access;
+        Field() : handle(0), type(X3DField::SFBOOL), access(0) {}
+    };
+
+private:
+
+    /// socket, or -1
+    int fd;
+
+    /// requests not yet sent
+    ByteBuffer output;
+
+    /// bytes received but not yet handled
+    vector<char> input;
+
+    /// last request id used
+    uint32_t lastId;
+
+    /// type of each field handle seen
+    map<uint32_t, X3DField::Type> types;
+
+    /// latest notified value of each field handle
+    map<uint32_t, X3DField*> values;
+
+    /// NOTIFY messages received
+    size_t notices;
+
+    /// ERROR messages received for SETs
+    size_t errors;
+
+    /// message of the last such error
+    string error;
+
+    /// Disallow copy constructor
+    SAIClient(const SAIClient& client) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    SAIClient() : fd(-1), lastId(0), notices(0), errors(0) {}
+
+    /// Destructor; closes the connection.
+    ~SAIClient();
+
+    /**
+     * Connect to a server.
+     *
+     * @param path file system path of the server's socket
+     * @throws X3DError if the connection fails
+     */
+    void connect(const string& path);
+
+    /// Close the connection.
+    void close();
+
+    /// @returns whether the client is connected
+    bool isConnected() const { return fd >= 0; }
+
+    /**
+     * Look up a named node.
+     *
+     * @param name DEF name of node
+     * @returns node handle
+     * @throws X3DError if there is no such node
+     */
+    uint32_t getNode(const string& name);
+
+    /**
+     * Look up a field of a node.
+     *
+     * @param node node handle
+     * @param name field name
+     * @returns field handle, type and access
+     * @throws X3DError if there is no such field
+     */
+    Field getField(uint32_t node, const string& name);
+
+    /**
+     * Queue a value to send to a field. Errors come back later, and are
+     * only counted; see errorCount().
+     *
+     * @param field field handle
+     * @param value value to send
+     */
+    void set(uint32_t field, const X3DField& value);
+
+    /**
+     * Read the current value of a field.
+     *
+     * @param field field handle
+     * @param value value to decode into, of the field's type
+     * @throws X3DError if the field can't be read
+     */
+    void get(uint32_t field, X3DField& value);
+
+    /**
+     * Have the server send the field's changes to this client.
+     *
+     * @param field field handle of an output or input-output field
+     */
+    void subscribe(uint32_t field);
+
+    /**
+     * Stop receiving the field's changes.
+     *
+     * @param field field handle
+     */
+    void unsubscribe(uint32_t field);
+
+    /**
+     * Route one field to another.
+     *
+     * @param from field handle of source
+     * @param to field handle of destination
+     */
+    void createRoute(uint32_t from, uint32_t to);
+
+    /// Send queued SETs.
+    void flush();
+
+    /**
+     * Wait until the server has handled everything sent so far and
+     * run the cascade for it, so its notifications have arrived.
+     */
+    void sync();
+
+    /**
+     * Wait for a notification.
+     *
+     * @param timeout milliseconds to wait; -1 waits indefinitely
+     * @returns whether a NOTIFY arrived
+     */
+    bool receive(int timeout = -1);
+
+    /**
+     * Get the latest notified value of a subscribed field.
+     *
+     * @param field field handle
+     * @returns value, or NULL if none has arrived
+     */
+    const X3DField* value(uint32_t field) const;
+
+    /// @returns number of NOTIFY messages received
+    size_t noticeCount() const { return notices; }
+
+    /// @returns number of errors reported for SETs
+    size_t errorCount() const { return errors; }
+
+    /// @returns message of the last error reported for a SET
+    const string& lastError() const { return error; }
+
+private:
+
+    /**
+     * Send the queued requests, and wait for the reply to the last one.
+     * An error reply to it is thrown.
+     *
+     * @param id request id
+     * @param reply expected reply type
+     * @returns reply payload, after the id
+     */
+    vector<char> call(uint32_t id, SAIProtocol::Op reply);
+
+    /**
+     * Read one message, blocking for up to the timeout.
+     *
+     * @param timeout milliseconds to wait; -1 waits indefinitely
+     * @param op set to the message type
+     * @param body set to the payload
+     * @returns whether a message was read
+     */
+    bool read(int timeout, uint8_t& op, vector<char>& body);
+
+    /**
+     * Take in a NOTIFY message.
+     *
+     * @param body message payload
+     */
+    void notify(const vector<char>& body);
+
+    /**
+     * Write bytes, blocking until all are sent.
+     *
+     * @param data bytes to write
+     * @param size number of bytes
+     */
+    void send(const char* data, size_t size);
+
+    /// @returns id for a new request
+    uint32_t nextId() { return ++lastId; }
+};
+
+}
+
+#endif // #ifndef _X3D_SAICLIENT_H_
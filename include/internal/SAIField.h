@@ -21,6 +21,7 @@
 #define _X3D_SAIFIELD_H_
 
 #include "internal/X3DField.h"
+#include "internal/Profiler.h"
 #include <string>
 #include <list>
 #include <map>
@@ -33,6 +34,8 @@ namespace X3D {
 class Node;
 class Route;
 class FieldDef;
+class FieldObserver;
+class UpdateBuffer;
 
 /**
  * Base class for all node-owned field instances. This is not a "definition"
@@ -52,9 +55,37 @@ public:
 		INPUT_OUTPUT
 	} Access;
 
+    /// bits of #flags
+    typedef enum {
+        ROUTED_IN = 0x1,  ///< has incoming routes in the route table
+        ROUTED_OUT = 0x2, ///< has outgoing routes in the route table
+        WATCHED = 0x4,    ///< read from outside the scene; see Browser::watch()
+        PRUNED = 0x8,     ///< routes lead only to dead nodes; see RouteGraph
+        SUBSCRIBED = 0x10, ///< has observers; see Browser::subscribe()
+        FROZEN = 0x20,    ///< in a compiled StaticGroup; can't be written or routed
+        PENDING = 0x40    ///< written during an update; see Browser::beginUpdate()
+    } Flag;
+
+    /// state bits; route lists live in the browser's route table
+    unsigned char flags;
+
+    /// position among the node's output fields (NodeDef::outputs), which
+    /// is the field's bit in the node's dirty mask
+    unsigned char index;
+
+    /// slot of the field's route lists in the route table, or 0
+    unsigned int routeSlot;
+
+    /// position of the field's write in the browser's update buffer,
+    /// while it is flagged #PENDING
+    unsigned int updateSlot;
+
     /// Empty constructor.
-    SAIField() {}
-    virtual ~SAIField() {}
+    SAIField() : flags(0), index(0), routeSlot(0), updateSlot(0) {}
+
+    /// Destructor. Drops any route lists left in the route table, and
+    /// any subscriptions or buffered write of the field.
+    virtual ~SAIField();
 
     /** @returns the name of the field */
     virtual const string& getName() const;
@@ -99,7 +130,9 @@ public:
 
     /**
      * Clone this field by initializing its opposite member in
-     * another node. Depending on the arguments, this may be recursive.
+     * another node. Depending on the arguments, this may be recursive;
+     * the nodes of a FROZEN field are shared rather than cloned, since
+     * they can't change.
      *
      * @param node node containing target field
      * @param mapping mapping from old node to new node
@@ -160,18 +193,76 @@ public:
      */
     virtual void clearDirty() = 0;
 
-    virtual void addIncomingRoute(Route* route);
-    virtual void removeIncomingRoute(Route* route);
-    virtual const list<Route*>& getIncomingRoutes() const;
+    /**
+     * Connect an incoming route. The route lists of all fields are kept
+     * in the browser's route table.
+     *
+     * @param route route to add
+     * @throws X3DError if the field isn't input-capable
+     */
+    void addIncomingRoute(Route* route);
+
+    /// @param route incoming route to disconnect
+    void removeIncomingRoute(Route* route);
+
+    /// @returns incoming routes, in the order they were added
+    const list<Route*>& getIncomingRoutes() const;
+
+    /// @returns whether the field has any incoming routes
+    bool hasIncomingRoutes() const { return flags & ROUTED_IN; }
+
+    /**
+     * Connect an outgoing route.
+     *
+     * @param route route to add
+     * @throws X3DError if the field isn't output-capable
+     */
+    void addOutgoingRoute(Route* route);
 
-    virtual void addOutgoingRoute(Route* route);
-    virtual void removeOutgoingRoute(Route* route);
-    virtual const list<Route*>& getOutgoingRoutes() const;
+    /// @param route outgoing route to disconnect
+    void removeOutgoingRoute(Route* route);
 
+    /// @returns outgoing routes, in the order they were added
+    const list<Route*>& getOutgoingRoutes() const;
+
+    /// @returns whether the field has any outgoing routes
+    bool hasOutgoingRoutes() const { return flags & ROUTED_OUT; }
+
+    /// @returns whether anything reads the field's events, by watch, by
+    /// subscription or by a route to a live node
+    bool isObserved() const {
+        return (flags & (WATCHED | SUBSCRIBED))
+            || (flags & (ROUTED_OUT | PRUNED)) == ROUTED_OUT;
+    }
+
+    /**
+     * Subscribe an observer to the field's changes; see
+     * Browser::subscribe().
+     *
+     * @param observer observer to call when the field changes
+     */
+    void subscribe(FieldObserver* observer);
+
+    /// @param observer subscribed observer to remove
+    void unsubscribe(FieldObserver* observer);
+
+    /// Delete all routes into and out of the field.
     void dispose();
 
+protected:
+
+    /// buffer for set() on input fields, or NULL if not buffering;
+    /// see Browser::beginUpdate()
+    static UpdateBuffer* buffering;
+
 private:
 
+    // allow browser to start and end buffering
+    friend class Browser;
+
+    /// remove a route from one of the field's lists
+    void unlink(Route* route, Flag which);
+
     // no copy constructor
     SAIField(const SAIField& f) { throw X3DError("COPY CONSTRUCTOR"); }
 };
@@ -216,6 +307,9 @@ template <class N, class TT>
 class BaseField : public NodeField<N> {
 public:
 
+    /// data container type of the field
+    typedef TT VALUE_TYPE;
+
     /// Empty constructor.
     BaseField() {}
 
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SAIPROTOCOL_H_
+#define _X3D_SAIPROTOCOL_H_
+
+#include "internal/Encoder.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace X3D {
+
+/**
+ * Binary protocol spoken by SAIServer and SAIClient over a Unix domain
+ * socket. All numbers are in native byte order, and values are in the
+ * packed form of X3DField::encode().
+ *
+ * Each message is a frame: a 32-bit length of the rest of the frame,
+ * an 8-bit opcode, and the payload below. Requests carry an id which
+ * the reply echoes; SET carries none, so a client can stream any
+ * number of them, and errors in them are reported with id 0.
+ *
+ * Client to server:
+ *   GET_NODE     id, name                  -> NODE id, node
+ *   GET_FIELD    id, node, name            -> FIELD id, field, type, access
+ *   SET          field, value
+ *   GET          id, field                 -> VALUE id, field, value
+ *   SUBSCRIBE    id, field                 -> OK id
+ *   UNSUBSCRIBE  id, field                 -> OK id
+ *   CREATE_ROUTE id, from field, to field  -> OK id
+ *   SYNC         id                        -> OK id, after the cascade
+ *
+ * Server to client, besides the replies:
+ *   ERROR        id, message
+ *   NOTIFY       cascade, time, count, (field, value) * count
+ *
+ * Ids, nodes, fields and counts are 32-bit; type and access are 8-bit
+ * X3DField::Type and SAIField::Access; time is a double; names and
+ * messages are length-prefixed strings, as Encoder::putString() writes.
+ */
+class SAIProtocol {
+public:
+
+    /// message types
+    typedef enum {
+        GET_NODE = 1,
+        GET_FIELD,
+        SET,
+        GET,
+        SUBSCRIBE,
+        UNSUBSCRIBE,
+        CREATE_ROUTE,
+        SYNC,
+
+        OK = 128,
+        ERROR,
+        NODE,
+        FIELD,
+        VALUE,
+        NOTIFY
+    } Op;
+
+    /// largest frame either side accepts
+    static const size_t MAX_FRAME = 1 << 24;
+
+    /**
+     * Start a frame, leaving room for its length.
+     *
+     * @param out buffer to append the frame to
+     * @param op message type
+     * @returns offset of the frame, to pass to end()
+     */
+    static size_t begin(ByteBuffer& out, Op op) {
+        size_t start = out.bytes.size();
+        out.put<uint32_t>(0);
+        out.put<uint8_t>(op);
+        return start;
+    }
+
+    /**
+     * Finish a frame by filling in its length.
+     *
+     * @param out buffer holding the frame
+     * @param start offset returned by begin()
+     */
+    static void end(ByteBuffer& out, size_t start) {
+        uint32_t length = out.bytes.size() - start - sizeof(uint32_t);
+        memcpy(&out.bytes[start], &length, sizeof(length));
+    }
+
+    /**
+     * Find the next whole frame in received bytes.
+     *
+     * @param data received bytes
+     * @param size number of bytes
+     * @returns length of the frame's body, not counting its length
+     *          word, or 0 if the frame isn't all there yet
+     * @throws X3DError if the frame is empty or too long
+     */
+    static size_t frame(const char* data, size_t size) {
+        uint32_t length;
+        if (size < sizeof(length))
+            return 0;
+        memcpy(&length, data, sizeof(length));
+        if (length == 0 || length > MAX_FRAME)
+            throw X3DError("bad frame length");
+        return size - sizeof(length) < length ? 0 : length;
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_SAIPROTOCOL_H_
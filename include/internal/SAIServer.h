@@ -0,0 +1,205 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SAISERVER_H_
+#define _X3D_SAISERVER_H_
+
+#include "internal/SAIProtocol.h"
+#include "internal/Subscriptions.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+
+/**
+ * Server letting other processes drive the scene through SAIProtocol on
+ * a Unix domain socket, without linking the library. The server never
+ * blocks: the application calls poll() between cascades, which accepts
+ * clients, reads whatever they have sent and handles every whole
+ * message. All values set in one poll(), by any client, are applied in
+ * one update, so they are routed together in a single cascade.
+ *
+ * Clients refer to nodes and fields by handles, which the server hands
+ * out from GET_NODE and GET_FIELD and shares between clients. Handles
+ * stay valid until the scene is reset; close the server before that.
+ *
+ * Subscribed clients get one NOTIFY per cascade with every subscribed
+ * field which changed in it, written as soon as the cascade ends.
+ */
+class SAIServer : public FieldObserver {
+private:
+
+    /// a connected client
+    struct Client {
+        /// socket
+        int fd;
+
+        /// bytes received but not yet handled
+        vector<char> input;
+
+        /// bytes waiting to be sent
+        ByteBuffer output;
+
+        /// bytes of output already sent
+        size_t sent;
+
+        /// changes of this cascade for the client's NOTIFY
+        ByteBuffer notice;
+
+        /// number of changes in #notice
+        uint32_t noticeCount;
+
+        /// SYNC ids to answer after this poll's cascade
+        vector<uint32_t> syncs;
+
+        /// whether the connection is to be closed
+        bool closing;
+
+        Client(int fd) : fd(fd), sent(0), noticeCount(0), closing(false) {}
+    };
+
+    /// socket accepting connections, or -1
+    int listener;
+
+    /// path of the socket
+    string path;
+
+    /// connected clients
+    vector<Client*> clients;
+
+    /// nodes by handle less one
+    vector<Node*> nodes;
+
+    /// handle of each node handed out
+    map<Node*, uint32_t> nodeHandles;
+
+    /// fields by handle less one
+    vector<SAIField*> fields;
+
+    /// handle of each field handed out
+    map<SAIField*, uint32_t> fieldHandles;
+
+    /// value buffer of each field handle, for decoding SETs into
+    vector<X3DField*> values;
+
+    /// clients subscribed to each field
+    map<SAIField*, vector<Client*> > subscribers;
+
+    /// messages handled
+    size_t messages;
+
+    /// Disallow copy constructor
+    SAIServer(const SAIServer& server) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    SAIServer() : listener(-1), messages(0) {}
+
+    /// Destructor; closes the server.
+    ~SAIServer();
+
+    /**
+     * Start listening. An existing socket file at the path is replaced.
+     *
+     * @param path file system path of the socket
+     * @throws X3DError if the socket can't be created
+     */
+    void listen(const string& path);
+
+    /// Disconnect all clients, stop listening and forget all handles.
+    void close();
+
+    /// @returns whether the server is listening
+    bool isListening() const { return listener >= 0; }
+
+    /**
+     * Accept connections, handle received messages and send replies.
+     *
+     * @param timeout milliseconds to wait for something to happen;
+     *                0 returns at once, -1 waits indefinitely
+     * @returns number of messages handled
+     */
+    size_t poll(int timeout = 0);
+
+    /// @returns number of connected clients
+    size_t clientCount() const { return clients.size(); }
+
+    /// @returns number of messages handled since listen()
+    size_t messageCount() const { return messages; }
+
+    /// Queue notifications of changed fields to their subscribers.
+    void changed(const vector<Change>& changes);
+
+private:
+
+    /**
+     * Handle the whole messages a client has sent.
+     *
+     * @param client client to read from
+     * @returns number of messages handled
+     */
+    size_t handleInput(Client* client);
+
+    /**
+     * Handle one message.
+     *
+     * @param client client which sent it
+     * @param op message type
+     * @param in message payload
+     */
+    void handle(Client* client, uint8_t op, Decoder& in);
+
+    /**
+     * Look up a field by handle.
+     *
+     * @param handle field handle
+     * @returns field
+     * @throws X3DError if there is no such field
+     */
+    SAIField* field(uint32_t handle);
+
+    /**
+     * Send whatever of a client's output the socket takes now.
+     *
+     * @param client client to write to
+     */
+    void flush(Client* client);
+
+    /**
+     * Disconnect a client and drop its subscriptions.
+     *
+     * @param client client to drop
+     */
+    void drop(Client* client);
+};
+
+}
+
+#endif // #ifndef _X3D_SAISERVER_H_
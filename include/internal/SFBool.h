@@ -98,6 +98,18 @@ public:
     void print(ostream& os) const {
         os << std::boolalpha << value;
     }
+
+    void encode(Encoder& out) const {
+        out.put<char>(value);
+    }
+
+    bool decode(Decoder& in) {
+        char c;
+        if (!in.get(c))
+            return false;
+        value = c != 0;
+        return true;
+    }
 };
 
 }
@@ -190,6 +190,26 @@ public:
     void print(ostream& os) const {
         os << r << ' ' << g << ' ' << b;
     }
+
+    void encode(Encoder& out) const {
+        out.put(r);
+        out.put(g);
+        out.put(b);
+    }
+
+    bool decode(Decoder& in) {
+        float r, g, b;
+        if (!(in.get(r) && in.get(g) && in.get(b)))
+            return false;
+        if (r < 0 || r > 1 ||
+            g < 0 || g > 1 ||
+            b < 0 || b > 1)
+            return false;
+        this->r = r;
+        this->g = g;
+        this->b = b;
+        return true;
+    }
 };
 
 
@@ -384,6 +404,29 @@ public:
     void print(ostream& os) const {
         os << r << ' ' << g << ' ' << b << ' ' << a;
     }
+
+    void encode(Encoder& out) const {
+        out.put(r);
+        out.put(g);
+        out.put(b);
+        out.put(a);
+    }
+
+    bool decode(Decoder& in) {
+        float r, g, b, a;
+        if (!(in.get(r) && in.get(g) && in.get(b) && in.get(a)))
+            return false;
+        if (r < 0 || r > 1 ||
+            g < 0 || g > 1 ||
+            b < 0 || b > 1 ||
+            a < 0 || a > 1)
+            return false;
+        this->r = r;
+        this->g = g;
+        this->b = b;
+        this->a = a;
+        return true;
+    }
 };
 
 }
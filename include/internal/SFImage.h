@@ -331,6 +331,10 @@ public:
 
     void print(ostream& os) const;
 
+    void encode(Encoder& out) const;
+
+    size_t heapBytes() const { return bytes == NULL ? 0 : size; }
+
 private:
 	
     /**
@@ -371,6 +375,9 @@ private:
 	const unsigned char* locate(int x, int y) const;
 };
 
+/// @returns heap bytes owned by an MFImage element
+inline size_t valueHeapBytes(const SFImage& value) { return value.heapBytes(); }
+
 }
 
 #endif // #ifndef _X3D_SFIMAGE_H_
@@ -106,6 +106,14 @@ public:
     void print(ostream& os) const {
         os << value;
     }
+
+    void encode(Encoder& out) const {
+        out.put(value);
+    }
+
+    bool decode(Decoder& in) {
+        return in.get(value);
+    }
 };
 
 }
@@ -98,7 +98,7 @@ public:
 	 * @param index element index
 	 * @returns mutable pointer into the array elements
 	 */
-	T& operator[](int index) { return &data[index]; }
+	T& operator[](int index) { return data[index]; }
 
 	/**
 	 * Index operator (const version).
@@ -248,6 +248,14 @@ public:
             os << data[i] << ' ';
     }
 
+    void encode(Encoder& out) const {
+        out.write(data, sizeof(data));
+    }
+
+    bool decode(Decoder& in) {
+        return in.read(data, sizeof(data));
+    }
+
 private:
 
     /**
@@ -332,7 +340,7 @@ public:
 	 * @param index element index
 	 * @returns mutable pointer into the array elements
 	 */
-	T& operator[](int index) { return &data[index]; }
+	T& operator[](int index) { return data[index]; }
 
 	/**
 	 * Index operator (const version).
@@ -447,7 +455,7 @@ public:
 			a[12]*b[ 2] + a[13]*b[ 6] + a[14]*b[10] + a[15]*b[14],
 			a[12]*b[ 3] + a[13]*b[ 7] + a[14]*b[11] + a[15]*b[15]
 		};
-		return SFMatrix3<T,S>(c);
+		return SFMatrix4<T,S>(c);
 	}
 
 	/**
@@ -512,6 +520,14 @@ public:
             os << data[i] << ' ';
     }
 
+    void encode(Encoder& out) const {
+        out.write(data, sizeof(data));
+    }
+
+    bool decode(Decoder& in) {
+        return in.read(data, sizeof(data));
+    }
+
 };
 
 typedef SFMatrix3<float,X3DField::SFMATRIX3F> SFMatrix3f;
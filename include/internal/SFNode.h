@@ -107,8 +107,8 @@ public:
      * Unwrap a generic field value containing a node.
      * In addition to checking the that the field is of type
      * SFNODE, the target node value must be a descendant of
-     * this wrapper's template type. To check this, we perform
-     * a dynamic cast.
+     * this wrapper's template type. To check this, we use
+     * nodeCast, which only falls back to RTTI for factory-made nodes.
      * 
      * @param f generic field value
      * @returns native node pointer
@@ -121,7 +121,7 @@ public:
 		const SFAbstractNode& n = static_cast<const SFAbstractNode&>(f);
         if (n() == NULL)
             return NULL;
-		N* v = dynamic_cast<N*>(n());
+		N* v = nodeCast<N>(n());
 		if (v == NULL)
 			throw X3DError("node type mismatch");
 		return v;
@@ -131,7 +131,7 @@ public:
         if (node == NULL)
             value = NULL;
         else {
-            N* n = dynamic_cast<N*>(node);
+            N* n = nodeCast<N>(node);
             if (n == NULL)
                 throw X3DError("node type mismatch");
             value = n;
@@ -139,7 +139,7 @@ public:
     }
 
     /// Low-level assignment operator.
-	INLINE const SFNode<N>& operator=(N* value) { this->value = value; }
+	INLINE const SFNode<N>& operator=(N* value) { this->value = value; return *this; }
 
     /// High-level assignment operator.
 	INLINE const SFNode<N>& operator=(const SFNode<N>& f) {
@@ -178,7 +178,7 @@ public:
                 throw X3DError(string("can't find node: ") + name);
             }
         } else {
-            N* newval = dynamic_cast<N*>(node);
+            N* newval = nodeCast<N>(node);
             if (newval == NULL)
                 throw X3DError(string("wrong node type: ") + name);
             value = newval;
@@ -197,8 +197,12 @@ public:
         }
     }
 
+    void encode(Encoder& out) const {
+        out.putString(value == NULL ? string() : value->getName());
+    }
+
     static N* clone(N* node, std::map<Node*,Node*>* mapping=NULL, bool shallow=false) {
-        return dynamic_cast<N*>(node->clone(mapping, shallow));
+        return nodeCast<N>(node->clone(mapping, shallow));
     }
 
 };
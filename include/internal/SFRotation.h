@@ -206,6 +206,24 @@ public:
     void print(ostream& os) const {
         os << x << ' ' << y << ' ' << z << ' ' << a;
     }
+
+    void encode(Encoder& out) const {
+        out.put(x);
+        out.put(y);
+        out.put(z);
+        out.put(a);
+    }
+
+    bool decode(Decoder& in) {
+        float x, y, z, a;
+        if (!(in.get(x) && in.get(y) && in.get(z) && in.get(a)))
+            return false;
+        this->x = x;
+        this->y = y;
+        this->z = z;
+        this->a = a;
+        return true;
+    }
 };
 
 }
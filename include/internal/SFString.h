@@ -121,6 +121,16 @@ public:
     void print(ostream& os) const {
         os << '"' << value << '"';
     }
+
+    void encode(Encoder& out) const {
+        out.putString(value);
+    }
+
+    bool decode(Decoder& in) {
+        return in.getString(value);
+    }
+
+    size_t heapBytes() const { return valueHeapBytes(value); }
 };
 
 }
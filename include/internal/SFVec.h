@@ -69,6 +69,9 @@ public:
     const SFVec2<T,S>& operator()() const {
         return *this;
     }
+    SFVec2<T,S>& operator()() {
+        return *this;
+    }
     SFVec2<T,S>& operator()(const X3DField& field) {
         *this = unwrap(field);
         return *this;
@@ -315,9 +318,24 @@ public:
         os << x << ' ' << y;
     }
 
+    void encode(Encoder& out) const {
+        out.put(x);
+        out.put(y);
+    }
+
+    bool decode(Decoder& in) {
+        T x, y;
+        if (!(in.get(x) && in.get(y)))
+            return false;
+        this->x = x;
+        this->y = y;
+        return true;
+    }
+
     SFVec2<T,S>& operator=(const SFVec2<T,S>& v) {
         x = v.x;
         y = v.y;
+        return *this;
     }
 };
 
@@ -353,6 +371,9 @@ public:
     const SFVec3<T,S>& operator()() const {
         return *this;
     }
+    SFVec3<T,S>& operator()() {
+        return *this;
+    }
     SFVec3<T,S>& operator()(const X3DField& field) {
         *this = unwrap(field);
         return *this;
@@ -675,10 +696,27 @@ public:
         os << x << ' ' << y << ' ' << z;
     }
 
+    void encode(Encoder& out) const {
+        out.put(x);
+        out.put(y);
+        out.put(z);
+    }
+
+    bool decode(Decoder& in) {
+        T x, y, z;
+        if (!(in.get(x) && in.get(y) && in.get(z)))
+            return false;
+        this->x = x;
+        this->y = y;
+        this->z = z;
+        return true;
+    }
+
     SFVec3<T,S>& operator=(const SFVec3<T,S>& v) {
         x = v.x;
         y = v.y;
         z = v.z;
+        return *this;
     }
 };
 
@@ -718,6 +756,9 @@ public:
     const SFVec4<T,S>& operator()() const {
         return *this;
     }
+    SFVec4<T,S>& operator()() {
+        return *this;
+    }
     SFVec4<T,S>& operator()(const X3DField& field) {
         *this = unwrap(field);
         return *this;
@@ -977,10 +1018,30 @@ public:
         os << x << ' ' << y << ' ' << z << ' ' << w;
     }
 
+    void encode(Encoder& out) const {
+        out.put(x);
+        out.put(y);
+        out.put(z);
+        out.put(w);
+    }
+
+    bool decode(Decoder& in) {
+        T x, y, z, w;
+        if (!(in.get(x) && in.get(y) && in.get(z) && in.get(w)))
+            return false;
+        this->x = x;
+        this->y = y;
+        this->z = z;
+        this->w = w;
+        return true;
+    }
+
     SFVec4<T,S>& operator=(const SFVec4<T,S>& v) {
         x = v.x;
         y = v.y;
         z = v.z;
+        w = v.w;
+        return *this;
     }
 };
 
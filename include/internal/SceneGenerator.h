@@ -0,0 +1,125 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_SCENEGENERATOR_H_
+#define _X3D_SCENEGENERATOR_H_
+
+#include <stddef.h>
+#include <string>
+#include <ostream>
+
+using std::string;
+using std::ostream;
+
+namespace X3D {
+
+/**
+ * Writes synthetic X3D scenes for load and cascade stress testing. The
+ * output is deterministic for a given set of parameters, so scaling
+ * runs can be reproduced.
+ *
+ * Each of the #sensors units in the scene looks like this:
+ *
+ * - a looping TimeSensor, nested inside #depth levels of alternating
+ *   Transform and Group nodes along with the rest of the unit;
+ * - #interpolators ScalarInterpolators with #keys keys, all routed from
+ *   the sensor's fraction_changed (route fan-out);
+ * - behind each of those, a chain of #chain identity ScalarInterpolators
+ *   (route depth);
+ * - if #fanIn is set, one sink ScalarInterpolator with every chain's
+ *   last output routed into it (route fan-in);
+ * - if #depth is at least one, a PositionInterpolator with #keys keys
+ *   routed into the innermost Transform's translation;
+ * - if #points is nonzero, a CoordinateInterpolator with #keys keys
+ *   of #points coordinates each.
+ */
+class SceneGenerator {
+public:
+
+    /// number of TimeSensor units
+    size_t sensors;
+
+    /// ScalarInterpolators routed from each sensor
+    size_t interpolators;
+
+    /// identity interpolators chained behind each interpolator
+    size_t chain;
+
+    /// whether each unit routes all of its chains into one sink
+    bool fanIn;
+
+    /// levels of Transform/Group nesting around each unit
+    size_t depth;
+
+    /// number of keys in each interpolator
+    size_t keys;
+
+    /// coordinates per key of each unit's CoordinateInterpolator, or 0
+    size_t points;
+
+    /// Constructor. Defaults give a scene of about 100 nodes.
+    SceneGenerator();
+
+    /// @returns number of nodes in one sensor unit
+    size_t nodesPerSensor() const;
+
+    /// @returns number of routes in one sensor unit
+    size_t routesPerSensor() const;
+
+    /// @returns number of nodes write() will emit
+    size_t countNodes() const { return sensors * nodesPerSensor(); }
+
+    /// @returns number of routes write() will emit
+    size_t countRoutes() const { return sensors * routesPerSensor(); }
+
+    /**
+     * Set #sensors so that the scene has about the given number of
+     * nodes, keeping the other parameters.
+     *
+     * @param nodes desired node count
+     */
+    void scaleTo(size_t nodes);
+
+    /**
+     * Write the scene as X3D XML.
+     *
+     * @param os stream to write to
+     */
+    void write(ostream& os) const;
+
+    /**
+     * Write the scene as X3D XML to a file.
+     *
+     * @param filename file to create
+     * @throws X3DError if the file can't be written
+     */
+    void write(const string& filename) const;
+
+private:
+
+    /// write one sensor unit's nodes
+    void writeUnit(ostream& os, size_t unit) const;
+
+    /// write one sensor unit's routes
+    void writeRoutes(ostream& os, size_t unit) const;
+};
+
+}
+
+#endif // #ifndef _X3D_SCENEGENERATOR_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_SCOPE_H_
+#define _X3D_SCOPE_H_
+
+#include "internal/errors.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+
+/**
+ * A table of DEF names for one naming scope, such as a world file or a
+ * prototype body. Names are hashed once, when they are defined, and are
+ * kept in an open-addressed table alongside their hash. A lookup hashes
+ * the requested name and walks a single probe sequence, only comparing
+ * strings whose hashes match.
+ *
+ * Scopes may be chained to a parent scope; a name which is not defined
+ * locally is then looked up in the parent.
+ */
+class Scope {
+private:
+
+    /// slot in the open-addressed table
+    struct Entry {
+        size_t hash;
+        string name;
+        Node* node;
+        Entry() : hash(0), node(NULL) {}
+    };
+
+    /// table slots; size is always a power of two
+    vector<Entry> table;
+
+    /// number of occupied slots
+    size_t count;
+
+    /// Disallow copy constructor
+    Scope(const Scope& scope) : parent(NULL) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// enclosing scope, searched when a name is not found locally
+    Scope* const parent;
+
+    /**
+     * Constructor.
+     *
+     * @param parent enclosing scope, or NULL for an isolated scope
+     */
+    Scope(Scope* parent=NULL);
+
+    /**
+     * Map a name to a node in this scope. If the name is already
+     * defined here, the new node replaces the old one.
+     *
+     * @param name DEF name of node
+     * @param node node to map to
+     */
+    void define(const string& name, Node* node);
+
+    /**
+     * Look up a node by its name in this scope only.
+     *
+     * @param name DEF name of node
+     * @returns named node, or NULL if not defined here
+     */
+    Node* lookupLocal(const string& name) const;
+
+    /**
+     * Look up a node by its name, trying enclosing scopes in turn.
+     *
+     * @param name DEF name of node
+     * @returns named node, or NULL if not found
+     */
+    Node* lookup(const string& name) const;
+
+    /// @returns number of names defined in this scope
+    size_t size() const { return count; }
+
+    /// Remove all names from this scope.
+    void clear();
+
+    /**
+     * Hash function used for names (32-bit FNV-1a).
+     *
+     * @param name string to hash
+     * @returns hash value
+     */
+    static size_t hash(const string& name);
+
+private:
+
+    /**
+     * Find the slot which holds the given name, or the empty slot
+     * where it would be inserted.
+     */
+    size_t probe(const string& name, size_t hash) const;
+
+    /// Double the table size and re-insert all entries.
+    void grow();
+};
+
+}
+
+#endif // #ifndef _X3D_SCOPE_H_
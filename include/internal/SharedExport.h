@@ -0,0 +1,294 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SHAREDEXPORT_H_
+#define _X3D_SHAREDEXPORT_H_
+
+#include "internal/Subscriptions.h"
+#include "internal/Encoder.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace X3D {
+
+/**
+ * Export of selected output fields into a POSIX shared-memory region,
+ * for a consumer in another process, such as a renderer, to read in
+ * place. The region starts with a Header, followed by an Entry for each
+ * field, followed by each field's value slot. Values are in the packed
+ * binary form of X3DField::encode(); an MF value is its element count
+ * followed by its elements.
+ *
+ * The exporter subscribes to its fields, so at the end of each cascade
+ * which changed any of them it rewrites their slots under a seqlock:
+ * the header's sequence number is odd while slots are being written.
+ * A reader takes the sequence, reads what it needs, and then checks the
+ * sequence is unchanged; see SharedExportReader.
+ *
+ * The layout is fixed when the region is opened. Each slot holds a set
+ * number of bytes; a value which doesn't fit isn't written, and the
+ * entry counts it as dropped.
+ */
+class SharedExport : public FieldObserver {
+public:
+
+    /// "X3DS", first word of the region
+    static const uint32_t MAGIC = 0x53443358;
+
+    /// version of the layout
+    static const uint32_t LAYOUT_VERSION = 1;
+
+    /// longest field name, including the terminating zero
+    static const size_t NAME_SIZE = 48;
+
+    /// start of the region
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+
+        /// number of entries
+        uint32_t fieldCount;
+
+        /// bytes in the region
+        uint32_t size;
+
+        /// seqlock sequence number; odd while slots are being written
+        uint64_t sequence;
+
+        /// cascade of the last write
+        uint64_t cascade;
+
+        /// simulation time of the last write
+        double time;
+    };
+
+    /// description of one exported field
+    struct Entry {
+        /// name given when the field was added
+        char name[NAME_SIZE];
+
+        /// field type, as X3DField::Type
+        uint32_t type;
+
+        /// offset of the value slot from the start of the region
+        uint32_t offset;
+
+        /// bytes in the slot
+        uint32_t capacity;
+
+        /// bytes of the current value
+        uint32_t size;
+
+        /// number of values too large for the slot
+        uint32_t dropped;
+
+        uint32_t reserved;
+
+        /// header sequence number after the value was last written
+        uint64_t sequence;
+    };
+
+private:
+
+    /// a field added but not yet exported
+    struct Pending {
+        SAIField* field;
+        string name;
+        size_t capacity;
+    };
+
+    /// fields to export when the region is opened
+    vector<Pending> pending;
+
+    /// entry number of each exported field
+    map<SAIField*, size_t> entries;
+
+    /// name of the region, with its leading slash
+    string region;
+
+    /// mapped region, or NULL if not open
+    char* base;
+
+    /// bytes mapped
+    size_t mapped;
+
+    /// encoded value being written
+    ByteBuffer scratch;
+
+    /// Disallow copy constructor
+    SharedExport(const SharedExport& other) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    SharedExport() : base(NULL), mapped(0) {}
+
+    /// Destructor; closes the region.
+    ~SharedExport();
+
+    /**
+     * Add a field to export when the region is opened.
+     *
+     * @param field output field
+     * @param name name for the consumer to look the field up by
+     * @param capacity bytes to reserve for its values, or 0 for twice
+     *                 the size of its current value, and at least 64
+     * @throws X3DError if the region is open or the name is too long
+     */
+    void add(SAIField* field, const string& name, size_t capacity = 0);
+
+    /**
+     * Create the shared-memory region, write the current values of the
+     * added fields and subscribe to them. An existing region of the same
+     * name is replaced.
+     *
+     * @param name name of the region, as for shm_open()
+     * @throws X3DError if the region is open or can't be created
+     */
+    void open(const string& name);
+
+    /// Unsubscribe from the fields, and unmap and unlink the region.
+    void close();
+
+    /// @returns whether the region is open
+    bool isOpen() const { return base != NULL; }
+
+    /// @returns header of the open region
+    const Header& header() const { return *(const Header*) base; }
+
+    /// @returns entry of the n-th exported field
+    const Entry& entry(size_t n) const {
+        return ((const Entry*) (base + sizeof(Header)))[n];
+    }
+
+    /// Write the changed values into their slots.
+    void changed(const vector<Change>& changes);
+
+private:
+
+    /// @returns entry of the n-th exported field
+    Entry& entry(size_t n) {
+        return ((Entry*) (base + sizeof(Header)))[n];
+    }
+
+    /**
+     * Write a field's value into its slot; the seqlock must be held.
+     *
+     * @param n entry number
+     * @param value value to write
+     * @param sequence header sequence number once the write is done
+     */
+    void write(size_t n, const X3DField& value, uint64_t sequence);
+};
+
+/**
+ * Consumer side of a SharedExport, in this or another process. Reads
+ * are zero-copy: take a sequence number with begin(), read values in
+ * place through data(), and then use them only if validate() agrees
+ * nothing was written meanwhile.
+ */
+class SharedExportReader {
+private:
+
+    /// mapped region, or NULL if not open
+    const char* base;
+
+    /// bytes mapped
+    size_t mapped;
+
+    /// Disallow copy constructor
+    SharedExportReader(const SharedExportReader& other) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    SharedExportReader() : base(NULL), mapped(0) {}
+
+    /// Destructor; unmaps the region.
+    ~SharedExportReader() { close(); }
+
+    /**
+     * Map a region created by SharedExport::open().
+     *
+     * @param name name of the region
+     * @returns false if there is no such region yet
+     * @throws X3DError if the region isn't an export of this version
+     */
+    bool open(const string& name);
+
+    /// Unmap the region.
+    void close();
+
+    /// @returns whether a region is mapped
+    bool isOpen() const { return base != NULL; }
+
+    /// @returns header of the region
+    const SharedExport::Header& header() const {
+        return *(const SharedExport::Header*) base;
+    }
+
+    /// @returns number of exported fields
+    size_t size() const { return header().fieldCount; }
+
+    /// @returns entry of the n-th exported field
+    const SharedExport::Entry& entry(size_t n) const {
+        return ((const SharedExport::Entry*) (base + sizeof(SharedExport::Header)))[n];
+    }
+
+    /**
+     * Look up a field by the name it was exported under.
+     *
+     * @param name field name
+     * @returns entry number, or -1 if there is no such field
+     */
+    int find(const string& name) const;
+
+    /// @returns packed value of the n-th field, valid until validate()
+    const void* data(size_t n) const { return base + entry(n).offset; }
+
+    /**
+     * Start a read, waiting out any write in progress.
+     *
+     * @returns sequence number to pass to validate()
+     */
+    uint64_t begin() const;
+
+    /**
+     * Check whether a read saw a consistent state.
+     *
+     * @param sequence sequence number from begin()
+     * @returns false if a write happened since, so the read must be
+     *          retried
+     */
+    bool validate(uint64_t sequence) const;
+};
+
+}
+
+#endif // #ifndef _X3D_SHAREDEXPORT_H_
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_SNAPSHOT_H_
+#define _X3D_SNAPSHOT_H_
+
+#include "internal/X3DField.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class SAIField;
+
+/**
+ * Copies of the values of captured fields at the end of one cascade,
+ * published by SnapshotStore. A snapshot doesn't change while it is
+ * pinned, and uses its fields only as keys, so any thread may read it.
+ */
+class Snapshot {
+
+    friend class SnapshotStore;
+
+private:
+
+    /// captured fields, sorted
+    vector<SAIField*> fields;
+
+    /// value of each field
+    vector<X3DField*> values;
+
+    /// id of the cascade at whose end the values were copied
+    unsigned int cascade;
+
+    /// simulation time of that cascade
+    double time;
+
+    /// Constructor.
+    Snapshot() : cascade(0), time(0) {}
+
+    /// Destructor; frees the values.
+    ~Snapshot();
+
+public:
+
+    /**
+     * Look up the value of a field.
+     *
+     * @param field captured field
+     * @returns value, or NULL if the field wasn't captured
+     */
+    const X3DField* get(SAIField* field) const;
+
+    /// @returns id of the cascade the snapshot was taken at
+    unsigned int getCascade() const { return cascade; }
+
+    /// @returns simulation time the snapshot was taken at
+    double getTime() const { return time; }
+
+    /// @returns number of captured fields
+    size_t size() const { return fields.size(); }
+};
+
+/**
+ * Publishes snapshots of captured fields for threads which read scene
+ * state while the simulation runs, such as a renderer. The simulation
+ * thread calls publish() at the end of each cascade; readers pin the
+ * latest snapshot with a SnapshotPin, and neither ever waits for the
+ * other.
+ *
+ * Old snapshots are reclaimed by epoch. Publishing advances the global
+ * epoch and retires the replaced snapshot with the new epoch. A reader
+ * claims a slot holding the epoch it started at before loading the
+ * current snapshot, so a retired snapshot is only reused once every
+ * pinned slot holds an epoch at least as new as its own. Reclaimed
+ * snapshots are refilled by later publishes rather than freed.
+ */
+class SnapshotStore {
+public:
+
+    /// number of snapshots which may be pinned at once
+    static const unsigned int MAX_READERS = 64;
+
+private:
+
+    /// epoch of one reader, or 0 if free; one cache line each
+    struct Slot {
+        uint64_t epoch;
+        char padding[64 - sizeof(uint64_t)];
+    };
+
+    /// reader slots
+    Slot slots[MAX_READERS];
+
+    /// latest snapshot, or NULL
+    Snapshot* current;
+
+    /// global epoch, starting at 1
+    uint64_t epoch;
+
+    /// fields to capture, sorted; only used by the simulation thread
+    vector<SAIField*> fields;
+
+    /// replaced snapshots and the epochs they were retired at
+    vector< std::pair<Snapshot*, uint64_t> > retired;
+
+    /// reclaimed snapshots, to fill with later values
+    vector<Snapshot*> spare;
+
+    /// Disallow copy constructor
+    SnapshotStore(const SnapshotStore& store) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    SnapshotStore();
+
+    /// Destructor; frees all snapshots, which must not be pinned.
+    ~SnapshotStore();
+
+    /**
+     * Capture a field in the snapshots published from now on.
+     *
+     * @param field field to capture
+     */
+    void capture(SAIField* field);
+
+    /**
+     * Stop capturing a field.
+     *
+     * @param field field to release
+     */
+    void release(SAIField* field);
+
+    /// @returns whether any fields are captured
+    bool isCapturing() const { return !fields.empty(); }
+
+    /**
+     * Copy the values of the captured fields into a snapshot and make it
+     * the current one. Called on the simulation thread.
+     *
+     * @param cascade id of the cascade which just ended
+     * @param time simulation time
+     */
+    void publish(unsigned int cascade, double time);
+
+    /**
+     * Pin the current snapshot. Safe on any thread.
+     *
+     * @param slot set to the reader slot to pass to unpin()
+     * @returns current snapshot, or NULL if none has been published
+     * @throws X3DError if #MAX_READERS snapshots are already pinned
+     */
+    const Snapshot* pin(unsigned int& slot);
+
+    /**
+     * Unpin a snapshot, after which it may be reused.
+     *
+     * @param slot slot returned by pin()
+     */
+    void unpin(unsigned int slot);
+
+    /// @returns number of retired snapshots not yet reclaimed
+    size_t retiredCount() const { return retired.size(); }
+
+    /// Forget the captured fields and free all snapshots, as when the
+    /// scene is reset; no snapshot may be pinned.
+    void clear();
+
+private:
+
+    /// Move retired snapshots which no reader can hold to #spare.
+    void reclaim();
+};
+
+/**
+ * Pins the current snapshot of a store for as long as it is in scope.
+ */
+class SnapshotPin {
+private:
+
+    /// store the snapshot is pinned in
+    SnapshotStore& store;
+
+    /// reader slot
+    unsigned int slot;
+
+    /// pinned snapshot
+    const Snapshot* snapshot;
+
+    /// Disallow copy constructor
+    SnapshotPin(const SnapshotPin& pin) : store(pin.store) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Pin the current snapshot of a store.
+    SnapshotPin(SnapshotStore& store) : store(store) {
+        snapshot = store.pin(slot);
+    }
+
+    /// Unpin the snapshot.
+    ~SnapshotPin() { store.unpin(slot); }
+
+    /// @returns pinned snapshot, or NULL if none has been published
+    const Snapshot* get() const { return snapshot; }
+
+    /// @returns pinned snapshot
+    const Snapshot* operator->() const { return snapshot; }
+};
+
+}
+
+#endif // #ifndef _X3D_SNAPSHOT_H_
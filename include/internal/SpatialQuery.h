@@ -0,0 +1,207 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SPATIALQUERY_H_
+#define _X3D_SPATIALQUERY_H_
+
+#include "internal/BoundingBox.h"
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class Node;
+class BoundingVolumeHierarchy;
+
+/// half-line from a point, for Browser::raycast()
+struct Ray {
+    /// start of ray
+    SFVec3f origin;
+
+    /// direction of ray; distances are in multiples of it
+    SFVec3f direction;
+
+    /// greatest distance to look for a hit
+    float length;
+
+    /// Constructor.
+    Ray() : length(FLT_MAX) {}
+
+    /**
+     * Constructor.
+     *
+     * @param origin start of ray
+     * @param direction direction of ray
+     * @param length greatest distance to look for a hit
+     */
+    Ray(const SFVec3f& origin, const SFVec3f& direction,
+        float length=FLT_MAX) :
+        origin(origin), direction(direction), length(length) {}
+};
+
+/// nearest object a ray hits
+struct RayHit {
+    /// node hit, or NULL for none
+    Node* node;
+
+    /// distance along the ray where it enters the node's bounds; 0 if
+    /// the ray starts inside them
+    float distance;
+};
+
+/**
+ * Convex volume bounded by six planes, as seen by a camera, for
+ * Browser::overlap(). A point p is inside when
+ * \f$ a p_x + b p_y + c p_z + d \ge 0 \f$ for each plane (a, b, c, d).
+ */
+struct Frustum {
+    /// left, right, bottom, top, near and far planes
+    float planes[6][4];
+
+    /**
+     * Make the frustum of a view-projection matrix, whose clip volume is
+     * \f$ -w \le x, y, z \le w \f$.
+     *
+     * @param m 16 row-major floats, for column vectors
+     * @returns frustum in world coordinates
+     */
+    static Frustum fromMatrix(const float* m);
+
+    /// @returns whether the box lies wholly outside one of the planes
+    bool excludes(const BoundingBox& box) const;
+};
+
+/**
+ * Results of a batch of queries, each a list of nodes, stored one after
+ * another. A node used more than once can appear once per instance.
+ */
+class QueryResults {
+public:
+
+    /// start of each query's results, and the end of the last
+    vector<uint32_t> offsets;
+
+    /// nodes found
+    vector<Node*> nodes;
+
+    /// distance to each node found, for nearest-node queries
+    vector<float> distances;
+
+    /// @returns number of queries
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /// @returns number of nodes a query found
+    size_t count(size_t query) const {
+        return offsets[query + 1] - offsets[query];
+    }
+
+    /// @returns one of the nodes a query found
+    Node* getNode(size_t query, size_t i) const {
+        return nodes[offsets[query] + i];
+    }
+
+    /// @returns distance to one of the nodes a query found
+    float getDistance(size_t query, size_t i) const {
+        return distances[offsets[query] + i];
+    }
+
+    /// Forget all results.
+    void clear() {
+        offsets.clear();
+        nodes.clear();
+        distances.clear();
+    }
+};
+
+/**
+ * Batched queries over the objects of a BoundingVolumeHierarchy, as
+ * run by the Browser's query methods. Each object is tested by its
+ * world box, there being no geometry in the scene graph to test.
+ *
+ * A batch of at least #PARALLEL_BATCH queries per thread is split into
+ * contiguous runs, one per thread, and the results of each run are
+ * joined in order, so the results don't depend on the thread count.
+ */
+class SpatialQuery {
+public:
+
+    /// fewest queries worth giving a thread of their own
+    static const size_t PARALLEL_BATCH = 256;
+
+    /**
+     * Find the nearest object each ray hits.
+     *
+     * @param bvh up-to-date tree
+     * @param rays rays to cast
+     * @param n number of rays
+     * @param hits nearest hit of each ray
+     * @param threads most threads to use
+     */
+    static void raycast(const BoundingVolumeHierarchy& bvh, const Ray* rays,
+                        size_t n, RayHit* hits, unsigned int threads);
+
+    /**
+     * Find the objects which overlap each box.
+     *
+     * @param bvh up-to-date tree
+     * @param boxes world boxes to search
+     * @param n number of boxes
+     * @param results nodes found for each box
+     * @param threads most threads to use
+     */
+    static void overlap(const BoundingVolumeHierarchy& bvh,
+                        const BoundingBox* boxes, size_t n,
+                        QueryResults& results, unsigned int threads);
+
+    /**
+     * Find the objects which may be inside each frustum: those not
+     * wholly outside one of its planes.
+     *
+     * @param bvh up-to-date tree
+     * @param frusta frusta to search
+     * @param n number of frusta
+     * @param results nodes found for each frustum
+     * @param threads most threads to use
+     */
+    static void overlap(const BoundingVolumeHierarchy& bvh,
+                        const Frustum* frusta, size_t n,
+                        QueryResults& results, unsigned int threads);
+
+    /**
+     * Find the k objects nearest each point, nearest first, measuring
+     * to the nearest point of their bounds.
+     *
+     * @param bvh up-to-date tree
+     * @param points points to search from
+     * @param n number of points
+     * @param k most nodes to find for each point
+     * @param results nodes found for each point, with distances
+     * @param threads most threads to use
+     */
+    static void nearest(const BoundingVolumeHierarchy& bvh,
+                        const SFVec3f* points, size_t n, size_t k,
+                        QueryResults& results, unsigned int threads);
+};
+
+}
+
+#endif // #ifndef _X3D_SPATIALQUERY_H_
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_SUBSCRIPTIONS_H_
+#define _X3D_SUBSCRIPTIONS_H_
+
+#include "internal/X3DField.h"
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+using std::map;
+using std::vector;
+
+namespace X3D {
+
+class SAIField;
+
+/**
+ * Receiver of changes to the fields it subscribed to with
+ * Browser::subscribe(). Subclass it and implement changed().
+ */
+class FieldObserver {
+public:
+
+    /// new value of a field
+    struct Change {
+        /// field which changed
+        SAIField* field;
+
+        /// its value; only valid during the call to changed()
+        const X3DField* value;
+    };
+
+    /// Destructor; unsubscribe before deleting an observer.
+    virtual ~FieldObserver() {}
+
+    /**
+     * Receive the changes of one cascade. Called once per cascade which
+     * changed any of the subscribed fields, after the cascade's events
+     * have been routed and before its dirty fields are cleared. Fields
+     * written from here are buffered as in Browser::beginUpdate(), and
+     * sent in a new cascade once all observers have been called.
+     *
+     * @param changes subscribed fields which changed, in the order
+     *                they changed
+     */
+    virtual void changed(const vector<Change>& changes) = 0;
+};
+
+/**
+ * Subscriptions of observers to output fields, owned by the browser.
+ * Subscribed fields carry the SAIField::SUBSCRIBED flag, so the browser
+ * only looks a field up here when it changes and someone listens. Each
+ * observer collects the changes of a cascade in its own batch, so the
+ * cost of delivery is in the number of changes, not of subscriptions.
+ */
+class Subscriptions {
+private:
+
+    /// an observer and the changes waiting for it
+    struct Entry {
+        FieldObserver* observer;
+        vector<FieldObserver::Change> batch;
+
+        /// number of fields subscribed to
+        size_t fields;
+
+        Entry(FieldObserver* observer) : observer(observer), fields(0) {}
+    };
+
+    /// entries of each subscribed field
+    map<SAIField*, vector<Entry*> > byField;
+
+    /// entry of each observer
+    map<FieldObserver*, Entry*> entries;
+
+    /// subscribed fields which changed in this cascade
+    vector<SAIField*> changed;
+
+    /// whether observers are being called
+    bool delivering;
+
+    /// Disallow copy constructor
+    Subscriptions(const Subscriptions& subscriptions) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    Subscriptions() : delivering(false) {}
+
+    /// Destructor; frees the entries, but not the observers.
+    ~Subscriptions();
+
+    /**
+     * Subscribe an observer to a field. Subscribing twice has no effect.
+     *
+     * @param field output field
+     * @param observer observer to call when it changes
+     */
+    void add(SAIField* field, FieldObserver* observer);
+
+    /**
+     * Unsubscribe an observer from a field. This may be done from
+     * FieldObserver::changed().
+     *
+     * @param field output field
+     * @param observer subscribed observer
+     */
+    void remove(SAIField* field, FieldObserver* observer);
+
+    /**
+     * Unsubscribe all observers from a field, as when it is deleted.
+     *
+     * @param field subscribed field
+     */
+    void removeField(SAIField* field);
+
+    /**
+     * Note that a subscribed field has changed in this cascade; called
+     * by Browser::addDirtyField().
+     *
+     * @param field subscribed field
+     */
+    void mark(SAIField* field) { changed.push_back(field); }
+
+    /// @returns whether any subscribed field changed in this cascade
+    bool isPending() const { return !changed.empty(); }
+
+    /**
+     * Call each observer with its subscribed fields which changed in
+     * this cascade.
+     *
+     * @returns number of observers called
+     */
+    size_t deliver();
+
+    /// @returns number of observers with subscriptions
+    size_t size() const { return entries.size(); }
+
+    /// @returns number of fields with subscriptions
+    size_t fieldCount() const { return byField.size(); }
+
+    /// Drop all subscriptions, as when the scene is reset.
+    void clear();
+
+private:
+
+    /**
+     * End a delivery, emptying the batches and freeing the entries of
+     * observers which unsubscribed from everything.
+     *
+     * @param called entries of the observers delivered to
+     */
+    void finish(const vector<Entry*>& called);
+
+    /**
+     * Free the entry of an observer with no subscriptions left, unless
+     * its batch may still be in use.
+     *
+     * @param entry entry to free
+     */
+    void retire(Entry* entry);
+};
+
+}
+
+#endif // #ifndef _X3D_SUBSCRIPTIONS_H_
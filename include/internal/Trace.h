@@ -0,0 +1,199 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_TRACE_H_
+#define _X3D_TRACE_H_
+
+#include "internal/errors.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+using std::string;
+using std::vector;
+using std::map;
+
+// Stores to a trace record must become visible in order. x86 never
+// reorders stores with other stores, so there only the compiler needs
+// to be held back.
+#if defined(__i386__) || defined(__x86_64__)
+#define X3D_STORE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define X3D_STORE_BARRIER() __sync_synchronize()
+#endif
+
+namespace X3D {
+
+/**
+ * One traced route activation. Records are fixed-size so they can be
+ * written straight into the ring buffer and out to disk.
+ */
+struct TraceRecord {
+    /// monotonic wall-clock time, in nanoseconds (raw ticks while in the ring)
+    uint64_t stamp;
+
+    /// simulation time of the cascade
+    double time;
+
+    /// ring position plus one; zero while the record is being written
+    uint32_t seq;
+
+    /// cascade in which the route fired
+    uint32_t cascade;
+
+    /// id of the route which fired
+    uint32_t route;
+
+    /// digest of the value which was sent
+    uint32_t digest;
+};
+
+/**
+ * Event trace facility. Route activations are recorded into a fixed-size
+ * ring buffer; when the ring fills up, the oldest records are overwritten.
+ * Writers claim a slot with an atomic increment and never block, so
+ * recording is cheap enough to leave compiled in. Tracing is off until
+ * enable() is called, and costs a single flag test while off.
+ *
+ * A trace can be saved to a binary file along with the names of the
+ * traced routes, and loaded again by the x3dtrace tool.
+ */
+class Trace {
+private:
+
+    /// ring of records
+    TraceRecord* ring;
+
+    /// ring size minus one; size is a power of two
+    uint32_t mask;
+
+    /// total number of records ever claimed
+    volatile uint32_t head;
+
+    /// whether recording is on
+    volatile bool enabled;
+
+    /// tick count and clock time when recording was last enabled,
+    /// used to convert tick stamps to nanoseconds
+    uint64_t baseTicks, baseClock;
+
+    /// Disallow copy constructor
+    Trace(const Trace& trace) { throw X3DError("illegal copy"); }
+
+public:
+
+    /// Constructor. Tracing starts disabled, with no ring allocated.
+    Trace() : ring(NULL), mask(0), head(0), enabled(false),
+              baseTicks(0), baseClock(0) {}
+
+    /// Destructor.
+    ~Trace();
+
+    /**
+     * Start recording. The ring is (re)allocated if its size changes,
+     * which discards any records.
+     *
+     * @param capacity number of records to keep; rounded up to a
+     *      power of two
+     */
+    void enable(uint32_t capacity=65536);
+
+    /// Stop recording. Records are kept until the next clear().
+    void disable() { enabled = false; }
+
+    /// @returns whether recording is on
+    bool isEnabled() const { return enabled; }
+
+    /// Discard all records.
+    void clear();
+
+    /**
+     * Record a route activation.
+     *
+     * @param cascade current cascade id
+     * @param time current simulation time
+     * @param route id of route which fired
+     * @param digest digest of value sent
+     */
+    void record(uint32_t cascade, double time, uint32_t route, uint32_t digest) {
+        uint32_t pos = __sync_fetch_and_add(&head, 1);
+        TraceRecord& r = ring[pos & mask];
+        r.seq = 0;
+        X3D_STORE_BARRIER();
+        r.stamp = ticks();
+        r.time = time;
+        r.cascade = cascade;
+        r.route = route;
+        r.digest = digest;
+        X3D_STORE_BARRIER();
+        r.seq = pos + 1;
+    }
+
+    /**
+     * Copy out the records currently in the ring, oldest first, with
+     * stamps converted to nanoseconds. Records which are being
+     * overwritten while this runs are skipped.
+     *
+     * @param records vector to fill
+     */
+    void snapshot(vector<TraceRecord>& records) const;
+
+    /**
+     * Write the current records to a file.
+     *
+     * @param filename path of trace file
+     * @param routes names of the traced routes, by id
+     */
+    void save(const string& filename, const map<uint32_t, string>& routes) const;
+
+    /**
+     * Read a trace file.
+     *
+     * @param filename path of trace file
+     * @param records vector to fill with records
+     * @param routes map to fill with route names
+     */
+    static void load(const string& filename,
+                     vector<TraceRecord>& records,
+                     map<uint32_t, string>& routes);
+
+    /// @returns monotonic clock time, in nanoseconds
+    static uint64_t clock();
+
+    /**
+     * Read the cheapest available monotonic counter. On x86 this is the
+     * time-stamp counter; elsewhere it is the same as clock().
+     *
+     * @returns tick count
+     */
+    static uint64_t ticks() {
+#if defined(__i386__) || defined(__x86_64__)
+        uint32_t lo, hi;
+        __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+        return ((uint64_t) hi << 32) | lo;
+#else
+        return clock();
+#endif
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_TRACE_H_
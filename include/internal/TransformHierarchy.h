@@ -0,0 +1,263 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _X3D_TRANSFORMHIERARCHY_H_
+#define _X3D_TRANSFORMHIERARCHY_H_
+
+#include "internal/SFMatrix.h"
+#include "internal/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+using std::list;
+using std::vector;
+
+namespace X3D {
+
+class Node;
+namespace Grouping { class Transform; }
+
+/**
+ * Cache of the world matrix of every Transform in the scene graph, kept
+ * by the browser as Browser::transforms. The graph below the roots is
+ * flattened in depth-first order into one slot per Transform instance,
+ * each holding its parent's slot, and the world matrices are kept in one
+ * contiguous array in the same order, so a parent always comes before
+ * its children.
+ *
+ * Updating is lazy. A Transform whose fields change marks its slots
+ * dirty; a change to any grouping node's children marks the whole
+ * structure stale. The next query then either rebuilds, or makes one
+ * pass from the first dirty slot, recomputing the slots which are dirty
+ * or whose parent was recomputed in the same pass. Each matrix costs one
+ * 4x4 multiply, done with SSE where the compiler targets it.
+ *
+ * Nodes used more than once through DEF/USE get a slot for each
+ * instance; queries by node give the first instance, in depth-first
+ * order. Nodes which aren't Transforms share their nearest Transform
+ * ancestor's slot. A compiled StaticGroup is a leaf here; the matrices
+ * of its contents are fixed in its CompiledGroup.
+ */
+class TransformHierarchy {
+private:
+
+    /// world matrix of one Transform instance
+    struct Slot {
+        /// Transform, or NULL for the root slot
+        Grouping::Transform* transform;
+
+        /// slot of the nearest Transform ancestor
+        uint32_t parent;
+
+        /// last pass which recomputed the matrix
+        uint32_t stamp;
+
+        /// whether the Transform changed since the last pass
+        bool dirty;
+    };
+
+    /// one place a node occurs in the graph
+    struct Instance {
+        /// node placed
+        Node* node;
+
+        /// slot of the node's matrix
+        uint32_t slot;
+
+        /// next instance of the same node, or #NONE
+        uint32_t next;
+
+        /// index after the last instance below this one
+        uint32_t end;
+    };
+
+public:
+
+    /// index meaning no instance
+    static const uint32_t NONE = 0xffffffff;
+
+private:
+
+    /// slots in depth-first order; slot 0 is the identity
+    vector<Slot> slots;
+
+    /// world matrix of each slot, 16 row-major floats apiece
+    vector<float> worlds;
+
+    /// every instance of every node below the roots
+    vector<Instance> instances;
+
+    /// open-addressed table of the first instance of each node, plus one;
+    /// 0 is empty
+    vector<uint32_t> table;
+
+    /// whether the structure needs rebuilding
+    bool stale;
+
+    /// first dirty slot, or the number of slots
+    uint32_t first;
+
+    /// id of the last pass
+    uint32_t pass;
+
+    /// number of rebuilds
+    uint32_t version;
+
+    /// matrices recomputed by the last update
+    size_t recomputed;
+
+    /// Disallow copy constructor
+    TransformHierarchy(const TransformHierarchy& hierarchy) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor; the hierarchy starts stale.
+    TransformHierarchy() :
+        stale(true), first(0), pass(0), version(0), recomputed(0) {}
+
+    /**
+     * Mark the slots of a Transform dirty. Called by
+     * Grouping::Transform::invalidate().
+     *
+     * @param transform Transform whose fields changed
+     */
+    void invalidate(Grouping::Transform* transform);
+
+    /// Mark the structure stale, as when children change or roots are
+    /// added.
+    void invalidateStructure() { stale = true; }
+
+    /// Mark the structure stale and every local matrix dirty, as when a
+    /// checkpoint is restored.
+    void invalidateAll();
+
+    /// Forget the scene, as when the browser is reset.
+    void clear();
+
+    /**
+     * Bring the world matrices up to date. Queries do this themselves.
+     *
+     * @returns number of matrices recomputed
+     */
+    size_t update();
+
+    /**
+     * Get the world matrix of a node: that of its nearest Transform
+     * ancestor, or its own if it is a Transform.
+     *
+     * @param node node in the scene graph
+     * @returns world matrix
+     * @throws X3DError if the node isn't below the browser's roots
+     */
+    SFMatrix4f getWorldMatrix(Node* node);
+
+    /// @returns whether the node is below the browser's roots
+    bool contains(Node* node);
+
+    /// @returns number of Transform instances, as of the last update
+    size_t size() const { return slots.empty() ? 0 : slots.size() - 1; }
+
+    /// @returns number of matrices recomputed by the last update
+    size_t recomputedCount() const { return recomputed; }
+
+    /**
+     * Get the first instance of a node. Instances are numbered in
+     * depth-first order as of the last update, and those below an
+     * instance follow it, up to getEnd().
+     *
+     * @param node node to find
+     * @returns index of instance, or #NONE if the node isn't in the graph
+     */
+    uint32_t indexOf(Node* node) const { return find(node); }
+
+    /// @returns number of instances, as of the last update
+    size_t instanceCount() const { return instances.size(); }
+
+    /// @returns node placed by an instance
+    Node* getNode(uint32_t instance) const {
+        return instances[instance].node;
+    }
+
+    /// @returns index after the last instance below an instance
+    uint32_t getEnd(uint32_t instance) const {
+        return instances[instance].end;
+    }
+
+    /// @returns world matrix of an instance, 16 row-major floats
+    const float* getWorld(uint32_t instance) const {
+        return &worlds[16 * instances[instance].slot];
+    }
+
+    /**
+     * Tell whether an instance's world matrix was recomputed by a pass
+     * after the given one. Rebuilds renumber the instances, so this is
+     * only meaningful while getVersion() stays the same.
+     *
+     * @param instance index of instance
+     * @param since id of a pass, as from getPass()
+     * @returns whether the matrix changed since
+     */
+    bool changedSince(uint32_t instance, uint32_t since) const {
+        return slots[instances[instance].slot].stamp > since;
+    }
+
+    /// @returns id of the last pass which recomputed any matrix
+    uint32_t getPass() const { return pass; }
+
+    /// @returns number of times the structure was rebuilt
+    uint32_t getVersion() const { return version; }
+
+    /**
+     * Multiply two row-major 4x4 matrices, \f$ c = a b \f$. The result
+     * may not overlap either operand.
+     *
+     * @param a left matrix
+     * @param b right matrix
+     * @param c product
+     */
+    static void multiply(const float* a, const float* b, float* c);
+
+private:
+
+    /// Flatten the graph below the roots and recompute every matrix.
+    void rebuild(const list<Node*>& roots);
+
+    /**
+     * Find the first instance of a node.
+     *
+     * @param node node to find
+     * @returns index of instance, or #NONE
+     */
+    uint32_t find(Node* node) const;
+
+    /**
+     * Make an instance the one found for its node.
+     *
+     * @param node node placed
+     * @param instance index of instance
+     */
+    void place(Node* node, uint32_t instance);
+};
+
+}
+
+#endif // #ifndef _X3D_TRANSFORMHIERARCHY_H_
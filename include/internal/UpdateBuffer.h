@@ -0,0 +1,185 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _X3D_UPDATEBUFFER_H_
+#define _X3D_UPDATEBUFFER_H_
+
+#include "internal/SAIField.h"
+#include "internal/X3DField.h"
+#include <stddef.h>
+#include <typeinfo>
+#include <vector>
+
+using std::vector;
+
+namespace X3D {
+
+class EventRecorder;
+
+/**
+ * Writes to input fields made between Browser::beginUpdate() and
+ * Browser::endUpdate(). Each field keeps only the last value written to
+ * it, and the fields are sent their values in the order they were first
+ * written, so a transaction costs one filter, action and routing pass
+ * per field however many times it was written.
+ *
+ * A written field is flagged SAIField::PENDING and holds the position
+ * of its write in SAIField::updateSlot, so writing it again is a plain
+ * assignment to the buffered value. The write slots keep their value
+ * buffers from one transaction to the next, so a transaction which
+ * writes values of the same classes in the same order as the last one
+ * allocates nothing. A field freed during a transaction drops its
+ * write; see remove().
+ */
+class UpdateBuffer {
+private:
+
+    /// buffered write to a field
+    struct Write {
+        /// field written, or NULL if it was freed since
+        SAIField* field;
+
+        /// last value written; kept with the slot between transactions
+        X3DField* value;
+
+        /// type of value
+        X3DField::Type type;
+
+        /// class of value; a value of this class is stored with a
+        /// plain assignment
+        const std::type_info* cls;
+    };
+
+    /// write slots; the first #used are the current transaction's, in
+    /// the order first written
+    vector<Write> writes;
+
+    /// number of slots in use
+    size_t used;
+
+    /// position of the next slot to send, while applying
+    size_t next;
+
+    /// depth of apply() calls, which nest if a value sent ends an update
+    unsigned int applying;
+
+    /// number of writes whose fields haven't been freed
+    size_t pending;
+
+    /// value buffers not held by any slot, by type
+    vector<X3DField*> spare[X3DField::MFVEC4F + 1];
+
+    /// writes replaced by later ones since the buffer was cleared
+    size_t replaced;
+
+    /// Disallow copy constructor
+    UpdateBuffer(const UpdateBuffer& buffer) {
+        throw X3DError("illegal copy");
+    }
+
+public:
+
+    /// Constructor.
+    UpdateBuffer() : used(0), next(0), applying(0), pending(0), replaced(0) {}
+
+    /// Destructor; frees the value buffers.
+    ~UpdateBuffer();
+
+    /**
+     * Buffer a write, replacing any pending value of the field. Typed
+     * by the field's value class, so that if its buffer is of that
+     * class, a value is stored with a plain assignment.
+     *
+     * @param field input field being written
+     * @param value value written
+     * @throws X3DError if the value is of the wrong type
+     */
+    template <class TT>
+    INLINE void add(SAIField* field, const X3DField& value) {
+        if (value.getType() != TT::getStaticType())
+            throw X3DError("field value type mismatch");
+        if (field->flags & SAIField::PENDING) {
+            Write& write = writes[field->updateSlot];
+            if (write.cls == &typeid(TT))
+                *static_cast<TT*>(write.value) = TT::unwrap(value);
+            else
+                (*write.value)(value);
+            replaced++;
+            return;
+        }
+        if (used < writes.size() && writes[used].cls == &typeid(TT)) {
+            *static_cast<TT*>(writes[used].value) = TT::unwrap(value);
+            writes[used].field = field;
+            take(field);
+        } else {
+            first(field, value);
+        }
+    }
+
+    /**
+     * Drop the pending write of a field which is being freed. Called by
+     * ~SAIField() for fields flagged SAIField::PENDING.
+     *
+     * @param field field being freed
+     */
+    void remove(SAIField* field);
+
+    /**
+     * Send the pending values to their fields, in place. Each field is
+     * unflagged as it is sent, so one freed meanwhile still drops its
+     * write, and an update begun by a field's action adds to the same
+     * slots and is sent in the same pass.
+     *
+     * @param recorder event log to note the values sent in, if any
+     * @returns number of fields sent to
+     */
+    size_t apply(EventRecorder* recorder=NULL);
+
+    /// @returns number of fields with pending values
+    size_t size() const { return pending; }
+
+    /// @returns number of writes replaced by later ones
+    size_t replacedCount() const { return replaced; }
+
+    /// Drop pending values and free the buffers, as when the scene is reset.
+    void clear();
+
+private:
+
+    /**
+     * Buffer the first write to a field in a transaction the generic
+     * way, through X3DField::operator(), giving the next slot a value
+     * buffer of the field's type if it has none.
+     *
+     * @param field input field being written
+     * @param value value written, of the field's type
+     */
+    void first(SAIField* field, const X3DField& value);
+
+    /// Give the next slot to a field's first write in a transaction.
+    INLINE void take(SAIField* field) {
+        field->flags |= SAIField::PENDING;
+        field->updateSlot = used++;
+        pending++;
+    }
+};
+
+}
+
+#endif // #ifndef _X3D_UPDATEBUFFER_H_
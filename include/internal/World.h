@@ -39,6 +39,9 @@ protected:
     string filename;
 	WorldInfo* info;
 	Browser* browser;
+
+    /// names DEF'd in this world's file
+    Scope scope;
 	
 public:
 
@@ -50,14 +53,28 @@ public:
 		browser(browser),
         filename(filename),
 		version(version),
-		profile(profile) {
+		profile(profile),
+        scope(browser->getGlobalScope()) {
 		info = browser->createNode<WorldInfo>("WorldInfo");
 		info->info(meta);
 	}
 
     ~World();
+
+    /**
+     * Load a world from an XML file. The world's naming scope is left
+     * entered on the browser, so its DEF names can be looked up until
+     * the world is deleted.
+     *
+     * @param browser browser to load into
+     * @param filename path of X3D file
+     * @returns new world
+     */
 	static World* read(Browser* browser, const char* filename);
 
+    /// @returns naming scope of this world
+    Scope* getScope() { return &scope; }
+
 protected:
 
     string getXmlAttr(xmlNode* xml, const string& name, const string& desc);
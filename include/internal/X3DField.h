@@ -22,6 +22,7 @@
 
 #include "internal/config.h"
 #include "internal/errors.h"
+#include "internal/Encoder.h"
 #include <string>
 #include <istream>
 #include <ostream>
@@ -189,6 +190,36 @@ public:
      */
     virtual void print(ostream& os) const = 0;
 
+    /**
+     * Write the value in packed binary form. The default writes the
+     * printed form; value types override this with their raw data.
+     *
+     * @param out encoder to write to
+     */
+    virtual void encode(Encoder& out) const;
+
+    /**
+     * Read the value from its packed binary form, as written by
+     * encode(). The default reads the printed form and parses it. If
+     * decoding fails, the value should remain unchanged.
+     *
+     * @param in decoder to read from
+     * @returns whether a whole value was read
+     */
+    virtual bool decode(Decoder& in);
+
+    /// @returns 32-bit digest of the encoded value
+    unsigned int digest() const;
+
+    /**
+     * Count the heap memory owned by the value, such as the elements
+     * of an MF value or the pixels of an image. Container overhead is
+     * estimated; allocator headers aren't counted.
+     *
+     * @returns bytes owned beyond the field object itself
+     */
+    virtual size_t heapBytes() const { return 0; }
+
     /**
      * Realize the value, which does nothing unless the value
      * is an MFNode or SFNode value.
@@ -205,7 +236,7 @@ public:
     static X3DField* create(const string& typeName);
 
     /**
-     * Create a new x3dfield.
+     * Create a new x3dfield. MF types are created as arrays.
      * The memory for the field is the responsibility of the caller.
      * 
      * @param type type of x3d field
@@ -216,6 +247,12 @@ public:
 
 std::ostream& operator<<(std::ostream& os, const X3DField& f);
 
+/// @returns heap bytes owned by an MF element; plain values own none
+template <class T> inline size_t valueHeapBytes(const T&) { return 0; }
+
+/// @returns heap bytes owned by a string, or 0 if it is stored inline
+size_t valueHeapBytes(const string& value);
+
 }
 
 #endif // #ifndef _X3D_X3DFIELD_H_
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Grouping/StaticGroup.h"
+#include "internal/Browser.h"
+
+namespace X3D {
+namespace Grouping {
+
+StaticGroup::~StaticGroup() {
+    delete compiled;
+}
+
+bool StaticGroup::compile() {
+    if (compiled != NULL)
+        return true;
+    if (CompiledGroup::isRouted(this))
+        return false;
+    compiled = new CompiledGroup(this);
+    const BoundingBox& bounds = compiled->getBounds();
+    if (!hasBBox() && !bounds.empty()) {
+        bboxCenter.value = bounds.center();
+        bboxSize.value = bounds.size();
+    }
+    browser()->transforms.invalidateStructure();
+    return true;
+}
+
+}}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Grouping/Transform.h"
+#include "internal/Browser.h"
+
+namespace X3D {
+namespace Grouping {
+
+const SFMatrix4f& Transform::getMatrix() {
+    if (!matrixDirty)
+        return matrix;
+    // SFRotation::matrix() is for row vectors, so it holds R transposed
+    const SFMatrix3f r = rotation.value().matrix();
+    const SFMatrix3f q = scaleOrientation.value().matrix();
+    const float* s = scale.value().array();
+    const float* c = center.value().array();
+    const float* t = translation.value().array();
+
+    // b = SR * S * SR^-1, then a = R * b
+    float b[9], a[9];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            b[3*i+j] = q[i]*s[0]*q[j] + q[3+i]*s[1]*q[3+j] + q[6+i]*s[2]*q[6+j];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            a[3*i+j] = r[i]*b[j] + r[3+i]*b[3+j] + r[6+i]*b[6+j];
+
+    // the translation column is T + C - a * C
+    float m[16];
+    for (int i = 0; i < 3; i++) {
+        m[4*i+0] = a[3*i+0];
+        m[4*i+1] = a[3*i+1];
+        m[4*i+2] = a[3*i+2];
+        m[4*i+3] = t[i] + c[i]
+            - (a[3*i+0]*c[0] + a[3*i+1]*c[1] + a[3*i+2]*c[2]);
+    }
+    m[12] = m[13] = m[14] = 0;
+    m[15] = 1;
+    matrix = SFMatrix4f(m);
+    matrixDirty = false;
+    return matrix;
+}
+
+SFMatrix4f Transform::getWorldMatrix() {
+    return browser()->transforms.getWorldMatrix(this);
+}
+
+void Transform::invalidate() {
+    matrixDirty = true;
+    browser()->transforms.invalidate(this);
+}
+
+}}
@@ -18,6 +18,7 @@
  */
 
 #include "Grouping/X3DBoundedObject.h"
+#include "internal/Browser.h"
 
 namespace X3D {
 namespace Grouping {
@@ -27,5 +28,9 @@ void X3DBoundedObject::setup() {
     bboxSize.value = SFVec3f(-1,-1,-1);
 }
 
+BoundingBox X3DBoundedObject::getBounds() {
+    return browser()->bounds.getBounds(this);
+}
+
 }}
 
@@ -18,6 +18,7 @@
  */
 
 #include "Grouping/X3DGroupingNode.h"
+#include "internal/Browser.h"
 #include <set>
 using std::set;
 
@@ -27,6 +28,10 @@ namespace Grouping {
 void X3DGroupingNode::setup() {
 }
 
+void X3DGroupingNode::Children::action() {
+    node()->browser()->transforms.invalidateStructure();
+}
+
 void X3DGroupingNode::add(const MFNode<X3DChildNode>& nodes) {
     MFNode<X3DChildNode>::const_iterator it;
     for (it = nodes.begin(); it != nodes.end(); it++)
@@ -28,6 +28,10 @@ bool CoordinateInterpolator::outputIsDirty() {
     return value_changed.isDirty();
 }
 
+bool CoordinateInterpolator::outputIsObserved() {
+    return value_changed.isObserved();
+}
+
 void CoordinateInterpolator::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<SFVec3f>& values = keyValue().array();
@@ -36,19 +40,20 @@ void CoordinateInterpolator::setFraction(float fraction, int index) {
     // TODO: check that values.size() is multiple of keys.size()
     int multiple = values.size() / size;
     if (index < 0) {
-        fraction = 0.0;
-        index = 0;
+        output.assign(values.begin(), values.begin() + multiple);
     } else if (index == size-1) {
-        fraction = 1.0;
-        index = size-1;
-    }
-    float a = keys[index], b = keys[index+1];
-    output.clear();
-    int start = index * multiple;
-    for (int i = start; i < start + multiple; i++) {
-        SFVec3f lo = values[i], hi = values[i+1];
-        SFVec3f diff = hi - lo;
-        output.push_back(lo + (diff / (b - a)) * (fraction - a));
+        int start = index * multiple;
+        output.assign(values.begin() + start, values.begin() + start + multiple);
+    } else {
+        // each value moves toward its counterpart in the next key's set
+        float a = keys[index], b = keys[index+1];
+        int start = index * multiple;
+        output.clear();
+        for (int i = start; i < start + multiple; i++) {
+            SFVec3f &lo = values[i], &hi = values[i+multiple];
+            SFVec3f diff = hi - lo;
+            output.push_back(lo + (diff / (b - a)) * (fraction - a));
+        }
     }
     value_changed.changed();
 }
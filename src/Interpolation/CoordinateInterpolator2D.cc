@@ -28,6 +28,10 @@ bool CoordinateInterpolator2D::outputIsDirty() {
     return value_changed.isDirty();
 }
 
+bool CoordinateInterpolator2D::outputIsObserved() {
+    return value_changed.isObserved();
+}
+
 void CoordinateInterpolator2D::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<SFVec2f>& values = keyValue().array();
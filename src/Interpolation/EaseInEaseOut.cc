@@ -28,6 +28,10 @@ bool EaseInEaseOut::outputIsDirty() {
     return modifiedFraction_changed.isDirty();
 }
 
+bool EaseInEaseOut::outputIsObserved() {
+    return modifiedFraction_changed.isObserved();
+}
+
 void EaseInEaseOut::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<SFVec2f>& ease = easeInEaseOut().array();
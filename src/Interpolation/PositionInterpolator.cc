@@ -32,6 +32,10 @@ bool PositionInterpolator::outputIsDirty() {
     return value_changed.isDirty();
 }
 
+bool PositionInterpolator::outputIsObserved() {
+    return value_changed.isObserved();
+}
+
 void PositionInterpolator::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<SFVec3f>& values = keyValue().array();
@@ -32,6 +32,10 @@ bool PositionInterpolator2D::outputIsDirty() {
     return value_changed.isDirty();
 }
 
+bool PositionInterpolator2D::outputIsObserved() {
+    return value_changed.isObserved();
+}
+
 void PositionInterpolator2D::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<SFVec2f>& values = keyValue().array();
@@ -32,6 +32,10 @@ bool ScalarInterpolator::outputIsDirty() {
     return value_changed.isDirty();
 }
 
+bool ScalarInterpolator::outputIsObserved() {
+    return value_changed.isObserved();
+}
+
 void ScalarInterpolator::setFraction(float fraction, int index) {
     vector<float>& keys = key().array();
     vector<float>& values = keyValue().array();
@@ -17,7 +17,9 @@
  * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "internal/Browser.h"
 #include "Interpolation/X3DInterpolatorNode.h"
+#include "internal/Encoder.h"
 
 #include <vector>
 using std::vector;
@@ -26,34 +28,33 @@ namespace X3D {
 namespace Interpolation {
 
 int X3DInterpolatorNode::findKeyIndex(float fraction) {
-    vector<float> keys = key().array();
+    const vector<float>& keys = key().array();
     int size = keys.size();
-    int low = 0, high = size - 1;
-    if (fraction >= keys[lastKeyIndex]) {
-        if (fraction <= keys[lastKeyIndex+1])
-            return lastKeyIndex;
-        if (lastKeyIndex + 2 < size)
-            return lastKeyIndex + 1;
-        low = lastKeyIndex;
-    }
-    if (fraction <= keys[0]) {
+    if (size == 0 || fraction <= keys[0])
         return -1;
-    } else if (fraction >= keys[size - 1]) {
+    if (fraction >= keys[size - 1])
         return size - 1;
-    } else {
-        while (low < high - 1) {
-            int mid = low + ((high - low) / 2);
-            if (keys[mid] >= fraction) {
-                high = mid;
-            } else if (keys[mid+1] < fraction) {
-                low = mid + 1;
-            } else {
-                low = mid;
-                break;
-            }
-        }
-        return low;
+
+    // fractions usually move forward a little at a time, so try the
+    // last interval and the one after it first
+    int last = lastKeyIndex;
+    if (last >= 0 && last + 1 < size) {
+        if (keys[last] <= fraction && fraction <= keys[last + 1])
+            return last;
+        if (last + 2 < size && keys[last + 1] <= fraction && fraction <= keys[last + 2])
+            return lastKeyIndex = last + 1;
+    }
+
+    // find low such that keys[low] < fraction <= keys[low + 1]
+    int low = 0, high = size - 1;
+    while (low < high - 1) {
+        int mid = low + ((high - low) / 2);
+        if (keys[mid] < fraction)
+            low = mid;
+        else
+            high = mid;
     }
+    return lastKeyIndex = low;
 }
 
 void X3DInterpolatorNode::setFraction(float fraction) {
@@ -61,11 +62,22 @@ void X3DInterpolatorNode::setFraction(float fraction) {
         return;
     if (outputIsDirty())
         return;
+    // leave lastFraction alone, so the output is computed by the
+    // first fraction after something starts observing it
+    if (browser()->isDemandDriven() && !outputIsObserved())
+        return;
     lastFraction = fraction;
-    int index = findKeyIndex(fraction);
-    vector<float> keys = key().array();
-    int size = keys.size();
     setFraction(fraction, findKeyIndex(fraction));
 }
 
+void X3DInterpolatorNode::saveState(Encoder& out) const {
+    out.put(lastFraction);
+    out.put(lastKeyIndex);
+}
+
+void X3DInterpolatorNode::restoreState(Decoder& in) {
+    in.get(lastFraction);
+    in.get(lastKeyIndex);
+}
+
 }}
@@ -86,8 +86,9 @@ const string& Expect::getTypeName() const {
     return expected->getTypeName();
 }
 
+// named after the field being watched, so routes to it can be described
 const string& Expect::getName() const {
-    throw X3DError("Abstract");
+    return field;
 }
 
 SAIField::Access Expect::getAccess() const {
@@ -124,14 +125,4 @@ bool Expect::isDirty() const {
 void Expect::clearDirty() {
 }
 
-void Expect::addIncomingRoute(Route* route) {
-    routes.push_back(route);
-}
-void Expect::removeIncomingRoute(Route* route) {
-    routes.remove(route);
-}
-const list<Route*>& Expect::getIncomingRoutes() const {
-    return routes;
-}
-
 }}
@@ -19,6 +19,7 @@
 
 #include "internal/Browser.h"
 #include "Time/TimeSensor.h"
+#include "internal/Encoder.h"
 
 #include <float.h>
 #include <iostream>
@@ -163,11 +164,11 @@ void TimeSensor::evaluate() {
 
     // output continuous events
     if (_cycle || (_active && active)) {
-        cycleTime.send(tick);
+        emit(cycleTime, tick);
         elapsed = 0;
     }
-    time.send(tick);
-    elapsedTime.send(elapsedTime() + dt);
+    emit(time, tick);
+    emit(elapsedTime, elapsedTime() + dt);
 
     // schedule cycle event
     if (active && (last == tick || _cycle))
@@ -177,7 +178,7 @@ void TimeSensor::evaluate() {
     double frac = elapsed / cycleInterval();
     if (frac == 0 && tick > start)
         frac = 1;
-    fraction_changed.send(frac);
+    emit(fraction_changed, frac);
 
     // update evaluation time
     last = tick;
@@ -193,17 +194,33 @@ bool TimeSensor::tick() {
     double frac = elapsed / cycleInterval();
     if (frac == 0 && now() > startTime())
         frac = 1;
-    time.send(now());
-    fraction_changed.send(frac);
-    elapsedTime.send(elapsedTime() + dt);
+    emit(time, now());
+    emit(fraction_changed, frac);
+    emit(elapsedTime, elapsedTime() + dt);
     last = now();
     return true;
 }
 
+bool TimeSensor::demands(const SAIField& field) {
+    return browser()->demands(field);
+}
+
 bool TimeSensor::getIsActive() const {
     return isActive.value();
 }
 
+void TimeSensor::saveState(Encoder& out) const {
+    out.put(elapsed);
+    out.put(last);
+    out.put(next);
+}
+
+void TimeSensor::restoreState(Decoder& in) {
+    in.get(elapsed);
+    in.get(last);
+    in.get(next);
+}
+
 #define COMPARE(DATA,INDX,A,B) \
     if (DATA[A] > DATA[B]) { \
         double __d; int __i; \
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/BoundingVolumeHierarchy.h"
+#include "internal/Browser.h"
+#include "Grouping/X3DBoundedObject.h"
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+using X3D::Grouping::X3DBoundedObject;
+
+namespace X3D {
+
+/// orders objects by the center of their boxes along one axis
+struct CenterLess {
+    const BoundingBox* boxes;
+    int axis;
+
+    float key(uint32_t i) const {
+        const BoundingBox& b = boxes[i];
+        return (&b.min.x)[axis] + (&b.max.x)[axis];
+    }
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        return key(a) < key(b);
+    }
+};
+
+struct BoundingVolumeHierarchy::Build {
+    /// volumes being built
+    Volume* volumes;
+
+    /// world box of each object, in instance order
+    const BoundingBox* boxes;
+
+    /// objects in build order, as indices in instance order
+    uint32_t* order;
+
+    /// number of objects above which to build on a thread
+    size_t threshold;
+
+    /// depth below which subtrees go on their own threads
+    unsigned int parallelDepth;
+};
+
+struct BoundingVolumeHierarchy::Task {
+    Build* build;
+    uint32_t volume, begin, end;
+    unsigned int depth;
+};
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() :
+        version(0), seen(0), refitted(0), builds(0),
+        threshold(16384), threads(0) {
+    setParallel(threshold);
+}
+
+void BoundingVolumeHierarchy::setParallel(size_t objects, unsigned int n) {
+    threshold = objects;
+    if (n == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cpus > 0 ? (unsigned int) cpus : 1;
+    }
+    threads = n;
+}
+
+size_t BoundingVolumeHierarchy::update() {
+    TransformHierarchy& transforms = Browser::getSingleton()->transforms;
+    transforms.update();
+    if (transforms.getVersion() != version)
+        rebuild(transforms);
+    else if (transforms.getPass() != seen)
+        refit(transforms);
+    else
+        refitted = 0;
+    return refitted;
+}
+
+BoundingBox BoundingVolumeHierarchy::getBounds(Node* node) {
+    update();
+    TransformHierarchy& transforms = Browser::getSingleton()->transforms;
+    uint32_t i = transforms.indexOf(node);
+    if (i == TransformHierarchy::NONE)
+        throw X3DError("node isn't in the scene graph");
+    X3DBoundedObject* bounded = nodeCast<X3DBoundedObject>(node);
+    if (bounded != NULL && bounded->hasBBox())
+        return bounded->getBBox().transform(transforms.getWorld(i));
+
+    // the objects below the instance are a run in instance order
+    uint32_t end = transforms.getEnd(i);
+    size_t lo = 0, hi = byInstance.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (objects[byInstance[mid]].instance < i)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    BoundingBox box;
+    for (; lo < byInstance.size(); lo++) {
+        uint32_t k = byInstance[lo];
+        if (objects[k].instance >= end)
+            break;
+        box.extend(boxes[k]);
+    }
+    return box;
+}
+
+BoundingBox BoundingVolumeHierarchy::getSceneBounds() {
+    update();
+    return volumes.empty() ? BoundingBox() : volumes[0].box;
+}
+
+void BoundingVolumeHierarchy::clear() {
+    volumes.clear();
+    objects.clear();
+    boxes.clear();
+    byInstance.clear();
+    changed.clear();
+    version = 0;
+    seen = 0;
+    refitted = 0;
+    builds = 0;
+}
+
+void BoundingVolumeHierarchy::rebuild(TransformHierarchy& transforms) {
+    vector<Object> found;
+    vector<BoundingBox> world;
+    for (uint32_t i = 0; i < transforms.instanceCount(); i++) {
+        Node* node = transforms.getNode(i);
+        X3DBoundedObject* bounded = nodeCast<X3DBoundedObject>(node);
+        if (bounded == NULL || !bounded->hasBBox())
+            continue;
+        Object object = { node, i, bounded->getBBox() };
+        found.push_back(object);
+        world.push_back(object.local.transform(transforms.getWorld(i)));
+    }
+
+    uint32_t n = found.size();
+    vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; i++)
+        order[i] = i;
+    volumes.resize(n == 0 ? 0 : volumeCount(n));
+    if (n > 0) {
+        Build b;
+        b.volumes = &volumes[0];
+        b.boxes = &world[0];
+        b.order = &order[0];
+        b.threshold = threshold;
+        b.parallelDepth = 0;
+        while ((1u << b.parallelDepth) < threads)
+            b.parallelDepth++;
+        build(b, 0, 0, n, 0);
+    }
+
+    // store the objects in tree order
+    objects.resize(n);
+    boxes.resize(n);
+    byInstance.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+        objects[i] = found[order[i]];
+        boxes[i] = world[order[i]];
+        byInstance[order[i]] = i;
+    }
+    version = transforms.getVersion();
+    seen = transforms.getPass();
+    refitted = n;
+    builds++;
+}
+
+void BoundingVolumeHierarchy::refit(TransformHierarchy& transforms) {
+    refitted = 0;
+    changed.assign(volumes.size(), 0);
+    // children follow their parents, so going backwards sees them first
+    for (size_t v = volumes.size(); v-- > 0; ) {
+        Volume& volume = volumes[v];
+        if (volume.count > 0) {
+            uint32_t end = volume.first + volume.count;
+            for (uint32_t i = volume.first; i < end; i++) {
+                uint32_t instance = objects[i].instance;
+                if (!transforms.changedSince(instance, seen))
+                    continue;
+                boxes[i] = objects[i].local.transform(
+                    transforms.getWorld(instance));
+                changed[v] = 1;
+                refitted++;
+            }
+            if (changed[v]) {
+                volume.box = BoundingBox();
+                for (uint32_t i = volume.first; i < end; i++)
+                    volume.box.extend(boxes[i]);
+            }
+        } else if (changed[v + 1] || changed[volume.first]) {
+            volume.box = volumes[v + 1].box;
+            volume.box.extend(volumes[volume.first].box);
+            changed[v] = 1;
+        }
+    }
+    seen = transforms.getPass();
+}
+
+void BoundingVolumeHierarchy::build(Build& b, uint32_t v,
+        uint32_t begin, uint32_t end, unsigned int depth) {
+    Volume& volume = b.volumes[v];
+    uint32_t n = end - begin;
+    if (n <= LEAF_SIZE) {
+        volume.box = BoundingBox();
+        for (uint32_t i = begin; i < end; i++)
+            volume.box.extend(b.boxes[b.order[i]]);
+        volume.first = begin;
+        volume.count = n;
+        return;
+    }
+
+    // split at the median center along the axis where centers spread most
+    BoundingBox centers;
+    for (uint32_t i = begin; i < end; i++)
+        centers.extend(b.boxes[b.order[i]].center());
+    SFVec3f spread = centers.size();
+    CenterLess less = { b.boxes, 0 };
+    if (spread.y > spread.x && spread.y >= spread.z)
+        less.axis = 1;
+    else if (spread.z > spread.x && spread.z > spread.y)
+        less.axis = 2;
+    uint32_t mid = begin + n / 2;
+    std::nth_element(b.order + begin, b.order + mid, b.order + end, less);
+
+    uint32_t right = v + 1 + volumeCount(mid - begin);
+    volume.first = right;
+    volume.count = 0;
+    bool spawned = false;
+    pthread_t thread;
+    Task task = { &b, right, mid, end, depth + 1 };
+    if (n > b.threshold && depth < b.parallelDepth)
+        spawned = pthread_create(&thread, NULL, buildThread, &task) == 0;
+    build(b, v + 1, begin, mid, depth + 1);
+    if (spawned)
+        pthread_join(thread, NULL);
+    else
+        build(b, right, mid, end, depth + 1);
+    volume.box = b.volumes[v + 1].box;
+    volume.box.extend(b.volumes[right].box);
+}
+
+void* BoundingVolumeHierarchy::buildThread(void* arg) {
+    Task* task = (Task*) arg;
+    build(*task->build, task->volume, task->begin, task->end, task->depth);
+    return NULL;
+}
+
+uint32_t BoundingVolumeHierarchy::volumeCount(uint32_t objects) {
+    if (objects <= LEAF_SIZE)
+        return 1;
+    return 1 + volumeCount(objects / 2) + volumeCount(objects - objects / 2);
+}
+
+}
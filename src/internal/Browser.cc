@@ -20,10 +20,12 @@
 #include "internal/Browser.h"
 #include "internal/Route.h"
 #include "internal/Plugin.h"
+#include "Grouping/StaticGroup.h"
 
 #include <iostream>
 using std::cout;
 using std::endl;
+using X3D::Grouping::StaticGroup;
 
 namespace X3D {
 
@@ -37,7 +39,14 @@ Browser::Browser() : profile(new Profile()) {
 		throw X3DError("multiple browser instances!");
     }
 	Builtin::init(profile);
+    scopes.push_back(&defs);
     started = false;
+    simTime = 0;
+    cascade = 0;
+    demandDriven = false;
+    pipelined = false;
+    updateDepth = 0;
+    replayer = NULL;
 }
 
 Plugin* Browser::addPlugin(const string& library) {
@@ -60,6 +69,7 @@ void Browser::removePlugin(Plugin* plugin) {
 }
 
 void Browser::reset() {
+    profiler.retireScene();
 	list<Node*>::iterator it = nodes.begin();
 	for (; it != nodes.end(); it++) {
         Node* node = *it;
@@ -67,11 +77,27 @@ void Browser::reset() {
         delete node;
     }
     nodes.clear();
+    routeGraph.clear();
+    pipeline.clear();
+    snapshots.clear();
+    injections.clear();
+    updates.clear();
+    subscriptions.clear();
+    deltas.close();
+    recorder.close();
+    if (replayer != NULL)
+        replayer->close();
+    checkpointBase.clear();
+    transforms.clear();
+    bounds.clear();
+    updateDepth = 0;
+    SAIField::buffering = NULL;
     persistent.clear();
     roots.clear();
     dirtyFields.clear();
-    firedFields.clear();
+    dirtyNodes.clear();
     defs.clear();
+    scopes.resize(1);
     newSensors.clear();
     timers.clear();
     while (!events.empty())
@@ -86,9 +112,18 @@ Browser::~Browser() {
 bool Browser::simulate() {
     initRoots();
     initSensors();
-    if (events.empty())
+    EventRecorder* eventLog = recorder.isOpen() ? &recorder : NULL;
+    bool injected = injections.drain(eventLog) > 0;
+    if (eventLog != NULL)
+        eventLog->simulate();
+    // committed values keep the simulation going for as long as they
+    // are passed down their routes, and injected ones must be routed
+    if (events.empty() && !pipeline.isPending() && !injected)
         return false;
-    advanceTime();
+    if (!events.empty())
+        advanceTime();
+    if (pipeline.isPending())
+        pipeline.deliver();
     do {
         do {
             processEvents();
@@ -132,17 +167,22 @@ void Browser::processEvents() {
 
 void Browser::processNextEvent() {
     X3DSensorNode* node = events.top().node;
-    if (node != NULL)
+    if (node != NULL) {
+        ProfilerScope scope(node);
         node->evaluate();
+    }
     events.pop();
 }
 
 bool Browser::haveTimers() {
+    // tick every timer before routing, rather than starting over after
+    // each one that ticks, so a frame costs one pass over the timers
+    bool ticked = false;
     list<X3DTimeDependentNode*>::iterator it;
     for (it = timers.begin(); it != timers.end(); it++)
         if ((*it)->tick())
-            return true;
-    return false;
+            ticked = true;
+    return ticked;
 }
 
 double Browser::now() {
@@ -150,6 +190,8 @@ double Browser::now() {
 }
 
 void Browser::wake(double time) {
+    if (recorder.isOpen())
+        recorder.wake(time);
     schedule(time, NULL);
 }
 
@@ -162,12 +204,10 @@ Node* Browser::createNode(const std::string& name) {
 	if (def == NULL)
 		return NULL;
     Node* node = def->create();
-    X3DSensorNode* sensor = dynamic_cast<X3DSensorNode*>(node);
-    X3DTimeDependentNode* timer = dynamic_cast<X3DTimeDependentNode*>(node);
-    if (sensor != NULL)
-        newSensors.push_back(sensor);
-    if (timer != NULL)
-        timers.push_back(timer);
+    if (def->is(NodeDef::SENSOR))
+        newSensors.push_back(nodeCast<X3DSensorNode>(node));
+    if (def->is(NodeDef::TIME_DEPENDENT))
+        timers.push_back(nodeCast<X3DTimeDependentNode>(node));
     return node;
 }
 
@@ -177,29 +217,193 @@ void Browser::addNode(Node* node) {
 }
 
 void Browser::route() {
+    // routes changed since the analysis may have left the ranks and
+    // pruned outputs wrong
+    if (routeGraph.isStale())
+        analyzeRoutes();
+    // pipelined frames route what changed at the next frame instead
+    if (pipelined)
+        return;
     // route until cascade is done; this vector will grow as
     // you are iterating it
+    ProfilerScope scope;
     for (int i = 0; i < dirtyFields.size(); i++)
         routeFrom(dirtyFields[i]);
     dirtyFields.clear();
 }
 
 void Browser::endRoute() {
-    for (int i = 0; i < firedFields.size(); i++)
-        firedFields[i]->clearDirty();
-    firedFields.clear();
+    // observers' writes go to the next cascade
+    bool notify = subscriptions.isPending();
+    if (notify) {
+        beginUpdate();
+        try {
+            subscriptions.deliver();
+        } catch (...) {
+            // don't leave writes buffered after a failed observer
+            if (--updateDepth == 0)
+                SAIField::buffering = NULL;
+            throw;
+        }
+    }
+    if (pipelined) {
+        pipeline.commit(dirtyFields);
+        dirtyFields.clear();
+    }
+    if (snapshots.isCapturing())
+        snapshots.publish(cascade, simTime);
+    if (deltas.isOpen())
+        deltas.record(cascade, simTime, dirtyNodes);
+    if (recorder.isOpen())
+        recorder.cascade(cascade, simTime, dirtyNodes);
+    if (replayer != NULL)
+        replayer->cascade(cascade, simTime, dirtyNodes);
+    for (size_t i = 0; i < dirtyNodes.size(); i++)
+        dirtyNodes[i]->clearDirty();
+    dirtyNodes.clear();
+    cascade++;
+    if (notify)
+        endUpdate();
 }
 
 void Browser::addDirtyField(SAIField* field) {
     dirtyFields.push_back(field);
+    if (field->flags & SAIField::SUBSCRIBED)
+        subscriptions.mark(field);
+}
+
+void Browser::beginUpdate() {
+    if (updateDepth++ == 0)
+        SAIField::buffering = &updates;
+}
+
+void Browser::endUpdate() {
+    if (updateDepth == 0)
+        throw X3DError("no update to end");
+    if (--updateDepth > 0)
+        return;
+    SAIField::buffering = NULL;
+    EventRecorder* eventLog = recorder.isOpen() ? &recorder : NULL;
+    if (updates.apply(eventLog) > 0) {
+        if (eventLog != NULL)
+            eventLog->update();
+        route();
+        endRoute();
+    }
+}
+
+Checkpoint* Browser::checkpoint() {
+    if (isUpdating() || !dirtyFields.empty() || !dirtyNodes.empty())
+        throw X3DError("can't take a checkpoint during a cascade");
+    if (pipelined)
+        throw X3DError("can't take a checkpoint in pipelined mode");
+    Checkpoint* checkpoint = new Checkpoint();
+    checkpoint->capture(nodes, checkpointBase);
+    list<Node*>::iterator it;
+    for (it = nodes.begin(); it != nodes.end(); it++)
+        (*it)->saveState(checkpoint->states);
+    checkpoint->events = events;
+    checkpoint->newSensors = newSensors;
+    checkpoint->time = simTime;
+    checkpoint->wakeupTime = wakeupTime;
+    checkpoint->started = started;
+    checkpoint->cascade = cascade;
+    checkpointBase.share(*checkpoint);
+    return checkpoint;
+}
+
+void Browser::restore(const Checkpoint& checkpoint) {
+    if (isUpdating() || !dirtyFields.empty() || !dirtyNodes.empty())
+        throw X3DError("can't restore a checkpoint during a cascade");
+    if (pipelined)
+        throw X3DError("can't restore a checkpoint in pipelined mode");
+    if (checkpoint.nodeCount > nodes.size())
+        throw X3DError("checkpoint is of another scene");
+    checkpoint.restoreValues();
+    const vector<char>& states = checkpoint.states.bytes;
+    Decoder in(states.empty() ? NULL : &states[0], states.size());
+    list<Node*>::iterator it = nodes.begin();
+    for (size_t n = 0; n < checkpoint.nodeCount; n++, it++)
+        (*it)->restoreState(in);
+    events = checkpoint.events;
+    newSensors = checkpoint.newSensors;
+    simTime = checkpoint.time;
+    wakeupTime = checkpoint.wakeupTime;
+    started = checkpoint.started;
+    cascade = checkpoint.cascade;
+    checkpointBase.share(checkpoint);
+    transforms.invalidateAll();
+}
+
+void Browser::watch(SAIField* field) {
+    field->flags |= SAIField::WATCHED;
+    if (field->flags & SAIField::PRUNED)
+        routeGraph.revive(field->getNode());
+}
+
+void Browser::unwatch(SAIField* field) {
+    field->flags &= ~SAIField::WATCHED;
+}
+
+void Browser::subscribe(SAIField* field, FieldObserver* observer) {
+    SAIField::Access access = field->getAccess();
+    if (access != SAIField::OUTPUT_ONLY && access != SAIField::INPUT_OUTPUT)
+        throw X3DError("this field does not support subscriptions");
+    subscriptions.add(field, observer);
+    if (field->flags & SAIField::PRUNED)
+        routeGraph.revive(field->getNode());
+}
+
+void Browser::unsubscribe(SAIField* field, FieldObserver* observer) {
+    subscriptions.remove(field, observer);
+}
+
+void Browser::addDirtyNode(Node* node) {
+    dirtyNodes.push_back(node);
+}
+
+void Browser::raycast(const vector<Ray>& rays, vector<RayHit>& hits) {
+    bounds.update();
+    hits.resize(rays.size());
+    if (!rays.empty())
+        SpatialQuery::raycast(bounds, &rays[0], rays.size(), &hits[0],
+                              bounds.getThreads());
+}
+
+RayHit Browser::raycast(const Ray& ray) {
+    RayHit hit;
+    bounds.update();
+    SpatialQuery::raycast(bounds, &ray, 1, &hit, 1);
+    return hit;
+}
+
+void Browser::overlap(const vector<BoundingBox>& boxes,
+                      QueryResults& results) {
+    bounds.update();
+    SpatialQuery::overlap(bounds, boxes.empty() ? NULL : &boxes[0],
+                          boxes.size(), results, bounds.getThreads());
+}
+
+void Browser::overlap(const vector<Frustum>& frusta, QueryResults& results) {
+    bounds.update();
+    SpatialQuery::overlap(bounds, frusta.empty() ? NULL : &frusta[0],
+                          frusta.size(), results, bounds.getThreads());
+}
+
+void Browser::nearest(const vector<SFVec3f>& points, size_t k,
+                      QueryResults& results) {
+    bounds.update();
+    SpatialQuery::nearest(bounds, points.empty() ? NULL : &points[0],
+                          points.size(), k, results, bounds.getThreads());
 }
 
 void Browser::routeFrom(SAIField* field) {
-    const list<Route*>& routes = field->getOutgoingRoutes();
-    list<Route*>::const_iterator it;
-    for (it = routes.begin(); it != routes.end(); it++)
-        (*it)->activate();
-    firedFields.push_back(field);
+    if (field->hasOutgoingRoutes()) {
+        const list<Route*>& routes = routeTable[field->routeSlot].outgoing;
+        list<Route*>::const_iterator it;
+        for (it = routes.begin(); it != routes.end(); it++)
+            (*it)->activate();
+    }
 }
 
 void Browser::persist(Node* node) {
@@ -208,6 +412,7 @@ void Browser::persist(Node* node) {
 
 void Browser::addRoot(Node* node) {
     roots.push_back(node);
+    transforms.invalidateStructure();
 }
 
 Route* Browser::createRoute(Node* fromNode, const string& fromFieldName,
@@ -250,15 +455,76 @@ Route* Browser::createRoute(const string& fromNode, const string& fromField,
     return createRoute(from, fromField, to, toField);
 }
 
+void Browser::saveTrace(const string& filename) {
+    map<uint32_t, string> names;
+    list<Node*>::iterator n_it;
+    for (n_it = nodes.begin(); n_it != nodes.end(); n_it++) {
+        FieldIterator it = (*n_it)->fields(FieldIterator::OUTPUT);
+        while (it.hasNext()) {
+            const list<Route*>& routes = it.nextField()->getOutgoingRoutes();
+            list<Route*>::const_iterator r_it;
+            for (r_it = routes.begin(); r_it != routes.end(); r_it++)
+                names[(*r_it)->id] = (*r_it)->describe();
+        }
+    }
+    trace.save(filename, names);
+}
+
+MemoryReport Browser::memoryReport() {
+    MemoryReport report;
+    list<Node*>::iterator it;
+    for (it = nodes.begin(); it != nodes.end(); it++)
+        report.add(*it);
+    report.routeLists.count = routeTable.size();
+    report.routeLists.bytes = routeTable.bytes();
+    return report;
+}
+
+const RouteGraph& Browser::analyzeRoutes() {
+    routeGraph.analyze(nodes);
+    return routeGraph;
+}
+
+const RouteGraph& Browser::getRouteGraph() {
+    if (routeGraph.isStale())
+        analyzeRoutes();
+    return routeGraph;
+}
+
+size_t Browser::compileStaticGroups() {
+    size_t count = 0;
+    list<Node*>::iterator it;
+    for (it = nodes.begin(); it != nodes.end(); it++) {
+        StaticGroup* group = nodeCast<StaticGroup>(*it);
+        if (group != NULL && !group->isCompiled() && group->compile())
+            count++;
+    }
+    return count;
+}
+
 void Browser::addNamedNode(const string& name, Node* node) {
-    defs[name] = node;
+    scopes.back()->define(name, node);
     node->setName(name);
 }
 
 Node* Browser::getNode(const string& name) {
-    if (defs.count(name))
-        return defs[name];
-    return NULL;
+    return scopes.back()->lookup(name);
+}
+
+void Browser::enterScope(Scope* scope) {
+    scopes.push_back(scope);
+}
+
+void Browser::leaveScope(Scope* scope) {
+    for (size_t i = scopes.size(); i-- > 0; ) {
+        if (scopes[i] == scope) {
+            // the global scope is always at the bottom
+            if (i == 0)
+                throw X3DError("can't leave the global scope");
+            scopes.erase(scopes.begin() + i);
+            return;
+        }
+    }
 }
 
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/Checkpoint.h"
+#include "internal/Node.h"
+#include "internal/SAIField.h"
+
+namespace X3D {
+
+Checkpoint::~Checkpoint() {
+    clear();
+}
+
+void Checkpoint::capture(const list<Node*>& nodes, Checkpoint& base) {
+    clear();
+    // nodes are only added to the end of the list, and never change
+    // their fields, so only the fields of new nodes need looking up
+    fields = base.fields;
+    list<Node*>::const_iterator it = nodes.begin();
+    for (size_t n = 0; it != nodes.end(); it++, n++) {
+        if (n < base.nodeCount)
+            continue;
+        FieldIterator f_it = (*it)->fields(FieldIterator::ALL);
+        while (f_it.hasNext()) {
+            SAIField* field = f_it.nextField();
+            X3DField::Type type = field->getType();
+            if (field->getAccess() != SAIField::INPUT_ONLY
+                    && type != X3DField::SFNODE && type != X3DField::MFNODE)
+                fields.push_back(field);
+        }
+    }
+    nodeCount = nodes.size();
+
+    values.resize(fields.size());
+    copies = 0;
+    for (size_t i = 0; i < fields.size(); i++) {
+        const X3DField& live = fields[i]->getSilently();
+        if (i < base.values.size()) {
+            Value* value = base.values[i];
+            bool same = (*value->value == live);
+            if (same || value->refs == 1) {
+                // a value only the base holds is overwritten in place
+                if (!same) {
+                    (*value->value)(live);
+                    copies++;
+                }
+                values[i] = value;
+                value->refs++;
+                continue;
+            }
+        }
+        Value* value = new Value();
+        value->value = X3DField::create(live.getType());
+        (*value->value)(live);
+        value->refs = 1;
+        values[i] = value;
+        copies++;
+    }
+}
+
+void Checkpoint::share(const Checkpoint& other) {
+    if (&other == this)
+        return;
+    clear();
+    nodeCount = other.nodeCount;
+    fields = other.fields;
+    values = other.values;
+    for (size_t i = 0; i < values.size(); i++)
+        values[i]->refs++;
+}
+
+void Checkpoint::restoreValues() const {
+    for (size_t i = 0; i < fields.size(); i++) {
+        const X3DField& value = *values[i]->value;
+        if (fields[i]->getSilently() != value)
+            fields[i]->setSilently(value);
+    }
+}
+
+void Checkpoint::clear() {
+    for (size_t i = 0; i < values.size(); i++) {
+        if (--values[i]->refs == 0) {
+            delete values[i]->value;
+            delete values[i];
+        }
+    }
+    values.clear();
+    fields.clear();
+    nodeCount = 0;
+}
+
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/CompiledGroup.h"
+#include "internal/TransformHierarchy.h"
+#include "Grouping/StaticGroup.h"
+#include "Grouping/Transform.h"
+#include <algorithm>
+#include <string.h>
+#include <utility>
+
+using X3D::Grouping::StaticGroup;
+using X3D::Grouping::Transform;
+using X3D::Grouping::X3DBoundedObject;
+using X3D::Grouping::X3DGroupingNode;
+
+namespace X3D {
+
+static const float IDENTITY[16] = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1
+};
+
+/// @returns children of a grouping node or StaticGroup, or NULL
+static const MFNode<X3DChildNode>* childrenOf(Node* node) {
+    X3DGroupingNode* group = nodeCast<X3DGroupingNode>(node);
+    if (group != NULL)
+        return &group->children();
+    StaticGroup* sg = nodeCast<StaticGroup>(node);
+    if (sg != NULL)
+        return &sg->children();
+    return NULL;
+}
+
+CompiledGroup::CompiledGroup(Node* group) {
+    freeze(group);
+    const MFNode<X3DChildNode>* children = childrenOf(group);
+    if (children == NULL)
+        return;
+
+    // depth-first, keeping each node's parent position with it on the
+    // stack; open holds the nodes whose end isn't known yet
+    struct Entry { Node* node; uint32_t parent; uint32_t depth; };
+    vector<Entry> stack;
+    vector<std::pair<uint32_t, uint32_t> > open;
+    MFNode<X3DChildNode>::const_iterator it;
+    for (it = children->begin(); it != children->end(); it++) {
+        Entry e = { (Node*) *it, TransformHierarchy::NONE, 0 };
+        stack.push_back(e);
+    }
+    std::reverse(stack.begin(), stack.end());
+    while (!stack.empty()) {
+        Entry e = stack.back();
+        stack.pop_back();
+        if (e.node == NULL)
+            continue;
+        while (!open.empty() && open.back().second >= e.depth) {
+            ends[open.back().first] = nodes.size();
+            open.pop_back();
+        }
+        uint32_t i = nodes.size();
+        open.push_back(std::make_pair(i, e.depth));
+        nodes.push_back(e.node);
+        ends.push_back(0);
+        freeze(e.node);
+
+        // the parent's matrix, times the node's own if it's a Transform
+        matrices.resize(16 * (i + 1));
+        float* m = &matrices[16 * i];
+        const float* up = e.parent == TransformHierarchy::NONE
+            ? IDENTITY : &matrices[16 * e.parent];
+        Transform* transform = nodeCast<Transform>(e.node);
+        if (transform != NULL)
+            TransformHierarchy::multiply(
+                up, transform->getMatrix().array(), m);
+        else
+            memcpy(m, up, 16 * sizeof(float));
+
+        X3DBoundedObject* bounded = nodeCast<X3DBoundedObject>(e.node);
+        if (bounded != NULL && bounded->hasBBox()) {
+            BoundingBox box = bounded->getBBox().transform(m);
+            boxed.push_back(i);
+            boxes.push_back(box);
+            bounds.extend(box);
+        }
+
+        const MFNode<X3DChildNode>* below = childrenOf(e.node);
+        if (below == NULL)
+            continue;
+        size_t top = stack.size();
+        for (it = below->begin(); it != below->end(); it++) {
+            Entry child = { (Node*) *it, i, e.depth + 1 };
+            stack.push_back(child);
+        }
+        std::reverse(stack.begin() + top, stack.end());
+    }
+    for (size_t i = 0; i < open.size(); i++)
+        ends[open[i].first] = nodes.size();
+}
+
+bool CompiledGroup::isRouted(Node* group) {
+    vector<Node*> stack(1, group);
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        if (node == NULL)
+            continue;
+        FieldIterator it = node->fields();
+        while (it.hasNext()) {
+            SAIField* field = it.nextField();
+            if (field->hasIncomingRoutes() || field->hasOutgoingRoutes())
+                return true;
+        }
+        const MFNode<X3DChildNode>* children = childrenOf(node);
+        if (children == NULL)
+            continue;
+        MFNode<X3DChildNode>::const_iterator c_it;
+        for (c_it = children->begin(); c_it != children->end(); c_it++)
+            stack.push_back((Node*) *c_it);
+    }
+    return false;
+}
+
+size_t CompiledGroup::indexOf(Node* node) const {
+    for (size_t i = 0; i < nodes.size(); i++)
+        if (nodes[i] == node)
+            return i;
+    return nodes.size();
+}
+
+size_t CompiledGroup::getBytes() const {
+    return sizeof(CompiledGroup)
+        + nodes.capacity() * sizeof(Node*)
+        + ends.capacity() * sizeof(uint32_t)
+        + matrices.capacity() * sizeof(float)
+        + boxed.capacity() * sizeof(uint32_t)
+        + boxes.capacity() * sizeof(BoundingBox);
+}
+
+void CompiledGroup::freeze(Node* node) {
+    FieldIterator it = node->fields();
+    while (it.hasNext())
+        it.nextField()->flags |= SAIField::FROZEN;
+}
+
+}
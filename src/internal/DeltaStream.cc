@@ -0,0 +1,314 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/DeltaStream.h"
+#include "internal/Node.h"
+#include "internal/SAIField.h"
+#include "internal/NodeDef.h"
+#include "internal/FieldDef.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace X3D {
+
+/// Append an unsigned number in seven-bit groups, low group first.
+static void putCount(vector<char>& out, size_t n) {
+    while (n >= 0x80) {
+        out.push_back((char) (n | 0x80));
+        n >>= 7;
+    }
+    out.push_back((char) n);
+}
+
+/// Read a number written by putCount().
+static bool getCount(Decoder& in, size_t& n) {
+    n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        unsigned char c;
+        if (!in.get(c))
+            return false;
+        n |= (size_t) (c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Write the XOR of two encodings of the same size as runs of zero and
+ * literal bytes.
+ *
+ * @returns false, leaving out partly written, if that takes limit bytes
+ */
+static bool putXor(vector<char>& out, const vector<char>& now,
+                   const vector<char>& before, size_t limit) {
+    size_t start = out.size(), i = 0, size = now.size();
+    while (i < size) {
+        size_t zeros = i;
+        while (i < size && now[i] == before[i])
+            i++;
+        putCount(out, i - zeros);
+        size_t literals = i;
+        while (i < size && now[i] != before[i])
+            i++;
+        putCount(out, i - literals);
+        for (size_t j = literals; j < i; j++)
+            out.push_back(now[j] ^ before[j]);
+        if (out.size() - start >= limit)
+            return false;
+    }
+    return true;
+}
+
+/// Apply an XOR written by putXor() to the previous encoding.
+static bool getXor(Decoder& in, vector<char>& value) {
+    size_t i = 0, size = value.size();
+    while (i < size) {
+        size_t zeros, literals;
+        if (!getCount(in, zeros) || !getCount(in, literals)
+                || literals > size - i || zeros > size - i - literals)
+            return false;
+        i += zeros;
+        for (size_t end = i + literals; i < end; i++) {
+            char c;
+            if (!in.get(c))
+                return false;
+            value[i] ^= c;
+        }
+    }
+    return true;
+}
+
+DeltaStream::~DeltaStream() {
+    close();
+}
+
+void DeltaStream::open(const string& filename) {
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw X3DError("can't create delta stream: " + filename);
+    attach(fd);
+    owned = true;
+}
+
+void DeltaStream::attach(int fd) {
+    if (isOpen())
+        throw X3DError("delta stream already open");
+    this->fd = fd;
+    owned = false;
+    deltas = bytes = 0;
+    delta.bytes.clear();
+    delta.put(MAGIC);
+    delta.put(FORMAT_VERSION);
+    send(&delta.bytes[0], delta.bytes.size());
+    delta.bytes.clear();
+}
+
+void DeltaStream::close() {
+    if (owned)
+        ::close(fd);
+    fd = -1;
+    owned = false;
+    ids.clear();
+    previous.clear();
+    delta.bytes.clear();
+}
+
+void DeltaStream::record(unsigned int cascade, double time, const vector<Node*>& nodes) {
+    delta.bytes.clear();
+    delta.put<uint32_t>(0);
+    delta.put<uint32_t>(cascade);
+    delta.put(time);
+    size_t countAt = delta.bytes.size();
+    delta.put<uint32_t>(0);
+    uint32_t count = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node* node = nodes[i];
+        const vector<FieldDef*>& outputs = node->definition->outputs;
+        uint32_t nodeId = ids.id(node);
+        for (size_t j = 0; j < outputs.size(); j++) {
+            if (!node->isDirty(j))
+                continue;
+            delta.put(nodeId);
+            delta.put<uint8_t>(j);
+            write(outputs[j]->getField(node));
+            count++;
+        }
+    }
+    uint32_t length = delta.bytes.size() - sizeof(length);
+    memcpy(&delta.bytes[0], &length, sizeof(length));
+    memcpy(&delta.bytes[countAt], &count, sizeof(count));
+    send(&delta.bytes[0], delta.bytes.size());
+    deltas++;
+}
+
+void DeltaStream::write(SAIField* field) {
+    const X3DField& current = field->getSilently();
+    if (current.getType() < X3DField::MFBOOL) {
+        // single values go straight into the delta
+        delta.put<uint8_t>(FULL);
+        size_t start = delta.bytes.size();
+        delta.put<uint32_t>(0);
+        current.encode(delta);
+        uint32_t size = delta.bytes.size() - start - sizeof(size);
+        memcpy(&delta.bytes[start], &size, sizeof(size));
+        return;
+    }
+    value.bytes.clear();
+    current.encode(value);
+    vector<char>& now = value.bytes;
+    vector<char>& before = previous[field];
+    if (before.size() == now.size()) {
+        size_t start = delta.bytes.size();
+        delta.put<uint8_t>(XOR);
+        delta.put<uint32_t>(now.size());
+        if (putXor(delta.bytes, now, before, now.size())) {
+            before.swap(now);
+            return;
+        }
+        delta.bytes.resize(start);
+    }
+    delta.put<uint8_t>(FULL);
+    delta.put<uint32_t>(now.size());
+    delta.bytes.insert(delta.bytes.end(), now.begin(), now.end());
+    before.swap(now);
+}
+
+void DeltaStream::send(const char* data, size_t size) {
+    if (!isOpen())
+        throw X3DError("delta stream not open");
+    bytes += size;
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw X3DError("can't write delta stream");
+        data += n;
+        size -= n;
+    }
+}
+
+DeltaReader::~DeltaReader() {
+    close();
+}
+
+void DeltaReader::open(const string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw X3DError("can't read delta stream: " + filename);
+    try {
+        attach(fd);
+    } catch (X3DError& e) {
+        ::close(fd);
+        throw;
+    }
+    owned = true;
+}
+
+void DeltaReader::attach(int fd) {
+    if (isOpen())
+        throw X3DError("delta reader already open");
+    this->fd = fd;
+    owned = false;
+    uint32_t header[2];
+    if (!receive((char*) header, sizeof(header))
+            || header[0] != DeltaStream::MAGIC
+            || header[1] != DeltaStream::FORMAT_VERSION) {
+        this->fd = -1;
+        throw X3DError("not a delta stream");
+    }
+    deltas = 0;
+}
+
+void DeltaReader::close() {
+    if (owned)
+        ::close(fd);
+    fd = -1;
+    owned = false;
+    ids.clear();
+    previous.clear();
+    map<int, X3DField*>::iterator it;
+    for (it = values.begin(); it != values.end(); it++)
+        delete it->second;
+    values.clear();
+}
+
+bool DeltaReader::next() {
+    uint32_t length;
+    if (!receive((char*) &length, sizeof(length)))
+        return false;
+    delta.resize(length);
+    if (length > 0 && !receive(&delta[0], length))
+        throw X3DError("delta stream ends inside a delta");
+    apply(&delta[0], length);
+    return true;
+}
+
+void DeltaReader::apply(const char* data, size_t size) {
+    Decoder in(data, size);
+    uint32_t count;
+    if (!in.get(cascade) || !in.get(time) || !in.get(count))
+        throw X3DError("truncated delta");
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t id, length;
+        uint8_t index, encoding;
+        if (!in.get(id) || !in.get(index) || !in.get(encoding) || !in.get(length))
+            throw X3DError("truncated delta");
+        Node* n = ids.node(id);
+        if (index >= n->definition->outputs.size())
+            throw X3DError("no such output in delta");
+        SAIField* field = n->definition->outputs[index]->getField(n);
+        vector<char>& bytes = previous[((uint64_t) id << 8) | index];
+        if (encoding == DeltaStream::FULL) {
+            if (length > in.remaining())
+                throw X3DError("truncated delta");
+            bytes.resize(length);
+            if (length > 0)
+                in.read(&bytes[0], length);
+        } else if (encoding != DeltaStream::XOR || bytes.size() != length
+                   || !getXor(in, bytes)) {
+            throw X3DError("bad value in delta");
+        }
+        X3DField*& value = values[field->getType()];
+        if (value == NULL)
+            value = X3DField::create(field->getType());
+        Decoder valueIn(bytes.empty() ? NULL : &bytes[0], bytes.size());
+        if (!value->decode(valueIn))
+            throw X3DError("bad value in delta");
+        field->setSilently(*value);
+    }
+    deltas++;
+}
+
+bool DeltaReader::receive(char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+}
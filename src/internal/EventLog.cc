@@ -0,0 +1,285 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/EventLog.h"
+#include "internal/Browser.h"
+#include "internal/NodeDef.h"
+#include "internal/FieldDef.h"
+#include "internal/Trace.h"
+
+#include <cstdio>
+
+namespace X3D {
+
+EventRecorder::~EventRecorder() {
+    close();
+}
+
+void EventRecorder::open(const string& filename) {
+    if (isOpen())
+        throw X3DError("event log already open");
+    file = fopen(filename.c_str(), "wb");
+    if (file == NULL)
+        throw X3DError("can't create event log: " + filename);
+    this->filename = filename;
+    cascades = 0;
+    Browser* browser = Browser::getSingleton();
+    record.put(MAGIC);
+    record.put(FORMAT_VERSION);
+    record.put<uint32_t>(browser->cascade);
+    record.put(browser->simTime);
+    record.put<uint8_t>(browser->started);
+    flush();
+}
+
+void EventRecorder::close() {
+    if (file != NULL)
+        fclose(file);
+    file = NULL;
+    ids.clear();
+    sent.bytes.clear();
+    sentCount = 0;
+    record.bytes.clear();
+}
+
+void EventRecorder::wake(double time) {
+    record.put<uint8_t>(WAKE);
+    record.put(time);
+    flush();
+}
+
+void EventRecorder::send(SAIField* field, const X3DField& value) {
+    sent.put(ids.id(field->getNode()));
+    sent.putString(field->getName());
+    sent.put<uint8_t>(value.getType());
+    value.encode(sent);
+    sentCount++;
+}
+
+void EventRecorder::cascade(unsigned int cascade, double time,
+                            const vector<Node*>& nodes) {
+    record.put<uint8_t>(CASCADE);
+    record.put<uint32_t>(cascade);
+    record.put(time);
+    record.put(digest(ids, nodes));
+    flush();
+    cascades++;
+}
+
+uint32_t EventRecorder::digest(NodeIds& ids, const vector<Node*>& nodes) {
+    Digest digest;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node* node = nodes[i];
+        const vector<FieldDef*>& outputs = node->definition->outputs;
+        digest.put(ids.id(node));
+        for (size_t j = 0; j < outputs.size(); j++) {
+            if (!node->isDirty(j))
+                continue;
+            digest.put<uint8_t>(j);
+            outputs[j]->getField(node)->getSilently().encode(digest);
+        }
+    }
+    return digest.value;
+}
+
+void EventRecorder::write(Code code) {
+    record.put<uint8_t>(code);
+    record.put(sentCount);
+    record.write(sent.bytes.empty() ? NULL : &sent.bytes[0], sent.bytes.size());
+    sent.bytes.clear();
+    sentCount = 0;
+    flush();
+}
+
+void EventRecorder::flush() {
+    size_t size = record.bytes.size();
+    bool written = fwrite(&record.bytes[0], 1, size, file) == size;
+    record.bytes.clear();
+    if (!written)
+        throw X3DError("can't write event log: " + filename);
+}
+
+EventReplayer::~EventReplayer() {
+    close();
+}
+
+void EventReplayer::open(const string& filename) {
+    Browser* browser = Browser::getSingleton();
+    if (isOpen() || browser->replayer != NULL)
+        throw X3DError("event log already being replayed");
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
+        throw X3DError("can't read event log: " + filename);
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+        log.insert(log.end(), buf, buf + n);
+    fclose(file);
+
+    in = Decoder(log.empty() ? NULL : &log[0], log.size());
+    uint32_t magic, version, cascade;
+    double time;
+    uint8_t started;
+    if (!in.get(magic) || magic != EventRecorder::MAGIC
+            || !in.get(version) || version != EventRecorder::FORMAT_VERSION
+            || !in.get(cascade) || !in.get(time) || !in.get(started)) {
+        log.clear();
+        throw X3DError("not an event log: " + filename);
+    }
+    browser->cascade = cascade;
+    browser->simTime = time;
+    browser->started = started;
+    browser->replayer = this;
+    cascades.clear();
+    checked = mismatches = 0;
+}
+
+void EventReplayer::close() {
+    Browser* browser = Browser::getSingleton();
+    if (browser->replayer == this)
+        browser->replayer = NULL;
+    // cascades the log doesn't hold don't match it
+    mismatches += cascades.size() - checked;
+    checked = cascades.size();
+    vector<char>().swap(log);
+    in = Decoder(NULL, 0);
+    ids.clear();
+    map<int, X3DField*>::iterator it;
+    for (it = values.begin(); it != values.end(); it++)
+        delete it->second;
+    values.clear();
+}
+
+bool EventReplayer::next() {
+    if (!isOpen() || in.remaining() == 0)
+        return false;
+    Browser* browser = Browser::getSingleton();
+    uint8_t code;
+    double time;
+    in.get(code);
+    switch (code) {
+    case EventRecorder::WAKE:
+        if (!in.get(time))
+            throw X3DError("truncated event log");
+        browser->wake(time);
+        break;
+    case EventRecorder::SIMULATE:
+        mark = Trace::clock();
+        send(false);
+        browser->simulate();
+        break;
+    case EventRecorder::UPDATE:
+        mark = Trace::clock();
+        browser->beginUpdate();
+        send(true);
+        browser->endUpdate();
+        break;
+    case EventRecorder::CASCADE:
+        check();
+        break;
+    default:
+        throw X3DError("bad record in event log");
+    }
+    return true;
+}
+
+bool EventReplayer::run() {
+    while (next())
+        ;
+    close();
+    return mismatches == 0;
+}
+
+void EventReplayer::cascade(unsigned int cascade, double time,
+                            const vector<Node*>& nodes) {
+    Cascade c;
+    c.cascade = cascade;
+    c.time = time;
+    c.nanoseconds = Trace::clock() - mark;
+    c.digest = EventRecorder::digest(ids, nodes);
+    c.matched = false;
+    cascades.push_back(c);
+    // the digest isn't part of the next cascade's time
+    mark = Trace::clock();
+}
+
+void EventReplayer::send(bool updating) {
+    Browser* browser = Browser::getSingleton();
+    uint32_t count;
+    if (!in.get(count))
+        throw X3DError("truncated event log");
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t id;
+        string name;
+        uint8_t type;
+        if (!in.get(id) || !in.getString(name) || !in.get(type))
+            throw X3DError("truncated event log");
+        SAIField* field = ids.node(id)->getField(name);
+        if (field == NULL || field->getType() != type)
+            throw X3DError("no such field in event log: " + name);
+        X3DField*& value = values[type];
+        if (value == NULL)
+            value = X3DField::create(field->getType());
+        if (!value->decode(in))
+            throw X3DError("bad value in event log");
+        if (updating)
+            field->set(*value);
+        else
+            browser->injections.inject(field, *value);
+    }
+}
+
+void EventReplayer::check() {
+    uint32_t cascade, digest;
+    double time;
+    if (!in.get(cascade) || !in.get(time) || !in.get(digest))
+        throw X3DError("truncated event log");
+    if (checked == cascades.size()) {
+        // the log holds a cascade the replay didn't run
+        mismatches++;
+        return;
+    }
+    Cascade& c = cascades[checked++];
+    c.matched = c.cascade == cascade && c.time == time && c.digest == digest;
+    if (!c.matched)
+        mismatches++;
+}
+
+void EventReplayer::print(ostream& os, bool each) const {
+    char buf[160];
+    uint64_t total = 0, slowest = 0;
+    for (size_t i = 0; i < cascades.size(); i++) {
+        const Cascade& c = cascades[i];
+        if (each) {
+            sprintf(buf, "%8u %12.6f %12.3fus  %08x%s", c.cascade, c.time,
+                c.nanoseconds / 1000.0, c.digest, c.matched ? "" : "  MISMATCH");
+            os << buf << std::endl;
+        }
+        total += c.nanoseconds;
+        if (c.nanoseconds > slowest)
+            slowest = c.nanoseconds;
+    }
+    sprintf(buf, "%lu cascades, %.3fms total, %.3fus mean, %.3fus slowest, "
+                 "%lu mismatched",
+        (unsigned long) cascades.size(), total / 1e6,
+        cascades.empty() ? 0 : total / 1e3 / cascades.size(), slowest / 1e3,
+        (unsigned long) mismatches);
+    os << buf << std::endl;
+}
+
+}
@@ -28,6 +28,11 @@ FieldIterator::FieldIterator(Node* node, IterMode mode) :
 }
 
 void FieldIterator::findNext() {
+    if (mode == DIRTY) {
+        output++;
+        findDirty();
+        return;
+    }
     while (++field_it != def->field_list.end())
         if (filter())
             return;
@@ -52,16 +57,28 @@ bool FieldIterator::filter() {
             return (fieldDef->access == SAIField::INIT_ONLY)
                 || (fieldDef->access == SAIField::INPUT_OUTPUT);
         case ALL: return true;
-        case DIRTY:
-            SAIField* field = fieldDef->getField(node);
-            return field->isDirty();
+        case DIRTY: break; // see findDirty()
     }
+    return false;
+}
+
+FieldDef* FieldIterator::currentDef() const {
+    if (mode == DIRTY)
+        return node->definition->outputs[output];
+    return *field_it;
+}
+
+void FieldIterator::findDirty() {
+    const vector<FieldDef*>& outputs = node->definition->outputs;
+    while (output < outputs.size() && !node->isDirty(output))
+        output++;
+    atEnd = (output == outputs.size());
 }
 
 SAIField* FieldIterator::nextField() {
     if (atEnd)
         return NULL;
-    SAIField* field = (*field_it)->getField(node);
+    SAIField* field = currentDef()->getField(node);
     findNext();
     return field;
 }
@@ -69,7 +86,7 @@ SAIField* FieldIterator::nextField() {
 FieldDef* FieldIterator::nextFieldDef() {
     if (atEnd)
         return NULL;
-    FieldDef* def = *field_it;
+    FieldDef* def = currentDef();
     findNext();
     return def;
 }
@@ -79,6 +96,11 @@ bool FieldIterator::hasNext() const {
 }
 
 void FieldIterator::reset() {
+    if (mode == DIRTY) {
+        output = 0;
+        findDirty();
+        return;
+    }
     chain_it = node->definition->chain.begin();
     def = *chain_it;
     field_it = def->field_list.begin();
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/FramePipeline.h"
+#include "internal/Route.h"
+
+namespace X3D {
+
+FramePipeline::~FramePipeline() {
+    clear();
+}
+
+void FramePipeline::commit(const vector<SAIField*>& fields) {
+    committed.clear();
+    for (size_t i = 0; i < fields.size(); i++) {
+        SAIField* field = fields[i];
+        if (!field->hasOutgoingRoutes()
+                && !(field->flags & (SAIField::WATCHED | SAIField::SUBSCRIBED)))
+            continue;
+        X3DField*& buffer = buffers[field];
+        if (buffer == NULL)
+            buffer = X3DField::create(field->getType());
+        (*buffer)(field->getSilently());
+        committed.push_back(Commit(field, buffer));
+    }
+    frame++;
+}
+
+void FramePipeline::deliver() {
+    for (size_t i = 0; i < committed.size(); i++) {
+        const list<Route*>& routes = committed[i].first->getOutgoingRoutes();
+        list<Route*>::const_iterator it;
+        for (it = routes.begin(); it != routes.end(); it++)
+            (*it)->deliver(*committed[i].second);
+    }
+    committed.clear();
+}
+
+void FramePipeline::release(SAIField* field) {
+    map<SAIField*, X3DField*>::iterator found = buffers.find(field);
+    if (found == buffers.end())
+        return;
+    for (size_t i = 0; i < committed.size(); i++) {
+        if (committed[i].first == field) {
+            committed.erase(committed.begin() + i);
+            break;
+        }
+    }
+    delete found->second;
+    buffers.erase(found);
+}
+
+const X3DField* FramePipeline::getCommitted(SAIField* field) const {
+    map<SAIField*, X3DField*>::const_iterator found = buffers.find(field);
+    return found == buffers.end() ? NULL : found->second;
+}
+
+void FramePipeline::clear() {
+    map<SAIField*, X3DField*>::iterator it;
+    for (it = buffers.begin(); it != buffers.end(); it++)
+        delete it->second;
+    buffers.clear();
+    committed.clear();
+    frame = 0;
+}
+
+}
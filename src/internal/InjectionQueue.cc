@@ -0,0 +1,147 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/InjectionQueue.h"
+#include "internal/EventLog.h"
+#include "internal/Trace.h"
+
+#include <map>
+#include <vector>
+
+namespace X3D {
+
+InjectionQueue::InjectionQueue() : head(&stub), tail(&stub), depth(0) {
+    stub.next = NULL;
+}
+
+InjectionQueue::~InjectionQueue() {
+    clear();
+}
+
+void InjectionQueue::check(SAIField* field, const X3DField& value) {
+    SAIField::Access access = field->getAccess();
+    if (access != SAIField::INPUT_ONLY && access != SAIField::INPUT_OUTPUT)
+        throw X3DError("injected field does not take input");
+    if (field->getType() != value.getType())
+        throw X3DError("injected value type mismatch");
+}
+
+void InjectionQueue::inject(SAIField* field, const X3DField& value) {
+    check(field, value);
+    Entry* entry = new Entry();
+    entry->field = field;
+    entry->value = X3DField::create(value.getType());
+    (*entry->value)(value);
+    entry->time = now();
+    atomicAdd(&depth, (size_t) 1);
+    push(entry);
+}
+
+uint64_t InjectionQueue::now() {
+    return Trace::clock();
+}
+
+void InjectionQueue::push(Entry* entry) {
+    atomicStore(&entry->next, (Entry*) NULL);
+    Entry* prev = atomicExchange(&head, entry);
+    atomicStore(&prev->next, entry);
+}
+
+InjectionQueue::Entry* InjectionQueue::pop() {
+    Entry* last = tail;
+    Entry* next = atomicLoad(&last->next);
+    if (last == &stub) {
+        if (next == NULL)
+            return NULL;
+        tail = last = next;
+        next = atomicLoad(&next->next);
+    }
+    if (next != NULL) {
+        tail = next;
+        return last;
+    }
+    // the last entry may only be taken with the stub behind it
+    if (last != atomicLoad(&head))
+        return NULL;
+    push(&stub);
+    next = atomicLoad(&last->next);
+    if (next == NULL)
+        return NULL;
+    tail = next;
+    return last;
+}
+
+size_t InjectionQueue::drain(EventRecorder* recorder) {
+    std::vector<Entry*> batch;
+    Entry* entry;
+    while ((entry = pop()) != NULL)
+        batch.push_back(entry);
+    if (batch.empty())
+        return 0;
+    atomicAdd(&depth, (size_t) 0 - batch.size());
+    if (batch.size() > stats.maxDepth)
+        stats.maxDepth = batch.size();
+    uint64_t time = now();
+    for (size_t i = 0; i < batch.size(); i++) {
+        uint64_t latency = time - batch[i]->time;
+        stats.totalLatency += latency;
+        if (latency > stats.maxLatency)
+            stats.maxLatency = latency;
+    }
+
+    // keep the last entry of each field, in order of first appearance
+    std::map<SAIField*, size_t> latest;
+    std::vector<Entry*> send;
+    for (size_t i = 0; i < batch.size(); i++) {
+        entry = batch[i];
+        std::pair<std::map<SAIField*, size_t>::iterator, bool> found =
+            latest.insert(std::make_pair(entry->field, send.size()));
+        if (found.second) {
+            send.push_back(entry);
+            continue;
+        }
+        Entry*& kept = send[found.first->second];
+        delete kept->value;
+        delete kept;
+        kept = entry;
+        stats.coalesced++;
+    }
+
+    for (size_t i = 0; i < send.size(); i++) {
+        if (recorder != NULL)
+            recorder->send(send[i]->field, *send[i]->value);
+        send[i]->field->set(*send[i]->value);
+        delete send[i]->value;
+        delete send[i];
+    }
+    stats.applied += send.size();
+    return send.size();
+}
+
+void InjectionQueue::clear() {
+    Entry* entry;
+    while ((entry = pop()) != NULL) {
+        delete entry->value;
+        delete entry;
+    }
+    atomicStore(&depth, (size_t) 0);
+    stats = Stats();
+}
+
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/MemoryReport.h"
+#include "internal/NodeDef.h"
+#include "internal/FieldIterator.h"
+#include "internal/Route.h"
+#include "Grouping/StaticGroup.h"
+
+#include <cstdio>
+#include <list>
+#include <vector>
+#include <algorithm>
+
+using X3D::Grouping::StaticGroup;
+
+namespace X3D {
+
+/// bytes of one entry in a route list
+static const size_t routeEntryBytes = sizeof(Route*) + 2 * sizeof(void*);
+
+void MemoryReport::add(Node* node) {
+    NodeDef* def = node->definition;
+    Entry& type = nodeTypes[def->name];
+    type.count++;
+    type.bytes += def->getSize();
+    FieldIterator it(node, FieldIterator::ALL);
+    while (it.hasNext()) {
+        FieldDef* fieldDef = it.nextFieldDef();
+        SAIField* field = fieldDef->getField(node);
+        Entry& entry = fieldTypes[X3DField::getTypeName(fieldDef->type)];
+        entry.count++;
+        entry.bytes += fieldDef->size;
+        entry.valueBytes += fieldDef->valueSize;
+        type.valueBytes += fieldDef->valueSize;
+        if (fieldDef->access != SAIField::INPUT_ONLY) {
+            size_t heap = field->getSilently().heapBytes();
+            entry.heapBytes += heap;
+            type.heapBytes += heap;
+        }
+        size_t in = field->getIncomingRoutes().size();
+        size_t out = field->getOutgoingRoutes().size();
+        routeLists.heapBytes += (in + out) * routeEntryBytes;
+        routes.count += out;
+        routes.bytes += out * sizeof(Route);
+    }
+    StaticGroup* group = nodeCast<StaticGroup>(node);
+    if (group != NULL && group->isCompiled())
+        type.heapBytes += group->getCompiled()->getBytes();
+}
+
+size_t MemoryReport::nodeCount() const {
+    size_t count = 0;
+    map<string, Entry>::const_iterator it;
+    for (it = nodeTypes.begin(); it != nodeTypes.end(); it++)
+        count += it->second.count;
+    return count;
+}
+
+size_t MemoryReport::totalBytes() const {
+    size_t bytes = routes.total() + routeLists.total();
+    map<string, Entry>::const_iterator it;
+    for (it = nodeTypes.begin(); it != nodeTypes.end(); it++)
+        bytes += it->second.total();
+    return bytes;
+}
+
+typedef std::pair<string, MemoryReport::Entry> Named;
+
+static bool byTotal(const Named& a, const Named& b) {
+    return a.second.total() > b.second.total();
+}
+
+/// print one table row
+static void printRow(ostream& os, const string& name, const MemoryReport::Entry& e) {
+    char buf[128];
+    sprintf(buf, "%-24s %9lu %12lu %12lu %12lu %12lu\n", name.c_str(),
+        (unsigned long) e.count, (unsigned long) e.bytes,
+        (unsigned long) e.valueBytes, (unsigned long) (e.bytes - e.valueBytes),
+        (unsigned long) e.heapBytes);
+    os << buf;
+}
+
+/// print a table header
+static void printHeader(ostream& os, const char* title) {
+    char buf[128];
+    sprintf(buf, "%-24s %9s %12s %12s %12s %12s\n",
+        title, "count", "bytes", "value", "overhead", "heap");
+    os << buf;
+}
+
+void MemoryReport::print(ostream& os, size_t n) const {
+    char buf[128];
+    sprintf(buf, "%lu nodes, %lu routes, %lu bytes\n\n",
+        (unsigned long) nodeCount(), (unsigned long) routes.count,
+        (unsigned long) totalBytes());
+    os << buf;
+
+    std::vector<Named> types(nodeTypes.begin(), nodeTypes.end());
+    std::stable_sort(types.begin(), types.end(), byTotal);
+    printHeader(os, "node type");
+    for (size_t i = 0; i < types.size() && i < n; i++)
+        printRow(os, types[i].first, types[i].second);
+
+    os << "\n";
+    printHeader(os, "field type");
+    std::vector<Named> fields(fieldTypes.begin(), fieldTypes.end());
+    std::stable_sort(fields.begin(), fields.end(), byTotal);
+    for (size_t i = 0; i < fields.size(); i++)
+        printRow(os, fields[i].first, fields[i].second);
+
+    os << "\n";
+    printRow(os, "routes", routes);
+    printRow(os, "route lists", routeLists);
+}
+
+/// write an entry's members as JSON
+static void writeEntry(ostream& os, const MemoryReport::Entry& e) {
+    os << "\"count\":" << e.count << ",\"bytes\":" << e.bytes
+       << ",\"valueBytes\":" << e.valueBytes << ",\"heapBytes\":" << e.heapBytes;
+}
+
+/// write a map of entries as a JSON array
+static void writeEntries(ostream& os, const map<string, MemoryReport::Entry>& entries) {
+    os << "[";
+    map<string, MemoryReport::Entry>::const_iterator it;
+    for (it = entries.begin(); it != entries.end(); it++) {
+        os << (it == entries.begin() ? "\n" : ",\n") << "{\"name\":\"";
+        const string& name = it->first;
+        for (size_t c = 0; c < name.size(); c++) {
+            if (name[c] == '"' || name[c] == '\\')
+                os << '\\';
+            os << name[c];
+        }
+        os << "\",";
+        writeEntry(os, it->second);
+        os << "}";
+    }
+    os << "\n]";
+}
+
+void MemoryReport::writeJson(ostream& os) const {
+    os << "{\"nodes\":" << nodeCount() << ",\"totalBytes\":" << totalBytes()
+       << ",\n\"routes\":{";
+    writeEntry(os, routes);
+    os << "},\n\"routeLists\":{";
+    writeEntry(os, routeLists);
+    os << "},\n\"nodeTypes\":";
+    writeEntries(os, nodeTypes);
+    os << ",\n\"fieldTypes\":";
+    writeEntries(os, fieldTypes);
+    os << "}\n";
+}
+
+}
@@ -12,6 +12,12 @@ void Node::dispose() {
         it.nextField()->dispose();
 }
 
+void* Node::getSubobject(const void* tag) const {
+    if (!exact)
+        return NULL;
+    return definition->getSubobject(this, tag);
+}
+
 Browser* Node::browser() {
 	return Browser::getSingleton();
 }
@@ -32,6 +38,10 @@ void Node::queue(SAIField* field) {
     browser()->addDirtyField(field);
 }
 
+void Node::markDirty() {
+    browser()->addDirtyNode(this);
+}
+
 void Node::cloneInto(Node* target, map<Node*,Node*>* mapping, bool shallow) {
     if (mapping != NULL)
         (*mapping)[this] = target;
@@ -19,6 +19,9 @@
 
 #include "internal/Browser.h"
 #include "internal/Component.h"
+#include "Core/X3DBindableNode.h"
+#include "Grouping/X3DGroupingNode.h"
+#include "Interpolation/X3DInterpolatorNode.h"
 
 #include <iostream>
 
@@ -57,9 +60,52 @@ void NodeDef::inherits(const string& name) {
 
 void NodeDef::finish() {
     chain.push_back(this);
+
+    // find where each ancestor's class lies within this one, so that
+    // nodes can be converted to any of them without RTTI
+    Node* probe = getProbe();
+    offsets.clear();
+    list<NodeDef*>::reverse_iterator it;
+    for (it = chain.rbegin(); it != chain.rend(); it++) {
+        Offset offset;
+        offset.tag = (*it)->getTag();
+        if ((*it)->findOffset(probe, offset.offset))
+            offsets.push_back(offset);
+    }
+
+    // number the output fields, so nodes can keep their dirty
+    // fields in a bit mask
+    outputs.clear();
+    list<NodeDef*>::iterator c_it;
+    for (c_it = chain.begin(); c_it != chain.end(); c_it++) {
+        list<FieldDef*>::iterator f_it;
+        for (f_it = (*c_it)->field_list.begin(); f_it != (*c_it)->field_list.end(); f_it++)
+            if ((*f_it)->outputCapable())
+                outputs.push_back(*f_it);
+    }
+    if (outputs.size() > Node::MAX_OUTPUTS)
+        throw X3DError(string("too many output fields in ") + name);
+
+    capabilities = 0;
+    if (dynamic_cast<X3DSensorNode*>(probe) != NULL)
+        capabilities |= SENSOR;
+    if (dynamic_cast<X3DTimeDependentNode*>(probe) != NULL)
+        capabilities |= TIME_DEPENDENT;
+    if (dynamic_cast<Core::X3DBindableNode*>(probe) != NULL)
+        capabilities |= BINDABLE;
+    if (dynamic_cast<Grouping::X3DGroupingNode*>(probe) != NULL)
+        capabilities |= GROUPING;
+    if (dynamic_cast<Interpolation::X3DInterpolatorNode*>(probe) != NULL)
+        capabilities |= INTERPOLATOR;
+
     finished = true;
 }
 
+void NodeDef::indexOutputs(Node* node) {
+    for (size_t i = 0; i < outputs.size(); i++)
+        outputs[i]->getField(node)->index = i;
+}
+
 void NodeDef::growChain(NodeDef* def) {
     list<NodeDef*>::iterator c_it = chain.begin();
     for (; c_it != chain.end(); c_it++)
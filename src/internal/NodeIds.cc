@@ -0,0 +1,81 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/NodeIds.h"
+#include "internal/Browser.h"
+
+namespace X3D {
+
+uint32_t NodeIds::id(Node* node) {
+    uint32_t id = find(node).id;
+    if (id != ~0u)
+        return id;
+    // nodes are only ever added to the end of the list, so renumbering
+    // gives the old nodes the same ids
+    const list<Node*>& all = Browser::getSingleton()->getNodes();
+    list<Node*>::const_iterator it = all.begin();
+    for (uint32_t n = 0; it != all.end(); it++, n++)
+        find(*it).id = n;
+    id = find(node).id;
+    if (id == ~0u)
+        throw X3DError("node not managed by the browser");
+    return id;
+}
+
+Node* NodeIds::node(uint32_t id) {
+    if (id >= nodes.size()) {
+        const list<Node*>& all = Browser::getSingleton()->getNodes();
+        nodes.assign(all.begin(), all.end());
+        if (id >= nodes.size())
+            throw X3DError("no such node id");
+    }
+    return nodes[id];
+}
+
+void NodeIds::clear() {
+    ids.clear();
+    count = 0;
+    nodes.clear();
+}
+
+NodeIds::Entry& NodeIds::find(Node* node) {
+    if (2 * (count + 1) > ids.size()) {
+        vector<Entry> old(ids.size() < 16 ? 16 : 2 * ids.size());
+        old.swap(ids);
+        count = 0;
+        for (size_t i = 0; i < old.size(); i++)
+            if (old[i].node != NULL)
+                find(old[i].node) = old[i];
+    }
+    size_t mask = ids.size() - 1;
+    // nodes of one type sit at even strides; fold in the high bits of
+    // the product, since its low bits only see the address's low bits
+    size_t h = ((size_t) node >> 4) * 2654435761u;
+    size_t i = (h ^ (h >> 16)) & mask;
+    while (ids[i].node != node) {
+        if (ids[i].node == NULL) {
+            ids[i].node = node;
+            count++;
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return ids[i];
+}
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/Profiler.h"
+#include "internal/NodeDef.h"
+#include "internal/Route.h"
+#include "internal/Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace X3D {
+
+Profiler* Profiler::active = NULL;
+
+/// order results by decreasing exclusive time
+static bool byExclusive(const Profiler::Stat& a, const Profiler::Stat& b) {
+    return a.exclusive > b.exclusive;
+}
+
+static const char* categoryNames[] = { "cascade", "route", "type", "node" };
+
+Profiler::Profiler() :
+        droppedSpans(0), baseTicks(0), baseClock(0), maxSpans(1 << 20) {
+    cascadeStat.name = "Browser::route";
+    cascadeStat.category = CASCADE;
+}
+
+Profiler::~Profiler() {
+    if (active == this)
+        active = NULL;
+}
+
+void Profiler::enable() {
+    if (baseTicks == 0) {
+        baseClock = Trace::clock();
+        baseTicks = Trace::ticks();
+    }
+    active = this;
+}
+
+void Profiler::disable() {
+    if (active == this)
+        active = NULL;
+}
+
+void Profiler::clear() {
+    if (!frames.empty())
+        throw X3DError("can't clear profiler while timing");
+    stats.clear();
+    retired.clear();
+    spans.clear();
+    droppedSpans = 0;
+    Stat empty;
+    empty.name = cascadeStat.name;
+    cascadeStat = empty;
+    baseTicks = baseClock = 0;
+    if (active == this) {
+        baseClock = Trace::clock();
+        baseTicks = Trace::ticks();
+    }
+}
+
+void Profiler::retireScene() {
+    if (!frames.empty())
+        return;
+    map<const void*, Stat>::iterator it = stats.begin();
+    while (it != stats.end()) {
+        if (it->second.category == NODE || it->second.category == ROUTE) {
+            retired.push_back(it->second);
+            stats.erase(it++);
+        } else {
+            it++;
+        }
+    }
+    // spans point into the map, so the ones for retired entries must go
+    spans.clear();
+}
+
+void Profiler::enter(Stat* stat, Stat* extra) {
+    Frame frame;
+    frame.stat = stat;
+    frame.extra = extra;
+    frame.child = 0;
+    frame.start = Trace::ticks();
+    frames.push_back(frame);
+}
+
+void Profiler::enterCascade() {
+    enter(&cascadeStat, NULL);
+}
+
+void Profiler::enterRoute(const Route* route) {
+    Stat& stat = stats[route];
+    if (stat.count == 0) {
+        stat.name = route->describe();
+        stat.category = ROUTE;
+    }
+    enter(&stat, NULL);
+}
+
+void Profiler::enterNode(Node* node) {
+    NodeDef* def = node->definition;
+    Stat& type = stats[def];
+    if (type.count == 0) {
+        type.name = def->name;
+        type.category = NODE_TYPE;
+    }
+    Stat* named = NULL;
+    if (!node->getName().empty()) {
+        named = &stats[node];
+        if (named->count == 0) {
+            named->name = node->getName();
+            named->category = NODE;
+        }
+    }
+    enter(&type, named);
+}
+
+void Profiler::leave() {
+    if (frames.empty())
+        return;
+    Frame& frame = frames.back();
+    uint64_t end = Trace::ticks();
+    uint64_t inclusive = end - frame.start;
+    uint64_t exclusive = inclusive > frame.child ? inclusive - frame.child : 0;
+    Stat* targets[2] = { frame.stat, frame.extra };
+    for (int i = 0; i < 2; i++) {
+        if (targets[i] == NULL)
+            continue;
+        targets[i]->count++;
+        targets[i]->inclusive += inclusive;
+        targets[i]->exclusive += exclusive;
+    }
+    if (spans.size() < maxSpans) {
+        Span span;
+        span.stat = frame.extra != NULL ? frame.extra : frame.stat;
+        span.start = frame.start;
+        span.duration = inclusive;
+        span.depth = frames.size() - 1;
+        spans.push_back(span);
+    } else {
+        droppedSpans++;
+    }
+    frames.pop_back();
+    if (!frames.empty())
+        frames.back().child += inclusive;
+}
+
+double Profiler::tickScale() const {
+    uint64_t ticks = Trace::ticks(), clock = Trace::clock();
+    if (baseTicks == 0 || ticks <= baseTicks || clock <= baseClock)
+        return 1;
+    return (double) (clock - baseClock) / (ticks - baseTicks);
+}
+
+void Profiler::getResults(vector<Stat>& results) const {
+    results.clear();
+    if (cascadeStat.count > 0)
+        results.push_back(cascadeStat);
+    map<const void*, Stat>::const_iterator it;
+    for (it = stats.begin(); it != stats.end(); it++)
+        results.push_back(it->second);
+    results.insert(results.end(), retired.begin(), retired.end());
+    double scale = tickScale();
+    for (size_t i = 0; i < results.size(); i++) {
+        results[i].inclusive = (uint64_t) (results[i].inclusive * scale);
+        results[i].exclusive = (uint64_t) (results[i].exclusive * scale);
+    }
+    std::stable_sort(results.begin(), results.end(), byExclusive);
+}
+
+void Profiler::report(ostream& os, size_t n) const {
+    vector<Stat> results;
+    getResults(results);
+    char buf[128];
+    sprintf(buf, "%-8s %10s %12s %12s %10s  %s\n",
+        "kind", "count", "excl(ms)", "incl(ms)", "avg(us)", "name");
+    os << buf;
+    for (size_t i = 0; i < results.size() && i < n; i++) {
+        const Stat& s = results[i];
+        sprintf(buf, "%-8s %10llu %12.3f %12.3f %10.3f  ",
+            categoryNames[s.category], (unsigned long long) s.count,
+            s.exclusive / 1e6, s.inclusive / 1e6,
+            s.count ? s.inclusive / 1e3 / s.count : 0.0);
+        os << buf << s.name << "\n";
+    }
+}
+
+void Profiler::writeChromeTrace(ostream& os) const {
+    double scale = tickScale();
+    uint64_t start = spans.empty() ? 0 : spans[0].start;
+    for (size_t i = 1; i < spans.size(); i++)
+        if (spans[i].start < start)
+            start = spans[i].start;
+    char buf[128];
+    os << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span& span = spans[i];
+        os << (i ? ",\n" : "") << "{\"name\":\"";
+        const string& name = span.stat->name;
+        for (size_t c = 0; c < name.size(); c++) {
+            if (name[c] == '"' || name[c] == '\\')
+                os << '\\';
+            os << name[c];
+        }
+        sprintf(buf, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"pid\":1,\"tid\":1}",
+            categoryNames[span.stat->category],
+            (span.start - start) * scale / 1e3, span.duration * scale / 1e3);
+        os << buf;
+    }
+    os << "\n],\"otherData\":{\"droppedSpans\":" << droppedSpans << "}}\n";
+}
+
+}
@@ -34,7 +34,7 @@ string Prototype::createTempName() {
 void Prototype::addNode(Node* node) {
     nodes.push_back(node);
     if (!node->getName().empty())
-        defs[node->getName()] = node;
+        defs.define(node->getName(), node);
 }
 
 void Prototype::addField(ProtoField* field) {
@@ -52,12 +52,12 @@ void Prototype::addConnection(Route* route) {
 
 void Prototype::addRoute(const string& fromNode, const string& fromField,
                          const string& toNode, const string& toField) {
-    if (!defs.count(fromNode))
+    Node* from = defs.lookupLocal(fromNode);
+    if (from == NULL)
         throw X3DError(string("prototype has no source node: ") + fromNode);
-    if (!defs.count(toNode))
+    Node* to = defs.lookupLocal(toNode);
+    if (to == NULL)
         throw X3DError(string("prototype has no target node: ") + toNode);
-    Node* from = defs[fromNode];
-    Node* to = defs[toNode];
     Route* route = new Route(from, fromField, to, toField);
     routes.push_back(route);
 }
@@ -17,17 +17,16 @@
  * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "internal/NodeDef.h"
+#include "internal/Browser.h"
 #include "internal/Route.h"
 
-#include <iostream>
 #include <sstream>
 using std::ostringstream;
-using std::cout;
-using std::endl;
 
 namespace X3D {
 
+unsigned int Route::nextId = 0;
+
 void Route::checkTypes() {
     FieldDef* def = toField->definition;
     if (fromField->getType() != toField->getType()) {
@@ -42,31 +41,42 @@ void Route::checkTypes() {
 void Route::activate() const {
     if (!fromField->isDirty())
         return;
-    const X3DField& value = fromField->get();
-    //logEvent(value);
+    deliver(fromField->get());
+}
+
+void Route::deliver(const X3DField& value) const {
+    ProfilerScope scope(this);
+    Browser* browser = Browser::getSingleton();
+    if (browser->trace.isEnabled())
+        browser->trace.record(
+            browser->getCascade(), browser->now(), id, value.digest());
     toField->set(value);
 }
 
-void Route::logEvent(const X3DField& value) const {
+string Route::describe() const {
+    ostringstream os;
     Node* node = fromField->getNode();
     const string& name1 = node->getName();
-    cout << "[" << node->definition->name << "] ";
-    cout << (name1.empty() ? "noname" : name1);
-    cout << "." << fromField->getName() << " --(";
-    cout << value << ")--> ";
+    os << "[" << node->definition->name << "] ";
+    os << (name1.empty() ? "noname" : name1);
+    os << "." << fromField->getName() << " -> ";
     node = toField->getNode();
     const string& name2 = node->getName();
-    cout << (name2.empty() ? "noname" : name2);
-    cout << "." << toField->getName() << " [";
-    cout << node->definition->name << "]" << endl;
+    os << (name2.empty() ? "noname" : name2);
+    os << "." << toField->getName() << " [";
+    os << node->definition->name << "]";
+    return os.str();
 }
 
 void Route::remove() {
     fromField->removeOutgoingRoute(this);
     toField->removeIncomingRoute(this);
+    Browser::getSingleton()->routeGraph.removeRoute(this);
 }
 
 void Route::insert() {
+    if ((fromField->flags | toField->flags) & SAIField::FROZEN)
+        throw X3DError("can't route a field in a compiled StaticGroup");
     const list<Route*>& outs = fromField->getOutgoingRoutes();
     list<Route*>::const_iterator it;
     for (it = outs.begin(); it != outs.end(); it++) {
@@ -77,6 +87,7 @@ void Route::insert() {
     toField->getNode()->realize();
     fromField->addOutgoingRoute(this);
     toField->addIncomingRoute(this);
+    Browser::getSingleton()->routeGraph.addRoute(this);
 }
 
 }
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/RouteGraph.h"
+#include "internal/NodeDef.h"
+#include "internal/FieldIterator.h"
+#include "internal/Route.h"
+
+#include <cstdio>
+
+namespace X3D {
+
+const size_t RouteGraph::NONE;
+
+/// capabilities of nodes whose inputs have no effect but their outputs
+static const unsigned int PURE =
+    NodeDef::SENSOR | NodeDef::TIME_DEPENDENT | NodeDef::INTERPOLATOR;
+
+/// @returns whether something other than routes can see the node's events
+static bool isSeen(Node* node) {
+    NodeDef* def = node->definition;
+    if (!def->is((NodeDef::Capability) PURE))
+        return true;
+    for (size_t i = 0; i < def->outputs.size(); i++) {
+        SAIField* field = def->outputs[i]->getField(node);
+        if (field->flags & (SAIField::WATCHED | SAIField::SUBSCRIBED))
+            return true;
+    }
+    return false;
+}
+
+/// a vertex being visited by the strongly connected components search
+struct Frame {
+    size_t vertex;
+    size_t edge;
+    Frame(size_t vertex) : vertex(vertex), edge(0) {}
+};
+
+void RouteGraph::analyze(const list<Node*>& nodes) {
+    clear();
+
+    // number the routed nodes and collect the edges between them
+    vector< vector<size_t> > edges;
+    list<Node*>::const_iterator n_it;
+    for (n_it = nodes.begin(); n_it != nodes.end(); n_it++) {
+        Node* node = *n_it;
+        const vector<FieldDef*>& outputs = node->definition->outputs;
+        for (size_t i = 0; i < outputs.size(); i++) {
+            SAIField* field = outputs[i]->getField(node);
+            if (!field->hasOutgoingRoutes())
+                continue;
+            const list<Route*>& routes = field->getOutgoingRoutes();
+            list<Route*>::const_iterator r_it;
+            for (r_it = routes.begin(); r_it != routes.end(); r_it++) {
+                Node* endpoints[2] = { node, (*r_it)->toField->getNode() };
+                size_t ends[2];
+                for (int e = 0; e < 2; e++) {
+                    std::pair<map<Node*, size_t>::iterator, bool> found =
+                        index.insert(std::make_pair(endpoints[e], vertices.size()));
+                    if (found.second) {
+                        vertices.push_back(endpoints[e]);
+                        edges.resize(vertices.size());
+                    }
+                    ends[e] = found.first->second;
+                }
+                edges[ends[0]].push_back(ends[1]);
+                edgeCount++;
+            }
+        }
+    }
+
+    // find the strongly connected components with Tarjan's algorithm,
+    // kept iterative so long chains don't exhaust the call stack. Each
+    // component is found after every component it routes to.
+    size_t n = vertices.size();
+    vector<size_t> number(n, NONE), low(n), component(n, NONE);
+    vector<size_t> stack, members, starts;
+    vector<Frame> frames;
+    size_t counter = 0;
+    for (size_t root = 0; root < n; root++) {
+        if (number[root] != NONE)
+            continue;
+        number[root] = low[root] = counter++;
+        stack.push_back(root);
+        frames.push_back(Frame(root));
+        while (!frames.empty()) {
+            size_t v = frames.back().vertex;
+            if (frames.back().edge < edges[v].size()) {
+                size_t w = edges[v][frames.back().edge++];
+                if (number[w] == NONE) {
+                    number[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    frames.push_back(Frame(w));
+                } else if (component[w] == NONE && number[w] < low[v]) {
+                    low[v] = number[w];
+                }
+                continue;
+            }
+            frames.pop_back();
+            if (!frames.empty() && low[v] < low[frames.back().vertex])
+                low[frames.back().vertex] = low[v];
+            if (low[v] != number[v])
+                continue;
+            size_t w;
+            starts.push_back(members.size());
+            do {
+                w = stack.back();
+                stack.pop_back();
+                component[w] = starts.size() - 1;
+                members.push_back(w);
+            } while (w != v);
+        }
+    }
+    size_t count = starts.size();
+    starts.push_back(members.size());
+
+    // a component is live if any member is seen or routes to a live
+    // component, all of which were found before it
+    vector<bool> liveComponent(count, false);
+    for (size_t c = 0; c < count; c++) {
+        bool cyclic = starts[c + 1] - starts[c] > 1;
+        for (size_t m = starts[c]; m < starts[c + 1]; m++) {
+            size_t v = members[m];
+            if (!liveComponent[c] && isSeen(vertices[v]))
+                liveComponent[c] = true;
+            for (size_t e = 0; e < edges[v].size(); e++) {
+                size_t w = edges[v][e];
+                if (w == v)
+                    cyclic = true;
+                else if (component[w] != c && liveComponent[component[w]])
+                    liveComponent[c] = true;
+            }
+        }
+        if (cyclic) {
+            cycles.push_back(vector<Node*>());
+            for (size_t m = starts[c]; m < starts[c + 1]; m++)
+                cycles.back().push_back(vertices[members[m]]);
+        }
+    }
+
+    // rank components in the reverse of the order they were found
+    ranks.resize(n);
+    live.resize(n);
+    order.reserve(n);
+    for (size_t c = count; c-- > 0; ) {
+        for (size_t m = starts[c]; m < starts[c + 1]; m++) {
+            size_t v = members[m];
+            ranks[v] = count - 1 - c;
+            live[v] = liveComponent[c];
+            order.push_back(vertices[v]);
+            if (!live[v])
+                deadCount++;
+            markOutputs(vertices[v], pruning && !live[v]);
+        }
+    }
+    analyzed = true;
+}
+
+void RouteGraph::addRoute(const Route* route) {
+    if (!analyzed)
+        return;
+    Node* from = route->fromField->getNode();
+    Node* to = route->toField->getNode();
+    if (isLive(to))
+        revive(from);
+    if (stale)
+        return;
+    size_t a = rank(from), b = rank(to);
+    // an edge within a cycle, or down the order, leaves the order valid
+    if (a == NONE || b == NONE || a > b || from == to)
+        stale = true;
+    else
+        edgeCount++;
+}
+
+void RouteGraph::removeRoute(const Route* route) {
+    if (analyzed)
+        stale = true;
+}
+
+void RouteGraph::revive(Node* node) {
+    vector<Node*> work(1, node);
+    while (!work.empty()) {
+        Node* next = work.back();
+        work.pop_back();
+        map<Node*, size_t>::iterator found = index.find(next);
+        if (found == index.end()) {
+            // only the node itself can have been pruned when it was
+            // outside the graph; anything routed to it came later
+            if (next == node)
+                markOutputs(next, false);
+            continue;
+        }
+        size_t v = found->second;
+        if (live[v])
+            continue;
+        live[v] = true;
+        deadCount--;
+        markOutputs(next, false);
+        FieldIterator it(next, FieldIterator::INPUT);
+        while (it.hasNext()) {
+            const list<Route*>& routes = it.nextField()->getIncomingRoutes();
+            list<Route*>::const_iterator r_it;
+            for (r_it = routes.begin(); r_it != routes.end(); r_it++)
+                work.push_back((*r_it)->fromField->getNode());
+        }
+    }
+}
+
+size_t RouteGraph::rank(Node* node) const {
+    map<Node*, size_t>::const_iterator found = index.find(node);
+    return found == index.end() ? NONE : ranks[found->second];
+}
+
+bool RouteGraph::isLive(Node* node) const {
+    map<Node*, size_t>::const_iterator found = index.find(node);
+    return found == index.end() || live[found->second];
+}
+
+void RouteGraph::print(ostream& os) const {
+    char buf[128];
+    sprintf(buf, "%lu routed nodes, %lu routes, %lu cycles, %lu dead nodes%s\n",
+        (unsigned long) vertices.size(), (unsigned long) edgeCount,
+        (unsigned long) cycles.size(), (unsigned long) deadCount,
+        stale ? " (stale)" : "");
+    os << buf;
+    for (size_t c = 0; c < cycles.size(); c++) {
+        os << "cycle of " << cycles[c].size() << " nodes:\n";
+        for (size_t i = 0; i < cycles[c].size(); i++) {
+            Node* node = cycles[c][i];
+            const string& name = node->getName();
+            os << "    [" << node->definition->name << "] "
+               << (name.empty() ? "noname" : name) << "\n";
+        }
+    }
+}
+
+void RouteGraph::clear() {
+    index.clear();
+    vertices.clear();
+    ranks.clear();
+    live.clear();
+    order.clear();
+    cycles.clear();
+    edgeCount = 0;
+    deadCount = 0;
+    analyzed = false;
+    stale = false;
+}
+
+void RouteGraph::markOutputs(Node* node, bool pruned) {
+    const vector<FieldDef*>& outputs = node->definition->outputs;
+    for (size_t i = 0; i < outputs.size(); i++) {
+        SAIField* field = outputs[i]->getField(node);
+        if (pruned)
+            field->flags |= SAIField::PRUNED;
+        else
+            field->flags &= ~SAIField::PRUNED;
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/RouteTable.h"
+
+namespace X3D {
+
+const list<Route*> RouteTable::none;
+
+RouteTable::~RouteTable() {
+    clear();
+}
+
+unsigned int RouteTable::add() {
+    if (freeSlots.empty()) {
+        slots.push_back(new Links());
+        return slots.size();
+    }
+    unsigned int slot = freeSlots.back();
+    freeSlots.pop_back();
+    slots[slot - 1] = new Links();
+    return slot;
+}
+
+void RouteTable::remove(unsigned int slot) {
+    if (slot == 0 || slot > slots.size() || slots[slot - 1] == NULL)
+        throw X3DError("no such route table slot");
+    delete slots[slot - 1];
+    slots[slot - 1] = NULL;
+    freeSlots.push_back(slot);
+}
+
+size_t RouteTable::bytes() const {
+    return slots.capacity() * sizeof(Links*)
+         + freeSlots.capacity() * sizeof(unsigned int)
+         + size() * sizeof(Links);
+}
+
+void RouteTable::clear() {
+    vector<Links*>::iterator it;
+    for (it = slots.begin(); it != slots.end(); it++)
+        delete *it;
+    vector<Links*>().swap(slots);
+    vector<unsigned int>().swap(freeSlots);
+}
+
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/SAIClient.h"
+
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace X3D {
+
+/// queued bytes which make flush() go out from set()
+static const size_t SEND_SIZE = 65536;
+
+SAIClient::~SAIClient() {
+    close();
+}
+
+void SAIClient::connect(const string& path) {
+    if (isConnected())
+        throw X3DError("SAI client already connected");
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw X3DError("SAI socket path too long: " + path);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw X3DError("can't create SAI socket");
+    if (::connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+        close();
+        throw X3DError("can't connect to " + path);
+    }
+}
+
+void SAIClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    map<uint32_t, X3DField*>::iterator it;
+    for (it = values.begin(); it != values.end(); it++)
+        delete it->second;
+    values.clear();
+    types.clear();
+    output.bytes.clear();
+    input.clear();
+}
+
+uint32_t SAIClient::getNode(const string& name) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::GET_NODE);
+    output.put(id);
+    output.putString(name);
+    SAIProtocol::end(output, start);
+    vector<char> reply = call(id, SAIProtocol::NODE);
+    Decoder in(&reply[0], reply.size());
+    uint32_t node;
+    if (!in.get(node))
+        throw X3DError("truncated reply");
+    return node;
+}
+
+SAIClient::Field SAIClient::getField(uint32_t node, const string& name) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::GET_FIELD);
+    output.put(id);
+    output.put(node);
+    output.putString(name);
+    SAIProtocol::end(output, start);
+    vector<char> reply = call(id, SAIProtocol::FIELD);
+    Decoder in(&reply[0], reply.size());
+    Field field;
+    uint8_t type;
+    if (!in.get(field.handle) || !in.get(type) || !in.get(field.access))
+        throw X3DError("truncated reply");
+    field.type = (X3DField::Type) type;
+    types[field.handle] = field.type;
+    return field;
+}
+
+void SAIClient::set(uint32_t field, const X3DField& value) {
+    size_t start = SAIProtocol::begin(output, SAIProtocol::SET);
+    output.put(field);
+    value.encode(output);
+    SAIProtocol::end(output, start);
+    if (output.bytes.size() >= SEND_SIZE)
+        flush();
+}
+
+void SAIClient::get(uint32_t field, X3DField& value) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::GET);
+    output.put(id);
+    output.put(field);
+    SAIProtocol::end(output, start);
+    vector<char> reply = call(id, SAIProtocol::VALUE);
+    Decoder in(&reply[0], reply.size());
+    uint32_t handle;
+    if (!in.get(handle) || !value.decode(in))
+        throw X3DError("bad value in reply");
+}
+
+void SAIClient::subscribe(uint32_t field) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::SUBSCRIBE);
+    output.put(id);
+    output.put(field);
+    SAIProtocol::end(output, start);
+    call(id, SAIProtocol::OK);
+}
+
+void SAIClient::unsubscribe(uint32_t field) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::UNSUBSCRIBE);
+    output.put(id);
+    output.put(field);
+    SAIProtocol::end(output, start);
+    call(id, SAIProtocol::OK);
+}
+
+void SAIClient::createRoute(uint32_t from, uint32_t to) {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::CREATE_ROUTE);
+    output.put(id);
+    output.put(from);
+    output.put(to);
+    SAIProtocol::end(output, start);
+    call(id, SAIProtocol::OK);
+}
+
+void SAIClient::flush() {
+    if (output.bytes.empty())
+        return;
+    send(&output.bytes[0], output.bytes.size());
+    output.bytes.clear();
+}
+
+void SAIClient::sync() {
+    uint32_t id = nextId();
+    size_t start = SAIProtocol::begin(output, SAIProtocol::SYNC);
+    output.put(id);
+    SAIProtocol::end(output, start);
+    call(id, SAIProtocol::OK);
+}
+
+bool SAIClient::receive(int timeout) {
+    flush();
+    uint8_t op;
+    vector<char> body;
+    while (read(timeout, op, body)) {
+        if (op == SAIProtocol::NOTIFY) {
+            notify(body);
+            return true;
+        }
+        if (op == SAIProtocol::ERROR) {
+            Decoder in(&body[0], body.size());
+            uint32_t id;
+            in.get(id);
+            in.getString(error);
+            errors++;
+        }
+    }
+    return false;
+}
+
+const X3DField* SAIClient::value(uint32_t field) const {
+    map<uint32_t, X3DField*>::const_iterator it = values.find(field);
+    return it == values.end() ? NULL : it->second;
+}
+
+vector<char> SAIClient::call(uint32_t id, SAIProtocol::Op reply) {
+    flush();
+    uint8_t op;
+    vector<char> body;
+    while (read(-1, op, body)) {
+        if (op == SAIProtocol::NOTIFY) {
+            notify(body);
+            continue;
+        }
+        Decoder in(&body[0], body.size());
+        uint32_t replyId;
+        if (!in.get(replyId))
+            throw X3DError("truncated reply");
+        if (op == SAIProtocol::ERROR) {
+            string message;
+            in.getString(message);
+            if (replyId == id)
+                throw X3DError(message);
+            errors++;
+            error = message;
+            continue;
+        }
+        if (replyId != id)
+            continue;
+        if (op != reply)
+            throw X3DError("unexpected reply");
+        return vector<char>(body.begin() + sizeof(replyId), body.end());
+    }
+    throw X3DError("SAI connection closed");
+}
+
+bool SAIClient::read(int timeout, uint8_t& op, vector<char>& body) {
+    while (fd >= 0) {
+        size_t length = input.empty() ? 0 : SAIProtocol::frame(&input[0], input.size());
+        if (length != 0) {
+            op = input[sizeof(uint32_t)];
+            body.assign(input.begin() + sizeof(uint32_t) + 1,
+                        input.begin() + sizeof(uint32_t) + length);
+            input.erase(input.begin(), input.begin() + sizeof(uint32_t) + length);
+            return true;
+        }
+        struct pollfd p;
+        p.fd = fd;
+        p.events = POLLIN;
+        int ready = ::poll(&p, 1, timeout);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            return false;
+        char buf[65536];
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        input.insert(input.end(), buf, buf + n);
+    }
+    return false;
+}
+
+void SAIClient::notify(const vector<char>& body) {
+    Decoder in(&body[0], body.size());
+    uint32_t cascade, count, handle;
+    double time;
+    if (!in.get(cascade) || !in.get(time) || !in.get(count))
+        throw X3DError("truncated notification");
+    for (uint32_t i = 0; i < count; i++) {
+        if (!in.get(handle) || types.find(handle) == types.end())
+            throw X3DError("bad notification");
+        X3DField*& value = values[handle];
+        if (value == NULL)
+            value = X3DField::create(types[handle]);
+        if (!value->decode(in))
+            throw X3DError("bad value in notification");
+    }
+    notices++;
+}
+
+void SAIClient::send(const char* data, size_t size) {
+    if (fd < 0)
+        throw X3DError("SAI client not connected");
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw X3DError("SAI connection closed");
+        data += n;
+        size -= n;
+    }
+}
+
+}
@@ -17,6 +17,7 @@
 * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "internal/Browser.h"
 #include "internal/Route.h"
 #include "internal/MF.h"
 
@@ -44,23 +45,48 @@ const string& SAIField::getName() const {
     return definition->name;
 }
 
-void deleteRoutes(const list<Route*>& routes) {
-    while (!routes.empty()) {
-        Route* route = routes.front();
-        route->remove();
-        delete route;
+UpdateBuffer* SAIField::buffering = NULL;
+
+SAIField::~SAIField() {
+    if (routeSlot != 0)
+        Browser::getSingleton()->routeTable.remove(routeSlot);
+    if (flags & SUBSCRIBED)
+        Browser::getSingleton()->subscriptions.removeField(this);
+    if (flags & PENDING)
+        Browser::getSingleton()->updates.remove(this);
+    Browser* browser = Browser::getSingleton();
+    if (browser != NULL) {
+        if (browser->snapshots.isCapturing())
+            browser->snapshots.release(this);
+        browser->pipeline.release(this);
     }
 }
 
+void SAIField::subscribe(FieldObserver* observer) {
+    Browser::getSingleton()->subscribe(this, observer);
+}
+
+void SAIField::unsubscribe(FieldObserver* observer) {
+    Browser::getSingleton()->unsubscribe(this, observer);
+}
+
 void SAIField::dispose() {
-    if (definition->inputCapable())
-        deleteRoutes(getIncomingRoutes());
-    if (definition->outputCapable())
-        deleteRoutes(getOutgoingRoutes());
+    while (flags & ROUTED_IN) {
+        Route* route = getIncomingRoutes().front();
+        route->remove();
+        delete route;
+    }
+    while (flags & ROUTED_OUT) {
+        Route* route = getOutgoingRoutes().front();
+        route->remove();
+        delete route;
+    }
 }
 
 SAIField* SAIField::cloneInto(Node* node, map<Node*,Node*>* mapping, bool shallow) {
     SAIField* target = definition->getField(node);
+    if (flags & FROZEN)
+        shallow = true;
     if (!shallow && (definition->type == X3DField::SFNODE)) {
         SFAbstractNode& wrapper = static_cast<SFAbstractNode&>(target->get());
         Node* source = SFNode<Node>::unwrap(getSilently());
@@ -76,28 +102,64 @@ SAIField* SAIField::cloneInto(Node* node, map<Node*,Node*>* mapping, bool shallo
     return target;
 }
 
+/// @returns the field's lists in the route table, adding them if needed
+static RouteTable::Links& links(unsigned int& slot) {
+    RouteTable& table = Browser::getSingleton()->routeTable;
+    if (slot == 0)
+        slot = table.add();
+    return table[slot];
+}
+
 void SAIField::addIncomingRoute(Route* route) {
-    throw X3DError("this field does not support incoming routes");
+    Access access = getAccess();
+    if (access != INPUT_ONLY && access != INPUT_OUTPUT)
+        throw X3DError("this field does not support incoming routes");
+    links(routeSlot).incoming.push_back(route);
+    flags |= ROUTED_IN;
 }
 
 void SAIField::removeIncomingRoute(Route* route) {
-    throw X3DError("this field does not support incoming routes");
+    unlink(route, ROUTED_IN);
 }
 
 const list<Route*>& SAIField::getIncomingRoutes() const {
-    throw X3DError("this field does not support incoming routes");
+    if (!(flags & ROUTED_IN))
+        return RouteTable::none;
+    return Browser::getSingleton()->routeTable[routeSlot].incoming;
 }
 
 void SAIField::addOutgoingRoute(Route* route) {
-    throw X3DError("this field does not support outgoing routes");
+    Access access = getAccess();
+    if (access != OUTPUT_ONLY && access != INPUT_OUTPUT)
+        throw X3DError("this field does not support outgoing routes");
+    links(routeSlot).outgoing.push_back(route);
+    flags |= ROUTED_OUT;
 }
 
 void SAIField::removeOutgoingRoute(Route* route) {
-    throw X3DError("this field does not support outgoing routes");
+    unlink(route, ROUTED_OUT);
 }
 
 const list<Route*>& SAIField::getOutgoingRoutes() const {
-    throw X3DError("this field does not support outgoing routes");
+    if (!(flags & ROUTED_OUT))
+        return RouteTable::none;
+    return Browser::getSingleton()->routeTable[routeSlot].outgoing;
+}
+
+void SAIField::unlink(Route* route, Flag which) {
+    if (!(flags & which))
+        return;
+    RouteTable& table = Browser::getSingleton()->routeTable;
+    RouteTable::Links& links = table[routeSlot];
+    list<Route*>& routes = (which == ROUTED_IN) ? links.incoming : links.outgoing;
+    routes.remove(route);
+    if (!routes.empty())
+        return;
+    flags &= ~which;
+    if (!(flags & (ROUTED_IN | ROUTED_OUT))) {
+        table.remove(routeSlot);
+        routeSlot = 0;
+    }
 }
 
 }
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/SAIServer.h"
+#include "internal/Browser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace X3D {
+
+const size_t SAIProtocol::MAX_FRAME;
+
+/// bytes to read from a socket at a time
+static const size_t READ_SIZE = 65536;
+
+/// Make a socket non-blocking.
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/// Append an ERROR reply.
+static void error(ByteBuffer& out, uint32_t id, const string& message) {
+    size_t start = SAIProtocol::begin(out, SAIProtocol::ERROR);
+    out.put(id);
+    out.putString(message);
+    SAIProtocol::end(out, start);
+}
+
+/// Append an OK reply.
+static void ok(ByteBuffer& out, uint32_t id) {
+    size_t start = SAIProtocol::begin(out, SAIProtocol::OK);
+    out.put(id);
+    SAIProtocol::end(out, start);
+}
+
+SAIServer::~SAIServer() {
+    close();
+}
+
+void SAIServer::listen(const string& path) {
+    if (isListening())
+        throw X3DError("SAI server already listening");
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw X3DError("SAI socket path too long: " + path);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw X3DError("can't create SAI socket");
+    unlink(path.c_str());
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        ::close(fd);
+        throw X3DError("can't listen on " + path);
+    }
+    setNonBlocking(fd);
+    listener = fd;
+    this->path = path;
+    messages = 0;
+}
+
+void SAIServer::close() {
+    while (!clients.empty())
+        drop(clients.back());
+    if (listener >= 0) {
+        ::close(listener);
+        unlink(path.c_str());
+        listener = -1;
+    }
+    for (size_t i = 0; i < values.size(); i++)
+        delete values[i];
+    values.clear();
+    fields.clear();
+    fieldHandles.clear();
+    nodes.clear();
+    nodeHandles.clear();
+}
+
+size_t SAIServer::poll(int timeout) {
+    if (!isListening())
+        return 0;
+    vector<struct pollfd> fds(clients.size() + 1);
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+    for (size_t i = 0; i < clients.size(); i++) {
+        fds[i + 1].fd = clients[i]->fd;
+        fds[i + 1].events = POLLIN;
+        if (clients[i]->sent < clients[i]->output.bytes.size())
+            fds[i + 1].events |= POLLOUT;
+    }
+    if (::poll(&fds[0], fds.size(), timeout) <= 0)
+        return 0;
+
+    // read everything available; clients accepted now are read next time
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)))
+            continue;
+        Client* client = clients[i];
+        while (true) {
+            size_t size = client->input.size();
+            client->input.resize(size + READ_SIZE);
+            ssize_t n = read(client->fd, &client->input[size], READ_SIZE);
+            client->input.resize(size + (n > 0 ? n : 0));
+            if (n > 0)
+                continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                client->closing = true;
+            if (n == 0 || errno != EINTR)
+                break;
+        }
+    }
+    if (fds[0].revents & POLLIN) {
+        int fd;
+        while ((fd = accept(listener, NULL, NULL)) >= 0) {
+            setNonBlocking(fd);
+            clients.push_back(new Client(fd));
+        }
+    }
+
+    // apply everything sent in one update, so it routes as one cascade
+    size_t handled = 0;
+    Browser* browser = Browser::getSingleton();
+    browser->beginUpdate();
+    try {
+        for (size_t i = 0; i < clients.size(); i++)
+            handled += handleInput(clients[i]);
+    } catch (...) {
+        browser->endUpdate();
+        throw;
+    }
+    browser->endUpdate();
+    messages += handled;
+
+    for (size_t i = 0; i < clients.size(); i++) {
+        Client* client = clients[i];
+        for (size_t j = 0; j < client->syncs.size(); j++)
+            ok(client->output, client->syncs[j]);
+        client->syncs.clear();
+        flush(client);
+    }
+    for (size_t i = clients.size(); i-- > 0; )
+        if (clients[i]->closing)
+            drop(clients[i]);
+    return handled;
+}
+
+void SAIServer::changed(const vector<Change>& changes) {
+    vector<Client*> notified;
+    for (size_t i = 0; i < changes.size(); i++) {
+        map<SAIField*, vector<Client*> >::iterator it = subscribers.find(changes[i].field);
+        if (it == subscribers.end())
+            continue;
+        uint32_t handle = fieldHandles[changes[i].field];
+        for (size_t j = 0; j < it->second.size(); j++) {
+            Client* client = it->second[j];
+            if (client->noticeCount++ == 0)
+                notified.push_back(client);
+            client->notice.put(handle);
+            changes[i].value->encode(client->notice);
+        }
+    }
+    Browser* browser = Browser::getSingleton();
+    for (size_t i = 0; i < notified.size(); i++) {
+        Client* client = notified[i];
+        ByteBuffer& out = client->output;
+        size_t start = SAIProtocol::begin(out, SAIProtocol::NOTIFY);
+        out.put<uint32_t>(browser->getCascade());
+        out.put(browser->now());
+        out.put(client->noticeCount);
+        out.write(&client->notice.bytes[0], client->notice.bytes.size());
+        SAIProtocol::end(out, start);
+        client->notice.bytes.clear();
+        client->noticeCount = 0;
+        flush(client);
+    }
+}
+
+size_t SAIServer::handleInput(Client* client) {
+    size_t handled = 0, offset = 0;
+    vector<char>& input = client->input;
+    while (!client->closing && offset < input.size()) {
+        size_t length;
+        try {
+            length = SAIProtocol::frame(&input[0] + offset, input.size() - offset);
+        } catch (X3DError& e) {
+            client->closing = true;
+            break;
+        }
+        if (length == 0)
+            break;
+        const char* body = &input[0] + offset + sizeof(uint32_t);
+        Decoder in(body + 1, length - 1);
+        try {
+            handle(client, (uint8_t) body[0], in);
+        } catch (X3DError& e) {
+            // the id, if any, is the first word of every request
+            uint32_t id = 0;
+            if (body[0] != SAIProtocol::SET && length >= 1 + sizeof(id))
+                memcpy(&id, body + 1, sizeof(id));
+            error(client->output, id, e.what());
+        }
+        offset += sizeof(uint32_t) + length;
+        handled++;
+    }
+    input.erase(input.begin(), input.begin() + offset);
+    return handled;
+}
+
+void SAIServer::handle(Client* client, uint8_t op, Decoder& in) {
+    Browser* browser = Browser::getSingleton();
+    ByteBuffer& out = client->output;
+    uint32_t id = 0, handle, to;
+    if (op != SAIProtocol::SET && !in.get(id))
+        throw X3DError("truncated message");
+    switch (op) {
+        case SAIProtocol::SET: {
+            if (!in.get(handle))
+                throw X3DError("truncated message");
+            SAIField* f = field(handle);
+            SAIField::Access access = f->getAccess();
+            if (access != SAIField::INPUT_ONLY && access != SAIField::INPUT_OUTPUT)
+                throw X3DError("field doesn't take input");
+            X3DField*& value = values[handle - 1];
+            if (value == NULL)
+                value = X3DField::create(f->getType());
+            if (!value->decode(in))
+                throw X3DError("bad value");
+            f->set(*value);
+            break;
+        }
+        case SAIProtocol::GET_NODE: {
+            string name;
+            if (!in.getString(name))
+                throw X3DError("truncated message");
+            Node* node = browser->getNode(name);
+            if (node == NULL)
+                throw X3DError("no such node: " + name);
+            uint32_t& h = nodeHandles[node];
+            if (h == 0) {
+                nodes.push_back(node);
+                h = nodes.size();
+            }
+            size_t start = SAIProtocol::begin(out, SAIProtocol::NODE);
+            out.put(id);
+            out.put(h);
+            SAIProtocol::end(out, start);
+            break;
+        }
+        case SAIProtocol::GET_FIELD: {
+            string name;
+            if (!in.get(handle) || !in.getString(name))
+                throw X3DError("truncated message");
+            if (handle == 0 || handle > nodes.size())
+                throw X3DError("no such node handle");
+            SAIField* f = nodes[handle - 1]->getField(name);
+            if (f == NULL)
+                throw X3DError("no such field: " + name);
+            uint32_t& h = fieldHandles[f];
+            if (h == 0) {
+                fields.push_back(f);
+                values.push_back(NULL);
+                h = fields.size();
+            }
+            size_t start = SAIProtocol::begin(out, SAIProtocol::FIELD);
+            out.put(id);
+            out.put(h);
+            out.put<uint8_t>(f->getType());
+            out.put<uint8_t>(f->getAccess());
+            SAIProtocol::end(out, start);
+            break;
+        }
+        case SAIProtocol::GET: {
+            if (!in.get(handle))
+                throw X3DError("truncated message");
+            // input-only fields throw here, before the reply is started
+            const X3DField& value = field(handle)->getSilently();
+            size_t start = SAIProtocol::begin(out, SAIProtocol::VALUE);
+            out.put(id);
+            out.put(handle);
+            value.encode(out);
+            SAIProtocol::end(out, start);
+            break;
+        }
+        case SAIProtocol::SUBSCRIBE: {
+            if (!in.get(handle))
+                throw X3DError("truncated message");
+            SAIField* f = field(handle);
+            vector<Client*>& list = subscribers[f];
+            if (list.empty())
+                browser->subscribe(f, this);
+            if (std::find(list.begin(), list.end(), client) == list.end())
+                list.push_back(client);
+            ok(out, id);
+            break;
+        }
+        case SAIProtocol::UNSUBSCRIBE: {
+            if (!in.get(handle))
+                throw X3DError("truncated message");
+            SAIField* f = field(handle);
+            map<SAIField*, vector<Client*> >::iterator it = subscribers.find(f);
+            if (it != subscribers.end()) {
+                vector<Client*>& list = it->second;
+                list.erase(std::remove(list.begin(), list.end(), client), list.end());
+                if (list.empty()) {
+                    subscribers.erase(it);
+                    browser->unsubscribe(f, this);
+                }
+            }
+            ok(out, id);
+            break;
+        }
+        case SAIProtocol::CREATE_ROUTE: {
+            if (!in.get(handle) || !in.get(to))
+                throw X3DError("truncated message");
+            browser->createRoute(field(handle), field(to));
+            ok(out, id);
+            break;
+        }
+        case SAIProtocol::SYNC:
+            client->syncs.push_back(id);
+            break;
+        default:
+            throw X3DError("unknown message type");
+    }
+}
+
+SAIField* SAIServer::field(uint32_t handle) {
+    if (handle == 0 || handle > fields.size())
+        throw X3DError("no such field handle");
+    return fields[handle - 1];
+}
+
+void SAIServer::flush(Client* client) {
+    vector<char>& bytes = client->output.bytes;
+    while (client->sent < bytes.size()) {
+        ssize_t n = send(client->fd, &bytes[client->sent],
+                         bytes.size() - client->sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            client->sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                client->closing = true;
+            break;
+        }
+    }
+    if (client->sent == bytes.size()) {
+        bytes.clear();
+        client->sent = 0;
+    }
+}
+
+void SAIServer::drop(Client* client) {
+    Browser* browser = Browser::getSingleton();
+    map<SAIField*, vector<Client*> >::iterator it = subscribers.begin();
+    while (it != subscribers.end()) {
+        vector<Client*>& list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), client), list.end());
+        if (list.empty()) {
+            browser->unsubscribe(it->first, this);
+            subscribers.erase(it++);
+        } else {
+            it++;
+        }
+    }
+    ::close(client->fd);
+    clients.erase(std::find(clients.begin(), clients.end(), client));
+    delete client;
+}
+
+}
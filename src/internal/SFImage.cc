@@ -28,6 +28,7 @@ SFImage& SFImage::operator=(const SFImage& i) {
     if (i.width != width || i.height != height || i.components != components)
         throw X3DError("mismatched image properties in =");
     setBytes(i.bytes);
+    return *this;
 }
  
 bool SFImage::operator==(const SFImage& i) const {
@@ -213,5 +214,12 @@ void SFImage::print(ostream& os) const {
             os << ' ' << getPixel(x,y);
     os << std::dec;
 }
+
+void SFImage::encode(Encoder& out) const {
+    out.put(width);
+    out.put(height);
+    out.put(components);
+    out.write(bytes, size);
+}
  
 }
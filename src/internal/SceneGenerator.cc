@@ -0,0 +1,222 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/SceneGenerator.h"
+#include "internal/errors.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace X3D {
+
+/// deterministic value in [0,1) for a pair of indices
+static float noise(size_t a, size_t b) {
+    unsigned int h = (unsigned int) (a * 2654435761u) ^ (unsigned int) (b * 40503u + 1);
+    h ^= h >> 15;
+    h *= 0x2c1b3c6d;
+    h ^= h >> 12;
+    return (h & 0xffffff) / (float) 0x1000000;
+}
+
+/// write n evenly spaced keys on [0,1]
+static void writeKeys(ostream& os, size_t n) {
+    char buf[32];
+    os << " key='";
+    for (size_t i = 0; i < n; i++) {
+        sprintf(buf, "%s%g", i ? " " : "", n > 1 ? i / (double) (n - 1) : 0.0);
+        os << buf;
+    }
+    os << "'";
+}
+
+static void indent(ostream& os, size_t level) {
+    for (size_t i = 0; i < level; i++)
+        os << "    ";
+}
+
+SceneGenerator::SceneGenerator() :
+    sensors(8), interpolators(4), chain(1), fanIn(true),
+    depth(2), keys(8), points(0) {}
+
+size_t SceneGenerator::nodesPerSensor() const {
+    return 1 + depth
+        + interpolators * (1 + chain)
+        + (fanIn ? 1 : 0)
+        + (depth > 0 ? 1 : 0)
+        + (points > 0 ? 1 : 0);
+}
+
+size_t SceneGenerator::routesPerSensor() const {
+    return interpolators * (1 + chain)
+        + (fanIn ? interpolators : 0)
+        + (depth > 0 ? 2 : 0)
+        + (points > 0 ? 1 : 0);
+}
+
+void SceneGenerator::scaleTo(size_t nodes) {
+    sensors = nodes / nodesPerSensor();
+    if (sensors == 0)
+        sensors = 1;
+}
+
+void SceneGenerator::write(ostream& os) const {
+    os << "<X3D>\n    <Scene>\n";
+    for (size_t unit = 0; unit < sensors; unit++)
+        writeUnit(os, unit);
+    for (size_t unit = 0; unit < sensors; unit++)
+        writeRoutes(os, unit);
+    os << "    </Scene>\n</X3D>\n";
+}
+
+void SceneGenerator::write(const string& filename) const {
+    std::ofstream out(filename.c_str());
+    if (!out)
+        throw X3DError("can't write scene to " + filename);
+    write(out);
+    out.close();
+    if (out.fail())
+        throw X3DError("error writing scene to " + filename);
+}
+
+void SceneGenerator::writeUnit(ostream& os, size_t unit) const {
+    char buf[160];
+
+    // open the nesting: even levels are Transforms, odd levels Groups;
+    // the outermost places the unit on a grid, the innermost is named
+    size_t inner = depth == 0 ? 0 : (depth - 1) & ~(size_t) 1;
+    for (size_t level = 0; level < depth; level++) {
+        indent(os, level + 2);
+        if (level % 2) {
+            os << "<Group>\n";
+            continue;
+        }
+        if (level == 0)
+            sprintf(buf, "%d %d %d", (int) (unit % 100) * 10,
+                (int) (unit / 100 % 100) * 10, (int) (unit / 10000) * 10);
+        else
+            sprintf(buf, "1 0 0");
+        os << "<Transform";
+        if (level == inner)
+            os << " DEF='xf" << unit << "'";
+        os << " translation='" << buf << "'"
+           << " rotation='0 1 0 " << noise(unit, level) << "'>\n";
+    }
+    size_t inside = depth + 2;
+
+    // the sensor; cycle lengths vary so units don't all fire alike
+    indent(os, inside);
+    sprintf(buf, "%g", 1 + (unit % 7) * 0.5);
+    os << "<TimeSensor DEF='ts" << unit << "' cycleInterval='" << buf
+       << "' loop='true'/>\n";
+
+    // fan-out interpolators, each followed by its chain
+    for (size_t i = 0; i < interpolators; i++) {
+        indent(os, inside);
+        os << "<ScalarInterpolator DEF='si" << unit << "_" << i << "'";
+        writeKeys(os, keys);
+        os << " keyValue='";
+        for (size_t k = 0; k < keys; k++) {
+            sprintf(buf, "%s%.4f", k ? " " : "", noise(unit * interpolators + i, k));
+            os << buf;
+        }
+        os << "'/>\n";
+        for (size_t c = 0; c < chain; c++) {
+            indent(os, inside);
+            os << "<ScalarInterpolator DEF='ch" << unit << "_" << i << "_" << c
+               << "' key='0 1' keyValue='0 1'/>\n";
+        }
+    }
+
+    // fan-in sink
+    if (fanIn) {
+        indent(os, inside);
+        os << "<ScalarInterpolator DEF='sink" << unit << "' key='0 1' keyValue='0 1'/>\n";
+    }
+
+    // mover for the innermost transform
+    if (depth > 0) {
+        indent(os, inside);
+        os << "<PositionInterpolator DEF='pi" << unit << "'";
+        writeKeys(os, keys);
+        os << " keyValue='";
+        for (size_t k = 0; k < keys; k++) {
+            sprintf(buf, "%s%.3f %.3f %.3f", k ? ", " : "",
+                noise(unit, 3 * k), noise(unit, 3 * k + 1), noise(unit, 3 * k + 2));
+            os << buf;
+        }
+        os << "'/>\n";
+    }
+
+    // large MF payload
+    if (points > 0) {
+        indent(os, inside);
+        os << "<CoordinateInterpolator DEF='ci" << unit << "'";
+        writeKeys(os, keys);
+        os << " keyValue='";
+        for (size_t k = 0; k < keys; k++) {
+            for (size_t p = 0; p < points; p++) {
+                sprintf(buf, "%s%.3f %.3f %.3f", k || p ? ", " : "",
+                    p + noise(k, p), noise(unit + k, p), (float) k);
+                os << buf;
+            }
+        }
+        os << "'/>\n";
+    }
+
+    // close the nesting
+    for (size_t level = depth; level > 0; level--) {
+        indent(os, level + 1);
+        os << ((level - 1) % 2 ? "</Group>\n" : "</Transform>\n");
+    }
+}
+
+/// write a route between named nodes
+static void route(ostream& os, const string& from, const char* fromField,
+                  const string& to, const char* toField) {
+    os << "        <ROUTE fromNode='" << from << "' fromField='" << fromField
+       << "' toNode='" << to << "' toField='" << toField << "'/>\n";
+}
+
+void SceneGenerator::writeRoutes(ostream& os, size_t unit) const {
+    char buf[64];
+    sprintf(buf, "%lu", (unsigned long) unit);
+    string u = buf;
+    string ts = "ts" + u;
+    for (size_t i = 0; i < interpolators; i++) {
+        sprintf(buf, "si%lu_%lu", (unsigned long) unit, (unsigned long) i);
+        string last = buf;
+        route(os, ts, "fraction_changed", last, "set_fraction");
+        for (size_t c = 0; c < chain; c++) {
+            sprintf(buf, "ch%lu_%lu_%lu", (unsigned long) unit,
+                (unsigned long) i, (unsigned long) c);
+            route(os, last, "value_changed", buf, "set_fraction");
+            last = buf;
+        }
+        if (fanIn)
+            route(os, last, "value_changed", "sink" + u, "set_fraction");
+    }
+    if (depth > 0) {
+        route(os, ts, "fraction_changed", "pi" + u, "set_fraction");
+        route(os, "pi" + u, "value_changed", "xf" + u, "set_translation");
+    }
+    if (points > 0)
+        route(os, ts, "fraction_changed", "ci" + u, "set_fraction");
+}
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/Scope.h"
+
+namespace X3D {
+
+Scope::Scope(Scope* parent) : table(16), count(0), parent(parent) {
+}
+
+size_t Scope::hash(const string& name) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < name.size(); i++) {
+        h ^= (unsigned char) name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t Scope::probe(const string& name, size_t hash) const {
+    size_t mask = table.size() - 1;
+    size_t i = hash & mask;
+    while (table[i].node != NULL) {
+        if (table[i].hash == hash && table[i].name == name)
+            break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void Scope::define(const string& name, Node* node) {
+    if (node == NULL)
+        throw X3DError("can't define a name for a null node");
+    // keep the load factor at or below one half
+    if (2 * (count + 1) > table.size())
+        grow();
+    size_t h = hash(name);
+    Entry& entry = table[probe(name, h)];
+    if (entry.node == NULL) {
+        entry.hash = h;
+        entry.name = name;
+        count++;
+    }
+    entry.node = node;
+}
+
+Node* Scope::lookupLocal(const string& name) const {
+    return table[probe(name, hash(name))].node;
+}
+
+Node* Scope::lookup(const string& name) const {
+    size_t h = hash(name);
+    for (const Scope* scope = this; scope != NULL; scope = scope->parent) {
+        Node* node = scope->table[scope->probe(name, h)].node;
+        if (node != NULL)
+            return node;
+    }
+    return NULL;
+}
+
+void Scope::clear() {
+    vector<Entry>(16).swap(table);
+    count = 0;
+}
+
+void Scope::grow() {
+    vector<Entry> old(table.size() * 2);
+    old.swap(table);
+    size_t mask = table.size() - 1;
+    vector<Entry>::iterator it;
+    for (it = old.begin(); it != old.end(); it++) {
+        if (it->node == NULL)
+            continue;
+        size_t i = it->hash & mask;
+        while (table[i].node != NULL)
+            i = (i + 1) & mask;
+        table[i].hash = it->hash;
+        table[i].name.swap(it->name);
+        table[i].node = it->node;
+    }
+}
+
+}
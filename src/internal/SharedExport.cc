@@ -0,0 +1,219 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/SharedExport.h"
+#include "internal/Atomic.h"
+#include "internal/Browser.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace X3D {
+
+const uint32_t SharedExport::MAGIC;
+const uint32_t SharedExport::LAYOUT_VERSION;
+const size_t SharedExport::NAME_SIZE;
+
+/// alignment of value slots
+static const size_t SLOT_ALIGN = 16;
+
+/// @returns shm_open() name, with a leading slash
+static string regionName(const string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+SharedExport::~SharedExport() {
+    close();
+}
+
+void SharedExport::add(SAIField* field, const string& name, size_t capacity) {
+    if (isOpen())
+        throw X3DError("can't add fields to an open export");
+    if (name.size() >= NAME_SIZE)
+        throw X3DError("export name too long: " + name);
+    if (capacity == 0) {
+        scratch.bytes.clear();
+        field->getSilently().encode(scratch);
+        capacity = 2 * scratch.bytes.size();
+        if (capacity < 64)
+            capacity = 64;
+    }
+    Pending p;
+    p.field = field;
+    p.name = name;
+    p.capacity = capacity;
+    pending.push_back(p);
+}
+
+void SharedExport::open(const string& name) {
+    if (isOpen())
+        throw X3DError("export already open");
+
+    // lay out the header, entries and slots
+    size_t size = sizeof(Header) + pending.size() * sizeof(Entry);
+    vector<size_t> offsets;
+    for (size_t i = 0; i < pending.size(); i++) {
+        size = (size + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+        offsets.push_back(size);
+        size += pending[i].capacity;
+    }
+
+    region = regionName(name);
+    shm_unlink(region.c_str());
+    int fd = shm_open(region.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        throw X3DError("can't create shared memory " + region);
+    if (ftruncate(fd, size) < 0) {
+        ::close(fd);
+        shm_unlink(region.c_str());
+        throw X3DError("can't size shared memory " + region);
+    }
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(region.c_str());
+        throw X3DError("can't map shared memory " + region);
+    }
+    base = (char*) p;
+    mapped = size;
+
+    // fill in the layout before the magic number makes it valid
+    Header& h = *(Header*) base;
+    h.version = LAYOUT_VERSION;
+    h.fieldCount = pending.size();
+    h.size = size;
+    h.sequence = 0;
+    Browser* browser = Browser::getSingleton();
+    h.cascade = browser->getCascade();
+    h.time = browser->now();
+    for (size_t i = 0; i < pending.size(); i++) {
+        Entry& e = entry(i);
+        strncpy(e.name, pending[i].name.c_str(), NAME_SIZE);
+        e.type = pending[i].field->getType();
+        e.offset = offsets[i];
+        e.capacity = pending[i].capacity;
+        entries[pending[i].field] = i;
+        write(i, pending[i].field->getSilently(), 0);
+    }
+    atomicStore(&h.magic, MAGIC);
+    for (size_t i = 0; i < pending.size(); i++)
+        browser->subscribe(pending[i].field, this);
+}
+
+void SharedExport::close() {
+    if (!isOpen())
+        return;
+    Browser* browser = Browser::getSingleton();
+    map<SAIField*, size_t>::iterator it;
+    for (it = entries.begin(); it != entries.end(); it++)
+        browser->unsubscribe(it->first, this);
+    entries.clear();
+    munmap(base, mapped);
+    shm_unlink(region.c_str());
+    base = NULL;
+    mapped = 0;
+}
+
+void SharedExport::changed(const vector<Change>& changes) {
+    Header& h = *(Header*) base;
+    uint64_t sequence = h.sequence;
+    atomicStore(&h.sequence, sequence + 1);
+    atomicFence();
+    for (size_t i = 0; i < changes.size(); i++)
+        write(entries[changes[i].field], *changes[i].value, sequence + 2);
+    Browser* browser = Browser::getSingleton();
+    h.cascade = browser->getCascade();
+    h.time = browser->now();
+    atomicFence();
+    atomicStore(&h.sequence, sequence + 2);
+}
+
+void SharedExport::write(size_t n, const X3DField& value, uint64_t sequence) {
+    Entry& e = entry(n);
+    scratch.bytes.clear();
+    value.encode(scratch);
+    if (scratch.bytes.size() > e.capacity) {
+        e.dropped++;
+        return;
+    }
+    memcpy(base + e.offset, &scratch.bytes[0], scratch.bytes.size());
+    e.size = scratch.bytes.size();
+    e.sequence = sequence;
+}
+
+bool SharedExportReader::open(const string& name) {
+    close();
+    string region = regionName(name);
+    int fd = shm_open(region.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(SharedExport::Header)) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    base = (const char*) p;
+    mapped = st.st_size;
+    const SharedExport::Header& h = header();
+    // the exporter sets the magic number last
+    if (atomicLoad(&h.magic) != SharedExport::MAGIC) {
+        close();
+        return false;
+    }
+    if (h.version != SharedExport::LAYOUT_VERSION || h.size > mapped) {
+        close();
+        throw X3DError("unsupported shared export " + region);
+    }
+    return true;
+}
+
+void SharedExportReader::close() {
+    if (base != NULL)
+        munmap((void*) base, mapped);
+    base = NULL;
+    mapped = 0;
+}
+
+int SharedExportReader::find(const string& name) const {
+    for (size_t i = 0; i < size(); i++)
+        if (name == entry(i).name)
+            return i;
+    return -1;
+}
+
+uint64_t SharedExportReader::begin() const {
+    const uint64_t* sequence = &header().sequence;
+    uint64_t s;
+    while ((s = atomicLoad(sequence)) & 1)
+        ;
+    return s;
+}
+
+bool SharedExportReader::validate(uint64_t sequence) const {
+    atomicFence();
+    return atomicLoad(&header().sequence) == sequence;
+}
+
+}
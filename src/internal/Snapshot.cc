@@ -0,0 +1,137 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/Snapshot.h"
+#include "internal/SAIField.h"
+#include "internal/Atomic.h"
+
+#include <algorithm>
+
+namespace X3D {
+
+const unsigned int SnapshotStore::MAX_READERS;
+
+Snapshot::~Snapshot() {
+    for (size_t i = 0; i < values.size(); i++)
+        delete values[i];
+}
+
+const X3DField* Snapshot::get(SAIField* field) const {
+    vector<SAIField*>::const_iterator it =
+        std::lower_bound(fields.begin(), fields.end(), field);
+    if (it == fields.end() || *it != field)
+        return NULL;
+    return values[it - fields.begin()];
+}
+
+SnapshotStore::SnapshotStore() : current(NULL), epoch(1) {
+    for (unsigned int i = 0; i < MAX_READERS; i++)
+        slots[i].epoch = 0;
+}
+
+SnapshotStore::~SnapshotStore() {
+    clear();
+}
+
+void SnapshotStore::capture(SAIField* field) {
+    vector<SAIField*>::iterator it =
+        std::lower_bound(fields.begin(), fields.end(), field);
+    if (it == fields.end() || *it != field)
+        fields.insert(it, field);
+}
+
+void SnapshotStore::release(SAIField* field) {
+    vector<SAIField*>::iterator it =
+        std::lower_bound(fields.begin(), fields.end(), field);
+    if (it != fields.end() && *it == field)
+        fields.erase(it);
+}
+
+void SnapshotStore::publish(unsigned int cascade, double time) {
+    Snapshot* next;
+    if (spare.empty()) {
+        next = new Snapshot();
+    } else {
+        next = spare.back();
+        spare.pop_back();
+    }
+    if (next->fields != fields) {
+        for (size_t i = 0; i < next->values.size(); i++)
+            delete next->values[i];
+        next->fields = fields;
+        next->values.resize(fields.size());
+        for (size_t i = 0; i < fields.size(); i++)
+            next->values[i] = X3DField::create(fields[i]->getType());
+    }
+    for (size_t i = 0; i < fields.size(); i++)
+        (*next->values[i])(fields[i]->getSilently());
+    next->cascade = cascade;
+    next->time = time;
+
+    Snapshot* old = atomicExchange(&current, next);
+    uint64_t retiredAt = atomicAdd(&epoch, (uint64_t) 1);
+    if (old != NULL)
+        retired.push_back(std::make_pair(old, retiredAt));
+    reclaim();
+}
+
+const Snapshot* SnapshotStore::pin(unsigned int& slot) {
+    for (slot = 0; slot < MAX_READERS; slot++) {
+        uint64_t now = atomicLoad(&epoch);
+        if (atomicCompareExchange(&slots[slot].epoch, (uint64_t) 0, now))
+            return atomicLoad(&current);
+    }
+    throw X3DError("too many snapshot readers");
+}
+
+void SnapshotStore::unpin(unsigned int slot) {
+    atomicStore(&slots[slot].epoch, (uint64_t) 0);
+}
+
+void SnapshotStore::reclaim() {
+    // a reader whose slot holds an epoch before a snapshot's was retired
+    // may have loaded it; later readers only see newer snapshots
+    uint64_t oldest = (uint64_t) -1;
+    for (unsigned int i = 0; i < MAX_READERS; i++) {
+        uint64_t pinned = atomicLoad(&slots[i].epoch);
+        if (pinned != 0 && pinned < oldest)
+            oldest = pinned;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+        if (retired[i].second <= oldest)
+            spare.push_back(retired[i].first);
+        else
+            retired[kept++] = retired[i];
+    }
+    retired.resize(kept);
+}
+
+void SnapshotStore::clear() {
+    delete atomicExchange(&current, (Snapshot*) NULL);
+    for (size_t i = 0; i < retired.size(); i++)
+        delete retired[i].first;
+    for (size_t i = 0; i < spare.size(); i++)
+        delete spare[i];
+    retired.clear();
+    spare.clear();
+    fields.clear();
+}
+
+}
@@ -0,0 +1,434 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/SpatialQuery.h"
+#include "internal/BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <pthread.h>
+#include <utility>
+
+using std::pair;
+
+namespace X3D {
+
+typedef BoundingVolumeHierarchy::Volume Volume;
+
+/// deepest tree a traversal can walk; median splits of 2^32 objects
+/// are at most 31 deep
+static const int STACK_SIZE = 64;
+
+Frustum Frustum::fromMatrix(const float* m) {
+    // each plane is the last row plus or minus one of the others
+    Frustum f;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            f.planes[2*i][j] = m[12 + j] + m[4*i + j];
+            f.planes[2*i+1][j] = m[12 + j] - m[4*i + j];
+        }
+    }
+    return f;
+}
+
+bool Frustum::excludes(const BoundingBox& box) const {
+    for (int i = 0; i < 6; i++) {
+        const float* p = planes[i];
+        // the corner furthest along the plane's normal
+        float x = p[0] >= 0 ? box.max.x : box.min.x;
+        float y = p[1] >= 0 ? box.max.y : box.min.y;
+        float z = p[2] >= 0 ? box.max.z : box.min.z;
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0)
+            return true;
+    }
+    return false;
+}
+
+/// queries split into runs, one per thread
+class Batch {
+public:
+    virtual ~Batch() {}
+
+    /**
+     * Run some of the queries.
+     *
+     * @param begin first query
+     * @param end query after the last
+     * @param part index of run
+     */
+    virtual void run(size_t begin, size_t end, unsigned int part) = 0;
+};
+
+/// one run of a batch, on its own thread
+struct BatchRun {
+    Batch* batch;
+    size_t begin, end;
+    unsigned int part;
+};
+
+static void* runThread(void* arg) {
+    BatchRun* run = (BatchRun*) arg;
+    run->batch->run(run->begin, run->end, run->part);
+    return NULL;
+}
+
+/// @returns number of runs to split so many queries into
+static unsigned int partsFor(size_t n, unsigned int threads) {
+    size_t parts = n / SpatialQuery::PARALLEL_BATCH;
+    if (parts > threads)
+        parts = threads;
+    return parts < 1 ? 1 : (unsigned int) parts;
+}
+
+/// Run a batch in the given number of runs, the first on this thread.
+static void runBatch(Batch& batch, size_t n, unsigned int parts) {
+    if (parts <= 1) {
+        batch.run(0, n, 0);
+        return;
+    }
+    vector<BatchRun> runs(parts);
+    vector<pthread_t> threads(parts);
+    vector<bool> started(parts, false);
+    for (unsigned int i = 0; i < parts; i++) {
+        runs[i].batch = &batch;
+        runs[i].begin = n * i / parts;
+        runs[i].end = n * (i + 1) / parts;
+        runs[i].part = i;
+    }
+    for (unsigned int i = 1; i < parts; i++)
+        started[i] = pthread_create(&threads[i], NULL, runThread, &runs[i]) == 0;
+    batch.run(runs[0].begin, runs[0].end, 0);
+    for (unsigned int i = 1; i < parts; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            batch.run(runs[i].begin, runs[i].end, i);
+    }
+}
+
+/// batch whose queries each find a list of nodes
+class ListBatch : public Batch {
+public:
+    ListBatch(const BoundingVolumeHierarchy& bvh, unsigned int parts) :
+        volumes(bvh.getVolumes()), objects(bvh.getObjects()),
+        boxes(bvh.getBoxes()), results(parts) {}
+
+    void run(size_t begin, size_t end, unsigned int part) {
+        QueryResults& out = results[part];
+        for (size_t i = begin; i < end; i++) {
+            out.offsets.push_back(out.nodes.size());
+            if (!volumes.empty())
+                query(i, part, out);
+        }
+    }
+
+    /// Join the runs' results in order.
+    void join(QueryResults& all) {
+        all.clear();
+        for (size_t p = 0; p < results.size(); p++) {
+            const QueryResults& part = results[p];
+            uint32_t base = all.nodes.size();
+            for (size_t i = 0; i < part.offsets.size(); i++)
+                all.offsets.push_back(base + part.offsets[i]);
+            all.nodes.insert(all.nodes.end(),
+                part.nodes.begin(), part.nodes.end());
+            all.distances.insert(all.distances.end(),
+                part.distances.begin(), part.distances.end());
+        }
+        all.offsets.push_back(all.nodes.size());
+    }
+
+protected:
+    const vector<Volume>& volumes;
+    const vector<BoundingVolumeHierarchy::Object>& objects;
+    const vector<BoundingBox>& boxes;
+
+    /**
+     * Append the results of one query.
+     *
+     * @param i index of query
+     * @param part index of run
+     * @param out results of the run
+     */
+    virtual void query(size_t i, unsigned int part, QueryResults& out) = 0;
+
+private:
+    vector<QueryResults> results;
+};
+
+/// finds the objects a region overlaps; R is BoundingBox or Frustum
+template <class R>
+class RegionBatch : public ListBatch {
+public:
+    RegionBatch(const BoundingVolumeHierarchy& bvh, const R* regions,
+                unsigned int parts) : ListBatch(bvh, parts), regions(regions) {}
+
+protected:
+    void query(size_t i, unsigned int part, QueryResults& out) {
+        const R& region = regions[i];
+        uint32_t stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            uint32_t v = stack[--top];
+            const Volume& volume = volumes[v];
+            if (!overlaps(region, volume.box))
+                continue;
+            if (volume.count == 0) {
+                stack[top++] = volume.first;
+                stack[top++] = v + 1;
+                continue;
+            }
+            uint32_t end = volume.first + volume.count;
+            for (uint32_t j = volume.first; j < end; j++)
+                if (overlaps(region, boxes[j]))
+                    out.nodes.push_back(objects[j].node);
+        }
+    }
+
+private:
+    const R* regions;
+
+    static bool overlaps(const BoundingBox& region, const BoundingBox& box) {
+        return region.overlaps(box);
+    }
+
+    static bool overlaps(const Frustum& region, const BoundingBox& box) {
+        return !region.excludes(box);
+    }
+};
+
+/// finds the k nearest objects to a point
+class NearestBatch : public ListBatch {
+public:
+    NearestBatch(const BoundingVolumeHierarchy& bvh, const SFVec3f* points,
+                 size_t k, unsigned int parts) :
+        ListBatch(bvh, parts), points(points), k(k),
+        opens(parts), bests(parts) {}
+
+protected:
+    void query(size_t i, unsigned int part, QueryResults& out) {
+        if (k == 0)
+            return;
+        const SFVec3f& p = points[i];
+        // volumes to visit, nearest first, and the best objects so far,
+        // worst first; both are heaps keyed on squared distance
+        vector<Entry>& open = opens[part];
+        vector<Entry>& best = bests[part];
+        open.clear();
+        best.clear();
+        open.push_back(Entry(-distance2(p, volumes[0].box), 0));
+        while (!open.empty()) {
+            float d = -open.front().first;
+            uint32_t v = open.front().second;
+            std::pop_heap(open.begin(), open.end());
+            open.pop_back();
+            if (best.size() == k && d > best.front().first)
+                break;
+            const Volume& volume = volumes[v];
+            if (volume.count == 0) {
+                uint32_t children[2] = { v + 1, volume.first };
+                for (int c = 0; c < 2; c++) {
+                    float dc = distance2(p, volumes[children[c]].box);
+                    if (best.size() == k && dc > best.front().first)
+                        continue;
+                    open.push_back(Entry(-dc, children[c]));
+                    std::push_heap(open.begin(), open.end());
+                }
+                continue;
+            }
+            uint32_t end = volume.first + volume.count;
+            for (uint32_t j = volume.first; j < end; j++) {
+                float dj = distance2(p, boxes[j]);
+                if (best.size() < k) {
+                    best.push_back(Entry(dj, j));
+                    std::push_heap(best.begin(), best.end());
+                } else if (dj < best.front().first) {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = Entry(dj, j);
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        }
+        std::sort_heap(best.begin(), best.end());
+        for (size_t j = 0; j < best.size(); j++) {
+            out.nodes.push_back(objects[best[j].second].node);
+            out.distances.push_back(std::sqrt(best[j].first));
+        }
+    }
+
+private:
+    typedef pair<float, uint32_t> Entry;
+
+    const SFVec3f* points;
+    size_t k;
+
+    /// heaps of each run, kept between queries
+    vector<vector<Entry> > opens, bests;
+
+    /// @returns squared distance from a point to the nearest point of a box
+    static float distance2(const SFVec3f& p, const BoundingBox& box) {
+        float dx = std::max(std::max(box.min.x - p.x, p.x - box.max.x), 0.0f);
+        float dy = std::max(std::max(box.min.y - p.y, p.y - box.max.y), 0.0f);
+        float dz = std::max(std::max(box.min.z - p.z, p.z - box.max.z), 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+};
+
+/// finds the nearest object each ray hits
+class RayBatch : public Batch {
+public:
+    RayBatch(const BoundingVolumeHierarchy& bvh, const Ray* rays,
+             RayHit* hits) :
+        volumes(bvh.getVolumes()), objects(bvh.getObjects()),
+        boxes(bvh.getBoxes()), rays(rays), hits(hits) {}
+
+    void run(size_t begin, size_t end, unsigned int part) {
+        for (size_t i = begin; i < end; i++)
+            cast(rays[i], hits[i]);
+    }
+
+private:
+    const vector<Volume>& volumes;
+    const vector<BoundingVolumeHierarchy::Object>& objects;
+    const vector<BoundingBox>& boxes;
+    const Ray* rays;
+    RayHit* hits;
+
+    /// ray with its reciprocal direction, for slab tests
+    struct Slab {
+        const float* origin;
+        float inverse[3];
+    };
+
+    /**
+     * Intersect a ray with a box.
+     *
+     * @param slab ray
+     * @param box box
+     * @param limit greatest distance of interest
+     * @param t set to the entry distance, or 0 if the ray starts inside
+     * @returns whether the ray enters the box no further than the limit
+     */
+    static bool enter(const Slab& slab, const BoundingBox& box, float limit,
+                      float& t) {
+        const float* lo = &box.min.x;
+        const float* hi = &box.max.x;
+        float near = 0, far = limit;
+        for (int a = 0; a < 3; a++) {
+            float t1 = (lo[a] - slab.origin[a]) * slab.inverse[a];
+            float t2 = (hi[a] - slab.origin[a]) * slab.inverse[a];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            // a ray along the plane of a slab gives NaN; comparisons with
+            // NaN are false, so the slab is then ignored
+            if (t1 > near)
+                near = t1;
+            if (t2 < far)
+                far = t2;
+            if (near > far)
+                return false;
+        }
+        t = near;
+        return true;
+    }
+
+    void cast(const Ray& ray, RayHit& hit) {
+        hit.node = NULL;
+        hit.distance = ray.length;
+        if (volumes.empty())
+            return;
+        Slab slab;
+        slab.origin = &ray.origin.x;
+        const float* d = &ray.direction.x;
+        for (int a = 0; a < 3; a++)
+            slab.inverse[a] = 1.0f / d[a];
+
+        uint32_t stack[STACK_SIZE];
+        int top = 0;
+        float t;
+        if (!enter(slab, volumes[0].box, hit.distance, t))
+            return;
+        stack[top++] = 0;
+        while (top > 0) {
+            uint32_t v = stack[--top];
+            const Volume& volume = volumes[v];
+            if (volume.count > 0) {
+                uint32_t end = volume.first + volume.count;
+                for (uint32_t j = volume.first; j < end; j++) {
+                    if (enter(slab, boxes[j], hit.distance, t)
+                            && (hit.node == NULL || t < hit.distance)) {
+                        hit.node = objects[j].node;
+                        hit.distance = t;
+                    }
+                }
+                continue;
+            }
+            // visit the nearer child first, pushing it last
+            float t1, t2;
+            bool in1 = enter(slab, volumes[v + 1].box, hit.distance, t1);
+            bool in2 = enter(slab, volumes[volume.first].box, hit.distance, t2);
+            if (in1 && in2 && t1 <= t2) {
+                stack[top++] = volume.first;
+                stack[top++] = v + 1;
+            } else if (in1 && in2) {
+                stack[top++] = v + 1;
+                stack[top++] = volume.first;
+            } else if (in1) {
+                stack[top++] = v + 1;
+            } else if (in2) {
+                stack[top++] = volume.first;
+            }
+        }
+        if (hit.node == NULL)
+            hit.distance = ray.length;
+    }
+};
+
+void SpatialQuery::raycast(const BoundingVolumeHierarchy& bvh,
+        const Ray* rays, size_t n, RayHit* hits, unsigned int threads) {
+    RayBatch batch(bvh, rays, hits);
+    runBatch(batch, n, partsFor(n, threads));
+}
+
+void SpatialQuery::overlap(const BoundingVolumeHierarchy& bvh,
+        const BoundingBox* boxes, size_t n, QueryResults& results,
+        unsigned int threads) {
+    unsigned int parts = partsFor(n, threads);
+    RegionBatch<BoundingBox> batch(bvh, boxes, parts);
+    runBatch(batch, n, parts);
+    batch.join(results);
+}
+
+void SpatialQuery::overlap(const BoundingVolumeHierarchy& bvh,
+        const Frustum* frusta, size_t n, QueryResults& results,
+        unsigned int threads) {
+    unsigned int parts = partsFor(n, threads);
+    RegionBatch<Frustum> batch(bvh, frusta, parts);
+    runBatch(batch, n, parts);
+    batch.join(results);
+}
+
+void SpatialQuery::nearest(const BoundingVolumeHierarchy& bvh,
+        const SFVec3f* points, size_t n, size_t k, QueryResults& results,
+        unsigned int threads) {
+    unsigned int parts = partsFor(n, threads);
+    NearestBatch batch(bvh, points, k, parts);
+    runBatch(batch, n, parts);
+    batch.join(results);
+}
+
+}
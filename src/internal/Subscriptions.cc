@@ -0,0 +1,137 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/Subscriptions.h"
+#include "internal/SAIField.h"
+
+#include <algorithm>
+
+namespace X3D {
+
+Subscriptions::~Subscriptions() {
+    clear();
+}
+
+void Subscriptions::add(SAIField* field, FieldObserver* observer) {
+    Entry*& entry = entries[observer];
+    if (entry == NULL)
+        entry = new Entry(observer);
+    vector<Entry*>& list = byField[field];
+    if (std::find(list.begin(), list.end(), entry) != list.end())
+        return;
+    list.push_back(entry);
+    entry->fields++;
+    field->flags |= SAIField::SUBSCRIBED;
+}
+
+void Subscriptions::remove(SAIField* field, FieldObserver* observer) {
+    map<SAIField*, vector<Entry*> >::iterator f_it = byField.find(field);
+    map<FieldObserver*, Entry*>::iterator e_it = entries.find(observer);
+    if (f_it == byField.end() || e_it == entries.end())
+        return;
+    vector<Entry*>& list = f_it->second;
+    vector<Entry*>::iterator it = std::find(list.begin(), list.end(), e_it->second);
+    if (it == list.end())
+        return;
+    list.erase(it);
+    if (list.empty()) {
+        byField.erase(f_it);
+        field->flags &= ~SAIField::SUBSCRIBED;
+    }
+    if (--e_it->second->fields == 0)
+        retire(e_it->second);
+}
+
+void Subscriptions::removeField(SAIField* field) {
+    map<SAIField*, vector<Entry*> >::iterator f_it = byField.find(field);
+    if (f_it != byField.end()) {
+        vector<Entry*> list;
+        list.swap(f_it->second);
+        byField.erase(f_it);
+        for (size_t i = 0; i < list.size(); i++)
+            if (--list[i]->fields == 0)
+                retire(list[i]);
+    }
+    field->flags &= ~SAIField::SUBSCRIBED;
+    changed.erase(std::remove(changed.begin(), changed.end(), field), changed.end());
+}
+
+size_t Subscriptions::deliver() {
+    // gather each observer's batch; a field is dirty at most once per
+    // cascade, so batches have no repeats
+    vector<Entry*> called;
+    for (size_t i = 0; i < changed.size(); i++) {
+        SAIField* field = changed[i];
+        map<SAIField*, vector<Entry*> >::iterator f_it = byField.find(field);
+        if (f_it == byField.end())
+            continue;
+        FieldObserver::Change change;
+        change.field = field;
+        change.value = &field->getSilently();
+        vector<Entry*>& list = f_it->second;
+        for (size_t j = 0; j < list.size(); j++) {
+            if (list[j]->batch.empty())
+                called.push_back(list[j]);
+            list[j]->batch.push_back(change);
+        }
+    }
+    changed.clear();
+
+    // observers may unsubscribe while being called, so their entries
+    // are only freed once all have been
+    delivering = true;
+    try {
+        for (size_t i = 0; i < called.size(); i++)
+            if (called[i]->fields > 0)
+                called[i]->observer->changed(called[i]->batch);
+    } catch (...) {
+        finish(called);
+        throw;
+    }
+    finish(called);
+    return called.size();
+}
+
+void Subscriptions::clear() {
+    map<SAIField*, vector<Entry*> >::iterator f_it;
+    for (f_it = byField.begin(); f_it != byField.end(); f_it++)
+        f_it->first->flags &= ~SAIField::SUBSCRIBED;
+    byField.clear();
+    map<FieldObserver*, Entry*>::iterator e_it;
+    for (e_it = entries.begin(); e_it != entries.end(); e_it++)
+        delete e_it->second;
+    entries.clear();
+    changed.clear();
+}
+
+void Subscriptions::finish(const vector<Entry*>& called) {
+    delivering = false;
+    for (size_t i = 0; i < called.size(); i++)
+        called[i]->batch.clear();
+    for (size_t i = 0; i < called.size(); i++)
+        retire(called[i]);
+}
+
+void Subscriptions::retire(Entry* entry) {
+    if (entry->fields > 0 || delivering)
+        return;
+    entries.erase(entry->observer);
+    delete entry;
+}
+
+}
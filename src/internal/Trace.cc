@@ -0,0 +1,146 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/Trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+namespace X3D {
+
+/// magic number at the start of trace files
+static const char traceMagic[8] = { 'X', '3', 'D', 'T', 'R', 'A', 'C', '1' };
+
+Trace::~Trace() {
+    delete[] ring;
+}
+
+void Trace::enable(uint32_t capacity) {
+    uint32_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    if (ring == NULL || size != mask + 1) {
+        enabled = false;
+        __sync_synchronize();
+        delete[] ring;
+        ring = new TraceRecord[size];
+        mask = size - 1;
+        clear();
+    }
+    baseClock = clock();
+    baseTicks = ticks();
+    __sync_synchronize();
+    enabled = true;
+}
+
+void Trace::clear() {
+    if (ring != NULL)
+        memset(ring, 0, (mask + 1) * sizeof(TraceRecord));
+    head = 0;
+}
+
+void Trace::snapshot(vector<TraceRecord>& records) const {
+    records.clear();
+    if (ring == NULL)
+        return;
+    uint64_t nowClock = clock(), nowTicks = ticks();
+    double scale = 1;
+    if (nowTicks > baseTicks && nowClock > baseClock)
+        scale = (double) (nowClock - baseClock) / (nowTicks - baseTicks);
+    uint32_t end = head;
+    uint32_t start = end > mask ? end - mask - 1 : 0;
+    for (uint32_t pos = start; pos != end; pos++) {
+        const TraceRecord& r = ring[pos & mask];
+        if (r.seq != pos + 1)
+            continue;
+        __sync_synchronize();
+        TraceRecord copy = r;
+        __sync_synchronize();
+        if (r.seq == pos + 1 && copy.seq == pos + 1) {
+            int64_t delta = (int64_t) (copy.stamp - baseTicks);
+            copy.stamp = baseClock + (int64_t) (delta * scale);
+            records.push_back(copy);
+        }
+    }
+}
+
+uint64_t Trace::clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void Trace::save(const string& filename, const map<uint32_t, string>& routes) const {
+    vector<TraceRecord> records;
+    snapshot(records);
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == NULL)
+        throw X3DError("can't open trace file for writing: " + filename);
+    uint32_t counts[2] = { (uint32_t) routes.size(), (uint32_t) records.size() };
+    fwrite(traceMagic, sizeof(traceMagic), 1, file);
+    fwrite(counts, sizeof(counts), 1, file);
+    map<uint32_t, string>::const_iterator it;
+    for (it = routes.begin(); it != routes.end(); it++) {
+        uint32_t head[2] = { it->first, (uint32_t) it->second.size() };
+        fwrite(head, sizeof(head), 1, file);
+        fwrite(it->second.data(), 1, it->second.size(), file);
+    }
+    if (!records.empty())
+        fwrite(&records[0], sizeof(TraceRecord), records.size(), file);
+    bool failed = ferror(file);
+    if (fclose(file) != 0 || failed)
+        throw X3DError("failed to write trace file: " + filename);
+}
+
+void Trace::load(const string& filename,
+                 vector<TraceRecord>& records,
+                 map<uint32_t, string>& routes) {
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
+        throw X3DError("can't open trace file: " + filename);
+    char magic[sizeof(traceMagic)];
+    uint32_t counts[2];
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, traceMagic, sizeof(magic)) ||
+        fread(counts, sizeof(counts), 1, file) != 1) {
+        fclose(file);
+        throw X3DError("not a trace file: " + filename);
+    }
+    for (uint32_t i = 0; i < counts[0]; i++) {
+        uint32_t head[2];
+        if (fread(head, sizeof(head), 1, file) != 1) {
+            fclose(file);
+            throw X3DError("truncated trace file: " + filename);
+        }
+        string name(head[1], ' ');
+        if (head[1] > 0 && fread(&name[0], 1, head[1], file) != head[1]) {
+            fclose(file);
+            throw X3DError("truncated trace file: " + filename);
+        }
+        routes[head[0]] = name;
+    }
+    records.resize(counts[1]);
+    size_t n = counts[1] ? fread(&records[0], sizeof(TraceRecord), counts[1], file) : 0;
+    fclose(file);
+    if (n != counts[1])
+        throw X3DError("truncated trace file: " + filename);
+}
+
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "internal/TransformHierarchy.h"
+#include "internal/Browser.h"
+#include "Grouping/StaticGroup.h"
+#include "Grouping/Transform.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+using X3D::Grouping::StaticGroup;
+using X3D::Grouping::Transform;
+using X3D::Grouping::X3DGroupingNode;
+
+namespace X3D {
+
+void TransformHierarchy::invalidate(Transform* transform) {
+    if (stale)
+        return;
+    uint32_t i = find(transform);
+    for (; i != NONE; i = instances[i].next) {
+        uint32_t slot = instances[i].slot;
+        slots[slot].dirty = true;
+        if (slot < first)
+            first = slot;
+    }
+}
+
+void TransformHierarchy::invalidateAll() {
+    stale = true;
+    const list<Node*>& nodes = Browser::getSingleton()->getNodes();
+    list<Node*>::const_iterator it;
+    for (it = nodes.begin(); it != nodes.end(); it++) {
+        Transform* transform = nodeCast<Transform>(*it);
+        if (transform != NULL)
+            transform->invalidate();
+    }
+}
+
+void TransformHierarchy::clear() {
+    slots.clear();
+    worlds.clear();
+    instances.clear();
+    table.clear();
+    stale = true;
+    first = 0;
+    recomputed = 0;
+}
+
+size_t TransformHierarchy::update() {
+    if (stale)
+        rebuild(Browser::getSingleton()->getRoots());
+    recomputed = 0;
+    if (first >= slots.size())
+        return 0;
+    pass++;
+    // parents come before their children, so one pass from the first
+    // dirty slot sees every parent's new matrix before its children
+    float* world = &worlds[0];
+    for (uint32_t i = first; i < slots.size(); i++) {
+        Slot& slot = slots[i];
+        if (!slot.dirty && slots[slot.parent].stamp != pass)
+            continue;
+        multiply(world + 16 * slot.parent,
+            slot.transform->getMatrix().array(), world + 16 * i);
+        slot.dirty = false;
+        slot.stamp = pass;
+        recomputed++;
+    }
+    first = slots.size();
+    return recomputed;
+}
+
+SFMatrix4f TransformHierarchy::getWorldMatrix(Node* node) {
+    update();
+    uint32_t i = find(node);
+    if (i == NONE)
+        throw X3DError("node isn't in the scene graph");
+    return SFMatrix4f(&worlds[16 * instances[i].slot]);
+}
+
+bool TransformHierarchy::contains(Node* node) {
+    if (stale)
+        update();
+    return find(node) != NONE;
+}
+
+void TransformHierarchy::multiply(const float* a, const float* b, float* c) {
+#ifdef __SSE__
+    // each row of c is a weighted sum of the rows of b
+    __m128 b0 = _mm_loadu_ps(b);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+    for (int i = 0; i < 16; i += 4) {
+        __m128 row = _mm_mul_ps(_mm_set1_ps(a[i]), b0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i+1]), b1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i+2]), b2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i+3]), b3));
+        _mm_storeu_ps(c + i, row);
+    }
+#else
+    for (int i = 0; i < 16; i += 4)
+        for (int j = 0; j < 4; j++)
+            c[i+j] = a[i]*b[j] + a[i+1]*b[4+j] + a[i+2]*b[8+j] + a[i+3]*b[12+j];
+#endif
+}
+
+void TransformHierarchy::rebuild(const list<Node*>& roots) {
+    slots.clear();
+    worlds.clear();
+    instances.clear();
+    Slot root = { NULL, 0, 0, false };
+    slots.push_back(root);
+    SFMatrix4f identity;
+    worlds.insert(worlds.end(), identity.array(), identity.array() + 16);
+
+    // depth-first, keeping each node's slot and depth with it on the
+    // stack; open holds the instances whose end isn't known yet
+    struct Entry { Node* node; uint32_t slot; uint32_t depth; };
+    vector<Entry> stack;
+    vector<std::pair<uint32_t, uint32_t> > open;
+    list<Node*>::const_reverse_iterator r_it;
+    for (r_it = roots.rbegin(); r_it != roots.rend(); r_it++) {
+        Entry e = { *r_it, 0, 0 };
+        stack.push_back(e);
+    }
+    while (!stack.empty()) {
+        Entry e = stack.back();
+        stack.pop_back();
+        Node* node = e.node;
+        uint32_t slot = e.slot;
+        if (node == NULL)
+            continue;
+        while (!open.empty() && open.back().second >= e.depth) {
+            instances[open.back().first].end = instances.size();
+            open.pop_back();
+        }
+        open.push_back(std::make_pair((uint32_t) instances.size(), e.depth));
+        Transform* transform = nodeCast<Transform>(node);
+        if (transform != NULL) {
+            Slot s = { transform, slot, 0, true };
+            slot = slots.size();
+            slots.push_back(s);
+        }
+        Instance instance = { node, slot, NONE, NONE };
+        instances.push_back(instance);
+
+        const MFNode<X3DChildNode>* children = NULL;
+        X3DGroupingNode* group = nodeCast<X3DGroupingNode>(node);
+        if (group != NULL) {
+            children = &group->children();
+        } else {
+            // a compiled group's contents are in its CompiledGroup
+            StaticGroup* sg = nodeCast<StaticGroup>(node);
+            if (sg != NULL && !sg->isCompiled())
+                children = &sg->children();
+        }
+        if (children == NULL)
+            continue;
+        size_t top = stack.size();
+        MFNode<X3DChildNode>::const_iterator it;
+        for (it = children->begin(); it != children->end(); it++) {
+            Entry child = { (Node*) *it, slot, e.depth + 1 };
+            stack.push_back(child);
+        }
+        std::reverse(stack.begin() + top, stack.end());
+    }
+    for (size_t i = 0; i < open.size(); i++)
+        instances[open[i].first].end = instances.size();
+    worlds.resize(16 * slots.size());
+
+    // index the instances; going backwards leaves each node's first
+    // instance at the head of its chain
+    size_t size = 16;
+    while (size < 2 * instances.size())
+        size *= 2;
+    table.assign(size, 0);
+    for (size_t i = instances.size(); i-- > 0; ) {
+        instances[i].next = find(instances[i].node);
+        place(instances[i].node, i);
+    }
+    stale = false;
+    first = 1;
+    version++;
+}
+
+uint32_t TransformHierarchy::find(Node* node) const {
+    if (table.empty())
+        return NONE;
+    size_t mask = table.size() - 1;
+    size_t h = ((size_t) node >> 4) * 2654435761u;
+    size_t i = (h ^ (h >> 16)) & mask;
+    for (; table[i] != 0; i = (i + 1) & mask)
+        if (instances[table[i] - 1].node == node)
+            return table[i] - 1;
+    return NONE;
+}
+
+void TransformHierarchy::place(Node* node, uint32_t instance) {
+    size_t mask = table.size() - 1;
+    size_t h = ((size_t) node >> 4) * 2654435761u;
+    size_t i = (h ^ (h >> 16)) & mask;
+    while (table[i] != 0 && instances[table[i] - 1].node != node)
+        i = (i + 1) & mask;
+    table[i] = instance + 1;
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "internal/UpdateBuffer.h"
+#include "internal/SAIField.h"
+#include "internal/EventLog.h"
+
+namespace X3D {
+
+UpdateBuffer::~UpdateBuffer() {
+    clear();
+}
+
+void UpdateBuffer::first(SAIField* field, const X3DField& value) {
+    X3DField::Type type = value.getType();
+    // keep the next slot's buffer if it is of the type; otherwise hand
+    // it to the spare lists and take one which is
+    if (used == writes.size() || writes[used].type != type) {
+        X3DField* buffer;
+        if (spare[type].empty()) {
+            buffer = X3DField::create(type);
+        } else {
+            buffer = spare[type].back();
+            spare[type].pop_back();
+        }
+        Write write = { NULL, buffer, type, &typeid(*buffer) };
+        if (used == writes.size()) {
+            writes.push_back(write);
+        } else {
+            spare[writes[used].type].push_back(writes[used].value);
+            writes[used] = write;
+        }
+    }
+    (*writes[used].value)(value);
+    writes[used].field = field;
+    take(field);
+}
+
+void UpdateBuffer::remove(SAIField* field) {
+    writes[field->updateSlot].field = NULL;
+    field->flags &= ~SAIField::PENDING;
+    pending--;
+}
+
+size_t UpdateBuffer::apply(EventRecorder* recorder) {
+    // a field's action may write more fields; those not yet sent take the
+    // value, the rest take new slots at the end and are sent below
+    size_t sent = 0;
+    applying++;
+    try {
+        while (next < used) {
+            SAIField* field = writes[next].field;
+            X3DField* value = writes[next].value;
+            next++;
+            if (field == NULL)
+                continue;
+            field->flags &= ~SAIField::PENDING;
+            pending--;
+            if (recorder != NULL)
+                recorder->send(field, *value);
+            field->set(*value);
+            sent++;
+        }
+    } catch (...) {
+        for (; next < used; next++)
+            if (writes[next].field != NULL)
+                writes[next].field->flags &= ~SAIField::PENDING;
+        pending = 0;
+        if (--applying == 0)
+            used = next = 0;
+        throw;
+    }
+    if (--applying == 0)
+        used = next = 0;
+    return sent;
+}
+
+void UpdateBuffer::clear() {
+    for (size_t i = 0; i < writes.size(); i++) {
+        if (i >= next && i < used && writes[i].field != NULL)
+            writes[i].field->flags &= ~SAIField::PENDING;
+        delete writes[i].value;
+    }
+    vector<Write>().swap(writes);
+    for (size_t t = 0; t <= X3DField::MFVEC4F; t++) {
+        for (size_t i = 0; i < spare[t].size(); i++)
+            delete spare[t][i];
+        vector<X3DField*>().swap(spare[t]);
+    }
+    used = next = 0;
+    pending = 0;
+    replaced = 0;
+}
+
+}
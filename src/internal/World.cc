@@ -22,7 +22,7 @@
 namespace X3D {
 
 World::~World() {
-    // do nothing?
+    browser->leaveScope(&scope);
 }
 
 World* World::read(Browser* browser, const char* filename) {
@@ -31,8 +31,17 @@ World* World::read(Browser* browser, const char* filename) {
     doc = xmlReadFile(filename, NULL, 0);
     if (doc == NULL)
         throw X3DError("failed to parse file");
-    world->parseRoot(xmlDocGetRootElement(doc));
+    browser->enterScope(&world->scope);
+    try {
+        world->parseRoot(xmlDocGetRootElement(doc));
+    } catch (X3DError& e) {
+        xmlFreeDoc(doc);
+        delete world;
+        throw;
+    }
     xmlFreeDoc(doc);
+    browser->analyzeRoutes();
+    browser->compileStaticGroups();
     return world;
 }
 
@@ -167,10 +176,18 @@ void World::parseProtoDeclare(xmlNode* xml) {
     if (body == NULL)
         throw X3DParserError("ProtoBody section required", filename, xml);
 
-    // get the body nodes
+    // get the body nodes; their names are private to the prototype
     vector<Node*> bodyNodes;
     vector<Connect> connects;
-    parseProtoBody(body, bodyNodes, connects);
+    Scope bodyScope;
+    browser->enterScope(&bodyScope);
+    try {
+        parseProtoBody(body, bodyNodes, connects);
+    } catch (X3DError& e) {
+        browser->leaveScope(&bodyScope);
+        throw;
+    }
+    browser->leaveScope(&bodyScope);
 
     // get the fields
     vector<ProtoFieldDef*> fields;
@@ -178,7 +195,6 @@ void World::parseProtoDeclare(xmlNode* xml) {
         parseProtoInterface(interface, fields);
 
     // make the prototype and add to global scope
-    // TODO: create a scope class to hold named objects
     Prototype* proto = Prototype::create(name, bodyNodes, connects, fields);
     //browser->addPrototype(proto);
 }
@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <sstream>
 
 using std::cout;
 using std::endl;
@@ -182,6 +183,9 @@ X3DField::Type X3DField::getTypeFromName(const string& typeName) {
 
 // XXX this is duuuuuuumb
 X3DField* X3DField::create(Type type) {
+    // lists of a type are created as arrays
+    if (type >= MFBOOL)
+        return create(getTypeName(type) + "Array");
     return create(getTypeName(type));
 }
 
@@ -235,11 +239,39 @@ X3DField* X3DField::create(const string& typeName) {
     return constructorMap[typeName]();
 }
 
+void X3DField::encode(Encoder& out) const {
+    std::ostringstream os;
+    print(os);
+    out.putString(os.str());
+}
+
+bool X3DField::decode(Decoder& in) {
+    string s;
+    if (!in.getString(s))
+        return false;
+    std::istringstream is(s);
+    return parse(is);
+}
+
+unsigned int X3DField::digest() const {
+    Digest digest;
+    encode(digest);
+    return digest.value;
+}
+
 std::ostream& operator<<(std::ostream& os, const X3DField& f) {
     f.print(os);
     return os;
 }
 
+size_t valueHeapBytes(const string& value) {
+    const char* data = value.data();
+    const char* self = (const char*) &value;
+    if (data >= self && data < self + sizeof(string))
+        return 0;
+    return value.capacity() + 1;
+}
+
 bool X3DField::float_close(double u, double v) {
     double d = fabs(u - v);
     if (d < 1e-150)
@@ -30,7 +30,9 @@
 #include "Interpolation/CoordinateInterpolator2D.h"
 #include "Interpolation/ScalarInterpolator.h"
 #include "Interpolation/EaseInEaseOut.h"
-#include "Grouping/X3DGroupingNode.h"
+#include "Grouping/Group.h"
+#include "Grouping/StaticGroup.h"
+#include "Grouping/Transform.h"
 
 #include <string>
 
@@ -429,6 +431,50 @@ void Builtin::init(Profile* profile) {
             gn->createField("children", &X3DGroupingNode::children);
             gn->finish();
         }
+
+        // Group : X3DGroupingNode
+        NodeDefImpl<Group>* g =
+            group->createNode<Group>("Group");
+        {
+            g->inherits("X3DGroupingNode");
+            g->finish();
+        }
+
+        // StaticGroup : X3DChildNode, X3DBoundedObject
+        NodeDefImpl<StaticGroup>* sg =
+            group->createNode<StaticGroup>("StaticGroup");
+        {
+            sg->inherits("X3DChildNode");
+            sg->inherits("X3DBoundedObject");
+
+            // MFNode [] children [] [X3DChildNode]
+            sg->createField("children", &StaticGroup::children);
+            sg->finish();
+        }
+
+        // Transform : X3DGroupingNode
+        NodeDefImpl<Transform>* tr =
+            group->createNode<Transform>("Transform");
+        {
+            tr->inherits("X3DGroupingNode");
+
+            // SFVec3f [in,out] center 0 0 0
+            tr->createField("center", &Transform::center);
+
+            // SFRotation [in,out] rotation 0 0 1 0
+            tr->createField("rotation", &Transform::rotation);
+
+            // SFVec3f [in,out] scale 1 1 1
+            tr->createField("scale", &Transform::scale);
+
+            // SFRotation [in,out] scaleOrientation 0 0 1 0
+            tr->createField("scaleOrientation", &Transform::scaleOrientation);
+
+            // SFVec3f [in,out] translation 0 0 0
+            tr->createField("translation", &Transform::translation);
+
+            tr->finish();
+        }
     }
 }
 
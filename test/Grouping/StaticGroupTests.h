@@ -0,0 +1,144 @@
+#include "Grouping/Group.h"
+#include "Grouping/StaticGroup.h"
+#include "Grouping/Transform.h"
+
+using X3D::Grouping::Group;
+using X3D::Grouping::StaticGroup;
+using X3D::Grouping::Transform;
+
+class StaticGroupTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// @returns a new realized Transform, added to the group if given
+    Transform* transform(MFNodeSet<X3DChildNode>* children,
+                         const SFVec3f& translation) {
+        Transform* node = browser()->createNode<Transform>("Transform");
+        node->translation(translation);
+        node->realize();
+        if (children != NULL)
+            children->add(node);
+        return node;
+    }
+
+    /// @returns the point transformed by the row-major matrix
+    SFVec3f apply(const float* a, const SFVec3f& p) {
+        return SFVec3f(
+            a[0]*p.x + a[1]*p.y + a[2]*p.z + a[3],
+            a[4]*p.x + a[5]*p.y + a[6]*p.z + a[7],
+            a[8]*p.x + a[9]*p.y + a[10]*p.z + a[11]);
+    }
+
+    void expectNear(const SFVec3f& expected, const SFVec3f& actual) {
+        EXPECT_NEAR(expected.x, actual.x, 1e-5);
+        EXPECT_NEAR(expected.y, actual.y, 1e-5);
+        EXPECT_NEAR(expected.z, actual.z, 1e-5);
+    }
+};
+
+TEST_F(StaticGroupTests, ShouldFlattenContentsWhenRead) {
+    World* world = World::read(browser(), "data/Static.xml");
+    StaticGroup* model = nodeCast<StaticGroup>(browser()->getNode("model"));
+    Node* arm = browser()->getNode("arm");
+    Node* hand = browser()->getNode("hand");
+    ASSERT_TRUE(model->isCompiled());
+    const CompiledGroup* compiled = model->getCompiled();
+    ASSERT_EQ(3, compiled->size());
+
+    // the hand follows the arm, with the arm's transform multiplied in
+    size_t i = compiled->indexOf(arm);
+    ASSERT_LT(i, 2);
+    EXPECT_EQ(hand, compiled->getNode(i + 1));
+    EXPECT_EQ(i + 2, compiled->getEnd(i));
+    EXPECT_EQ(i + 2, compiled->getEnd(i + 1));
+    expectNear(SFVec3f(1, 2, 0),
+        apply(compiled->getMatrix(i + 1), SFVec3f(0, 0, 0)));
+    expectNear(SFVec3f(3, 4, 2),
+        apply(compiled->getMatrix(i + 1), SFVec3f(1, 1, 1)));
+
+    // the contents' bounds become the group's
+    ASSERT_EQ(2, compiled->boxCount());
+    BoundingBox box = model->getBBox();
+    expectNear(SFVec3f(-1.0f, -1.5f, -1.0f), box.min);
+    expectNear(SFVec3f(2, 3, 1), box.max);
+    box = model->getBounds();
+    expectNear(SFVec3f(-11.0f, -1.5f, -1.0f), box.min);
+    expectNear(SFVec3f(-8, 3, 1), box.max);
+
+    // the transform hierarchy stops at the group
+    EXPECT_TRUE(browser()->transforms.contains(model));
+    EXPECT_FALSE(browser()->transforms.contains(arm));
+    EXPECT_FALSE(browser()->transforms.contains(hand));
+
+    StaticGroup* routed = nodeCast<StaticGroup>(browser()->getNode("routed"));
+    EXPECT_FALSE(routed->isCompiled());
+    EXPECT_TRUE(browser()->transforms.contains(browser()->getNode("mover")));
+    delete world;
+}
+
+TEST_F(StaticGroupTests, ShouldFreezeContents) {
+    StaticGroup* group = browser()->createNode<StaticGroup>("StaticGroup");
+    group->realize();
+    browser()->addRoot(group);
+    Transform* inside = transform(&group->children(), SFVec3f(1, 0, 0));
+    Transform* outside = transform(NULL, SFVec3f(0, 0, 0));
+    ASSERT_TRUE(group->compile());
+    EXPECT_TRUE(group->compile());
+
+    EXPECT_THROW(inside->translation(SFVec3f(2, 0, 0)), X3DError);
+    EXPECT_THROW(inside->translation.send(SFVec3f(2, 0, 0)), X3DError);
+    EXPECT_THROW(browser()->createRoute(
+        outside, "translation_changed", inside, "set_translation"), X3DError);
+    EXPECT_THROW(browser()->createRoute(
+        inside, "translation_changed", outside, "set_translation"), X3DError);
+    expectNear(SFVec3f(1, 0, 0), inside->translation());
+
+    // routes keep a group's contents dynamic
+    StaticGroup* other = browser()->createNode<StaticGroup>("StaticGroup");
+    other->realize();
+    Transform* routed = transform(&other->children(), SFVec3f(0, 0, 0));
+    browser()->createRoute(
+        outside, "translation_changed", routed, "set_translation");
+    EXPECT_FALSE(other->compile());
+    EXPECT_FALSE(other->isCompiled());
+    routed->translation(SFVec3f(3, 0, 0));
+}
+
+TEST_F(StaticGroupTests, ShouldShareContentsAcrossInstances) {
+    StaticGroup* group = browser()->createNode<StaticGroup>("StaticGroup");
+    group->realize();
+    Transform* inside = transform(&group->children(), SFVec3f(0, 0, 0));
+    inside->bboxSize.value = SFVec3f(1, 1, 1);
+    for (int i = 0; i < 3; i++)
+        transform(&group->children(), SFVec3f(0.0f, 0.0f, i + 1.0f));
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    for (int i = 0; i < 10; i++)
+        transform(&root->children(), SFVec3f(i * 10.0f, 0.0f, 0.0f))
+            ->children().add(group);
+    ASSERT_EQ(1, browser()->compileStaticGroups());
+    EXPECT_EQ(0, browser()->compileStaticGroups());
+
+    // each use is one instance, and one object with the group's bounds
+    browser()->bounds.update();
+    EXPECT_EQ(1 + 10 * 2, browser()->transforms.instanceCount());
+    ASSERT_EQ(10, browser()->bounds.getObjects().size());
+    BoundingBox all = browser()->bounds.getSceneBounds();
+    expectNear(SFVec3f(-0.5f, -0.5f, -0.5f), all.min);
+    expectNear(SFVec3f(90.5f, 0.5f, 0.5f), all.max);
+
+    // a clone shares the frozen contents rather than copying them
+    StaticGroup* copy = browser()->createNode<StaticGroup>("StaticGroup");
+    group->cloneInto(copy);
+    ASSERT_EQ(4, copy->children().size());
+    MFNodeSet<X3DChildNode>::iterator a = group->children().begin();
+    MFNodeSet<X3DChildNode>::iterator b = copy->children().begin();
+    for (; a != group->children().end(); a++, b++)
+        EXPECT_EQ((X3DChildNode*) *a, (X3DChildNode*) *b);
+    copy->realize();
+    EXPECT_TRUE(copy->compile());
+    EXPECT_EQ(4, copy->getCompiled()->size());
+}
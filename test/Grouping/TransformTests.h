@@ -0,0 +1,143 @@
+#include "Grouping/Group.h"
+#include "Grouping/Transform.h"
+#include "internal/Checkpoint.h"
+
+#include <cmath>
+
+using X3D::Grouping::Group;
+using X3D::Grouping::Transform;
+using X3D::Grouping::X3DGroupingNode;
+
+class TransformTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// @returns a new realized Transform, added to the parent if given
+    Transform* transform(X3DGroupingNode* parent, const SFVec3f& translation) {
+        Transform* node = browser()->createNode<Transform>("Transform");
+        node->translation(translation);
+        node->realize();
+        if (parent != NULL)
+            parent->children().add(node);
+        return node;
+    }
+
+    void cascade() {
+        browser()->route();
+        browser()->endRoute();
+    }
+
+    /// @returns the point transformed by the matrix
+    SFVec3f apply(const SFMatrix4f& m, const SFVec3f& p) {
+        const float* a = m.array();
+        return SFVec3f(
+            a[0]*p.x + a[1]*p.y + a[2]*p.z + a[3],
+            a[4]*p.x + a[5]*p.y + a[6]*p.z + a[7],
+            a[8]*p.x + a[9]*p.y + a[10]*p.z + a[11]);
+    }
+
+    void expectNear(const SFVec3f& expected, const SFVec3f& actual) {
+        EXPECT_NEAR(expected.x, actual.x, 1e-5);
+        EXPECT_NEAR(expected.y, actual.y, 1e-5);
+        EXPECT_NEAR(expected.z, actual.z, 1e-5);
+    }
+};
+
+TEST_F(TransformTests, ShouldComposeLocalMatrix) {
+    Transform* node = browser()->createNode<Transform>("Transform");
+    node->translation(SFVec3f(1, 2, 3));
+    node->rotation(SFRotation(0, 0, 1, M_PI / 2));
+    node->scale(SFVec3f(2, 2, 2));
+    node->center(SFVec3f(1, 0, 0));
+    // T + C + R S (p - C)
+    expectNear(SFVec3f(0, 2, 3), apply(node->getMatrix(), SFVec3f(1, 1, 0)));
+
+    // the scale is along the axes of scaleOrientation
+    node = browser()->createNode<Transform>("Transform");
+    node->scale(SFVec3f(2, 1, 1));
+    node->scaleOrientation(SFRotation(0, 0, 1, M_PI / 2));
+    expectNear(SFVec3f(0, 2, 0), apply(node->getMatrix(), SFVec3f(0, 1, 0)));
+    expectNear(SFVec3f(1, 0, 0), apply(node->getMatrix(), SFVec3f(1, 0, 0)));
+}
+
+TEST_F(TransformTests, ShouldOnlyRecomputeChangedSubtrees) {
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    Transform* outer = transform(root, SFVec3f(10, 0, 0));
+    Group* group = browser()->createNode<Group>("Group");
+    group->realize();
+    outer->children().add(group);
+    Transform* inner = transform(group, SFVec3f(0, 1, 0));
+    Transform* other = transform(root, SFVec3f(0, 0, 5));
+
+    EXPECT_EQ(3, browser()->transforms.update());
+    EXPECT_EQ(3, browser()->transforms.size());
+    expectNear(SFVec3f(10, 1, 0), apply(inner->getWorldMatrix(), SFVec3f()));
+    expectNear(SFVec3f(10, 0, 0), apply(browser()->transforms.getWorldMatrix(group), SFVec3f()));
+    EXPECT_EQ(0, browser()->transforms.recomputedCount());
+
+    browser()->beginUpdate();
+    outer->translation.set(SFVec3f(20, 0, 0));
+    browser()->endUpdate();
+    expectNear(SFVec3f(20, 1, 0), apply(inner->getWorldMatrix(), SFVec3f()));
+    EXPECT_EQ(2, browser()->transforms.recomputedCount());
+
+    browser()->beginUpdate();
+    inner->translation.set(SFVec3f(0, 2, 0));
+    browser()->endUpdate();
+    EXPECT_EQ(1, browser()->transforms.update());
+    expectNear(SFVec3f(20, 2, 0), apply(inner->getWorldMatrix(), SFVec3f()));
+    expectNear(SFVec3f(0, 0, 5), apply(other->getWorldMatrix(), SFVec3f()));
+}
+
+TEST_F(TransformTests, ShouldRebuildWhenChildrenChange) {
+    Transform* root = transform(NULL, SFVec3f(1, 0, 0));
+    browser()->addRoot(root);
+    Transform* left = transform(root, SFVec3f(0, 1, 0));
+    Transform* right = transform(root, SFVec3f(0, 2, 0));
+    Transform* shared = transform(NULL, SFVec3f(0, 0, 1));
+    EXPECT_FALSE(browser()->transforms.contains(shared));
+    EXPECT_THROW(shared->getWorldMatrix(), X3DError);
+
+    MFNodeArray<X3DChildNode> nodes;
+    nodes.add(shared);
+    right->addChildren(nodes);
+    cascade();
+    expectNear(SFVec3f(1, 2, 1), apply(shared->getWorldMatrix(), SFVec3f()));
+
+    // a node used twice gets a slot for each instance
+    left->addChildren(nodes);
+    cascade();
+    EXPECT_EQ(5, browser()->transforms.update());
+    left->removeChildren(nodes);
+    cascade();
+    expectNear(SFVec3f(1, 2, 1), apply(shared->getWorldMatrix(), SFVec3f()));
+
+    // both instances follow a change to the shared node
+    left->addChildren(nodes);
+    cascade();
+    browser()->transforms.update();
+    browser()->beginUpdate();
+    shared->translation.set(SFVec3f(0, 0, 2));
+    browser()->endUpdate();
+    EXPECT_EQ(2, browser()->transforms.update());
+}
+
+TEST_F(TransformTests, ShouldFollowRestoredCheckpoints) {
+    Transform* root = transform(NULL, SFVec3f(1, 0, 0));
+    browser()->addRoot(root);
+    Transform* child = transform(root, SFVec3f(0, 1, 0));
+    Checkpoint* checkpoint = browser()->checkpoint();
+
+    browser()->beginUpdate();
+    root->translation.set(SFVec3f(5, 0, 0));
+    browser()->endUpdate();
+    expectNear(SFVec3f(5, 1, 0), apply(child->getWorldMatrix(), SFVec3f()));
+
+    browser()->restore(*checkpoint);
+    expectNear(SFVec3f(1, 1, 0), apply(child->getWorldMatrix(), SFVec3f()));
+    delete checkpoint;
+}
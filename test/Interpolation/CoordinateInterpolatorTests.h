@@ -0,0 +1,63 @@
+#include "Interpolation/CoordinateInterpolator.h"
+
+using X3D::Interpolation::CoordinateInterpolator;
+
+class CoordinateInterpolatorTests : public ::testing::Test {
+protected:
+    CoordinateInterpolator* node;
+
+    /// two points per key, at keys 0, 0.5 and 1
+    void SetUp() {
+        node = browser()->createNode<CoordinateInterpolator>(
+            "CoordinateInterpolator");
+        float keys[] = { 0, 0.5f, 1 };
+        for (int i = 0; i < 3; i++) {
+            node->key().array().push_back(keys[i]);
+            float k = (float) i;
+            node->keyValue().array().push_back(SFVec3f(k, 0.0f, 0.0f));
+            node->keyValue().array().push_back(SFVec3f(0.0f, 10*k, 0.0f));
+        }
+        node->realize();
+    }
+
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// @returns output for a fraction, in a cascade of its own
+    const vector<SFVec3f>& at(float fraction) {
+        node->set_fraction(fraction);
+        browser()->endRoute();
+        return node->value_changed().array();
+    }
+};
+
+TEST_F(CoordinateInterpolatorTests, ShouldMoveEachValueTowardItsCounterpart) {
+    const vector<SFVec3f>& output = at(0.25f);
+    ASSERT_EQ(2, output.size());
+    EXPECT_EQ(SFVec3f(0.5f, 0.0f, 0.0f), output[0]);
+    EXPECT_EQ(SFVec3f(0.0f, 5.0f, 0.0f), output[1]);
+
+    at(0.75f);
+    EXPECT_EQ(SFVec3f(1.5f, 0.0f, 0.0f), output[0]);
+    EXPECT_EQ(SFVec3f(0.0f, 15.0f, 0.0f), output[1]);
+}
+
+TEST_F(CoordinateInterpolatorTests, ShouldHoldFirstKeyBeforeIt) {
+    const vector<SFVec3f>& output = at(-0.5f);
+    ASSERT_EQ(2, output.size());
+    EXPECT_EQ(SFVec3f(0.0f, 0.0f, 0.0f), output[0]);
+    EXPECT_EQ(SFVec3f(0.0f, 0.0f, 0.0f), output[1]);
+}
+
+TEST_F(CoordinateInterpolatorTests, ShouldHoldLastKeyAtAndAfterIt) {
+    const vector<SFVec3f>& output = at(1);
+    ASSERT_EQ(2, output.size());
+    EXPECT_EQ(SFVec3f(2.0f, 0.0f, 0.0f), output[0]);
+    EXPECT_EQ(SFVec3f(0.0f, 20.0f, 0.0f), output[1]);
+
+    at(2);
+    ASSERT_EQ(2, output.size());
+    EXPECT_EQ(SFVec3f(2.0f, 0.0f, 0.0f), output[0]);
+    EXPECT_EQ(SFVec3f(0.0f, 20.0f, 0.0f), output[1]);
+}
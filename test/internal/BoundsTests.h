@@ -0,0 +1,158 @@
+#include "Grouping/Group.h"
+#include "Grouping/Transform.h"
+#include "internal/BoundingVolumeHierarchy.h"
+
+using X3D::Grouping::Group;
+using X3D::Grouping::Transform;
+using X3D::Grouping::X3DGroupingNode;
+
+class BoundsTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->bounds.setParallel(16384);
+        browser()->reset();
+    }
+
+    /// @returns a new realized Transform, with bounds if size is given
+    Transform* transform(X3DGroupingNode* parent, const SFVec3f& translation,
+                         const SFVec3f& size=SFVec3f(-1, -1, -1)) {
+        Transform* node = browser()->createNode<Transform>("Transform");
+        node->translation(translation);
+        node->bboxSize(size);
+        node->realize();
+        if (parent != NULL)
+            parent->children().add(node);
+        return node;
+    }
+
+    void cascade() {
+        browser()->route();
+        browser()->endRoute();
+    }
+
+    void expectBox(const SFVec3f& min, const SFVec3f& max,
+                   const BoundingBox& box) {
+        EXPECT_NEAR(min.x, box.min.x, 1e-5);
+        EXPECT_NEAR(min.y, box.min.y, 1e-5);
+        EXPECT_NEAR(min.z, box.min.z, 1e-5);
+        EXPECT_NEAR(max.x, box.max.x, 1e-5);
+        EXPECT_NEAR(max.y, box.max.y, 1e-5);
+        EXPECT_NEAR(max.z, box.max.z, 1e-5);
+    }
+
+    /// check that every volume contains those and the objects below it
+    void expectContained(const BoundingVolumeHierarchy& bvh, uint32_t v) {
+        const vector<BoundingVolumeHierarchy::Volume>& volumes = bvh.getVolumes();
+        const BoundingBox& box = volumes[v].box;
+        if (volumes[v].count > 0) {
+            for (uint32_t i = 0; i < volumes[v].count; i++) {
+                const BoundingBox& child = bvh.getBoxes()[volumes[v].first + i];
+                EXPECT_TRUE(box.contains(child.min) && box.contains(child.max));
+            }
+            return;
+        }
+        uint32_t children[2] = { v + 1, volumes[v].first };
+        for (int i = 0; i < 2; i++) {
+            const BoundingBox& child = volumes[children[i]].box;
+            EXPECT_TRUE(box.contains(child.min) && box.contains(child.max));
+            expectContained(bvh, children[i]);
+        }
+    }
+};
+
+TEST_F(BoundsTests, ShouldComputeGroupBoundsFromChildren) {
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    Transform* a = transform(root, SFVec3f(5, 0, 0), SFVec3f(2, 2, 2));
+    Transform* outer = transform(root, SFVec3f(0, 10, 0));
+    outer->rotation(SFRotation(0, 0, 1, M_PI / 2));
+    Transform* b = transform(outer, SFVec3f(0, 0, 0), SFVec3f(4, 2, 2));
+    Group* empty = browser()->createNode<Group>("Group");
+    empty->realize();
+    root->children().add(empty);
+
+    expectBox(SFVec3f(4, -1, -1), SFVec3f(6, 1, 1), a->getBounds());
+    // the rotation turns the long side of b along y
+    expectBox(SFVec3f(-1, 8, -1), SFVec3f(1, 12, 1), b->getBounds());
+    expectBox(SFVec3f(-1, 8, -1), SFVec3f(1, 12, 1), outer->getBounds());
+    expectBox(SFVec3f(-1, -1, -1), SFVec3f(6, 12, 1), root->getBounds());
+    expectBox(SFVec3f(-1, -1, -1), SFVec3f(6, 12, 1),
+              browser()->bounds.getSceneBounds());
+    EXPECT_TRUE(empty->getBounds().empty());
+    EXPECT_EQ(2, browser()->bounds.size());
+}
+
+TEST_F(BoundsTests, ShouldRefitWhenTransformsChange) {
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    vector<Transform*> nodes;
+    for (int i = 0; i < 20; i++)
+        nodes.push_back(transform(root, SFVec3f(i, 0, 0), SFVec3f(1, 1, 1)));
+    Transform* mover = transform(root, SFVec3f());
+    Transform* child = transform(mover, SFVec3f(), SFVec3f(1, 1, 1));
+    expectBox(SFVec3f(-0.5, -0.5, -0.5), SFVec3f(19.5, 0.5, 0.5),
+              browser()->bounds.getSceneBounds());
+    EXPECT_EQ(1, browser()->bounds.buildCount());
+
+    browser()->beginUpdate();
+    mover->translation.set(SFVec3f(0, 30, 0));
+    browser()->endUpdate();
+    EXPECT_EQ(1, browser()->bounds.update());
+    EXPECT_EQ(1, browser()->bounds.buildCount());
+    expectBox(SFVec3f(-0.5, 29.5, -0.5), SFVec3f(0.5, 30.5, 0.5),
+              child->getBounds());
+    expectBox(SFVec3f(-0.5, -0.5, -0.5), SFVec3f(19.5, 30.5, 0.5),
+              browser()->bounds.getSceneBounds());
+    expectContained(browser()->bounds, 0);
+    EXPECT_EQ(0, browser()->bounds.update());
+}
+
+TEST_F(BoundsTests, ShouldRebuildWhenChildrenChange) {
+    Transform* root = transform(NULL, SFVec3f());
+    browser()->addRoot(root);
+    transform(root, SFVec3f(1, 0, 0), SFVec3f(1, 1, 1));
+    Transform* extra = transform(NULL, SFVec3f(0, 5, 0), SFVec3f(1, 1, 1));
+    expectBox(SFVec3f(0.5, -0.5, -0.5), SFVec3f(1.5, 0.5, 0.5),
+              root->getBounds());
+
+    MFNodeArray<X3DChildNode> nodes;
+    nodes.add(extra);
+    root->addChildren(nodes);
+    cascade();
+    expectBox(SFVec3f(-0.5, -0.5, -0.5), SFVec3f(1.5, 5.5, 0.5),
+              root->getBounds());
+    EXPECT_EQ(2, browser()->bounds.buildCount());
+    EXPECT_EQ(2, browser()->bounds.size());
+}
+
+TEST_F(BoundsTests, ShouldBuildTheSameTreeInParallel) {
+    Group* root = browser()->createNode<Group>("Group");
+    root->realize();
+    browser()->addRoot(root);
+    vector<Transform*> groups;
+    for (int i = 0; i < 50; i++) {
+        groups.push_back(transform(root, SFVec3f(i % 7, i % 3, i)));
+        for (int j = 0; j < 40; j++) {
+            float x = (float) ((i * 40 + j) * 7919 % 1000);
+            transform(groups.back(), SFVec3f(x, (float) j, -x), SFVec3f(1, 2, 3));
+        }
+    }
+    browser()->bounds.update();
+    vector<BoundingBox> serial;
+    for (size_t i = 0; i < groups.size(); i++)
+        serial.push_back(groups[i]->getBounds());
+    BoundingBox scene = browser()->bounds.getSceneBounds();
+    size_t volumes = browser()->bounds.getVolumes().size();
+
+    browser()->bounds.setParallel(1, 4);
+    browser()->transforms.invalidateStructure();
+    browser()->bounds.update();
+    EXPECT_EQ(2000, browser()->bounds.size());
+    EXPECT_EQ(volumes, browser()->bounds.getVolumes().size());
+    expectContained(browser()->bounds, 0);
+    expectBox(scene.min, scene.max, browser()->bounds.getSceneBounds());
+    for (size_t i = 0; i < groups.size(); i++)
+        expectBox(serial[i].min, serial[i].max, groups[i]->getBounds());
+}
@@ -18,8 +18,12 @@
  */
 
 #include "internal/Browser.h"
+#include "Interpolation/ScalarInterpolator.h"
+#include "Time/TimeSensor.h"
 
 using ::testing::NotNull;
+using X3D::Interpolation::ScalarInterpolator;
+using X3D::Time::TimeSensor;
 
 TEST(Browser, GetSingletonShouldNotBeNull) {
 	EXPECT_THAT(browser(), NotNull()) << "Browser singleton is NULL";
@@ -29,3 +33,39 @@ TEST(Browser, GetSingletonShouldNotBeNull) {
 TEST(Browser, ShouldThrowErrorOnMultipleInstances) {
 	ASSERT_THROW(new Browser(), X3DError) << "Browser is allowing multiple instances";
 }
+
+TEST(Browser, TimersShouldFanInWithinOneFrame) {
+    // created by name, so the browser schedules and ticks them
+    TimeSensor* slow =
+        nodeCast<TimeSensor>(browser()->createNode("TimeSensor"));
+    TimeSensor* fast =
+        nodeCast<TimeSensor>(browser()->createNode("TimeSensor"));
+    ScalarInterpolator* node =
+        browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+    node->key().array().push_back(0);
+    node->key().array().push_back(1);
+    node->keyValue().array().push_back(0);
+    node->keyValue().array().push_back(1);
+    node->realize();
+    // start after the default stopTime of zero
+    double start = browser()->now() + 1;
+    slow->startTime.value = start;
+    slow->cycleInterval.value = 2;
+    slow->loop.value = true;
+    fast->startTime.value = start;
+    fast->loop.value = true;
+    slow->realize();
+    fast->realize();
+    browser()->createRoute(slow, "fraction_changed", node, "set_fraction");
+    browser()->createRoute(fast, "fraction_changed", node, "set_fraction");
+
+    // both sensors tick in one frame and route in one cascade, so the
+    // interpolator sends once, for the first timer to reach it
+    browser()->wake(start + 0.5);
+    while (browser()->now() < start + 0.5)
+        browser()->simulate();
+    EXPECT_EQ(0.25f, slow->fraction_changed());
+    EXPECT_EQ(0.5f, fast->fraction_changed());
+    EXPECT_EQ(0.25f, node->value_changed());
+    browser()->reset();
+}
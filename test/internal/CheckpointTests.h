@@ -0,0 +1,112 @@
+#include "internal/Checkpoint.h"
+#include "internal/SceneGenerator.h"
+#include "Interpolation/CoordinateInterpolator.h"
+
+#include <cstdio>
+#include <memory>
+
+using X3D::Interpolation::CoordinateInterpolator;
+
+class CheckpointTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// @returns encodings of all non-node fields with values, in node order
+    vector<char> state() {
+        ByteBuffer out;
+        const list<Node*>& nodes = browser()->getNodes();
+        list<Node*>::const_iterator it;
+        for (it = nodes.begin(); it != nodes.end(); it++) {
+            FieldIterator fields = (*it)->fields(FieldIterator::ALL);
+            while (fields.hasNext()) {
+                SAIField* field = fields.nextField();
+                X3DField::Type type = field->getType();
+                if (field->getAccess() != SAIField::INPUT_ONLY
+                        && type != X3DField::SFNODE && type != X3DField::MFNODE)
+                    field->getSilently().encode(out);
+            }
+        }
+        out.put(browser()->now());
+        out.put(browser()->getCascade());
+        return out.bytes;
+    }
+
+    /// step the simulation a number of frames
+    void step(int frames) {
+        for (int i = 0; i < frames; i++) {
+            frame++;
+            browser()->wake(frame * 0.05);
+            browser()->simulate();
+        }
+    }
+
+    int frame;
+};
+
+TEST_F(CheckpointTests, ShouldReplayIdenticallyFromRestoredCheckpoint) {
+    SceneGenerator gen;
+    gen.sensors = 2;
+    gen.points = 10;
+    const char* scene = "checkpoint-scene.x3d";
+    gen.write(scene);
+    World* world = World::read(browser(), scene);
+    remove(scene);
+
+    frame = 0;
+    step(10);
+    std::auto_ptr<Checkpoint> checkpoint(browser()->checkpoint());
+    vector<char> saved = state();
+    step(10);
+    vector<char> ahead = state();
+    EXPECT_NE(saved, ahead);
+
+    // roll back, and the same frames give the same state
+    browser()->restore(*checkpoint);
+    EXPECT_EQ(saved, state());
+    EXPECT_EQ(checkpoint->getCascade(), browser()->getCascade());
+    frame = 10;
+    step(10);
+    EXPECT_EQ(ahead, state());
+    delete world;
+}
+
+TEST_F(CheckpointTests, ShouldShareUnchangedValues) {
+    CoordinateInterpolator* node =
+        browser()->createNode<CoordinateInterpolator>("CoordinateInterpolator");
+    node->realize();
+    node->keyValue().array().assign(1000, SFVec3f(1, 2, 3));
+    std::auto_ptr<Checkpoint> first(browser()->checkpoint());
+    EXPECT_EQ(first->fieldCount(), first->copiedCount());
+
+    std::auto_ptr<Checkpoint> second(browser()->checkpoint());
+    EXPECT_EQ(first->fieldCount(), second->fieldCount());
+    EXPECT_EQ(0, second->copiedCount());
+
+    node->keyValue().array()[999].z = 4;
+    node->key().array().push_back(0.5f);
+    std::auto_ptr<Checkpoint> third(browser()->checkpoint());
+    EXPECT_EQ(2, third->copiedCount());
+
+    // older checkpoints keep their own values
+    browser()->restore(*first);
+    EXPECT_EQ(3, node->keyValue().array()[999].z);
+    EXPECT_TRUE(node->key().array().empty());
+    browser()->restore(*third);
+    EXPECT_EQ(4, node->keyValue().array()[999].z);
+    first.reset();
+    second.reset();
+    browser()->restore(*third);
+    EXPECT_EQ(4, node->keyValue().array()[999].z);
+}
+
+TEST_F(CheckpointTests, ShouldRefuseDuringUpdates) {
+    browser()->beginUpdate();
+    EXPECT_THROW(browser()->checkpoint(), X3DError);
+    browser()->endUpdate();
+    std::auto_ptr<Checkpoint> checkpoint(browser()->checkpoint());
+    browser()->beginUpdate();
+    EXPECT_THROW(browser()->restore(*checkpoint), X3DError);
+    browser()->endUpdate();
+}
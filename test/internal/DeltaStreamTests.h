@@ -0,0 +1,113 @@
+#include "internal/DeltaStream.h"
+#include "internal/SceneGenerator.h"
+#include "Interpolation/CoordinateInterpolator.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+using X3D::Interpolation::CoordinateInterpolator;
+
+class DeltaStreamTests : public ::testing::Test {
+protected:
+    /// file name unique to this process
+    string filename;
+
+    void SetUp() {
+        char buf[64];
+        sprintf(buf, "deltas-%d.bin", (int) getpid());
+        filename = buf;
+    }
+
+    void TearDown() {
+        remove(filename.c_str());
+        browser()->reset();
+    }
+
+    /// @returns encodings of all non-node output fields, in node order
+    vector<char> state() {
+        ByteBuffer out;
+        const list<Node*>& nodes = browser()->getNodes();
+        list<Node*>::const_iterator it;
+        for (it = nodes.begin(); it != nodes.end(); it++) {
+            FieldIterator fields = (*it)->fields(FieldIterator::OUTPUT);
+            while (fields.hasNext()) {
+                SAIField* field = fields.nextField();
+                X3DField::Type type = field->getType();
+                if (type != X3DField::SFNODE && type != X3DField::MFNODE)
+                    field->getSilently().encode(out);
+            }
+        }
+        return out.bytes;
+    }
+};
+
+TEST_F(DeltaStreamTests, ShouldMirrorGeneratedScene) {
+    SceneGenerator gen;
+    gen.sensors = 2;
+    gen.points = 20;
+    const char* scene = "delta-scene.x3d";
+    gen.write(scene);
+
+    World* world = World::read(browser(), scene);
+    vector<char> initial = state();
+    browser()->deltas.open(filename);
+    for (int i = 0; i <= 20; i++) {
+        browser()->wake(i * 0.05);
+        browser()->simulate();
+    }
+    vector<char> final = state();
+    size_t deltas = browser()->deltas.deltaCount();
+    EXPECT_LT(0, deltas);
+    browser()->deltas.close();
+    EXPECT_NE(initial, final);
+    delete world;
+    browser()->reset();
+
+    // a mirror reads the same scene and only replays, never simulates
+    world = World::read(browser(), scene);
+    remove(scene);
+    EXPECT_EQ(initial, state());
+    DeltaReader reader;
+    reader.open(filename);
+    while (reader.next())
+        ;
+    EXPECT_EQ(deltas, reader.deltaCount());
+    EXPECT_EQ(final, state());
+    delete world;
+}
+
+/// write the first y of an interpolator's output and end the cascade
+static void moveFirst(CoordinateInterpolator* node, float y) {
+    node->value_changed().array()[0].y = y;
+    node->value_changed.changed();
+    browser()->route();
+    browser()->endRoute();
+}
+
+TEST_F(DeltaStreamTests, ShouldXorArraysWhichKeepTheirSize) {
+    CoordinateInterpolator* node =
+        browser()->createNode<CoordinateInterpolator>("CoordinateInterpolator");
+    node->realize();
+    node->value_changed().array().assign(100, SFVec3f(1, 0, 0));
+    DeltaStream& deltas = browser()->deltas;
+    deltas.open(filename);
+
+    // only the first of 100 points moves
+    moveFirst(node, 0.25f);
+    vector<char> full = deltas.lastDelta();
+    moveFirst(node, 0.5f);
+    vector<char> changed = deltas.lastDelta();
+    EXPECT_LT(300 * sizeof(float), full.size());
+    EXPECT_GT(40, changed.size());
+    deltas.close();
+
+    // replaying both restores the value; the second alone can't be
+    node->value_changed().array().assign(100, SFVec3f());
+    DeltaReader reader;
+    EXPECT_THROW(reader.apply(&changed[4], changed.size() - 4), X3DError);
+    reader.apply(&full[4], full.size() - 4);
+    EXPECT_EQ(0.25f, node->value_changed().array()[0].y);
+    reader.apply(&changed[4], changed.size() - 4);
+    EXPECT_EQ(0.5f, node->value_changed().array()[0].y);
+    EXPECT_EQ(1.0f, node->value_changed().array()[99].x);
+}
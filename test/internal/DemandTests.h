@@ -0,0 +1,84 @@
+#include "Interpolation/ScalarInterpolator.h"
+#include "Time/TimeSensor.h"
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class DemandTests : public ::testing::Test {
+protected:
+    void SetUp() {
+        browser()->setDemandDriven(true);
+    }
+
+    void TearDown() {
+        browser()->setDemandDriven(false);
+        browser()->reset();
+    }
+
+    /// a realized interpolator whose output equals its input
+    ScalarInterpolator* identity() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+};
+
+TEST_F(DemandTests, UnobservedInterpolatorShouldNotRun) {
+    ScalarInterpolator* node = identity();
+    node->set_fraction(0.5f);
+    EXPECT_FALSE(node->value_changed.isDirty());
+    EXPECT_EQ(0, node->value_changed());
+    browser()->endRoute();
+
+    // catches up on the next input once watched
+    browser()->watch(&node->value_changed);
+    EXPECT_TRUE(node->value_changed.isObserved());
+    node->set_fraction(0.5f);
+    EXPECT_TRUE(node->value_changed.isDirty());
+    EXPECT_EQ(0.5f, node->value_changed());
+    browser()->endRoute();
+
+    browser()->unwatch(&node->value_changed);
+    EXPECT_FALSE(node->value_changed.isObserved());
+    node->set_fraction(0.75f);
+    EXPECT_EQ(0.5f, node->value_changed());
+}
+
+TEST_F(DemandTests, RoutedInterpolatorShouldRun) {
+    ScalarInterpolator* from = identity();
+    ScalarInterpolator* to = identity();
+    browser()->createRoute(from, "value_changed", to, "set_fraction");
+    from->set_fraction(0.25f);
+    browser()->route();
+    EXPECT_EQ(0.25f, from->value_changed());
+    EXPECT_EQ(0, to->value_changed());
+}
+
+TEST_F(DemandTests, InterpolatorShouldRunWhenNotDemandDriven) {
+    browser()->setDemandDriven(false);
+    ScalarInterpolator* node = identity();
+    node->set_fraction(0.5f);
+    EXPECT_EQ(0.5f, node->value_changed());
+}
+
+TEST_F(DemandTests, TimeSensorShouldStoreUnobservedOutputs) {
+    Node* sensor = browser()->createNode("TimeSensor");
+    X3D::Time::TimeSensor* ts = nodeCast<X3D::Time::TimeSensor>(sensor);
+    ScalarInterpolator* node = identity();
+    double start = browser()->now();
+    ts->startTime.value = start;
+    sensor->realize();
+    browser()->createRoute(sensor, "fraction_changed", node, "set_fraction");
+    browser()->watch(&node->value_changed);
+    browser()->wake(start + 0.25);
+    while (browser()->now() < start + 0.25)
+        browser()->simulate();
+    EXPECT_EQ(start + 0.25, ts->time());
+    EXPECT_EQ(0.25, ts->elapsedTime());
+    EXPECT_EQ(0.25f, ts->fraction_changed());
+    EXPECT_EQ(0.25f, node->value_changed());
+}
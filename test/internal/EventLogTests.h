@@ -0,0 +1,124 @@
+#include "internal/EventLog.h"
+#include "internal/SceneGenerator.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class EventLogTests : public ::testing::Test {
+protected:
+    /// file names unique to this process
+    string scene, log;
+
+    void SetUp() {
+        char buf[64];
+        sprintf(buf, "events-%d.x3d", (int) getpid());
+        scene = buf;
+        sprintf(buf, "events-%d.log", (int) getpid());
+        log = buf;
+        SceneGenerator gen;
+        gen.sensors = 2;
+        gen.points = 10;
+        gen.write(scene);
+    }
+
+    void TearDown() {
+        remove(scene.c_str());
+        remove(log.c_str());
+        browser()->reset();
+    }
+
+    /// @returns encodings of all non-node output fields, in node order
+    vector<char> state() {
+        ByteBuffer out;
+        const list<Node*>& nodes = browser()->getNodes();
+        list<Node*>::const_iterator it;
+        for (it = nodes.begin(); it != nodes.end(); it++) {
+            FieldIterator fields = (*it)->fields(FieldIterator::OUTPUT);
+            while (fields.hasNext()) {
+                SAIField* field = fields.nextField();
+                X3DField::Type type = field->getType();
+                if (type != X3DField::SFNODE && type != X3DField::MFNODE)
+                    field->getSilently().encode(out);
+            }
+        }
+        return out.bytes;
+    }
+
+    /// @returns the first ScalarInterpolator in the scene
+    ScalarInterpolator* interpolator() {
+        const list<Node*>& nodes = browser()->getNodes();
+        list<Node*>::const_iterator it;
+        for (it = nodes.begin(); it != nodes.end(); it++) {
+            ScalarInterpolator* node = nodeCast<ScalarInterpolator>(*it);
+            if (node != NULL)
+                return node;
+        }
+        return NULL;
+    }
+
+    /// read the scene and record a run with injections and updates
+    void record() {
+        World* world = World::read(browser(), scene.c_str());
+        ScalarInterpolator* node = interpolator();
+        browser()->recorder.open(log);
+        for (int i = 0; i <= 20; i++) {
+            browser()->wake(i * 0.05);
+            if (i % 5 == 2)
+                browser()->injections.inject(&node->set_fraction, SFFloat(0.5f));
+            browser()->simulate();
+            if (i % 7 == 3) {
+                browser()->beginUpdate();
+                node->set_fraction.set(SFFloat(0.25f));
+                browser()->endUpdate();
+            }
+        }
+        browser()->recorder.close();
+        delete world;
+    }
+};
+
+TEST_F(EventLogTests, ShouldReplayRecordedRunIdentically) {
+    record();
+    vector<char> recorded = state();
+    size_t cascades = browser()->recorder.cascadeCount();
+    EXPECT_LT(21, cascades);
+    browser()->reset();
+
+    World* world = World::read(browser(), scene.c_str());
+    EXPECT_NE(recorded, state());
+    EventReplayer replayer;
+    replayer.open(log);
+    EXPECT_TRUE(replayer.run());
+    EXPECT_EQ(0, replayer.mismatchCount());
+    EXPECT_EQ(cascades, replayer.getCascades().size());
+    EXPECT_TRUE(replayer.getCascades().back().matched);
+    EXPECT_EQ(recorded, state());
+    delete world;
+}
+
+TEST_F(EventLogTests, ShouldReportCascadesWhichDiverge) {
+    record();
+    browser()->reset();
+
+    // the same scene, with one interpolator's values changed
+    World* world = World::read(browser(), scene.c_str());
+    interpolator()->keyValue().array().assign(2, 7.0f);
+    EventReplayer replayer;
+    replayer.open(log);
+    EXPECT_FALSE(replayer.run());
+    EXPECT_LT(0, replayer.mismatchCount());
+    std::ostringstream report;
+    replayer.print(report);
+    EXPECT_NE(string::npos, report.str().find("MISMATCH"));
+    delete world;
+}
+
+TEST_F(EventLogTests, ShouldRejectOtherFiles) {
+    EventReplayer replayer;
+    EXPECT_THROW(replayer.open(scene), X3DError);
+    EXPECT_FALSE(replayer.isOpen());
+}
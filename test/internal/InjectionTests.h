@@ -0,0 +1,100 @@
+#include "internal/InjectionQueue.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <pthread.h>
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class InjectionTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// a realized interpolator whose output equals its input
+    ScalarInterpolator* identity() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+};
+
+/// a producer thread and the field it injects into
+struct Injector {
+    InjectionQueue* queue;
+    SAIField* field;
+    int count;
+};
+
+/// inject fractions counting up to one
+static void* injectFractions(void* arg) {
+    Injector* injector = (Injector*) arg;
+    for (int i = 1; i <= injector->count; i++)
+        injector->queue->inject(injector->field, SFFloat((float) i / injector->count));
+    return NULL;
+}
+
+TEST_F(InjectionTests, ShouldCoalesceValuesPerField) {
+    ScalarInterpolator* a = identity();
+    ScalarInterpolator* b = identity();
+    ScalarInterpolator* sink = identity();
+    browser()->createRoute(a, "value_changed", sink, "set_fraction");
+    InjectionQueue& queue = browser()->injections;
+    queue.inject(&a->set_fraction, SFFloat(0.25f));
+    queue.inject(&b->set_fraction, SFFloat(0.5f));
+    queue.inject(&a->set_fraction, SFFloat(0.75f));
+    EXPECT_EQ(3, queue.getDepth());
+    EXPECT_EQ(0, a->value_changed());
+
+    // the cascade routes the injected values
+    EXPECT_TRUE(browser()->simulate());
+    EXPECT_EQ(0.75f, a->value_changed());
+    EXPECT_EQ(0.5f, b->value_changed());
+    EXPECT_EQ(0.75f, sink->value_changed());
+    EXPECT_EQ(0, queue.getDepth());
+    EXPECT_EQ(2, queue.getStats().applied);
+    EXPECT_EQ(1, queue.getStats().coalesced);
+    EXPECT_EQ(3, queue.getStats().maxDepth);
+    EXPECT_LE(queue.getStats().meanLatency(), queue.getStats().maxLatency);
+    EXPECT_FALSE(browser()->simulate());
+}
+
+TEST_F(InjectionTests, ShouldRejectFieldsWithoutInput) {
+    ScalarInterpolator* node = identity();
+    InjectionQueue& queue = browser()->injections;
+    EXPECT_THROW(queue.inject(&node->value_changed, SFFloat(0.5f)), X3DError);
+    EXPECT_THROW(queue.inject(&node->set_fraction, SFInt32(1)), X3DError);
+    EXPECT_EQ(0, queue.getDepth());
+}
+
+TEST_F(InjectionTests, ConcurrentProducersShouldAllArrive) {
+    const int threads = 4, count = 10000;
+    InjectionQueue& queue = browser()->injections;
+    ScalarInterpolator* nodes[threads];
+    Injector injectors[threads];
+    pthread_t ids[threads];
+    for (int i = 0; i < threads; i++) {
+        nodes[i] = identity();
+        Injector injector = { &queue, &nodes[i]->set_fraction, count };
+        injectors[i] = injector;
+        ASSERT_EQ(0, pthread_create(&ids[i], NULL, injectFractions, &injectors[i]));
+    }
+    for (int i = 0; i < threads; i++) {
+        // drain while the producers run, then after they are done
+        while (browser()->simulate())
+            ;
+        pthread_join(ids[i], NULL);
+    }
+    while (browser()->simulate())
+        ;
+    for (int i = 0; i < threads; i++)
+        EXPECT_EQ(1.0f, nodes[i]->value_changed());
+    const InjectionQueue::Stats& stats = queue.getStats();
+    EXPECT_EQ(threads * count, stats.applied + stats.coalesced);
+    EXPECT_EQ(0, queue.getDepth());
+}
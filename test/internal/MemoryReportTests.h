@@ -0,0 +1,91 @@
+#include "internal/MemoryReport.h"
+#include "internal/SceneGenerator.h"
+
+#include <cstdio>
+#include <sstream>
+
+class MemoryReportTests : public RoutingTests {
+};
+
+TEST_F(MemoryReportTests, ShouldCountNodesFieldsAndRoutes) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "testOut", to, "testIn");
+    MemoryReport report = browser()->memoryReport();
+
+    EXPECT_EQ(2, report.nodeCount());
+    const MemoryReport::Entry& type = report.nodeTypes["RouteTestNode"];
+    EXPECT_EQ(2, type.count);
+    EXPECT_EQ(2 * sizeof(RouteTestNode), type.bytes);
+    EXPECT_LT(type.valueBytes, type.bytes);
+
+    // five string fields on each node; the two input-only ones
+    // have no value
+    const MemoryReport::Entry& strings = report.fieldTypes["SFString"];
+    EXPECT_EQ(10, strings.count);
+    EXPECT_EQ(2 * (sizeof(RouteTestNode::TestInField)
+                 + sizeof(RouteTestNode::TestOutField)
+                 + sizeof(DefaultInOutField<RouteTestNode,SFString>)
+                 + sizeof(RouteTestNode::CustomIn)
+                 + sizeof(RouteTestNode::CountingInOut)), strings.bytes);
+    EXPECT_EQ(6 * sizeof(SFString), strings.valueBytes);
+
+    // one route, with an entry in each endpoint's route list
+    EXPECT_EQ(1, report.routes.count);
+    EXPECT_EQ(sizeof(Route), report.routes.bytes);
+    EXPECT_EQ(2, report.routeLists.count);
+    EXPECT_EQ(browser()->routeTable.bytes(), report.routeLists.bytes);
+    EXPECT_EQ(2 * (sizeof(Route*) + 2 * sizeof(void*)), report.routeLists.heapBytes);
+    EXPECT_EQ(type.total() + report.routes.bytes + report.routeLists.total(),
+              report.totalBytes());
+    browser()->reset();
+}
+
+TEST_F(MemoryReportTests, ShouldCountHeapPayload) {
+    RouteTestNode* node = browser()->createNode<RouteTestNode>("RouteTestNode");
+    node->realize();
+    size_t before = browser()->memoryReport().fieldTypes["SFString"].heapBytes;
+    node->testInOut.setSilently(SFString(string(1000, 'x')));
+    MemoryReport report = browser()->memoryReport();
+    EXPECT_GE(report.fieldTypes["SFString"].heapBytes, before + 1000);
+    EXPECT_EQ(report.fieldTypes["SFString"].heapBytes,
+              report.nodeTypes["RouteTestNode"].heapBytes);
+    browser()->reset();
+}
+
+TEST_F(MemoryReportTests, ShouldCountMFElements) {
+    SceneGenerator gen;
+    gen.sensors = 1;
+    gen.keys = 4;
+    gen.points = 100;
+    const char* filename = "generated.x3d";
+    gen.write(filename);
+    World* world = World::read(browser(), filename);
+    remove(filename);
+    MemoryReport report = browser()->memoryReport();
+    // the world's WorldInfo is a node too
+    EXPECT_EQ(gen.countNodes() + 1, report.nodeCount());
+    EXPECT_EQ(gen.countRoutes(), report.routes.count);
+    EXPECT_GE(report.fieldTypes["MFVec3f"].heapBytes, 400 * sizeof(SFVec3f));
+    EXPECT_GE(report.nodeTypes["CoordinateInterpolator"].heapBytes, 400 * sizeof(SFVec3f));
+    delete world;
+    browser()->reset();
+}
+
+TEST_F(MemoryReportTests, ShouldWriteJson) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "testOut", to, "testIn");
+    std::ostringstream os;
+    browser()->memoryReport().writeJson(os);
+    string json = os.str();
+    EXPECT_NE(string::npos, json.find("\"nodes\":2,"));
+    EXPECT_NE(string::npos, json.find("\"routes\":{\"count\":1,"));
+    EXPECT_NE(string::npos, json.find("{\"name\":\"RouteTestNode\",\"count\":2,"));
+    EXPECT_NE(string::npos, json.find("{\"name\":\"SFString\",\"count\":10,"));
+    browser()->reset();
+}
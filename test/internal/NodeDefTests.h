@@ -0,0 +1,50 @@
+#include "Time/TimeSensor.h"
+#include "Core/MetadataDouble.h"
+
+using X3D::Time::TimeSensor;
+using X3D::Core::MetadataDouble;
+
+TEST(NodeDefTests, ShouldComputeCapabilities) {
+    NodeDef* def = browser()->profile->getNode("TimeSensor");
+    EXPECT_TRUE(def->is(NodeDef::SENSOR));
+    EXPECT_TRUE(def->is(NodeDef::TIME_DEPENDENT));
+    EXPECT_FALSE(def->is(NodeDef::BINDABLE));
+    EXPECT_FALSE(def->is(NodeDef::GROUPING));
+    def = browser()->profile->getNode("MetadataDouble");
+    EXPECT_FALSE(def->is(NodeDef::SENSOR));
+    EXPECT_FALSE(def->is(NodeDef::TIME_DEPENDENT));
+    def = browser()->profile->getNode("X3DGroupingNode");
+    EXPECT_TRUE(def->is(NodeDef::GROUPING));
+}
+
+TEST(NodeDefTests, NodeCastShouldMatchDynamicCast) {
+    Node* node = browser()->createNode("TimeSensor");
+    EXPECT_EQ(dynamic_cast<TimeSensor*>(node), nodeCast<TimeSensor>(node));
+    EXPECT_EQ(dynamic_cast<X3DSensorNode*>(node), nodeCast<X3DSensorNode>(node));
+    EXPECT_EQ(dynamic_cast<X3DTimeDependentNode*>(node),
+              nodeCast<X3DTimeDependentNode>(node));
+    EXPECT_EQ(dynamic_cast<X3DChildNode*>(node), nodeCast<X3DChildNode>(node));
+    EXPECT_EQ(dynamic_cast<X3DNode*>(node), nodeCast<X3DNode>(node));
+    EXPECT_EQ(NULL, nodeCast<MetadataDouble>(node));
+    const Node* cnode = node;
+    EXPECT_EQ(dynamic_cast<const X3DSensorNode*>(cnode),
+              nodeCast<X3DSensorNode>(cnode));
+    EXPECT_EQ(NULL, nodeCast<TimeSensor>((Node*) NULL));
+    browser()->reset();
+}
+
+TEST(NodeDefTests, ShouldIndexOutputFields) {
+    NodeDef* def = browser()->profile->getNode("TimeSensor");
+    Node* node = browser()->createNode("TimeSensor");
+    ASSERT_FALSE(def->outputs.empty());
+    for (size_t i = 0; i < def->outputs.size(); i++) {
+        EXPECT_TRUE(def->outputs[i]->outputCapable());
+        EXPECT_EQ(i, def->outputs[i]->getField(node)->index);
+    }
+    size_t count = 0;
+    FieldIterator it = node->fields(FieldIterator::OUTPUT);
+    while (it.hasNext())
+        EXPECT_EQ(def->outputs[count++], it.nextFieldDef());
+    EXPECT_EQ(def->outputs.size(), count);
+    browser()->reset();
+}
@@ -0,0 +1,126 @@
+#include "internal/FramePipeline.h"
+#include "Interpolation/CoordinateInterpolator.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+using X3D::Interpolation::CoordinateInterpolator;
+using X3D::Interpolation::ScalarInterpolator;
+
+class PipelineTests : public ::testing::Test {
+protected:
+    void SetUp() {
+        browser()->setPipelined(true);
+    }
+
+    void TearDown() {
+        browser()->setPipelined(false);
+        browser()->reset();
+    }
+
+    /// a realized interpolator whose output equals its input
+    ScalarInterpolator* identity() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+};
+
+TEST_F(PipelineTests, RoutesShouldTakeOneFrame) {
+    ScalarInterpolator* first = identity();
+    ScalarInterpolator* second = identity();
+    ScalarInterpolator* third = identity();
+    browser()->createRoute(first, "value_changed", second, "set_fraction");
+    browser()->createRoute(second, "value_changed", third, "set_fraction");
+    const FramePipeline& pipeline = browser()->getPipeline();
+    size_t frame = pipeline.getFrame();
+
+    first->set_fraction(0.5f);
+    browser()->route();
+    EXPECT_EQ(0, second->value_changed());
+    browser()->endRoute();
+    EXPECT_EQ(frame + 1, pipeline.getFrame());
+    EXPECT_TRUE(pipeline.isPending());
+
+    ASSERT_TRUE(browser()->simulate());
+    EXPECT_EQ(0.5f, second->value_changed());
+    EXPECT_EQ(0, third->value_changed());
+    ASSERT_TRUE(browser()->simulate());
+    EXPECT_EQ(0.5f, third->value_changed());
+    EXPECT_FALSE(pipeline.isPending());
+    EXPECT_FALSE(browser()->simulate());
+}
+
+TEST_F(PipelineTests, ReadersShouldSeeCommittedValues) {
+    ScalarInterpolator* node = identity();
+    const FramePipeline& pipeline = browser()->getPipeline();
+    browser()->watch(&node->value_changed);
+    EXPECT_EQ(NULL, pipeline.getCommitted(&node->value_changed));
+
+    node->set_fraction(0.25f);
+    browser()->endRoute();
+    const X3DField* committed = pipeline.getCommitted(&node->value_changed);
+    ASSERT_TRUE(committed != NULL);
+    EXPECT_EQ(0.25f, SFFloat::unwrap(*committed));
+
+    // the next frame changes the field, not the committed value
+    node->set_fraction(0.75f);
+    EXPECT_EQ(0.75f, node->value_changed());
+    EXPECT_EQ(0.25f, SFFloat::unwrap(*committed));
+    browser()->endRoute();
+    EXPECT_EQ(0.75f, SFFloat::unwrap(*committed));
+}
+
+TEST_F(PipelineTests, ShouldSkipUnobservedFields) {
+    ScalarInterpolator* node = identity();
+    node->set_fraction(0.5f);
+    browser()->endRoute();
+    EXPECT_EQ(NULL, browser()->getPipeline().getCommitted(&node->value_changed));
+    EXPECT_FALSE(browser()->getPipeline().isPending());
+}
+
+TEST_F(PipelineTests, ShouldCommitAndDeliverMFValues) {
+    CoordinateInterpolator* from = browser()->createNode<
+        CoordinateInterpolator>("CoordinateInterpolator");
+    CoordinateInterpolator* to = browser()->createNode<
+        CoordinateInterpolator>("CoordinateInterpolator");
+    from->key().array().push_back(0);
+    from->key().array().push_back(1);
+    from->keyValue().array().push_back(SFVec3f(0.0f, 0.0f, 0.0f));
+    from->keyValue().array().push_back(SFVec3f(2.0f, 4.0f, 6.0f));
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "value_changed", to, "keyValue");
+
+    from->set_fraction(0.5f);
+    browser()->endRoute();
+    const X3DField* committed =
+        browser()->getPipeline().getCommitted(&from->value_changed);
+    ASSERT_TRUE(committed != NULL);
+    EXPECT_TRUE(*committed == from->value_changed());
+
+    ASSERT_TRUE(browser()->simulate());
+    ASSERT_EQ(1, to->keyValue().array().size());
+    EXPECT_EQ(SFVec3f(1.0f, 2.0f, 3.0f), to->keyValue().array()[0]);
+}
+
+TEST_F(PipelineTests, ShouldForgetFreedFields) {
+    // made by hand, since the browser frees the nodes it makes
+    RouteTestNode* gone = new RouteTestNode();
+    gone->testOut.setNode(gone);
+    gone->realize();
+    browser()->watch(&gone->testOut);
+    gone->testOut("a");
+    browser()->endRoute();
+    const FramePipeline& pipeline = browser()->getPipeline();
+    SAIField* field = &gone->testOut;
+    ASSERT_TRUE(pipeline.getCommitted(field) != NULL);
+    EXPECT_TRUE(pipeline.isPending());
+    delete gone;
+    EXPECT_EQ(NULL, pipeline.getCommitted(field));
+    EXPECT_FALSE(pipeline.isPending());
+    EXPECT_FALSE(browser()->simulate());
+}
@@ -0,0 +1,92 @@
+#include "internal/Profiler.h"
+
+#include <sstream>
+
+class ProfilerTests : public RoutingTests {
+};
+
+static const Profiler::Stat* findStat(
+        const vector<Profiler::Stat>& stats, const string& name) {
+    for (size_t i = 0; i < stats.size(); i++)
+        if (stats[i].name == name)
+            return &stats[i];
+    return NULL;
+}
+
+TEST_F(ProfilerTests, ShouldNotRecordWhenDisabled) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "testOut", to, "testIn");
+    browser()->profiler.clear();
+    from->testOut("foo");
+    browser()->route();
+    vector<Profiler::Stat> stats;
+    browser()->profiler.getResults(stats);
+    EXPECT_EQ(0, stats.size());
+    browser()->reset();
+}
+
+TEST_F(ProfilerTests, ShouldCountRoutesAndNodes) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    browser()->addNamedNode("From", from);
+    browser()->addNamedNode("To", to);
+    from->realize();
+    to->realize();
+    Route* route = browser()->createRoute(from, "testOut", to, "testIn");
+    browser()->profiler.clear();
+    browser()->profiler.enable();
+    from->testOut("foo");
+    browser()->route();
+    browser()->profiler.disable();
+
+    vector<Profiler::Stat> stats;
+    browser()->profiler.getResults(stats);
+    const Profiler::Stat* routeStat = findStat(stats, route->describe());
+    ASSERT_THAT(routeStat, NotNull());
+    EXPECT_EQ(Profiler::ROUTE, routeStat->category);
+    EXPECT_EQ(1, routeStat->count);
+    EXPECT_LE(routeStat->exclusive, routeStat->inclusive);
+
+    // one action on the source, one on the target
+    const Profiler::Stat* typeStat = findStat(stats, "RouteTestNode");
+    ASSERT_THAT(typeStat, NotNull());
+    EXPECT_EQ(2, typeStat->count);
+    const Profiler::Stat* toStat = findStat(stats, "To");
+    ASSERT_THAT(toStat, NotNull());
+    EXPECT_EQ(Profiler::NODE, toStat->category);
+    EXPECT_EQ(1, toStat->count);
+
+    // the target's action is nested inside the route activation
+    EXPECT_GE(routeStat->inclusive, toStat->inclusive);
+
+    const Profiler::Stat* cascade = findStat(stats, "Browser::route");
+    ASSERT_THAT(cascade, NotNull());
+    EXPECT_EQ(1, cascade->count);
+
+    std::ostringstream report, trace;
+    browser()->profiler.report(report, 10);
+    EXPECT_NE(string::npos, report.str().find(route->describe()));
+    browser()->profiler.writeChromeTrace(trace);
+    EXPECT_NE(string::npos, trace.str().find("\"name\":\"To\""));
+    browser()->reset();
+}
+
+TEST_F(ProfilerTests, ShouldKeepResultsAfterReset) {
+    RouteTestNode* node = browser()->createNode<RouteTestNode>("RouteTestNode");
+    browser()->addNamedNode("Gone", node);
+    node->realize();
+    browser()->profiler.clear();
+    browser()->profiler.enable();
+    node->testOut("foo");
+    browser()->profiler.disable();
+    browser()->reset();
+    vector<Profiler::Stat> stats;
+    browser()->profiler.getResults(stats);
+    const Profiler::Stat* stat = findStat(stats, "Gone");
+    ASSERT_THAT(stat, NotNull());
+    EXPECT_EQ(1, stat->count);
+    browser()->profiler.clear();
+}
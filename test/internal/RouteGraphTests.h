@@ -0,0 +1,232 @@
+#include "internal/RouteGraph.h"
+#include "internal/SceneGenerator.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <cstdio>
+#include <sstream>
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class RouteGraphTests : public RoutingTests {
+protected:
+    void TearDown() {
+        browser()->routeGraph.setPruning(false);
+        browser()->setDemandDriven(false);
+        browser()->reset();
+    }
+
+    RouteTestNode* node() {
+        RouteTestNode* node = browser()->createNode<RouteTestNode>("RouteTestNode");
+        node->realize();
+        return node;
+    }
+
+    void route(Node* from, Node* to) {
+        browser()->createRoute(from, "testOut", to, "testIn");
+    }
+
+    ScalarInterpolator* interpolator() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+};
+
+TEST_F(RouteGraphTests, ShouldFindCycles) {
+    RouteTestNode* a = node();
+    RouteTestNode* b = node();
+    RouteTestNode* c = node();
+    RouteTestNode* d = node();
+    route(a, b);
+    route(b, a);
+    route(b, c);
+    route(d, d);
+    const RouteGraph& graph = browser()->analyzeRoutes();
+    EXPECT_TRUE(graph.isCurrent());
+    EXPECT_EQ(4, graph.nodeCount());
+    EXPECT_EQ(4, graph.routeCount());
+    ASSERT_EQ(2, graph.getCycles().size());
+    size_t pair = graph.getCycles()[0].size() == 2 ? 0 : 1;
+    EXPECT_EQ(2, graph.getCycles()[pair].size());
+    EXPECT_EQ(1, graph.getCycles()[1 - pair].size());
+    EXPECT_EQ(d, graph.getCycles()[1 - pair][0]);
+    EXPECT_EQ(graph.rank(a), graph.rank(b));
+    EXPECT_LT(graph.rank(b), graph.rank(c));
+
+    std::ostringstream os;
+    graph.print(os);
+    EXPECT_EQ(0, os.str().find("4 routed nodes, 4 routes, 2 cycles, 0 dead nodes\n"));
+}
+
+TEST_F(RouteGraphTests, ShouldRankInTopologicalOrder) {
+    RouteTestNode* a = node();
+    RouteTestNode* b = node();
+    RouteTestNode* c = node();
+    RouteTestNode* lone = node();
+    route(b, c);
+    route(a, c);
+    route(a, b);
+    const RouteGraph& graph = browser()->analyzeRoutes();
+    EXPECT_TRUE(graph.getCycles().empty());
+    EXPECT_EQ(0, graph.rank(a));
+    EXPECT_EQ(1, graph.rank(b));
+    EXPECT_EQ(2, graph.rank(c));
+    EXPECT_EQ(RouteGraph::NONE, graph.rank(lone));
+    ASSERT_EQ(3, graph.getOrder().size());
+    EXPECT_EQ(a, graph.getOrder()[0]);
+    EXPECT_EQ(b, graph.getOrder()[1]);
+    EXPECT_EQ(c, graph.getOrder()[2]);
+}
+
+TEST_F(RouteGraphTests, ShouldUpdateIncrementally) {
+    RouteTestNode* a = node();
+    RouteTestNode* b = node();
+    RouteTestNode* c = node();
+    route(a, b);
+    route(b, c);
+    const RouteGraph& graph = browser()->analyzeRoutes();
+
+    // agrees with the order
+    route(a, c);
+    EXPECT_TRUE(graph.isCurrent());
+    EXPECT_EQ(3, graph.routeCount());
+
+    // closes a cycle
+    route(c, a);
+    EXPECT_FALSE(graph.isCurrent());
+    browser()->analyzeRoutes();
+    EXPECT_TRUE(graph.isCurrent());
+    ASSERT_EQ(1, graph.getCycles().size());
+    EXPECT_EQ(3, graph.getCycles()[0].size());
+
+    // new nodes and removed routes need another analysis
+    route(c, node());
+    EXPECT_FALSE(graph.isCurrent());
+    browser()->analyzeRoutes();
+    a->testOut.getOutgoingRoutes().front()->remove();
+    EXPECT_FALSE(graph.isCurrent());
+}
+
+TEST_F(RouteGraphTests, ShouldAnalyzeAgainWhenStale) {
+    RouteTestNode* a = node();
+    RouteTestNode* b = node();
+    RouteTestNode* c = node();
+    route(a, b);
+    route(b, c);
+    browser()->analyzeRoutes();
+
+    // the next cascade analyzes again
+    route(c, a);
+    EXPECT_FALSE(browser()->routeGraph.isCurrent());
+    browser()->route();
+    browser()->endRoute();
+    const RouteGraph& graph = browser()->routeGraph;
+    EXPECT_TRUE(graph.isCurrent());
+    ASSERT_EQ(1, graph.getCycles().size());
+    EXPECT_EQ(3, graph.getCycles()[0].size());
+
+    // and so does reading the graph
+    c->testOut.getOutgoingRoutes().front()->remove();
+    EXPECT_TRUE(browser()->getRouteGraph().isCurrent());
+    EXPECT_TRUE(graph.getCycles().empty());
+    EXPECT_EQ(2, graph.routeCount());
+    ASSERT_EQ(3, graph.getOrder().size());
+    EXPECT_EQ(a, graph.getOrder()[0]);
+    EXPECT_EQ(c, graph.getOrder()[2]);
+}
+
+TEST_F(RouteGraphTests, ShouldPruneAgainWhenStale) {
+    browser()->routeGraph.setPruning(true);
+    ScalarInterpolator* first = interpolator();
+    ScalarInterpolator* last = interpolator();
+    ScalarInterpolator* watched = interpolator();
+    browser()->watch(&watched->value_changed);
+    browser()->createRoute(first, "value_changed", last, "set_fraction");
+    Route* route = browser()->createRoute(
+        last, "value_changed", watched, "set_fraction");
+    browser()->analyzeRoutes();
+    EXPECT_TRUE(first->value_changed.isObserved());
+
+    // nothing can see the chain once its last route is gone
+    route->remove();
+    browser()->route();
+    browser()->endRoute();
+    EXPECT_FALSE(first->value_changed.isObserved());
+    EXPECT_EQ(2, browser()->routeGraph.deadNodeCount());
+}
+
+TEST_F(RouteGraphTests, ShouldPruneDeadChains) {
+    browser()->setDemandDriven(true);
+    browser()->routeGraph.setPruning(true);
+    ScalarInterpolator* first = interpolator();
+    ScalarInterpolator* last = interpolator();
+    browser()->createRoute(first, "value_changed", last, "set_fraction");
+    const RouteGraph& graph = browser()->analyzeRoutes();
+    EXPECT_EQ(2, graph.deadNodeCount());
+    EXPECT_FALSE(graph.isLive(first));
+    EXPECT_FALSE(first->value_changed.isObserved());
+    first->set_fraction(0.5f);
+    browser()->route();
+    EXPECT_EQ(0, first->value_changed());
+    EXPECT_EQ(0, last->value_changed());
+    browser()->endRoute();
+
+    // watching the end of the chain revives all of it
+    browser()->watch(&last->value_changed);
+    EXPECT_EQ(0, graph.deadNodeCount());
+    EXPECT_TRUE(graph.isLive(first));
+    EXPECT_TRUE(first->value_changed.isObserved());
+    first->set_fraction(0.5f);
+    browser()->route();
+    EXPECT_EQ(0.5f, last->value_changed());
+    browser()->endRoute();
+}
+
+TEST_F(RouteGraphTests, ShouldReviveOnRouteToLiveNode) {
+    browser()->routeGraph.setPruning(true);
+    ScalarInterpolator* first = interpolator();
+    ScalarInterpolator* last = interpolator();
+    ScalarInterpolator* next = interpolator();
+    browser()->createRoute(first, "value_changed", last, "set_fraction");
+    browser()->createRoute(last, "value_changed", next, "set_fraction");
+    const RouteGraph& graph = browser()->analyzeRoutes();
+    EXPECT_EQ(3, graph.deadNodeCount());
+
+    // without pruning, nothing is marked
+    browser()->routeGraph.setPruning(false);
+    browser()->analyzeRoutes();
+    EXPECT_EQ(3, graph.deadNodeCount());
+    EXPECT_TRUE(first->value_changed.isObserved());
+    browser()->routeGraph.setPruning(true);
+    browser()->analyzeRoutes();
+    EXPECT_FALSE(first->value_changed.isObserved());
+
+    // a node outside the graph counts as live
+    ScalarInterpolator* watched = interpolator();
+    browser()->createRoute(last, "value_changed", watched, "set_fraction");
+    EXPECT_EQ(1, graph.deadNodeCount());
+    EXPECT_FALSE(graph.isLive(next));
+    EXPECT_TRUE(first->value_changed.isObserved());
+    EXPECT_TRUE(last->value_changed.isObserved());
+}
+
+TEST_F(RouteGraphTests, ShouldAnalyzeReadWorld) {
+    SceneGenerator gen;
+    gen.sensors = 2;
+    gen.keys = 4;
+    gen.points = 10;
+    const char* filename = "generated.x3d";
+    gen.write(filename);
+    World* world = World::read(browser(), filename);
+    remove(filename);
+    const RouteGraph& graph = browser()->routeGraph;
+    EXPECT_TRUE(graph.isCurrent());
+    EXPECT_EQ(gen.countRoutes(), graph.routeCount());
+    EXPECT_TRUE(graph.getCycles().empty());
+    delete world;
+}
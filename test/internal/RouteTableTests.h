@@ -0,0 +1,41 @@
+#include "internal/RouteTable.h"
+
+TEST(RouteTable, SlotsShouldHoldTheirOwnLists) {
+    RouteTable table;
+    vector<unsigned int> slots;
+    for (size_t i = 0; i < 1000; i++) {
+        slots.push_back(table.add());
+        table[slots.back()].outgoing.push_back((Route*) (i + 1));
+    }
+    EXPECT_EQ(1000, table.size());
+    for (size_t i = 0; i < 1000; i++) {
+        EXPECT_NE(0, slots[i]);
+        EXPECT_EQ((Route*) (i + 1), table[slots[i]].outgoing.front());
+        EXPECT_TRUE(table[slots[i]].incoming.empty());
+    }
+}
+
+TEST(RouteTable, RemovedSlotsShouldBeReused) {
+    RouteTable table;
+    unsigned int a = table.add();
+    unsigned int b = table.add();
+    table.remove(a);
+    EXPECT_EQ(1, table.size());
+    EXPECT_ANY_THROW(table.remove(a));
+    unsigned int c = table.add();
+    EXPECT_EQ(a, c);
+    EXPECT_TRUE(table[c].outgoing.empty());
+    EXPECT_NE(b, c);
+    EXPECT_EQ(2, table.size());
+}
+
+TEST(RouteTable, ListsShouldStayPutWhenTableGrows) {
+    RouteTable table;
+    unsigned int first = table.add();
+    RouteTable::Links* links = &table[first];
+    for (size_t i = 1; i < 100; i++)
+        table.add();
+    EXPECT_EQ(links, &table[first]);
+    table.clear();
+    EXPECT_EQ(0, table.size());
+}
@@ -83,3 +83,30 @@ TEST(RouteStorage, CreateIdenticalRouteShouldReturnOriginalPtr) {
     EXPECT_EQ(route, browser()->createRoute(from, "loop_changed", to, "set_enabled"));
     browser()->reset();
 }
+
+TEST(RouteStorage, OnlyRoutedFieldsShouldHaveRouteLists) {
+    Node* from = browser()->createNode("TimeSensor");
+    Node* to = browser()->createNode("TimeSensor");
+    EXPECT_EQ(0, browser()->routeTable.size());
+    Route* route = browser()->createRoute(from, "loop_changed", to, "set_enabled");
+    EXPECT_EQ(2, browser()->routeTable.size());
+    EXPECT_TRUE(from->getField("loop")->hasOutgoingRoutes());
+    EXPECT_FALSE(from->getField("loop")->hasIncomingRoutes());
+    EXPECT_TRUE(to->getField("enabled")->hasIncomingRoutes());
+    EXPECT_FALSE(from->getField("enabled")->hasOutgoingRoutes());
+    route->remove();
+    delete route;
+    EXPECT_EQ(0, browser()->routeTable.size());
+    EXPECT_FALSE(from->getField("loop")->hasOutgoingRoutes());
+    EXPECT_FALSE(to->getField("enabled")->hasIncomingRoutes());
+    browser()->reset();
+}
+
+TEST(RouteStorage, ResetShouldEmptyRouteTable) {
+    Node* from = browser()->createNode("TimeSensor");
+    Node* to = browser()->createNode("TimeSensor");
+    browser()->createRoute(from, "loop_changed", to, "set_enabled");
+    browser()->createRoute(from, "enabled_changed", to, "set_loop");
+    browser()->reset();
+    EXPECT_EQ(0, browser()->routeTable.size());
+}
@@ -258,3 +258,26 @@ TEST_F(RoutingTests, LoopBreaking) {
     EXPECT_EQ(1, node->inOutActionCount);
     browser()->reset();
 }
+
+TEST_F(RoutingTests, EndRouteShouldClearDirtyNodes) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "testOut", to, "testInOut");
+    EXPECT_FALSE(from->isDirty());
+
+    from->testOut("foo");
+    EXPECT_TRUE(from->isDirty());
+    EXPECT_TRUE(from->testOut.isDirty());
+    EXPECT_FALSE(from->testInOut.isDirty());
+    browser()->route();
+    EXPECT_TRUE(to->isDirty());
+    EXPECT_TRUE(to->testInOut.isDirty());
+
+    browser()->endRoute();
+    EXPECT_FALSE(from->isDirty());
+    EXPECT_FALSE(to->isDirty());
+    EXPECT_FALSE(to->testInOut.isDirty());
+    browser()->reset();
+}
@@ -0,0 +1,167 @@
+#include "internal/SAIServer.h"
+#include "internal/SAIClient.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class SAIServerTests : public ::testing::Test {
+protected:
+    /// socket path unique to this process
+    string path;
+
+    SAIServer server;
+
+    void SetUp() {
+        char buf[64];
+        sprintf(buf, "/tmp/x3d-sai-test-%d.sock", (int) getpid());
+        path = buf;
+        server.listen(path);
+    }
+
+    void TearDown() {
+        server.close();
+        browser()->reset();
+    }
+
+    /// a realized, named interpolator whose output equals its input
+    ScalarInterpolator* identity(const string& name) {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        node->setName(name);
+        browser()->getScope()->define(name, node);
+        return node;
+    }
+
+    /**
+     * Run a client in a child process, serving it until it exits.
+     *
+     * @returns child's exit status
+     */
+    int serve(int (*client)(const string& path)) {
+        pid_t child = fork();
+        if (child == 0) {
+            int status;
+            try {
+                status = client(path);
+            } catch (X3DError& e) {
+                status = 100;
+            }
+            _exit(status);
+        }
+        int status = -1;
+        while (child > 0 && waitpid(child, &status, WNOHANG) == 0)
+            server.poll(1);
+        // see the hangup
+        for (int tries = 0; tries < 100 && server.clientCount() > 0; tries++)
+            server.poll(1);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+};
+
+static int setAndNotify(const string& path) {
+    SAIClient client;
+    client.connect(path);
+    uint32_t node = client.getNode("A");
+    SAIClient::Field in = client.getField(node, "set_fraction");
+    SAIClient::Field out = client.getField(node, "value_changed");
+    if (in.type != X3DField::SFFLOAT || out.access != SAIField::OUTPUT_ONLY)
+        return 1;
+    client.subscribe(out.handle);
+    // only the last of several values sent together is routed
+    client.set(in.handle, SFFloat(0.25f));
+    client.set(in.handle, SFFloat(0.5f));
+    client.sync();
+    const X3DField* value = client.value(out.handle);
+    if (client.noticeCount() != 1 || value == NULL)
+        return 2;
+    if (SFFloat::unwrap(*value) != 0.5f)
+        return 3;
+    SFFloat current;
+    client.get(out.handle, current);
+    if (SFFloat::unwrap(current) != 0.5f)
+        return 4;
+    client.unsubscribe(out.handle);
+    client.set(in.handle, SFFloat(0.75f));
+    client.sync();
+    return client.noticeCount() == 1 ? 0 : 5;
+}
+
+TEST_F(SAIServerTests, ShouldSetFieldsAndNotifySubscribers) {
+    ScalarInterpolator* node = identity("A");
+    EXPECT_EQ(0, serve(setAndNotify));
+    EXPECT_EQ(0.75f, node->value_changed());
+    EXPECT_EQ(0, server.clientCount());
+    EXPECT_EQ(0, browser()->subscriptions.size());
+    EXPECT_LT(0, server.messageCount());
+}
+
+static int reportErrors(const string& path) {
+    SAIClient client;
+    client.connect(path);
+    try {
+        client.getNode("missing");
+        return 1;
+    } catch (X3DError& e) {
+    }
+    uint32_t node = client.getNode("A");
+    try {
+        client.getField(node, "missing");
+        return 2;
+    } catch (X3DError& e) {
+    }
+    SAIClient::Field in = client.getField(node, "set_fraction");
+    SAIClient::Field out = client.getField(node, "value_changed");
+    try {
+        client.subscribe(in.handle);
+        return 3;
+    } catch (X3DError& e) {
+    }
+    // errors in SETs come back without failing the connection
+    client.set(out.handle, SFFloat(0.5f));
+    client.set(in.handle, SFFloat(0.5f));
+    client.sync();
+    if (client.errorCount() != 1 || client.lastError() != "field doesn't take input")
+        return 4;
+    SFFloat value;
+    client.get(out.handle, value);
+    return SFFloat::unwrap(value) == 0.5f ? 0 : 5;
+}
+
+TEST_F(SAIServerTests, ShouldReportErrors) {
+    identity("A");
+    EXPECT_EQ(0, serve(reportErrors));
+}
+
+static int routeFields(const string& path) {
+    SAIClient client;
+    client.connect(path);
+    uint32_t a = client.getNode("A");
+    uint32_t b = client.getNode("B");
+    SAIClient::Field in = client.getField(a, "set_fraction");
+    SAIClient::Field from = client.getField(a, "value_changed");
+    SAIClient::Field to = client.getField(b, "set_fraction");
+    SAIClient::Field out = client.getField(b, "value_changed");
+    client.createRoute(from.handle, to.handle);
+    client.subscribe(out.handle);
+    client.set(in.handle, SFFloat(0.25f));
+    if (!client.receive(5000))
+        return 1;
+    const X3DField* value = client.value(out.handle);
+    return value != NULL && SFFloat::unwrap(*value) == 0.25f ? 0 : 2;
+}
+
+TEST_F(SAIServerTests, ShouldCreateRoutes) {
+    identity("A");
+    ScalarInterpolator* b = identity("B");
+    EXPECT_EQ(0, serve(routeFields));
+    EXPECT_EQ(0.25f, b->value_changed());
+}
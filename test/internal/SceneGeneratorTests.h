@@ -0,0 +1,67 @@
+#include "internal/SceneGenerator.h"
+#include "internal/World.h"
+#include "Grouping/Transform.h"
+
+#include <cstdio>
+#include <sstream>
+
+using X3D::Grouping::Transform;
+
+/// count occurrences of a substring
+static size_t countOf(const string& text, const string& what) {
+    size_t n = 0;
+    for (size_t i = text.find(what); i != string::npos; i = text.find(what, i + 1))
+        n++;
+    return n;
+}
+
+TEST(SceneGenerator, CountsShouldMatchOutput) {
+    SceneGenerator gen;
+    gen.sensors = 3;
+    gen.chain = 2;
+    gen.depth = 3;
+    gen.points = 4;
+    std::ostringstream os;
+    gen.write(os);
+    string xml = os.str();
+    size_t elements = countOf(xml, "<") - countOf(xml, "</");
+    // everything but X3D, Scene and the routes is a node
+    EXPECT_EQ(gen.countRoutes(), countOf(xml, "<ROUTE"));
+    EXPECT_EQ(gen.countNodes(), elements - 2 - gen.countRoutes());
+}
+
+TEST(SceneGenerator, ScaleToShouldApproximateNodeCount) {
+    SceneGenerator gen;
+    gen.scaleTo(10000);
+    EXPECT_LE(gen.countNodes(), 10000);
+    EXPECT_GT(gen.countNodes(), 10000 - gen.nodesPerSensor());
+}
+
+TEST(SceneGenerator, GeneratedSceneShouldLoadAndRun) {
+    SceneGenerator gen;
+    gen.sensors = 4;
+    gen.points = 3;
+    const char* filename = "generated.x3d";
+    gen.write(filename);
+    World* world = World::read(browser(), filename);
+    remove(filename);
+
+    for (int frame = 0; frame <= 150; frame++) {
+        browser()->wake(frame * 0.01);
+        browser()->simulate();
+    }
+
+    // the fan-in sink got an event, and the innermost transform was
+    // moved within the unit cube its interpolator covers
+    Node* sink = browser()->getNode("sink3");
+    ASSERT_THAT(sink, NotNull());
+    float value = SFFloat::unwrap(sink->getField("value_changed")->get());
+    EXPECT_TRUE(value > 0 && value <= 1);
+    Transform* xf = browser()->getNode<Transform>("xf3");
+    ASSERT_THAT(xf, NotNull());
+    const SFVec3f& t = xf->translation();
+    EXPECT_TRUE(t.x >= 0 && t.x <= 1 && t.y >= 0 && t.y <= 1 && t.z >= 0 && t.z <= 1);
+
+    delete world;
+    browser()->reset();
+}
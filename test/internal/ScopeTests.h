@@ -0,0 +1,91 @@
+#include "internal/Scope.h"
+
+#include <sstream>
+using std::ostringstream;
+
+TEST(ScopeTests, ShouldDefineAndLookUpNames) {
+    Scope scope;
+    Node* a = browser()->createNode("Test");
+    Node* b = browser()->createNode("Test");
+    scope.define("A", a);
+    scope.define("B", b);
+    EXPECT_EQ(2, scope.size());
+    EXPECT_EQ(a, scope.lookup("A"));
+    EXPECT_EQ(b, scope.lookup("B"));
+    EXPECT_EQ(NULL, scope.lookup("C"));
+    browser()->reset();
+}
+
+TEST(ScopeTests, ShouldReplaceRedefinedName) {
+    Scope scope;
+    Node* a = browser()->createNode("Test");
+    Node* b = browser()->createNode("Test");
+    scope.define("A", a);
+    scope.define("A", b);
+    EXPECT_EQ(1, scope.size());
+    EXPECT_EQ(b, scope.lookup("A"));
+    browser()->reset();
+}
+
+TEST(ScopeTests, ShouldFallBackToParent) {
+    Scope outer;
+    Scope inner(&outer);
+    Node* a = browser()->createNode("Test");
+    Node* b = browser()->createNode("Test");
+    outer.define("A", a);
+    inner.define("B", b);
+    EXPECT_EQ(a, inner.lookup("A"));
+    EXPECT_EQ(NULL, inner.lookupLocal("A"));
+    EXPECT_EQ(NULL, outer.lookup("B"));
+    browser()->reset();
+}
+
+TEST(ScopeTests, ShouldKeepNamesWhenGrowing) {
+    Scope scope;
+    Node* a = browser()->createNode("Test");
+    Node* b = browser()->createNode("Test");
+    for (int i = 0; i < 1000; i++) {
+        ostringstream os;
+        os << "N" << i;
+        scope.define(os.str(), (i % 2) ? a : b);
+    }
+    EXPECT_EQ(1000, scope.size());
+    for (int i = 0; i < 1000; i++) {
+        ostringstream os;
+        os << "N" << i;
+        EXPECT_EQ((i % 2) ? a : b, scope.lookup(os.str()));
+    }
+    scope.clear();
+    EXPECT_EQ(0, scope.size());
+    EXPECT_EQ(NULL, scope.lookup("N0"));
+    browser()->reset();
+}
+
+TEST(ScopeTests, BrowserShouldResolveNamesInEnteredScope) {
+    Scope scope(browser()->getGlobalScope());
+    Node* a = browser()->createNode("Test");
+    Node* b = browser()->createNode("Test");
+    browser()->addNamedNode("A", a);
+    browser()->enterScope(&scope);
+    browser()->addNamedNode("B", b);
+    EXPECT_EQ(a, browser()->getNode("A"));
+    EXPECT_EQ(b, browser()->getNode("B"));
+    browser()->leaveScope(&scope);
+    EXPECT_EQ(NULL, browser()->getNode("B"));
+    browser()->reset();
+}
+
+TEST(ScopeTests, BrowserShouldLeaveOnlyTheGivenScope) {
+    Scope first(browser()->getGlobalScope());
+    Scope second(browser()->getGlobalScope());
+    browser()->enterScope(&first);
+    browser()->enterScope(&second);
+    browser()->leaveScope(&first);
+    EXPECT_EQ(&second, browser()->getScope());
+    browser()->leaveScope(&first);
+    EXPECT_EQ(&second, browser()->getScope());
+    browser()->leaveScope(&second);
+    EXPECT_EQ(browser()->getGlobalScope(), browser()->getScope());
+    EXPECT_THROW(browser()->leaveScope(browser()->getGlobalScope()), X3DError);
+    EXPECT_EQ(browser()->getGlobalScope(), browser()->getScope());
+}
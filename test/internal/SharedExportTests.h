@@ -0,0 +1,127 @@
+#include "internal/SharedExport.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using X3D::Interpolation::ScalarInterpolator;
+
+class SharedExportTests : public ::testing::Test {
+protected:
+    /// region name unique to this process
+    string region;
+
+    void SetUp() {
+        char buf[64];
+        sprintf(buf, "/x3d-export-test-%d", (int) getpid());
+        region = buf;
+    }
+
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// a realized interpolator whose output equals its input
+    ScalarInterpolator* identity() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+
+    void cascade() {
+        browser()->route();
+        browser()->endRoute();
+    }
+};
+
+/// read a float field until it has the expected value, in a child process
+static int expectInChild(const string& region, float expected) {
+    SharedExportReader reader;
+    for (int tries = 0; tries < 5000; tries++) {
+        if (reader.isOpen() || reader.open(region)) {
+            int n = reader.find("value");
+            if (n < 0)
+                return 2;
+            float value;
+            uint64_t sequence;
+            do {
+                sequence = reader.begin();
+                memcpy(&value, reader.data(n), sizeof(float));
+            } while (!reader.validate(sequence));
+            if (value == expected)
+                return 0;
+        }
+        usleep(1000);
+    }
+    return 1;
+}
+
+TEST_F(SharedExportTests, ShouldPublishToAnotherProcess) {
+    ScalarInterpolator* node = identity();
+    SharedExport out;
+    out.add(&node->value_changed, "value");
+    out.open(region);
+
+    pid_t child = fork();
+    ASSERT_LE(0, child);
+    if (child == 0)
+        _exit(expectInChild(region, 0.5f));
+
+    node->set_fraction(0.5f);
+    cascade();
+    int status;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+    out.close();
+}
+
+TEST_F(SharedExportTests, ShouldWriteChangedFieldsAtEndOfCascade) {
+    ScalarInterpolator* a = identity();
+    ScalarInterpolator* b = identity();
+    SharedExport out;
+    out.add(&a->value_changed, "a");
+    out.add(&b->value_changed, "b", 2);
+    out.open(region);
+    EXPECT_THROW(out.add(&a->value_changed, "again"), X3DError);
+
+    SharedExportReader reader;
+    ASSERT_TRUE(reader.open(region));
+    ASSERT_EQ(2, reader.size());
+    EXPECT_EQ(1, reader.find("b"));
+    EXPECT_EQ(-1, reader.find("c"));
+    EXPECT_EQ(X3DField::SFFLOAT, reader.entry(0).type);
+    EXPECT_EQ(0, reader.header().sequence);
+    EXPECT_EQ(0, reader.entry(reader.find("a")).offset % 16);
+    // b's slot is too small for a float, even the first
+    EXPECT_EQ(1, reader.entry(1).dropped);
+
+    a->set_fraction(0.25f);
+    b->set_fraction(0.75f);
+    cascade();
+    EXPECT_EQ(2, reader.header().sequence);
+    EXPECT_EQ(2, reader.entry(0).sequence);
+    EXPECT_EQ(sizeof(float), reader.entry(0).size);
+    EXPECT_EQ(0.25f, *(const float*) reader.data(0));
+
+    EXPECT_EQ(2, reader.entry(1).dropped);
+    EXPECT_EQ(0, reader.entry(1).size);
+
+    // unchanged fields aren't written
+    a->set_fraction(0.5f);
+    cascade();
+    EXPECT_EQ(4, reader.header().sequence);
+    EXPECT_EQ(4, reader.entry(0).sequence);
+    EXPECT_EQ(2, reader.entry(1).dropped);
+
+    out.close();
+    reader.close();
+    EXPECT_FALSE(reader.open(region));
+}
@@ -0,0 +1,172 @@
+#include "internal/Snapshot.h"
+#include "Interpolation/CoordinateInterpolator.h"
+#include "Interpolation/ScalarInterpolator.h"
+
+#include <pthread.h>
+
+using X3D::Interpolation::CoordinateInterpolator;
+using X3D::Interpolation::ScalarInterpolator;
+
+class SnapshotTests : public ::testing::Test {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    /// a realized interpolator whose output equals its input
+    ScalarInterpolator* identity() {
+        ScalarInterpolator* node =
+            browser()->createNode<ScalarInterpolator>("ScalarInterpolator");
+        node->key().array().push_back(0);
+        node->key().array().push_back(1);
+        node->keyValue().array().push_back(0);
+        node->keyValue().array().push_back(1);
+        node->realize();
+        return node;
+    }
+};
+
+/// what a reader thread checks and counts
+struct SnapshotReader {
+    SnapshotStore* store;
+    SAIField* first;
+    SAIField* second;
+    volatile bool* done;
+    int reads;
+    int torn;
+    int backwards;
+};
+
+/// read snapshots until told to stop, checking they are consistent
+static void* readSnapshots(void* arg) {
+    SnapshotReader* reader = (SnapshotReader*) arg;
+    unsigned int last = 0;
+    while (!__atomic_load_n(reader->done, __ATOMIC_SEQ_CST)) {
+        SnapshotPin pin(*reader->store);
+        if (pin.get() == NULL)
+            continue;
+        float a = SFFloat::unwrap(*pin->get(reader->first));
+        float b = SFFloat::unwrap(*pin->get(reader->second));
+        if (a != b)
+            reader->torn++;
+        if (pin->getCascade() < last)
+            reader->backwards++;
+        last = pin->getCascade();
+        __atomic_add_fetch(&reader->reads, 1, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+TEST_F(SnapshotTests, ShouldCopyCapturedFields) {
+    ScalarInterpolator* node = identity();
+    SnapshotStore& store = browser()->snapshots;
+    store.capture(&node->value_changed);
+    node->set_fraction(0.25f);
+    browser()->route();
+    browser()->endRoute();
+
+    unsigned int cascade;
+    {
+        SnapshotPin pin(store);
+        ASSERT_TRUE(pin.get() != NULL);
+        cascade = pin->getCascade();
+        EXPECT_EQ(1, pin->size());
+        EXPECT_EQ(0.25f, SFFloat::unwrap(*pin->get(&node->value_changed)));
+        EXPECT_EQ(NULL, pin->get(&node->set_fraction));
+
+        // the pinned snapshot doesn't change, and isn't reused
+        node->set_fraction(0.5f);
+        browser()->route();
+        browser()->endRoute();
+        node->set_fraction(0.75f);
+        browser()->route();
+        browser()->endRoute();
+        EXPECT_EQ(0.25f, SFFloat::unwrap(*pin->get(&node->value_changed)));
+        EXPECT_EQ(2, store.retiredCount());
+    }
+    browser()->endRoute();
+    EXPECT_EQ(0, store.retiredCount());
+    SnapshotPin pin(store);
+    EXPECT_EQ(cascade + 3, pin->getCascade());
+    EXPECT_EQ(0.75f, SFFloat::unwrap(*pin->get(&node->value_changed)));
+}
+
+TEST_F(SnapshotTests, ShouldCopyMFFields) {
+    CoordinateInterpolator* node = browser()->createNode<
+        CoordinateInterpolator>("CoordinateInterpolator");
+    node->key().array().push_back(0);
+    node->key().array().push_back(1);
+    node->keyValue().array().push_back(SFVec3f(0.0f, 0.0f, 0.0f));
+    node->keyValue().array().push_back(SFVec3f(2.0f, 4.0f, 6.0f));
+    node->realize();
+    SnapshotStore& store = browser()->snapshots;
+    store.capture(&node->value_changed);
+    node->set_fraction(0.5f);
+    browser()->route();
+    browser()->endRoute();
+
+    SnapshotPin pin(store);
+    ASSERT_TRUE(pin.get() != NULL);
+    const X3DField* value = pin->get(&node->value_changed);
+    ASSERT_TRUE(value != NULL);
+    EXPECT_TRUE(*value == node->value_changed());
+    EXPECT_EQ(1, node->value_changed().array().size());
+}
+
+TEST_F(SnapshotTests, ConcurrentReadersShouldSeeWholeCascades) {
+    ScalarInterpolator* first = identity();
+    ScalarInterpolator* second = identity();
+    browser()->createRoute(first, "value_changed", second, "set_fraction");
+    SnapshotStore& store = browser()->snapshots;
+    store.capture(&first->value_changed);
+    store.capture(&second->value_changed);
+
+    const int threads = 4;
+    volatile bool done = false;
+    SnapshotReader readers[threads];
+    pthread_t ids[threads];
+    for (int i = 0; i < threads; i++) {
+        SnapshotReader reader = { &store, &first->value_changed,
+            &second->value_changed, &done, 0, 0, 0 };
+        readers[i] = reader;
+        ASSERT_EQ(0, pthread_create(&ids[i], NULL, readSnapshots, &readers[i]));
+    }
+    // keep going until every reader has read something
+    bool allRead = false;
+    for (int frame = 1; frame <= 2000 || !allRead; frame++) {
+        first->set_fraction((frame % 100) / 100.0f);
+        browser()->route();
+        browser()->endRoute();
+        allRead = true;
+        for (int i = 0; i < threads; i++)
+            if (__atomic_load_n(&readers[i].reads, __ATOMIC_SEQ_CST) == 0)
+                allRead = false;
+    }
+    __atomic_store_n(&done, true, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        EXPECT_EQ(0, readers[i].torn);
+        EXPECT_EQ(0, readers[i].backwards);
+        EXPECT_LT(0, readers[i].reads);
+    }
+}
+
+TEST_F(SnapshotTests, ShouldReleaseFreedFields) {
+    ScalarInterpolator* kept = identity();
+    // made by hand, since the browser frees the nodes it makes
+    RouteTestNode* gone = new RouteTestNode();
+    gone->testOut.setNode(gone);
+    gone->realize();
+    SnapshotStore& store = browser()->snapshots;
+    store.capture(&kept->value_changed);
+    store.capture(&gone->testOut);
+    delete gone;
+    kept->set_fraction(0.5f);
+    browser()->route();
+    browser()->endRoute();
+
+    SnapshotPin pin(store);
+    ASSERT_TRUE(pin.get() != NULL);
+    EXPECT_EQ(1, pin->size());
+    EXPECT_EQ(0.5f, SFFloat::unwrap(*pin->get(&kept->value_changed)));
+}
@@ -0,0 +1,150 @@
+#include "Grouping/Group.h"
+#include "Grouping/Transform.h"
+#include "internal/SpatialQuery.h"
+
+#include <algorithm>
+
+using X3D::Grouping::Group;
+using X3D::Grouping::Transform;
+
+class SpatialQueryTests : public ::testing::Test {
+protected:
+    /// unit boxes on a 10 by 10 grid in z = 0, three apart
+    Transform* grid[10][10];
+
+    void SetUp() {
+        Group* root = browser()->createNode<Group>("Group");
+        root->realize();
+        browser()->addRoot(root);
+        for (int i = 0; i < 10; i++) {
+            for (int j = 0; j < 10; j++) {
+                Transform* node = browser()->createNode<Transform>("Transform");
+                node->translation(SFVec3f(3 * i, 3 * j, 0));
+                node->bboxSize(SFVec3f(1, 1, 1));
+                node->realize();
+                root->children().add(node);
+                grid[i][j] = node;
+            }
+        }
+    }
+
+    void TearDown() {
+        browser()->bounds.setParallel(16384);
+        browser()->reset();
+    }
+
+    /// @returns squared distance from a point to a node's bounds
+    static float distance2(const SFVec3f& p, const BoundingBox& box) {
+        float dx = std::max(std::max(box.min.x - p.x, p.x - box.max.x), 0.0f);
+        float dy = std::max(std::max(box.min.y - p.y, p.y - box.max.y), 0.0f);
+        float dz = std::max(std::max(box.min.z - p.z, p.z - box.max.z), 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+};
+
+TEST_F(SpatialQueryTests, RaycastShouldFindNearestHit) {
+    RayHit hit = browser()->raycast(
+        Ray(SFVec3f(-10, 3, 0), SFVec3f(1, 0, 0)));
+    EXPECT_EQ(grid[0][1], hit.node);
+    EXPECT_NEAR(9.5, hit.distance, 1e-5);
+
+    // from the far side, and from inside a box
+    hit = browser()->raycast(Ray(SFVec3f(40, 6, 0), SFVec3f(-2, 0, 0)));
+    EXPECT_EQ(grid[9][2], hit.node);
+    EXPECT_NEAR(6.25, hit.distance, 1e-5);
+    hit = browser()->raycast(Ray(SFVec3f(9.2f, 9.0f, 0.0f), SFVec3f(0, 1, 0)));
+    EXPECT_EQ(grid[3][3], hit.node);
+    EXPECT_EQ(0, hit.distance);
+
+    // between rows, and stopping short
+    hit = browser()->raycast(Ray(SFVec3f(-10.0f, 1.5f, 0.0f), SFVec3f(1, 0, 0)));
+    EXPECT_TRUE(hit.node == NULL);
+    hit = browser()->raycast(Ray(SFVec3f(-10, 3, 0), SFVec3f(1, 0, 0), 9));
+    EXPECT_TRUE(hit.node == NULL);
+}
+
+TEST_F(SpatialQueryTests, OverlapShouldFindBoxesAndFrusta) {
+    vector<BoundingBox> boxes;
+    boxes.push_back(BoundingBox(SFVec3f(2.5f, -1.0f, -1.0f), SFVec3f(6.5f, 1.0f, 1.0f)));
+    boxes.push_back(BoundingBox(SFVec3f(100, 100, 100), SFVec3f(101, 101, 101)));
+    QueryResults results;
+    browser()->overlap(boxes, results);
+    ASSERT_EQ(2, results.size());
+    ASSERT_EQ(2, results.count(0));
+    vector<Node*> found(results.nodes.begin(), results.nodes.end());
+    std::sort(found.begin(), found.end());
+    vector<Node*> expected;
+    expected.push_back(grid[1][0]);
+    expected.push_back(grid[2][0]);
+    std::sort(expected.begin(), expected.end());
+    EXPECT_TRUE(found == expected);
+    EXPECT_EQ(0, results.count(1));
+
+    // orthographic view of x in [-1, 4], y in [-1, 1], z in [-1, 1]
+    float m[16] = {
+        0.4f, 0, 0, -0.6f,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1
+    };
+    vector<Frustum> frusta(1, Frustum::fromMatrix(m));
+    browser()->overlap(frusta, results);
+    ASSERT_EQ(1, results.size());
+    ASSERT_EQ(2, results.count(0));
+    found.assign(results.nodes.begin(), results.nodes.end());
+    std::sort(found.begin(), found.end());
+    expected[0] = grid[0][0];
+    expected[1] = grid[1][0];
+    std::sort(expected.begin(), expected.end());
+    EXPECT_TRUE(found == expected);
+}
+
+TEST_F(SpatialQueryTests, NearestShouldOrderByDistance) {
+    vector<SFVec3f> points(1, SFVec3f(9.2f, 9.1f, 0.0f));
+    QueryResults results;
+    browser()->nearest(points, 3, results);
+    ASSERT_EQ(3, results.count(0));
+    EXPECT_EQ(grid[3][3], results.getNode(0, 0));
+    EXPECT_EQ(0, results.getDistance(0, 0));
+    EXPECT_EQ(grid[4][3], results.getNode(0, 1));
+    EXPECT_NEAR(2.3, results.getDistance(0, 1), 1e-5);
+    EXPECT_EQ(grid[3][4], results.getNode(0, 2));
+    EXPECT_NEAR(2.4, results.getDistance(0, 2), 1e-5);
+}
+
+TEST_F(SpatialQueryTests, BatchesShouldMatchAcrossThreads) {
+    vector<Ray> rays;
+    vector<SFVec3f> points;
+    for (int i = 0; i < 2000; i++) {
+        float y = (float) (i * 37 % 300) / 10;
+        float z = (float) (i % 7) / 7 - 0.5f;
+        rays.push_back(Ray(SFVec3f(-5.0f, y, z), SFVec3f(1.0f, 0.01f * (i % 5), 0.0f)));
+        points.push_back(SFVec3f((float) (i * 13 % 310) / 10, y, z * 4));
+    }
+    browser()->bounds.setParallel(16384, 4);
+    vector<RayHit> hits;
+    browser()->raycast(rays, hits);
+    QueryResults results;
+    browser()->nearest(points, 5, results);
+    ASSERT_EQ(2000, hits.size());
+    ASSERT_EQ(2000, results.size());
+
+    // every node's distance, for checking the nearest by brute force
+    vector<BoundingBox> all;
+    for (int i = 0; i < 10; i++)
+        for (int j = 0; j < 10; j++)
+            all.push_back(grid[i][j]->getBounds());
+    for (size_t i = 0; i < rays.size(); i++) {
+        RayHit hit = browser()->raycast(rays[i]);
+        EXPECT_EQ(hit.node, hits[i].node);
+        EXPECT_EQ(hit.distance, hits[i].distance);
+
+        vector<float> d;
+        for (size_t j = 0; j < all.size(); j++)
+            d.push_back(std::sqrt(distance2(points[i], all[j])));
+        std::sort(d.begin(), d.end());
+        ASSERT_EQ(5, results.count(i));
+        for (size_t j = 0; j < 5; j++)
+            EXPECT_NEAR(d[j], results.getDistance(i, j), 1e-4);
+    }
+}
@@ -0,0 +1,110 @@
+#include "internal/Subscriptions.h"
+
+/// records the batches it is called with
+class RecordingObserver : public FieldObserver {
+public:
+    int calls;
+    vector<SAIField*> fields;
+    vector<string> values;
+
+    /// field to write to when called, if any
+    SAIField* echo;
+
+    RecordingObserver() : calls(0), echo(NULL) {}
+
+    void changed(const vector<Change>& changes) {
+        calls++;
+        for (size_t i = 0; i < changes.size(); i++) {
+            fields.push_back(changes[i].field);
+            values.push_back(SFString::unwrap(*changes[i].value));
+        }
+        if (echo != NULL)
+            echo->set(SFString(values.back()));
+    }
+};
+
+class SubscriptionTests : public RoutingTests {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    RouteTestNode* node() {
+        RouteTestNode* node = browser()->createNode<RouteTestNode>("RouteTestNode");
+        node->realize();
+        return node;
+    }
+
+    void cascade() {
+        browser()->route();
+        browser()->endRoute();
+    }
+};
+
+TEST_F(SubscriptionTests, ShouldBatchChangesOfACascade) {
+    RouteTestNode* node = this->node();
+    RecordingObserver observer;
+    node->testOut.subscribe(&observer);
+    browser()->subscribe(&node->testInOut, &observer);
+    EXPECT_TRUE(node->testOut.isObserved());
+
+    browser()->beginUpdate();
+    node->testInOut.set(SFString("c"));
+    node->customIn.set(SFString("ab"));
+    browser()->endUpdate();
+    EXPECT_EQ(1, observer.calls);
+    ASSERT_EQ(2, observer.fields.size());
+    EXPECT_EQ(&node->testInOut, observer.fields[0]);
+    EXPECT_EQ("c", observer.values[0]);
+    EXPECT_EQ(&node->testOut, observer.fields[1]);
+    EXPECT_EQ("abab", observer.values[1]);
+
+    // nothing changed, so nobody is called
+    cascade();
+    EXPECT_EQ(1, observer.calls);
+}
+
+TEST_F(SubscriptionTests, ShouldOnlyCallObserversOfChangedFields) {
+    RouteTestNode* a = node();
+    RouteTestNode* b = node();
+    RecordingObserver first, second;
+    a->testOut.subscribe(&first);
+    a->testOut.subscribe(&first);
+    b->testOut.subscribe(&second);
+    EXPECT_EQ(2, browser()->subscriptions.size());
+    EXPECT_EQ(2, browser()->subscriptions.fieldCount());
+
+    a->customIn.set(SFString("x"));
+    cascade();
+    EXPECT_EQ(1, first.calls);
+    EXPECT_EQ(1, first.fields.size());
+    EXPECT_EQ(0, second.calls);
+
+    a->testOut.unsubscribe(&first);
+    EXPECT_FALSE(a->testOut.flags & SAIField::SUBSCRIBED);
+    EXPECT_EQ(1, browser()->subscriptions.size());
+    a->customIn.set(SFString("y"));
+    cascade();
+    EXPECT_EQ(1, first.calls);
+}
+
+TEST_F(SubscriptionTests, ShouldSendObserverWritesInNextCascade) {
+    RouteTestNode* from = node();
+    RouteTestNode* to = node();
+    RecordingObserver observer;
+    observer.echo = &to->testIn;
+    from->testOut.subscribe(&observer);
+    unsigned int start = browser()->getCascade();
+    from->customIn.set(SFString("ab"));
+    cascade();
+    EXPECT_EQ(start + 2, browser()->getCascade());
+    EXPECT_EQ("abab", to->inValue);
+    EXPECT_FALSE(browser()->isUpdating());
+}
+
+TEST_F(SubscriptionTests, ShouldRejectInputField) {
+    RouteTestNode* node = this->node();
+    RecordingObserver observer;
+    EXPECT_THROW(node->testIn.subscribe(&observer), X3DError);
+    EXPECT_EQ(0, browser()->subscriptions.size());
+}
@@ -0,0 +1,105 @@
+#include "internal/Trace.h"
+
+#include <cstdio>
+
+class TraceTests : public RoutingTests {
+};
+
+TEST_F(TraceTests, ShouldNotRecordWhenDisabled) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    browser()->createRoute(from, "testOut", to, "testIn");
+    browser()->trace.clear();
+    from->testOut("foo");
+    browser()->route();
+    vector<TraceRecord> records;
+    browser()->trace.snapshot(records);
+    EXPECT_EQ(0, records.size());
+    browser()->reset();
+}
+
+TEST_F(TraceTests, ShouldRecordRouteActivations) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    from->realize();
+    to->realize();
+    Route* route = browser()->createRoute(from, "testOut", to, "testIn");
+    browser()->trace.enable(16);
+    unsigned int cascade = browser()->getCascade();
+    from->testOut("foo");
+    browser()->route();
+    browser()->endRoute();
+    from->testOut("bar");
+    browser()->route();
+    browser()->trace.disable();
+    vector<TraceRecord> records;
+    browser()->trace.snapshot(records);
+    ASSERT_EQ(2, records.size());
+    EXPECT_EQ(route->id, records[0].route);
+    EXPECT_EQ(cascade, records[0].cascade);
+    EXPECT_EQ(cascade + 1, records[1].cascade);
+    EXPECT_EQ(SFString("foo").digest(), records[0].digest);
+    EXPECT_EQ(SFString("bar").digest(), records[1].digest);
+    EXPECT_LE(records[0].stamp, records[1].stamp);
+    browser()->reset();
+}
+
+TEST_F(TraceTests, ShouldKeepNewestRecordsWhenFull) {
+    Trace trace;
+    trace.enable(4);
+    for (uint32_t i = 0; i < 10; i++)
+        trace.record(i, 0, i, 0);
+    vector<TraceRecord> records;
+    trace.snapshot(records);
+    ASSERT_EQ(4, records.size());
+    EXPECT_EQ(6, records[0].cascade);
+    EXPECT_EQ(9, records[3].cascade);
+}
+
+TEST_F(TraceTests, ShouldSaveAndLoad) {
+    RouteTestNode* from = browser()->createNode<RouteTestNode>("RouteTestNode");
+    RouteTestNode* to = browser()->createNode<RouteTestNode>("RouteTestNode");
+    browser()->addNamedNode("From", from);
+    browser()->addNamedNode("To", to);
+    from->realize();
+    to->realize();
+    Route* route = browser()->createRoute(from, "testOut", to, "testIn");
+    browser()->trace.enable(16);
+    browser()->trace.clear();
+    from->testOut("foo");
+    browser()->route();
+    browser()->trace.disable();
+    browser()->saveTrace("trace.tmp");
+    vector<TraceRecord> records;
+    map<uint32_t, string> routes;
+    Trace::load("trace.tmp", records, routes);
+    remove("trace.tmp");
+    ASSERT_EQ(1, records.size());
+    EXPECT_EQ(route->id, records[0].route);
+    EXPECT_EQ(route->describe(), routes[route->id]);
+    EXPECT_EQ("[RouteTestNode] From.testOut -> To.testIn [RouteTestNode]",
+              routes[route->id]);
+    browser()->reset();
+}
+
+TEST_F(TraceTests, ShouldRejectTruncatedRouteNames) {
+    map<uint32_t, string> names;
+    names[1] = "[RouteTestNode] From.testOut -> To.testIn [RouteTestNode]";
+    browser()->trace.clear();
+    browser()->trace.save("trace.tmp", names);
+    // cut the file off in the middle of the route's name
+    FILE* file = fopen("trace.tmp", "rb");
+    ASSERT_TRUE(file != NULL);
+    char bytes[256];
+    size_t size = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    file = fopen("trace.tmp", "wb");
+    fwrite(bytes, 1, size - 10, file);
+    fclose(file);
+    vector<TraceRecord> records;
+    map<uint32_t, string> routes;
+    EXPECT_THROW(Trace::load("trace.tmp", records, routes), X3DError);
+    remove("trace.tmp");
+}
@@ -131,3 +131,49 @@ TEST(TypeSystem, RealizedInputFieldShouldNotGet) {
     ASSERT_ANY_THROW(node->testField());
 }
 */
+
+/// @returns whether a value decodes back from its encoding
+static bool roundTrips(X3DField::Type type, const string& text) {
+    X3DField* value = X3DField::create(type);
+    X3DField* copy = X3DField::create(type);
+    std::istringstream is(text);
+    bool ok = value->parse(is);
+    ByteBuffer buffer;
+    value->encode(buffer);
+    Decoder in(&buffer.bytes[0], buffer.bytes.size());
+    ok = ok && copy->decode(in) && in.remaining() == 0 && *copy == *value;
+    delete value;
+    delete copy;
+    return ok;
+}
+
+TEST(TypeSystem, ValuesShouldDecodeTheirEncoding) {
+    EXPECT_TRUE(roundTrips(X3DField::SFBOOL, "true"));
+    EXPECT_TRUE(roundTrips(X3DField::SFINT32, "-7"));
+    EXPECT_TRUE(roundTrips(X3DField::SFSTRING, "\"foo bar\""));
+    EXPECT_TRUE(roundTrips(X3DField::SFROTATION, "0 1 0 1.5"));
+    EXPECT_TRUE(roundTrips(X3DField::SFVEC3D, "1 2 3"));
+    EXPECT_TRUE(roundTrips(X3DField::SFCOLORRGBA, "0 0.5 1 1"));
+    EXPECT_TRUE(roundTrips(X3DField::MFVEC3F, "1 2 3, 4 5 6"));
+    EXPECT_TRUE(roundTrips(X3DField::MFFLOAT, ""));
+}
+
+TEST(TypeSystem, ShortDecodeShouldLeaveValueUnchanged) {
+    SFVec3f value(1, 2, 3);
+    float data[2] = { 4, 5 };
+    Decoder in(data, sizeof(data));
+    EXPECT_FALSE(value.decode(in));
+    EXPECT_EQ(SFVec3f(1, 2, 3), value);
+}
+
+TEST(TypeSystem, MFValuesShouldAssignGenerically) {
+    X3DField* from = X3DField::create(X3DField::MFFLOAT);
+    X3DField* to = X3DField::create(X3DField::MFFLOAT);
+    std::istringstream is("1, 2, 3");
+    from->parse(is);
+    (*to)(*from);
+    EXPECT_TRUE(*to == *from);
+    EXPECT_THROW((*to)(SFFloat(1)), X3DError);
+    delete from;
+    delete to;
+}
@@ -0,0 +1,167 @@
+#include "internal/UpdateBuffer.h"
+#include "Interpolation/CoordinateInterpolator.h"
+
+using X3D::Interpolation::CoordinateInterpolator;
+
+/// frees another node when written
+class FreeingNode : public Node {
+public:
+    RouteTestNode* victim;
+
+    class FreeIn : public InField<FreeingNode,SFString> {
+        void action(const string& str) {
+            delete node()->victim;
+            node()->victim = NULL;
+        }
+    } freeIn;
+};
+
+class UpdateTests : public RoutingTests {
+protected:
+    void TearDown() {
+        browser()->reset();
+    }
+
+    RouteTestNode* node() {
+        RouteTestNode* node = browser()->createNode<RouteTestNode>("RouteTestNode");
+        node->realize();
+        return node;
+    }
+};
+
+TEST_F(UpdateTests, ShouldSendLastValueOnce) {
+    RouteTestNode* node = this->node();
+    browser()->beginUpdate();
+    EXPECT_TRUE(browser()->isUpdating());
+    node->testIn.set(SFString("a"));
+    node->countingInOut.set(SFString("a"));
+    node->testIn.set(SFString("b"));
+    node->countingInOut.set(SFString("b"));
+    EXPECT_EQ(0, node->inCount);
+    EXPECT_EQ(0, node->inOutFilterCount);
+    EXPECT_EQ(2, browser()->updates.size());
+    EXPECT_EQ(2, browser()->updates.replacedCount());
+
+    browser()->endUpdate();
+    EXPECT_FALSE(browser()->isUpdating());
+    EXPECT_EQ(1, node->inCount);
+    EXPECT_EQ("b", node->inValue);
+    EXPECT_EQ(1, node->inOutFilterCount);
+    EXPECT_EQ(1, node->inOutActionCount);
+    EXPECT_EQ("b", node->countingInOut());
+    EXPECT_EQ(0, browser()->updates.size());
+}
+
+TEST_F(UpdateTests, ShouldRouteInOneCascade) {
+    RouteTestNode* from = node();
+    RouteTestNode* to = node();
+    browser()->createRoute(from, "testOut", to, "testIn");
+    unsigned int cascade = browser()->getCascade();
+    browser()->beginUpdate();
+    from->customIn.set(SFString("ab"));
+    to->testInOut.set(SFString("c"));
+    browser()->endUpdate();
+    EXPECT_EQ(cascade + 1, browser()->getCascade());
+    EXPECT_EQ("abab", to->inValue);
+    EXPECT_EQ("c", to->testInOut());
+}
+
+TEST_F(UpdateTests, ShouldNest) {
+    RouteTestNode* node = this->node();
+    browser()->beginUpdate();
+    browser()->beginUpdate();
+    node->testIn.set(SFString("a"));
+    browser()->endUpdate();
+    EXPECT_TRUE(browser()->isUpdating());
+    EXPECT_EQ(0, node->inCount);
+    browser()->endUpdate();
+    EXPECT_EQ(1, node->inCount);
+    EXPECT_THROW(browser()->endUpdate(), X3DError);
+}
+
+TEST_F(UpdateTests, ShouldRejectWrongType) {
+    RouteTestNode* node = this->node();
+    browser()->beginUpdate();
+    EXPECT_THROW(node->testIn.set(SFInt32(1)), X3DError);
+    browser()->endUpdate();
+    EXPECT_EQ(0, node->inCount);
+}
+
+TEST_F(UpdateTests, ShouldBufferMFValues) {
+    CoordinateInterpolator* node = browser()->createNode<
+        CoordinateInterpolator>("CoordinateInterpolator");
+    node->realize();
+    MFVec3fArray first, last;
+    first.array().push_back(SFVec3f(1.0f, 2.0f, 3.0f));
+    last.array().push_back(SFVec3f(4.0f, 5.0f, 6.0f));
+    last.array().push_back(SFVec3f(7.0f, 8.0f, 9.0f));
+    browser()->beginUpdate();
+    node->keyValue.set(first);
+    node->keyValue.set(last);
+    EXPECT_EQ(0, node->keyValue().array().size());
+    EXPECT_EQ(1, browser()->updates.size());
+    browser()->endUpdate();
+    EXPECT_TRUE(node->keyValue() == last);
+}
+
+TEST_F(UpdateTests, ShouldDropWritesOfFreedFields) {
+    // made by hand, since the browser frees the nodes it makes
+    RouteTestNode* gone = new RouteTestNode();
+    gone->testIn.setNode(gone);
+    gone->realize();
+    RouteTestNode* kept = node();
+    browser()->beginUpdate();
+    gone->testIn.set(SFString("a"));
+    kept->testIn.set(SFString("b"));
+    delete gone;
+    EXPECT_EQ(1, browser()->updates.size());
+    // a field made where the freed one was starts with no write
+    RouteTestNode* fresh = node();
+    fresh->testIn.set(SFString("c"));
+    browser()->endUpdate();
+    EXPECT_EQ(1, kept->inCount);
+    EXPECT_EQ("b", kept->inValue);
+    EXPECT_EQ(1, fresh->inCount);
+    EXPECT_EQ("c", fresh->inValue);
+}
+
+TEST_F(UpdateTests, ShouldReuseSlotsForOtherTypes) {
+    RouteTestNode* node = this->node();
+    CoordinateInterpolator* interp = browser()->createNode<
+        CoordinateInterpolator>("CoordinateInterpolator");
+    interp->realize();
+    browser()->beginUpdate();
+    node->testIn.set(SFString("a"));
+    browser()->endUpdate();
+    MFVec3fArray value;
+    value.array().push_back(SFVec3f(1.0f, 2.0f, 3.0f));
+    browser()->beginUpdate();
+    interp->keyValue.set(value);
+    node->testIn.set(SFString("b"));
+    node->testIn.set(SFString("c"));
+    browser()->endUpdate();
+    EXPECT_TRUE(interp->keyValue() == value);
+    EXPECT_EQ(2, node->inCount);
+    EXPECT_EQ("c", node->inValue);
+}
+
+TEST_F(UpdateTests, ShouldDropWritesOfFieldsFreedWhileSending) {
+    // made by hand, since the browser frees the nodes it makes
+    FreeingNode* freeing = new FreeingNode();
+    freeing->freeIn.setNode(freeing);
+    freeing->realize();
+    freeing->victim = new RouteTestNode();
+    freeing->victim->testIn.setNode(freeing->victim);
+    freeing->victim->realize();
+    RouteTestNode* kept = node();
+    browser()->beginUpdate();
+    freeing->freeIn.set(SFString("x"));
+    freeing->victim->testIn.set(SFString("a"));
+    kept->testIn.set(SFString("b"));
+    browser()->endUpdate();
+    EXPECT_TRUE(freeing->victim == NULL);
+    EXPECT_EQ(0, browser()->updates.size());
+    EXPECT_EQ(1, kept->inCount);
+    EXPECT_EQ("b", kept->inValue);
+    delete freeing;
+}
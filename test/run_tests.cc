@@ -43,12 +43,36 @@ Browser* browser() {
 #include "internal/FieldIteratorTests.h"
 #include "internal/RouteTests.h"
 #include "internal/RoutingTests.h"
+#include "internal/RouteTableTests.h"
 #include "internal/XmlLoadTests.h"
 #include "internal/ParseTests.h"
 #include "internal/DynamicFieldTests.h"
 #include "internal/MFNodeTests.h"
 #include "internal/CloneTests.h"
+#include "internal/ScopeTests.h"
+#include "internal/NodeDefTests.h"
+#include "internal/TraceTests.h"
+#include "internal/ProfilerTests.h"
+#include "internal/SceneGeneratorTests.h"
+#include "internal/MemoryReportTests.h"
+#include "internal/DemandTests.h"
+#include "internal/RouteGraphTests.h"
+#include "internal/PipelineTests.h"
+#include "internal/SnapshotTests.h"
+#include "internal/InjectionTests.h"
+#include "internal/UpdateTests.h"
+#include "internal/SubscriptionTests.h"
+#include "internal/SharedExportTests.h"
+#include "internal/SAIServerTests.h"
+#include "internal/DeltaStreamTests.h"
+#include "internal/CheckpointTests.h"
+#include "internal/EventLogTests.h"
+#include "internal/BoundsTests.h"
+#include "internal/SpatialQueryTests.h"
 #include "Core/X3DBindableNodeTests.h"
+#include "Interpolation/CoordinateInterpolatorTests.h"
+#include "Grouping/TransformTests.h"
+#include "Grouping/StaticGroupTests.h"
 //#include "Test/TestSuiteTests.h"
 #include "X3DTests.h"
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Synthetic scene generator, for load and cascade stress testing.
+ *
+ * usage: x3dgen [options] [outfile]
+ *
+ *   -n nodes    pick the number of sensor units to give about this many
+ *               nodes (overrides -s)
+ *   -s sensors  number of TimeSensor units (default 8)
+ *   -i count    interpolators routed from each sensor (default 4)
+ *   -c length   identity interpolators chained behind each (default 1)
+ *   -F          no fan-in sink
+ *   -d depth    Transform/Group nesting around each unit (default 2)
+ *   -k keys     keys per interpolator, at least 2 (default 8)
+ *   -p points   coordinates per key of a CoordinateInterpolator in
+ *               each unit (default 0, none)
+ *
+ * Writes the scene to outfile, or to standard output, and prints the
+ * node and route counts to standard error. See SceneGenerator.h for
+ * the scene layout.
+ */
+
+#include "internal/SceneGenerator.h"
+#include "internal/errors.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace X3D;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static void usage(const char* name) {
+    cerr << "usage: " << name << " [-n nodes] [-s sensors] [-i interpolators]"
+         << " [-c chain] [-F] [-d depth] [-k keys] [-p points] [outfile]" << endl;
+}
+
+int main(int argc, char** argv) {
+    SceneGenerator gen;
+    size_t nodes = 0;
+    const char* filename = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (!strcmp(arg, "-F")) {
+            gen.fanIn = false;
+            continue;
+        }
+        if (arg[0] != '-') {
+            filename = arg;
+            continue;
+        }
+        if (i + 1 >= argc || strlen(arg) != 2) {
+            usage(argv[0]);
+            return 2;
+        }
+        size_t value = strtoul(argv[++i], NULL, 10);
+        switch (arg[1]) {
+            case 'n': nodes = value; break;
+            case 's': gen.sensors = value; break;
+            case 'i': gen.interpolators = value; break;
+            case 'c': gen.chain = value; break;
+            case 'd': gen.depth = value; break;
+            case 'k': gen.keys = value; break;
+            case 'p': gen.points = value; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (gen.keys < 2) {
+        cerr << argv[0] << ": interpolators need at least 2 keys" << endl;
+        return 2;
+    }
+    if (nodes > 0)
+        gen.scaleTo(nodes);
+
+    try {
+        if (filename == NULL)
+            gen.write(cout);
+        else
+            gen.write(filename);
+    } catch (X3DError& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    cerr << gen.countNodes() << " nodes, " << gen.countRoutes() << " routes" << endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Replays an event log written by Browser::recorder into the scene it
+ * was recorded against, for reproducible timing runs.
+ *
+ * usage: x3dreplay [-s] scene.x3d events.log
+ *
+ *   -s  print only the summary, not a line per cascade
+ *
+ * Prints the id, simulation time, wall-clock time and output digest of
+ * each cascade, marking those which don't match the log, and then the
+ * total and slowest times. Exits with status 1 if any cascade didn't
+ * match.
+ */
+
+#include "internal/Browser.h"
+#include "internal/EventLog.h"
+#include "internal/World.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <libxml/parser.h>
+
+using namespace X3D;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+int main(int argc, char** argv) {
+    bool summary = false;
+    const char* scene = NULL;
+    const char* log = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s"))
+            summary = true;
+        else if (scene == NULL)
+            scene = argv[i];
+        else
+            log = argv[i];
+    }
+    if (log == NULL) {
+        cerr << "usage: " << argv[0] << " [-s] scene.x3d events.log" << endl;
+        return 2;
+    }
+    LIBXML_TEST_VERSION
+    bool matched;
+    try {
+        Browser browser;
+        World* world = World::read(&browser, scene);
+        EventReplayer replayer;
+        replayer.open(log);
+        matched = replayer.run();
+        replayer.print(cout, !summary);
+        delete world;
+    } catch (X3DError& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    xmlCleanupParser();
+    return matched ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Reader for shared-memory field exports, for checking what an
+ * out-of-process consumer sees.
+ *
+ * usage: x3dshm [-n count] [-i ms] name
+ *
+ *   -n count  read the region this many times (default 1)
+ *   -i ms     milliseconds between reads (default 100)
+ *
+ * Prints the cascade and time of each read, and for each exported
+ * field its name, type, size, last write and dropped values, followed
+ * by the first few components of numeric values. See SharedExport.h
+ * for the layout.
+ */
+
+#include "internal/SharedExport.h"
+#include "internal/X3DField.h"
+#include "internal/errors.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+using namespace X3D;
+using std::cerr;
+using std::endl;
+
+/// most components of a value to print
+static const size_t MAX_COMPONENTS = 8;
+
+static void usage(const char* name) {
+    cerr << "usage: " << name << " [-n count] [-i ms] name" << endl;
+}
+
+/**
+ * Print the leading components of a packed value of a numeric type.
+ *
+ * @param type field type
+ * @param data packed value
+ * @param size bytes of packed value
+ */
+static void printComponents(X3DField::Type type, const char* data, size_t size) {
+    bool multiple = type >= X3DField::MFBOOL;
+    if (multiple) {
+        unsigned int count;
+        if (size < sizeof(count))
+            return;
+        memcpy(&count, data, sizeof(count));
+        printf(" [%u]", count);
+        data += sizeof(count);
+        size -= sizeof(count);
+        type = (X3DField::Type) (type - X3DField::MFBOOL + X3DField::SFBOOL);
+    }
+    size_t width;
+    switch (type) {
+        case X3DField::SFCOLOR: case X3DField::SFCOLORRGBA:
+        case X3DField::SFFLOAT: case X3DField::SFROTATION:
+        case X3DField::SFVEC2F: case X3DField::SFVEC3F: case X3DField::SFVEC4F:
+        case X3DField::SFMATRIX3F: case X3DField::SFMATRIX4F:
+        case X3DField::SFINT32:
+            width = 4;
+            break;
+        case X3DField::SFDOUBLE: case X3DField::SFTIME:
+        case X3DField::SFVEC2D: case X3DField::SFVEC3D: case X3DField::SFVEC4D:
+        case X3DField::SFMATRIX3D: case X3DField::SFMATRIX4D:
+            width = 8;
+            break;
+        default:
+            return;
+    }
+    for (size_t i = 0; i < size / width && i < MAX_COMPONENTS; i++) {
+        if (type == X3DField::SFINT32) {
+            int x;
+            memcpy(&x, data + i * width, width);
+            printf(" %d", x);
+        } else if (width == 4) {
+            float x;
+            memcpy(&x, data + i * width, width);
+            printf(" %g", x);
+        } else {
+            double x;
+            memcpy(&x, data + i * width, width);
+            printf(" %g", x);
+        }
+    }
+    if (size / width > MAX_COMPONENTS)
+        printf(" ...");
+}
+
+/**
+ * Copy a consistent state of the region and print it.
+ *
+ * @param reader open reader
+ */
+static void print(const SharedExportReader& reader) {
+    vector<SharedExport::Entry> entries(reader.size());
+    vector< vector<char> > values(reader.size());
+    SharedExport::Header header;
+    uint64_t sequence;
+    do {
+        sequence = reader.begin();
+        header = reader.header();
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i] = reader.entry(i);
+            size_t size = entries[i].size;
+            if (size > entries[i].capacity)
+                size = 0;
+            const char* data = (const char*) reader.data(i);
+            values[i].assign(data, data + size);
+        }
+    } while (!reader.validate(sequence));
+
+    printf("cascade %lu, time %g, sequence %lu\n", (unsigned long) header.cascade,
+        header.time, (unsigned long) header.sequence);
+    for (size_t i = 0; i < entries.size(); i++) {
+        const SharedExport::Entry& e = entries[i];
+        X3DField::Type type = (X3DField::Type) e.type;
+        printf("    %-24s %-12s %6u/%-6u bytes  seq %-8lu dropped %u:",
+            e.name, X3DField::getTypeName(type).c_str(), e.size, e.capacity,
+            (unsigned long) e.sequence, e.dropped);
+        if (!values[i].empty())
+            printComponents(type, &values[i][0], values[i].size());
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = 1;
+    size_t interval = 100;
+    const char* name = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (arg[0] != '-') {
+            name = arg;
+            continue;
+        }
+        if (i + 1 >= argc || strlen(arg) != 2) {
+            usage(argv[0]);
+            return 2;
+        }
+        size_t value = strtoul(argv[++i], NULL, 10);
+        switch (arg[1]) {
+            case 'n': count = value; break;
+            case 'i': interval = value; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (name == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    SharedExportReader reader;
+    try {
+        if (!reader.open(name)) {
+            cerr << argv[0] << ": no export named " << name << endl;
+            return 1;
+        }
+    } catch (X3DError& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0)
+            usleep(interval * 1000);
+        print(reader);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2009 Nathan Matthews <lowentropy@gmail.com>
+ *
+ * This file is part of SimpleX3D.
+ * 
+ * SimpleX3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * SimpleX3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleX3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Decoder for event trace files written by Browser::saveTrace().
+ *
+ * usage: x3dtrace [-j] tracefile
+ *
+ * By default, prints one line per route activation. With -j, prints
+ * Chrome trace JSON (load it in chrome://tracing), with one instant
+ * event per route activation and one span per cascade.
+ */
+
+#include "internal/Trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace X3D;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static const string& routeName(map<uint32_t, string>& routes, uint32_t id) {
+    if (!routes.count(id)) {
+        char buf[32];
+        sprintf(buf, "route %u", id);
+        routes[id] = buf;
+    }
+    return routes[id];
+}
+
+static string jsonString(const string& s) {
+    string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void printText(vector<TraceRecord>& records, map<uint32_t, string>& routes) {
+    uint64_t start = records.empty() ? 0 : records[0].stamp;
+    char buf[128];
+    for (size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& r = records[i];
+        sprintf(buf, "%8u %12.6f %+12.3fus  %08x  ",
+            r.cascade, r.time, (r.stamp - start) / 1000.0, r.digest);
+        cout << buf << routeName(routes, r.route) << endl;
+    }
+}
+
+static void printCascade(uint32_t cascade, uint64_t begin, uint64_t end,
+                         uint64_t start, bool& first) {
+    char buf[160];
+    sprintf(buf, "%s{\"name\":\"cascade %u\",\"cat\":\"cascade\",\"ph\":\"X\","
+                 "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+            first ? "" : ",\n", cascade,
+            (begin - start) / 1000.0, (end - begin) / 1000.0);
+    cout << buf;
+    first = false;
+}
+
+static void printJson(vector<TraceRecord>& records, map<uint32_t, string>& routes) {
+    uint64_t start = records.empty() ? 0 : records[0].stamp;
+    bool first = true;
+    char buf[160];
+    cout << "{\"traceEvents\":[" << endl;
+    for (size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& r = records[i];
+        cout << (first ? "" : ",\n") << "{\"name\":"
+             << jsonString(routeName(routes, r.route));
+        sprintf(buf, ",\"cat\":\"route\",\"ph\":\"i\",\"s\":\"t\","
+                     "\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{"
+                     "\"cascade\":%u,\"time\":%.6f,\"digest\":\"%08x\"}}",
+                (r.stamp - start) / 1000.0, r.cascade, r.time, r.digest);
+        cout << buf;
+        first = false;
+    }
+    // one span for each run of records in the same cascade
+    size_t i = 0;
+    while (i < records.size()) {
+        size_t j = i;
+        while (j + 1 < records.size() && records[j + 1].cascade == records[i].cascade)
+            j++;
+        printCascade(records[i].cascade, records[i].stamp, records[j].stamp, start, first);
+        i = j + 1;
+    }
+    cout << endl << "]}" << endl;
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    const char* filename = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j"))
+            json = true;
+        else
+            filename = argv[i];
+    }
+    if (filename == NULL) {
+        cerr << "usage: " << argv[0] << " [-j] tracefile" << endl;
+        return 2;
+    }
+    vector<TraceRecord> records;
+    map<uint32_t, string> routes;
+    try {
+        Trace::load(filename, records, routes);
+    } catch (X3DError& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    if (json)
+        printJson(records, routes);
+    else
+        printText(records, routes);
+    return 0;
+}